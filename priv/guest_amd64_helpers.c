@@ -2991,7 +2991,9 @@ void amd64g_dirtyhelper_CPUID_avx_and_cx16 ( VexGuestAMD64State* st )
          switch (old_ecx) {
             case 0x00000000: SET_ABCD(0x00000007, 0x00000340,
                                       0x00000340, 0x00000000); break;
-            case 0x00000001: SET_ABCD(0x00000000, 0x00000000,
+            /* XSAVEOPT and XSAVEC, and the compacted size for
+               XCR0 = 7. */
+            case 0x00000001: SET_ABCD(0x00000003, 0x00000340,
                                       0x00000000, 0x00000000); break;
             case 0x00000002: SET_ABCD(0x00000100, 0x00000240,
                                       0x00000000, 0x00000000); break;
@@ -3164,7 +3166,9 @@ void amd64g_dirtyhelper_CPUID_avx2 ( VexGuestAMD64State* st )
          switch (old_ecx) {
             case 0x00000000: SET_ABCD(0x00000007, 0x00000340,
                                       0x00000340, 0x00000000); break;
-            case 0x00000001: SET_ABCD(0x00000000, 0x00000000,
+            /* XSAVEOPT and XSAVEC, and the compacted size for
+               XCR0 = 7. */
+            case 0x00000001: SET_ABCD(0x00000003, 0x00000340,
                                       0x00000000, 0x00000000); break;
             case 0x00000002: SET_ABCD(0x00000100, 0x00000240,
                                       0x00000000, 0x00000000); break;
@@ -11587,9 +11587,14 @@ static Long dis_LDMXCSR ( const VexAbiInfo* vbi, Prefix pfx,
 }
 
 
-static void gen_XSAVE_SEQUENCE ( IRTemp addr, IRTemp rfbm )
+/* Write the components selected by |xstate_bv| to the XSAVE area at
+   |addr|.  For XSAVE and FXSAVE that is all of |rfbm|; XSAVEC and
+   XSAVEOPT pass rfbm & XINUSE, leaving out components that are in
+   their initial configuration.  MXCSR is written regardless if
+   rfbm[1] or rfbm[2] is set. */
+static void gen_XSAVE_SEQUENCE ( IRTemp addr, IRTemp xstate_bv, IRTemp rfbm )
 {
-   /* ------ rfbm[0] gates the x87 state ------ */
+   /* ------ xstate_bv[0] gates the x87 state ------ */
 
    /* Uses dirty helper: 
          void amd64g_do_XSAVE_COMPONENT_0 ( VexGuestAMD64State*, ULong )
@@ -11600,7 +11605,7 @@ static void gen_XSAVE_SEQUENCE ( IRTemp addr, IRTemp rfbm )
                     &amd64g_dirtyhelper_XSAVE_COMPONENT_0,
                     mkIRExprVec_2( IRExpr_BBPTR(), mkexpr(addr) )
                  );
-   d0->guard = binop(Iop_CmpEQ64, binop(Iop_And64, mkexpr(rfbm), mkU64(1)),
+   d0->guard = binop(Iop_CmpEQ64, binop(Iop_And64, mkexpr(xstate_bv), mkU64(1)),
                      mkU64(1));
 
    /* Declare we're writing memory.  Really, bytes 24 through 31
@@ -11637,53 +11642,34 @@ static void gen_XSAVE_SEQUENCE ( IRTemp addr, IRTemp rfbm )
 
    stmt( IRStmt_Dirty(d0) );
 
-   /* ------ rfbm[1] gates the SSE state ------ */
+   /* ------ xstate_bv[1] gates the SSE state ------ */
 
-   IRTemp rfbm_1    = newTemp(Ity_I64);
-   IRTemp rfbm_1or2 = newTemp(Ity_I64);
-   assign(rfbm_1,    binop(Iop_And64, mkexpr(rfbm), mkU64(2)));
-   assign(rfbm_1or2, binop(Iop_And64, mkexpr(rfbm), mkU64(6)));
+   IRTemp xstate_bv_1 = newTemp(Ity_I64);
+   IRTemp rfbm_1or2   = newTemp(Ity_I64);
+   assign(xstate_bv_1, binop(Iop_And64, mkexpr(xstate_bv), mkU64(2)));
+   assign(rfbm_1or2,   binop(Iop_And64, mkexpr(rfbm), mkU64(6)));
 
-   IRExpr* guard_1    = binop(Iop_CmpEQ64, mkexpr(rfbm_1),    mkU64(2));
-   IRExpr* guard_1or2 = binop(Iop_CmpNE64, mkexpr(rfbm_1or2), mkU64(0));
+   IRExpr* guard_1    = binop(Iop_CmpEQ64, mkexpr(xstate_bv_1), mkU64(2));
+   IRExpr* guard_1or2 = binop(Iop_CmpNE64, mkexpr(rfbm_1or2),   mkU64(0));
 
-   /* Uses dirty helper: 
-         void amd64g_do_XSAVE_COMPONENT_1_EXCLUDING_XMMREGS
-                 ( VexGuestAMD64State*, ULong )
-      This creates only MXCSR and MXCSR_MASK.  We need to do this if
+   /* MXCSR and MXCSR_MASK, at bytes 24 .. 31.  We need to do this if
       either components 1 (SSE) or 2 (AVX) are requested.  Hence the
-      guard condition is a bit more complex.
-   */
-   IRDirty* d1 = unsafeIRDirty_0_N (
-                    0/*regparms*/, 
-                    "amd64g_dirtyhelper_XSAVE_COMPONENT_1_EXCLUDING_XMMREGS",
-                    &amd64g_dirtyhelper_XSAVE_COMPONENT_1_EXCLUDING_XMMREGS,
-                    mkIRExprVec_2( IRExpr_BBPTR(), mkexpr(addr) )
-                 );
-   d1->guard = guard_1or2;
-
-   /* Declare we're writing memory: MXCSR and MXCSR_MASK.  Note that
-      the code for rbfm[0] just above claims a write of 0 .. 159, so
-      this duplicates it.  But at least correctly connects 24 .. 31 to
-      the MXCSR guest state representation (SSEROUND field). */
-   d1->mFx   = Ifx_Write;
-   d1->mAddr = binop(Iop_Add64, mkexpr(addr), mkU64(24));
-   d1->mSize = 8;
-
-   /* declare we're reading guest state */
-   d1->nFxState = 1;
-   vex_bzero(&d1->fxState, sizeof(d1->fxState));
-
-   d1->fxState[0].fx     = Ifx_Read;
-   d1->fxState[0].offset = OFFB_SSEROUND;
-   d1->fxState[0].size   = sizeof(ULong);
-
-   /* Call the helper.  This creates MXCSR and MXCSR_MASK but nothing
-      else.  We do the actual register array, XMM[0..15], separately,
-      in order that any undefinedness in the XMM registers is tracked
-      separately by Memcheck and does not "infect" the in-memory
-      shadow for the other parts of the image. */
-   stmt( IRStmt_Dirty(d1) );
+      guard condition is a bit more complex.  The only thing MXCSR
+      depends on is SSEROUND[1:0] (see amd64g_create_mxcsr), so this
+      is simple enough to do inline, as a single 64-bit store. */
+   IRTemp mxcsr = newTemp(Ity_I64);
+   assign(mxcsr,
+          binop(Iop_Or64,
+                mkU64(0x1F80),
+                binop(Iop_Shl64,
+                      unop(Iop_32Uto64, get_sse_roundingmode()),
+                      mkU8(13))));
+   stmt( IRStmt_StoreG(
+            Iend_LE,
+            binop(Iop_Add64, mkexpr(addr), mkU64(24)),
+            binop(Iop_Or64, mkexpr(mxcsr), mkU64(0xFFFFULL << 32)),
+            guard_1or2
+   ));
 
    /* And now the XMMs themselves. */
    UInt reg;
@@ -11696,14 +11682,14 @@ static void gen_XSAVE_SEQUENCE ( IRTemp addr, IRTemp rfbm )
       ));
    }
 
-   /* ------ rfbm[2] gates the AVX state ------ */
+   /* ------ xstate_bv[2] gates the AVX state ------ */
    /* Component 2 is just a bunch of register saves, so we'll do it
       inline, just to be simple and to be Memcheck friendly. */
 
-   IRTemp rfbm_2 = newTemp(Ity_I64);
-   assign(rfbm_2, binop(Iop_And64, mkexpr(rfbm), mkU64(4)));
+   IRTemp xstate_bv_2 = newTemp(Ity_I64);
+   assign(xstate_bv_2, binop(Iop_And64, mkexpr(xstate_bv), mkU64(4)));
 
-   IRExpr* guard_2 = binop(Iop_CmpEQ64, mkexpr(rfbm_2), mkU64(4));
+   IRExpr* guard_2 = binop(Iop_CmpEQ64, mkexpr(xstate_bv_2), mkU64(4));
 
    for (reg = 0; reg < 16; reg++) {
       stmt( IRStmt_StoreG(
@@ -11716,6 +11702,54 @@ static void gen_XSAVE_SEQUENCE ( IRTemp addr, IRTemp rfbm )
 }
 
 
+/* VEX's caller is assumed to have checked that XCR0 is 7 (x87, SSE
+   and AVX state enabled). */
+#define aSSUMED_XCR0_VALUE 7ULL
+
+/* The requested-feature bitmap for the XSAVE family: EDX:EAX & XCR0. */
+static IRTemp gen_XSAVE_RFBM ( void )
+{
+   IRTemp rfbm = newTemp(Ity_I64);
+   assign(rfbm,
+          binop(Iop_And64,
+                binop(Iop_Or64,
+                      binop(Iop_Shl64,
+                            unop(Iop_32Uto64, getIRegRDX(4)), mkU8(32)),
+                      unop(Iop_32Uto64, getIRegRAX(4))),
+                mkU64(aSSUMED_XCR0_VALUE)));
+   return rfbm;
+}
+
+/* XINUSE, the components not in their initial configuration, as used
+   by the init optimisation of XSAVEC and XSAVEOPT.  We don't track
+   that for the x87 and SSE state, and claim they are always in use,
+   which the architecture allows.  The AVX state is in its initial
+   configuration exactly when the upper halves of all the YMM
+   registers are zero, which is cheap enough to check, and usually
+   the case at a call boundary, where these are mostly used. */
+static IRTemp gen_XINUSE ( void )
+{
+   IRTemp  xinuse = newTemp(Ity_I64);
+   IRTemp  upper  = newTemp(Ity_V128);
+   IRExpr* orred  = getYMMRegLane128(0, 1);
+   UInt    reg;
+   for (reg = 1; reg < 16; reg++)
+      orred = binop(Iop_OrV128, orred, getYMMRegLane128(reg, 1));
+   assign(upper, orred);
+   assign(xinuse,
+          binop(Iop_Or64,
+                mkU64(3),
+                binop(Iop_Shl64,
+                      unop(Iop_1Uto64,
+                           binop(Iop_CmpNE64,
+                                 binop(Iop_Or64,
+                                       unop(Iop_V128HIto64, mkexpr(upper)),
+                                       unop(Iop_V128to64, mkexpr(upper))),
+                                 mkU64(0))),
+                      mkU8(2))));
+   return xinuse;
+}
+
 static Long dis_XSAVE ( const VexAbiInfo* vbi,
                         Prefix pfx, Long delta, Int sz )
 {
@@ -11738,19 +11772,9 @@ static Long dis_XSAVE ( const VexAbiInfo* vbi,
 
    DIP("%sxsave %s\n", sz==8 ? "rex64/" : "", dis_buf);
 
-   /* VEX's caller is assumed to have checked this. */
-   const ULong aSSUMED_XCR0_VALUE = 7;
+   IRTemp rfbm = gen_XSAVE_RFBM();
 
-   IRTemp rfbm = newTemp(Ity_I64);
-   assign(rfbm,
-          binop(Iop_And64,
-                binop(Iop_Or64,
-                      binop(Iop_Shl64,
-                            unop(Iop_32Uto64, getIRegRDX(4)), mkU8(32)),
-                      unop(Iop_32Uto64, getIRegRAX(4))),
-                mkU64(aSSUMED_XCR0_VALUE)));
-
-   gen_XSAVE_SEQUENCE(addr, rfbm);
+   gen_XSAVE_SEQUENCE(addr, rfbm, rfbm);
 
    /* Finally, we need to update XSTATE_BV in the XSAVE header area, by
       OR-ing the RFBM value into it. */
@@ -11765,6 +11789,85 @@ static Long dis_XSAVE ( const VexAbiInfo* vbi,
 }
 
 
+static Long dis_XSAVEOPT ( const VexAbiInfo* vbi,
+                           Prefix pfx, Long delta, Int sz )
+{
+   /* As XSAVE, but using the init optimisation: components in their
+      initial configuration are not written, and have their XSTATE_BV
+      bits cleared.  We don't do the modified optimisation, which
+      would require knowing that the area was last loaded by an XRSTOR
+      of the same state; writing the state anyway is always allowed. */
+   IRTemp addr  = IRTemp_INVALID;
+   Int    alen  = 0;
+   HChar  dis_buf[50];
+   UChar  modrm = getUChar(delta);
+   vassert(!epartIsReg(modrm)); /* ensured by caller */
+   vassert(sz == 4 || sz == 8); /* ditto */
+
+   addr = disAMode ( &alen, vbi, pfx, delta, dis_buf, 0 );
+   delta += alen;
+   gen_SEGV_if_not_64_aligned(addr);
+
+   DIP("%sxsaveopt %s\n", sz==8 ? "rex64/" : "", dis_buf);
+
+   IRTemp rfbm      = gen_XSAVE_RFBM();
+   IRTemp xstate_bv = newTemp(Ity_I64);
+   assign(xstate_bv, binop(Iop_And64, mkexpr(rfbm), mkexpr(gen_XINUSE())));
+
+   gen_XSAVE_SEQUENCE(addr, xstate_bv, rfbm);
+
+   /* XSTATE_BV[i] becomes XINUSE[i] for the components in RFBM, and
+      is unchanged for the rest.  All of them are in the low byte. */
+   IRTemp addr_plus_512 = newTemp(Ity_I64);
+   assign(addr_plus_512, binop(Iop_Add64, mkexpr(addr), mkU64(512)));
+   storeLE( mkexpr(addr_plus_512),
+            binop(Iop_Or8,
+                  unop(Iop_64to8, mkexpr(xstate_bv)),
+                  binop(Iop_And8,
+                        unop(Iop_Not8, unop(Iop_64to8, mkexpr(rfbm))),
+                        loadLE(Ity_I8, mkexpr(addr_plus_512)))) );
+
+   return delta;
+}
+
+
+static Long dis_XSAVEC ( const VexAbiInfo* vbi,
+                         Prefix pfx, Long delta, Int sz )
+{
+   /* XSAVEC writes the compacted format, using the init optimisation.
+      With XCR0 limited to components 0 .. 2 the compacted layout is
+      the same as the standard one, since component 2 is the first
+      extended component and so lives at 576 either way; the only
+      differences are the header and which components get written. */
+   IRTemp addr  = IRTemp_INVALID;
+   Int    alen  = 0;
+   HChar  dis_buf[50];
+   UChar  modrm = getUChar(delta);
+   vassert(!epartIsReg(modrm)); /* ensured by caller */
+   vassert(sz == 4 || sz == 8); /* ditto */
+
+   addr = disAMode ( &alen, vbi, pfx, delta, dis_buf, 0 );
+   delta += alen;
+   gen_SEGV_if_not_64_aligned(addr);
+
+   DIP("%sxsavec %s\n", sz==8 ? "rex64/" : "", dis_buf);
+
+   IRTemp rfbm      = gen_XSAVE_RFBM();
+   IRTemp xstate_bv = newTemp(Ity_I64);
+   assign(xstate_bv, binop(Iop_And64, mkexpr(rfbm), mkexpr(gen_XINUSE())));
+
+   gen_XSAVE_SEQUENCE(addr, xstate_bv, rfbm);
+
+   /* The header: XSTATE_BV = RFBM & XINUSE, and XCOMP_BV = RFBM with
+      bit 63 set to mark the compacted format. */
+   storeLE( binop(Iop_Add64, mkexpr(addr), mkU64(512)), mkexpr(xstate_bv) );
+   storeLE( binop(Iop_Add64, mkexpr(addr), mkU64(512+8)),
+            binop(Iop_Or64, mkexpr(rfbm), mkU64(1ULL << 63)) );
+
+   return delta;
+}
+
+
 static Long dis_FXSAVE ( const VexAbiInfo* vbi,
                          Prefix pfx, Long delta, Int sz )
 {
@@ -11787,7 +11890,7 @@ static Long dis_FXSAVE ( const VexAbiInfo* vbi,
       fold out the unused (AVX) parts accordingly. */
    IRTemp rfbm = newTemp(Ity_I64);
    assign(rfbm, mkU64(3));
-   gen_XSAVE_SEQUENCE(addr, rfbm);
+   gen_XSAVE_SEQUENCE(addr, rfbm, rfbm);
 
    return delta;
 }
@@ -11890,44 +11993,21 @@ static void gen_XRSTOR_SEQUENCE ( IRTemp addr, IRTemp xstate_bv, IRTemp rfbm )
       putGuarded(xmmGuestRegOffset(reg), rfbm_1e, mkV128(0));
    }
 
-   /* And now possibly restore from MXCSR/MXCSR_MASK */
-   /* Uses dirty helper: 
-         void amd64g_do_XRSTOR_COMPONENT_1_EXCLUDING_XMMREGS
-                 ( VexGuestAMD64State*, ULong )
-      This restores from only MXCSR and MXCSR_MASK.  We need to do
-      this if either components 1 (SSE) or 2 (AVX) are requested.
-      Hence the guard condition is a bit more complex.
-   */
-   IRDirty* d1 = unsafeIRDirty_0_N (
-                    0/*regparms*/, 
-                    "amd64g_dirtyhelper_XRSTOR_COMPONENT_1_EXCLUDING_XMMREGS",
-                    &amd64g_dirtyhelper_XRSTOR_COMPONENT_1_EXCLUDING_XMMREGS,
-                    mkIRExprVec_2( IRExpr_BBPTR(), mkexpr(addr) )
-                ) ;
-   d1->guard = restore_1or2e;
-
-   /* Declare we're reading memory: MXCSR and MXCSR_MASK.  Note that
-      the code for rbfm[0] just above claims a read of 0 .. 159, so
-      this duplicates it.  But at least correctly connects 24 .. 31 to
-      the MXCSR guest state representation (SSEROUND field). */
-   d1->mFx   = Ifx_Read;
-   d1->mAddr = binop(Iop_Add64, mkexpr(addr), mkU64(24));
-   d1->mSize = 8;
-
-   /* declare we're writing guest state */
-   d1->nFxState = 1;
-   vex_bzero(&d1->fxState, sizeof(d1->fxState));
-
-   d1->fxState[0].fx     = Ifx_Write;
-   d1->fxState[0].offset = OFFB_SSEROUND;
-   d1->fxState[0].size   = sizeof(ULong);
-
-   /* Call the helper.  This creates SSEROUND but nothing
-      else.  We do the actual register array, XMM[0..15], separately,
-      in order that any undefinedness in the XMM registers is tracked
-      separately by Memcheck and is not "infected" by the in-memory
-      shadow for the other parts of the image. */
-   stmt( IRStmt_Dirty(d1) );
+   /* And now possibly restore from MXCSR.  We need to do this if
+      either components 1 (SSE) or 2 (AVX) are requested.  Hence the
+      guard condition is a bit more complex.  All we observe of MXCSR
+      is the rounding mode, bits 14:13 (cf. amd64g_check_ldmxcsr), so
+      do it inline with a guarded load. */
+   IRTemp mxcsr = newTemp(Ity_I32);
+   stmt( IRStmt_LoadG(Iend_LE,
+                      ILGop_Ident32,
+                      mxcsr, binop(Iop_Add64, mkexpr(addr), mkU64(24)),
+                      mkU32(0x1F80), restore_1or2e) );
+   putGuarded(OFFB_SSEROUND, restore_1or2e,
+              binop(Iop_And64,
+                    binop(Iop_Shr64, unop(Iop_32Uto64, mkexpr(mxcsr)),
+                          mkU8(13)),
+                    mkU64(3)));
 
    /* And now the XMMs themselves.  For each register, we PUT either
       its old value, or the value loaded from memory.  One convenient
@@ -11993,17 +12073,7 @@ static Long dis_XRSTOR ( const VexAbiInfo* vbi,
 
    DIP("%sxrstor %s\n", sz==8 ? "rex64/" : "", dis_buf);
 
-   /* VEX's caller is assumed to have checked this. */
-   const ULong aSSUMED_XCR0_VALUE = 7;
-
-   IRTemp rfbm = newTemp(Ity_I64);
-   assign(rfbm,
-          binop(Iop_And64,
-                binop(Iop_Or64,
-                      binop(Iop_Shl64,
-                            unop(Iop_32Uto64, getIRegRDX(4)), mkU8(32)),
-                      unop(Iop_32Uto64, getIRegRAX(4))),
-                mkU64(aSSUMED_XCR0_VALUE)));
+   IRTemp rfbm = gen_XSAVE_RFBM();
 
    IRTemp xstate_bv = newTemp(Ity_I64);
    assign(xstate_bv, loadLE(Ity_I64,
@@ -12019,18 +12089,42 @@ static Long dis_XRSTOR ( const VexAbiInfo* vbi,
                   binop(Iop_Add64, mkexpr(addr), mkU64(512+16))));
 
    /* We must fault if 
-      * xcomp_bv[63] == 1, since this simulated CPU does not support
-        the compaction extension.
       * xstate_bv sets a bit outside of XCR0 (which we assume to be 7).
-      * any of the xsave header bytes 23 .. 8 are nonzero.  This seems to
-        imply that xcomp_bv must be zero.
+      * any of the xsave header bytes 23 .. 16 are nonzero.
+      * for the standard format (xcomp_bv[63] == 0): xcomp_bv is
+        nonzero.
+      * for the compacted format, as written by XSAVEC: xcomp_bv sets
+        a bit outside of XCR0, other than bit 63, or xstate_bv sets a
+        bit not set in xcomp_bv.
       xcomp_bv is header bytes 15 .. 8 and xstate_bv is header bytes 7 .. 0
+
+      With XCR0 = 7 both formats have the same layout (see dis_XSAVEC),
+      and since xstate_bv is a subset of xcomp_bv the components absent
+      from a compacted image are just initialised, so the restore
+      sequence is the same for both.
    */
    IRTemp fault_if_nonzero = newTemp(Ity_I64);
    assign(fault_if_nonzero,
           binop(Iop_Or64,
-                binop(Iop_And64, mkexpr(xstate_bv), mkU64(~aSSUMED_XCR0_VALUE)),
-                binop(Iop_Or64, mkexpr(xcomp_bv), mkexpr(xsavehdr_23_16))));
+                mkexpr(xsavehdr_23_16),
+                IRExpr_ITE(
+                   binop(Iop_CmpNE64,
+                         binop(Iop_And64, mkexpr(xcomp_bv),
+                                          mkU64(1ULL << 63)),
+                         mkU64(0)),
+                   /* compacted */
+                   binop(Iop_Or64,
+                         binop(Iop_And64, mkexpr(xcomp_bv),
+                               mkU64(~((1ULL << 63) | aSSUMED_XCR0_VALUE))),
+                         binop(Iop_And64, mkexpr(xstate_bv),
+                               unop(Iop_Not64,
+                                    binop(Iop_And64, mkexpr(xcomp_bv),
+                                          mkU64(aSSUMED_XCR0_VALUE))))),
+                   /* standard */
+                   binop(Iop_Or64,
+                         binop(Iop_And64, mkexpr(xstate_bv),
+                                          mkU64(~aSSUMED_XCR0_VALUE)),
+                         mkexpr(xcomp_bv)))));
    stmt( IRStmt_Exit(binop(Iop_CmpNE64, mkexpr(fault_if_nonzero), mkU64(0)),
                      Ijk_SigSEGV,
                      IRConst_U64(guest_RIP_curr_instr),
@@ -14178,6 +14272,14 @@ Long dis_ESC_0F__SSE2 ( Bool* decode_OK,
          delta = dis_XRSTOR(vbi, pfx, delta, sz);
          goto decode_success;
       }
+      /* 0F AE /6 = XSAVEOPT mem -- XSAVE, skipping init-state components */
+      if (haveNo66noF2noF3(pfx) && (sz == 4 || sz == 8)
+          && !epartIsReg(getUChar(delta))
+          && gregOfRexRM(pfx,getUChar(delta)) == 6
+          && (archinfo->hwcaps & VEX_HWCAPS_AMD64_AVX)) {
+         delta = dis_XSAVEOPT(vbi, pfx, delta, sz);
+         goto decode_success;
+      }
       break;
 
    case 0xC2:
@@ -22155,7 +22257,28 @@ Long dis_ESC_0F (
       return delta;
    }
 
-   case 0xC7: { /* CMPXCHG8B Ev, CMPXCHG16B Ev */
+   case 0xC7:
+      /* 0F C7 /4 = XSAVEC mem */
+      modrm = getUChar(delta);
+      if (haveNo66noF2noF3(pfx) && (sz == 4 || sz == 8)
+          && !epartIsReg(modrm) && gregLO3ofRM(modrm) == 4
+          && (archinfo->hwcaps & VEX_HWCAPS_AMD64_AVX)) {
+         delta = dis_XSAVEC(vbi, pfx, delta, sz);
+         return delta;
+      }
+      /* 0F C7 /5 = XSAVES mem.  This is only allowed at CPL 0, so
+         it can only #GP, which in user space is a SIGSEGV. */
+      if (haveNo66noF2noF3(pfx) && (sz == 4 || sz == 8)
+          && !epartIsReg(modrm) && gregLO3ofRM(modrm) == 5
+          && (archinfo->hwcaps & VEX_HWCAPS_AMD64_AVX)) {
+         (void)disAMode ( &alen, vbi, pfx, delta, dis_buf, 0 );
+         delta += alen;
+         jmp_lit(dres, Ijk_SigSEGV, guest_RIP_curr_instr);
+         vassert(dres->whatNext == Dis_StopHere);
+         DIP("%sxsaves %s\n", sz==8 ? "rex64/" : "", dis_buf);
+         return delta;
+      }
+   { /* CMPXCHG8B Ev, CMPXCHG16B Ev */
       IRType  elemTy     = sz==4 ? Ity_I32 : Ity_I64;
       IRTemp  expdHi     = newTemp(elemTy);
       IRTemp  expdLo     = newTemp(elemTy);
@@ -381,6 +381,57 @@ static IRTemp newTemp ( IRType ty )
    return newIRTemp( irsb->tyenv, ty );
 }
 
+/* Guarded loads and stores of F32, I64 and F64 values, for the VFP
+   transfers.  The back end only does guarded 32-bit accesses, so an
+   8-byte value is moved as two words, low word at the lower address.
+   If the guard is false the loaded value is zero, so the caller must
+   guard the register write too.  Unguarded, these are a single plain
+   access of type 'ty'. */
+static IRExpr* loadGuardedLE_ty ( IRType ty, IRExpr* addr,
+                                  IRTemp guardT /* :: Ity_I32, 0 or 1 */ )
+{
+   if (guardT == IRTemp_INVALID)
+      return loadLE(ty, addr);
+
+   IRTemp addrT = newTemp(Ity_I32);
+   IRTemp lo    = newTemp(Ity_I32);
+   assign(addrT, addr);
+   loadGuardedLE(lo, ILGop_Ident32, mkexpr(addrT), mkU32(0), guardT);
+   if (ty == Ity_F32)
+      return unop(Iop_ReinterpI32asF32, mkexpr(lo));
+
+   vassert(ty == Ity_I64 || ty == Ity_F64);
+   IRTemp hi = newTemp(Ity_I32);
+   loadGuardedLE(hi, ILGop_Ident32,
+                 binop(Iop_Add32, mkexpr(addrT), mkU32(4)), mkU32(0), guardT);
+   IRExpr* pair = binop(Iop_32HLto64, mkexpr(hi), mkexpr(lo));
+   return ty == Ity_F64 ? unop(Iop_ReinterpI64asF64, pair) : pair;
+}
+
+static void storeGuardedLE_ty ( IRExpr* addr, IRExpr* data,
+                                IRTemp guardT /* :: Ity_I32, 0 or 1 */ )
+{
+   if (guardT == IRTemp_INVALID) {
+      storeLE(addr, data);
+      return;
+   }
+
+   IRType ty = typeOfIRExpr(irsb->tyenv, data);
+   if (ty == Ity_F32) {
+      storeGuardedLE(addr, unop(Iop_ReinterpF32asI32, data), guardT);
+      return;
+   }
+
+   vassert(ty == Ity_I64 || ty == Ity_F64);
+   IRTemp addrT = newTemp(Ity_I32);
+   IRTemp dataT = newTemp(Ity_I64);
+   assign(addrT, addr);
+   assign(dataT, ty == Ity_F64 ? unop(Iop_ReinterpF64asI64, data) : data);
+   storeGuardedLE(mkexpr(addrT), unop(Iop_64to32, mkexpr(dataT)), guardT);
+   storeGuardedLE(binop(Iop_Add32, mkexpr(addrT), mkU32(4)),
+                  unop(Iop_64HIto32, mkexpr(dataT)), guardT);
+}
+
 /* Produces a value in 0 .. 3, which is encoded as per the type
    IRRoundingMode. */
 static IRExpr* /* :: Ity_I32 */ get_FAKE_roundingmode ( void )
@@ -12590,7 +12641,8 @@ static void mk_ldm_stm ( Bool arm,     /* True: ARM, False: Thumb */
                          UInt bBEFORE, /* 1: inc/dec before, 0: after */
                          UInt bW,      /* 1: writeback to Rn */
                          UInt bL,      /* 1: load, 0: store */
-                         UInt regList )
+                         UInt regList,
+                         IRTemp condT  /* guard, or IRTemp_INVALID */ )
 {
    Int i, r, m, nRegs;
    IRTemp jk = Ijk_Boring;
@@ -12635,9 +12687,9 @@ static void mk_ldm_stm ( Bool arm,     /* True: ARM, False: Thumb */
    if (bW == 1 && !bINC) {
       IRExpr* e = binop(opADDorSUB, mkexpr(oldRnT), mkU32(4*nRegs));
       if (arm)
-         putIRegA( rN, e, IRTemp_INVALID, Ijk_Boring );
+         putIRegA( rN, e, condT, Ijk_Boring );
       else
-         putIRegT( rN, e, IRTemp_INVALID );
+         putIRegT( rN, e, condT );
    }
 
    // Make up a list of the registers to transfer, and their offsets
@@ -12733,24 +12785,31 @@ static void mk_ldm_stm ( Bool arm,     /* True: ARM, False: Thumb */
    for (i = 0; i < nX; i++) {
       r = xReg[i];
       if (bL == 1) {
-         IRExpr* e = loadLE(Ity_I32,
-                            binop(opADDorSUB, mkexpr(anchorT),
-                                  mkU32(xOff[i])));
+         /* If the load doesn't happen, the old value of r is put
+            back, so the write itself needn't be guarded.  Loading
+            the PC is a branch, which the caller has made uncond. */
+         IRTemp e = newTemp(Ity_I32);
+         vassert(r != 15 || condT == IRTemp_INVALID);
+         loadGuardedLE( e, ILGop_Ident32,
+                        binop(opADDorSUB, mkexpr(anchorT),
+                              mkU32(xOff[i])),
+                        llGetIReg(r), condT );
          if (arm) {
-            putIRegA( r, e, IRTemp_INVALID, jk );
+            putIRegA( r, mkexpr(e), IRTemp_INVALID, jk );
          } else {
             // no: putIRegT( r, e, IRTemp_INVALID );
             // putIRegT refuses to write to R15.  But that might happen.
-            // Since this is uncond, and we need to be able to
+            // Since that case is uncond, and we need to be able to
             // write the PC, just use the low level put:
-            llPutIReg( r, e );
+            llPutIReg( r, mkexpr(e) );
          }
       } else {
          /* if we're storing Rn, make sure we use the correct
             value, as per extensive comments above */
-         storeLE( binop(opADDorSUB, mkexpr(anchorT), mkU32(xOff[i])),
-                  r == rN ? mkexpr(oldRnT) 
-                          : (arm ? getIRegA(r) : getIRegT(r) ) );
+         storeGuardedLE( binop(opADDorSUB, mkexpr(anchorT), mkU32(xOff[i])),
+                         r == rN ? mkexpr(oldRnT) 
+                                 : (arm ? getIRegA(r) : getIRegT(r) ),
+                         condT );
       }
    }
 
@@ -12759,9 +12818,9 @@ static void mk_ldm_stm ( Bool arm,     /* True: ARM, False: Thumb */
    if (bW == 1 && bINC) {
       IRExpr* e = binop(opADDorSUB, mkexpr(oldRnT), mkU32(4*nRegs));
       if (arm)
-         putIRegA( rN, e, IRTemp_INVALID, Ijk_Boring );
+         putIRegA( rN, e, condT, Ijk_Boring );
       else
-         putIRegT( rN, e, IRTemp_INVALID );
+         putIRegT( rN, e, condT );
    }
 }
 
@@ -12882,17 +12941,8 @@ static Bool decode_CP10_CP11_instruction (
       if (dD + nRegs - 1 >= 32)
          goto after_vfp_fldmx_fstmx;
 
-      /* Now, we can't do a conditional load or store, since that very
-         likely will generate an exception.  So we have to take a side
-         exit at this point if the condition is false. */
-      if (condT != IRTemp_INVALID) {
-         if (isT)
-            mk_skip_over_T32_if_cond_is_false( condT );
-         else
-            mk_skip_over_A32_if_cond_is_false( condT );
-         condT = IRTemp_INVALID;
-      }
-      /* Ok, now we're unconditional.  Do the load or store. */
+      /* The transfers and the Rn update are all guarded by condT, so
+         a conditional load or store doesn't need a side exit. */
 
       /* get the old Rn value */
       IRTemp rnT = newTemp(Ity_I32);
@@ -12917,18 +12967,18 @@ static Bool decode_CP10_CP11_instruction (
          and V's stack-extending logic (on linux) happy */
       if (summary == 3) {
          if (isT)
-            putIRegT(rN, mkexpr(rnTnew), IRTemp_INVALID);
+            putIRegT(rN, mkexpr(rnTnew), condT);
          else
-            putIRegA(rN, mkexpr(rnTnew), IRTemp_INVALID, Ijk_Boring);
+            putIRegA(rN, mkexpr(rnTnew), condT, Ijk_Boring);
       }
 
       /* generate the transfers */
       for (i = 0; i < nRegs; i++) {
          IRExpr* addr = binop(Iop_Add32, mkexpr(taT), mkU32(8*i));
          if (bL) {
-            putDReg(dD + i, loadLE(Ity_F64, addr), IRTemp_INVALID);
+            putDReg(dD + i, loadGuardedLE_ty(Ity_F64, addr, condT), condT);
          } else {
-            storeLE(addr, getDReg(dD + i));
+            storeGuardedLE_ty(addr, getDReg(dD + i), condT);
          }
       }
 
@@ -12937,9 +12987,9 @@ static Bool decode_CP10_CP11_instruction (
          and V's stack-extending logic (on linux) happy */
       if (summary == 2) {
          if (isT)
-            putIRegT(rN, mkexpr(rnTnew), IRTemp_INVALID);
+            putIRegT(rN, mkexpr(rnTnew), condT);
          else
-            putIRegA(rN, mkexpr(rnTnew), IRTemp_INVALID, Ijk_Boring);
+            putIRegA(rN, mkexpr(rnTnew), condT, Ijk_Boring);
       }
 
       const HChar* nm = bL==1 ? "ld" : "st";
@@ -13019,17 +13069,8 @@ static Bool decode_CP10_CP11_instruction (
       if (dD + nRegs - 1 >= 32)
          goto after_vfp_fldmd_fstmd;
 
-      /* Now, we can't do a conditional load or store, since that very
-         likely will generate an exception.  So we have to take a side
-         exit at this point if the condition is false. */
-      if (condT != IRTemp_INVALID) {
-         if (isT)
-            mk_skip_over_T32_if_cond_is_false( condT );
-         else
-            mk_skip_over_A32_if_cond_is_false( condT );
-         condT = IRTemp_INVALID;
-      }
-      /* Ok, now we're unconditional.  Do the load or store. */
+      /* The transfers and the Rn update are all guarded by condT, so
+         a conditional load or store doesn't need a side exit. */
 
       /* get the old Rn value */
       IRTemp rnT = newTemp(Ity_I32);
@@ -13054,18 +13095,18 @@ static Bool decode_CP10_CP11_instruction (
          and V's stack-extending logic (on linux) happy */
       if (summary == 3) {
          if (isT)
-            putIRegT(rN, mkexpr(rnTnew), IRTemp_INVALID);
+            putIRegT(rN, mkexpr(rnTnew), condT);
          else
-            putIRegA(rN, mkexpr(rnTnew), IRTemp_INVALID, Ijk_Boring);
+            putIRegA(rN, mkexpr(rnTnew), condT, Ijk_Boring);
       }
 
       /* generate the transfers */
       for (i = 0; i < nRegs; i++) {
          IRExpr* addr = binop(Iop_Add32, mkexpr(taT), mkU32(8*i));
          if (bL) {
-            putDReg(dD + i, loadLE(Ity_F64, addr), IRTemp_INVALID);
+            putDReg(dD + i, loadGuardedLE_ty(Ity_F64, addr, condT), condT);
          } else {
-            storeLE(addr, getDReg(dD + i));
+            storeGuardedLE_ty(addr, getDReg(dD + i), condT);
          }
       }
 
@@ -13074,9 +13115,9 @@ static Bool decode_CP10_CP11_instruction (
          and V's stack-extending logic (on linux) happy */
       if (summary == 2) {
          if (isT)
-            putIRegT(rN, mkexpr(rnTnew), IRTemp_INVALID);
+            putIRegT(rN, mkexpr(rnTnew), condT);
          else
-            putIRegA(rN, mkexpr(rnTnew), IRTemp_INVALID, Ijk_Boring);
+            putIRegA(rN, mkexpr(rnTnew), condT, Ijk_Boring);
       }
 
       const HChar* nm = bL==1 ? "ld" : "st";
@@ -13430,23 +13471,15 @@ static Bool decode_CP10_CP11_instruction (
       UInt offset = (insn28 & 0xFF) << 2;
       UInt bU     = (insn28 >> 23) & 1; /* 1: +offset  0: -offset */
       UInt bL     = (insn28 >> 20) & 1; /* 1: load  0: store */
-      /* make unconditional */
-      if (condT != IRTemp_INVALID) {
-         if (isT)
-            mk_skip_over_T32_if_cond_is_false( condT );
-         else
-            mk_skip_over_A32_if_cond_is_false( condT );
-         condT = IRTemp_INVALID;
-      }
       IRTemp ea = newTemp(Ity_I32);
       assign(ea, binop(bU ? Iop_Add32 : Iop_Sub32,
                        align4if(isT ? getIRegT(rN) : getIRegA(rN),
                                 rN == 15),
                        mkU32(offset)));
       if (bL) {
-         putDReg(dD, loadLE(Ity_F64,mkexpr(ea)), IRTemp_INVALID);
+         putDReg(dD, loadGuardedLE_ty(Ity_F64, mkexpr(ea), condT), condT);
       } else {
-         storeLE(mkexpr(ea), getDReg(dD));
+         storeGuardedLE_ty(mkexpr(ea), getDReg(dD), condT);
       }
       DIP("f%sd%s d%u, [r%u, %c#%u]\n",
           bL ? "ld" : "st", nCC(conq), dD, rN,
@@ -13811,17 +13844,8 @@ static Bool decode_CP10_CP11_instruction (
       if (fD + nRegs - 1 >= 32)
          goto after_vfp_fldms_fstms;
 
-      /* Now, we can't do a conditional load or store, since that very
-         likely will generate an exception.  So we have to take a side
-         exit at this point if the condition is false. */
-      if (condT != IRTemp_INVALID) {
-         if (isT)
-            mk_skip_over_T32_if_cond_is_false( condT );
-         else
-            mk_skip_over_A32_if_cond_is_false( condT );
-         condT = IRTemp_INVALID;
-      }
-      /* Ok, now we're unconditional.  Do the load or store. */
+      /* The transfers and the Rn update are all guarded by condT, so
+         a conditional load or store doesn't need a side exit. */
 
       /* get the old Rn value */
       IRTemp rnT = newTemp(Ity_I32);
@@ -13846,18 +13870,18 @@ static Bool decode_CP10_CP11_instruction (
          and V's stack-extending logic (on linux) happy */
       if (summary == 3) {
          if (isT)
-            putIRegT(rN, mkexpr(rnTnew), IRTemp_INVALID);
+            putIRegT(rN, mkexpr(rnTnew), condT);
          else
-            putIRegA(rN, mkexpr(rnTnew), IRTemp_INVALID, Ijk_Boring);
+            putIRegA(rN, mkexpr(rnTnew), condT, Ijk_Boring);
       }
 
       /* generate the transfers */
       for (i = 0; i < nRegs; i++) {
          IRExpr* addr = binop(Iop_Add32, mkexpr(taT), mkU32(4*i));
          if (bL) {
-            putFReg(fD + i, loadLE(Ity_F32, addr), IRTemp_INVALID);
+            putFReg(fD + i, loadGuardedLE_ty(Ity_F32, addr, condT), condT);
          } else {
-            storeLE(addr, getFReg(fD + i));
+            storeGuardedLE_ty(addr, getFReg(fD + i), condT);
          }
       }
 
@@ -13866,9 +13890,9 @@ static Bool decode_CP10_CP11_instruction (
          and V's stack-extending logic (on linux) happy */
       if (summary == 2) {
          if (isT)
-            putIRegT(rN, mkexpr(rnTnew), IRTemp_INVALID);
+            putIRegT(rN, mkexpr(rnTnew), condT);
          else
-            putIRegA(rN, mkexpr(rnTnew), IRTemp_INVALID, Ijk_Boring);
+            putIRegA(rN, mkexpr(rnTnew), condT, Ijk_Boring);
       }
 
       const HChar* nm = bL==1 ? "ld" : "st";
@@ -13935,23 +13959,15 @@ static Bool decode_CP10_CP11_instruction (
       UInt offset = (insn28 & 0xFF) << 2;
       UInt bU     = (insn28 >> 23) & 1; /* 1: +offset  0: -offset */
       UInt bL     = (insn28 >> 20) & 1; /* 1: load  0: store */
-      /* make unconditional */
-      if (condT != IRTemp_INVALID) {
-         if (isT)
-            mk_skip_over_T32_if_cond_is_false( condT );
-         else
-            mk_skip_over_A32_if_cond_is_false( condT );
-         condT = IRTemp_INVALID;
-      }
       IRTemp ea = newTemp(Ity_I32);
       assign(ea, binop(bU ? Iop_Add32 : Iop_Sub32,
                        align4if(isT ? getIRegT(rN) : getIRegA(rN),
                                 rN == 15),
                        mkU32(offset)));
       if (bL) {
-         putFReg(fD, loadLE(Ity_F32,mkexpr(ea)), IRTemp_INVALID);
+         putFReg(fD, loadGuardedLE_ty(Ity_F32, mkexpr(ea), condT), condT);
       } else {
-         storeLE(mkexpr(ea), getFReg(fD));
+         storeGuardedLE_ty(mkexpr(ea), getFReg(fD), condT);
       }
       DIP("f%ss%s s%u, [r%u, %c#%u]\n",
           bL ? "ld" : "st", nCC(conq), fD, rN,
@@ -15532,16 +15548,15 @@ DisResult disInstr_ARM_WRK (
       if (bW == 1 && bL == 1 && ((1 << rN) & regList) > 0)
          goto after_load_store_multiple;
 
-      /* Now, we can't do a conditional load or store, since that very
-         likely will generate an exception.  So we have to take a side
-         exit at this point if the condition is false. */
-      if (condT != IRTemp_INVALID) {
+      /* Loading the PC is a branch, so in that case take a side exit
+         if the condition is false.  Otherwise the transfers and the
+         writeback are all guarded by condT. */
+      if (bL == 1 && (regList & (1<<15)) && condT != IRTemp_INVALID) {
          mk_skip_over_A32_if_cond_is_false( condT );
          condT = IRTemp_INVALID;
       }
 
-      /* Ok, now we're unconditional.  Generate the IR. */
-      mk_ldm_stm( True/*arm*/, rN, bINC, bBEFORE, bW, bL, regList );
+      mk_ldm_stm( True/*arm*/, rN, bINC, bBEFORE, bW, bL, regList, condT );
 
       DIP("%sm%c%c%s r%u%s, {0x%04x}\n",
           bL == 1 ? "ld" : "st", bINC ? 'i' : 'd', bBEFORE ? 'b' : 'a',
@@ -18515,13 +18530,10 @@ DisResult disInstr_THUMB_WRK (
       /* At least one register must be transferred, else result is
          UNPREDICTABLE. */
       if (regList != 0) {
-         /* Since we can't generate a guaranteed non-trapping IR
-            sequence, (1) jump over the insn if it is gated false, and
-            (2) back out the ITSTATE update. */
-         mk_skip_over_T16_if_cond_is_false(condT);
-         condT = IRTemp_INVALID;
+         /* The transfers and the SP update are guarded by condT.
+            Since they can trap, back out the ITSTATE update while
+            they happen. */
          put_ITSTATE(old_itstate);
-         // now uncond
 
          nRegs = 0;
          for (i = 0; i < 16; i++) {
@@ -18534,7 +18546,7 @@ DisResult disInstr_THUMB_WRK (
             mess with its alignment. */
          IRTemp newSP = newTemp(Ity_I32);
          assign(newSP, binop(Iop_Sub32, getIRegT(13), mkU32(4 * nRegs)));
-         putIRegT(13, mkexpr(newSP), IRTemp_INVALID);
+         putIRegT(13, mkexpr(newSP), condT);
 
          /* Generate a transfer base address as a forced-aligned
             version of the final SP value. */
@@ -18545,8 +18557,9 @@ DisResult disInstr_THUMB_WRK (
          nRegs = 0;
          for (i = 0; i < 16; i++) {
             if ((regList & (1 << i)) != 0) {
-               storeLE( binop(Iop_Add32, mkexpr(base), mkU32(4 * nRegs)),
-                        getIRegT(i) );
+               storeGuardedLE( binop(Iop_Add32, mkexpr(base),
+                                                mkU32(4 * nRegs)),
+                               getIRegT(i), condT );
                nRegs++;
             }
          }
@@ -18569,13 +18582,17 @@ DisResult disInstr_THUMB_WRK (
       /* At least one register must be transferred, else result is
          UNPREDICTABLE. */
       if (regList != 0 || bitR) {
-         /* Since we can't generate a guaranteed non-trapping IR
-            sequence, (1) jump over the insn if it is gated false, and
-            (2) back out the ITSTATE update. */
-         mk_skip_over_T16_if_cond_is_false(condT);
-         condT = IRTemp_INVALID;
+         /* Popping the PC is a branch, which can't be done
+            conditionally, so in that case jump over the insn if it
+            is gated false.  Otherwise the transfers and the SP update
+            are guarded by condT.  Either way, since the transfers can
+            trap, back out the ITSTATE update while they happen. */
+         if (bitR) {
+            mk_skip_over_T16_if_cond_is_false(condT);
+            condT = IRTemp_INVALID;
+            // now uncond
+         }
          put_ITSTATE(old_itstate);
-         // now uncond
 
          nRegs = 0;
          for (i = 0; i < 8; i++) {
@@ -18604,10 +18621,12 @@ DisResult disInstr_THUMB_WRK (
          nRegs = 0;
          for (i = 0; i < 8; i++) {
             if ((regList & (1 << i)) != 0) {
-               putIRegT(i, loadLE( Ity_I32,
-                                   binop(Iop_Add32, mkexpr(base),
-                                                    mkU32(4 * nRegs))),
-                           IRTemp_INVALID );
+               IRTemp tI = newTemp(Ity_I32);
+               loadGuardedLE( tI, ILGop_Ident32,
+                              binop(Iop_Add32, mkexpr(base),
+                                               mkU32(4 * nRegs)),
+                              llGetIReg(i), condT );
+               putIRegT(i, mkexpr(tI), IRTemp_INVALID);
                nRegs++;
             }
          }
@@ -18621,7 +18640,7 @@ DisResult disInstr_THUMB_WRK (
          }
 
          /* Now we can safely install the new SP value */
-         putIRegT(13, mkexpr(newSP), IRTemp_INVALID);
+         putIRegT(13, mkexpr(newSP), condT);
 
          /* Reinstate the ITSTATE update. */
          put_ITSTATE(new_itstate);
@@ -19006,10 +19025,9 @@ DisResult disInstr_THUMB_WRK (
       UInt list = INSN0(7,0);
       /* Empty lists aren't allowed. */
       if (list != 0) {
-         mk_skip_over_T16_if_cond_is_false(condT);
-         condT = IRTemp_INVALID;
+         /* Guarded by condT; back out the ITSTATE update while the
+            transfers happen, since they can trap. */
          put_ITSTATE(old_itstate);
-         // now uncond
 
          IRTemp oldRn = newTemp(Ity_I32);
          IRTemp base  = newTemp(Ity_I32);
@@ -19019,12 +19037,12 @@ DisResult disInstr_THUMB_WRK (
             if (0 == (list & (1 << i)))
                continue;
             nRegs++;
-            putIRegT(
-               i, loadLE(Ity_I32,
-                         binop(Iop_Add32, mkexpr(base),
-                                          mkU32(nRegs * 4 - 4))),
-               IRTemp_INVALID
-            );
+            IRTemp tI = newTemp(Ity_I32);
+            loadGuardedLE( tI, ILGop_Ident32,
+                           binop(Iop_Add32, mkexpr(base),
+                                            mkU32(nRegs * 4 - 4)),
+                           llGetIReg(i), condT );
+            putIRegT(i, mkexpr(tI), IRTemp_INVALID);
          }
          /* Only do the writeback for rN if it isn't in the list of
             registers to be transferred. */
@@ -19032,7 +19050,7 @@ DisResult disInstr_THUMB_WRK (
             putIRegT(rN,
                      binop(Iop_Add32, mkexpr(oldRn),
                                       mkU32(nRegs * 4)),
-                     IRTemp_INVALID
+                     condT
             );
          }
 
@@ -19060,10 +19078,9 @@ DisResult disInstr_THUMB_WRK (
          }
       }
       if (valid) {
-         mk_skip_over_T16_if_cond_is_false(condT);
-         condT = IRTemp_INVALID;
+         /* Guarded by condT; back out the ITSTATE update while the
+            transfers happen, since they can trap. */
          put_ITSTATE(old_itstate);
-         // now uncond
 
          IRTemp oldRn = newTemp(Ity_I32);
          IRTemp base = newTemp(Ity_I32);
@@ -19073,14 +19090,15 @@ DisResult disInstr_THUMB_WRK (
             if (0 == (list & (1 << i)))
                continue;
             nRegs++;
-            storeLE( binop(Iop_Add32, mkexpr(base), mkU32(nRegs * 4 - 4)),
-                     getIRegT(i) );
+            storeGuardedLE( binop(Iop_Add32, mkexpr(base),
+                                             mkU32(nRegs * 4 - 4)),
+                            getIRegT(i), condT );
          }
          /* Always do the writeback. */
          putIRegT(rN,
                   binop(Iop_Add32, mkexpr(oldRn),
                                    mkU32(nRegs * 4)),
-                  IRTemp_INVALID);
+                  condT);
 
          /* Reinstate the ITSTATE update. */
          put_ITSTATE(new_itstate);
@@ -19350,15 +19368,15 @@ DisResult disInstr_THUMB_WRK (
             // We'll be writing the PC.  Hence:
             /* Only allowed outside or last-in IT block; SIGILL if not so. */
             gen_SIGILL_T_if_in_but_NLI_ITBlock(old_itstate, new_itstate);
+            /* and go uncond, since we can't write the PC conditionally */
+            mk_skip_over_T32_if_cond_is_false(condT);
+            condT = IRTemp_INVALID;
+            // now uncond
          }
 
-         /* Go uncond: */
-         mk_skip_over_T32_if_cond_is_false(condT);
-         condT = IRTemp_INVALID;
-         // now uncond
-
          /* Generate the IR.  This might generate a write to R15. */
-         mk_ldm_stm(False/*!arm*/, rN, bINC, bBEFORE, bW, bL, regList);
+         mk_ldm_stm(False/*!arm*/, rN, bINC, bBEFORE, bW, bL, regList,
+                    condT);
 
          if (bL == 1 && (regList & (1<<15))) {
             // If we wrote to R15, we have an interworking return to
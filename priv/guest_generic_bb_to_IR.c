@@ -101,7 +101,513 @@ static Bool const_False ( void* callback_opaque, Addr a ) {
    return False; 
 }
 
-/* Disassemble a complete basic block, starting at guest_IP_start, 
+/* Speculative devirtualisation.  The insn whose IR occupies
+   irsb->stmts[first_stmt_idx ..] has just ended the block with an
+   indirect jump or call, ie its final statement is PUT(IP) = t for
+   some temp t.  Given a predicted target, try to insert, directly
+   after t's definition,
+
+      if (t != predicted) goto guest_IP_curr_instr
+
+   so that the caller can chase into the predicted target.  That is
+   only correct if nothing before the guard has any side effect, so
+   that a misprediction can simply rerun the insn from scratch.  The
+   front ends generally compute the target before pushing a return
+   address or updating a link register, so this is not much of a
+   restriction.  Returns True if the guard was added. */
+static Bool add_indirect_guard ( IRSB* irsb, Int first_stmt_idx,
+                                 Addr guest_IP_curr_instr, Addr predicted,
+                                 IRType guest_word_type, Int offB_GUEST_IP )
+{
+   Int     i, def_idx;
+   IRTemp  t;
+   IRStmt* last = irsb->stmts[irsb->stmts_used-1];
+   IRExpr* guard;
+   Bool    ty64 = toBool(guest_word_type == Ity_I64);
+
+   vassert(last->tag == Ist_Put && last->Ist.Put.offset == offB_GUEST_IP);
+   if (last->Ist.Put.data->tag != Iex_RdTmp)
+      return False;
+   t = last->Ist.Put.data->Iex.RdTmp.tmp;
+
+   /* Everything up to and including t's definition must be a plain
+      temp assignment. */
+   vassert(irsb->stmts[first_stmt_idx]->tag == Ist_IMark);
+   def_idx = -1;
+   for (i = first_stmt_idx + 1; i < irsb->stmts_used - 1; i++) {
+      IRStmt* st = irsb->stmts[i];
+      if (st->tag != Ist_WrTmp)
+         return False;
+      if (st->Ist.WrTmp.tmp == t) {
+         def_idx = i;
+         break;
+      }
+   }
+   if (def_idx == -1)
+      return False;
+
+   guard = IRExpr_Binop(ty64 ? Iop_CmpNE64 : Iop_CmpNE32,
+                        IRExpr_RdTmp(t),
+                        IRExpr_Const(ty64 ? IRConst_U64(predicted)
+                                          : IRConst_U32(toUInt(predicted))));
+   addStmtToIRSB(irsb, IRStmt_Exit(guard, Ijk_Boring,
+                                   ty64 ? IRConst_U64(guest_IP_curr_instr)
+                                        : IRConst_U32(
+                                             toUInt(guest_IP_curr_instr)),
+                                   offB_GUEST_IP));
+   /* .. and move it into place. */
+   { IRStmt* ex = irsb->stmts[irsb->stmts_used-1];
+     for (i = irsb->stmts_used-1; i > def_idx+1; i--)
+        irsb->stmts[i] = irsb->stmts[i-1];
+     irsb->stmts[def_idx+1] = ex;
+   }
+   return True;
+}
+
+/* If-conversion of short forward hammocks, ie
+
+      insn X:  if (g) goto L         -- falls through to ft
+      ft:      one or two insns
+      L:       ...
+
+   Rather than ending the block at X (or chasing just one side of
+   it), disassemble the insns between ft and L and make them
+   conditional on !g, so the block carries on at L with no side exit:
+   guest state writes become ITEs that put back the old value when g
+   holds, and loads and stores become LoadG/StoreG.  This is only
+   done if every statement of the arm can be treated like that, which
+   excludes anything that can trap or has side effects beyond guest
+   state and memory.  The arm insns keep their IMarks, so
+   instrumenters see them as executed even when they are skipped. */
+
+#define HAMMOCK_MAX_INSNS 2
+#define HAMMOCK_MAX_BYTES 32
+#define HAMMOCK_MAX_STMTS 80
+
+static Bool hammock_op_may_trap ( IROp op )
+{
+   switch (op) {
+      case Iop_DivU32: case Iop_DivS32: case Iop_DivU64: case Iop_DivS64:
+      case Iop_DivU64E: case Iop_DivS64E: case Iop_DivU32E: case Iop_DivS32E:
+      case Iop_DivModU64to32: case Iop_DivModS64to32:
+      case Iop_DivModU128to64: case Iop_DivModS128to64:
+      case Iop_DivModS64to64:
+         return True;
+      default:
+         return False;
+   }
+}
+
+/* Can E be computed whether or not the arm is taken? */
+static Bool hammock_expr_ok ( const IRExpr* e )
+{
+   Int i;
+   switch (e->tag) {
+      case Iex_Get: case Iex_RdTmp: case Iex_Const:
+         return True;
+      case Iex_GetI:
+         return hammock_expr_ok(e->Iex.GetI.ix);
+      case Iex_Unop:
+         return toBool(!hammock_op_may_trap(e->Iex.Unop.op)
+                       && hammock_expr_ok(e->Iex.Unop.arg));
+      case Iex_Binop:
+         return toBool(!hammock_op_may_trap(e->Iex.Binop.op)
+                       && hammock_expr_ok(e->Iex.Binop.arg1)
+                       && hammock_expr_ok(e->Iex.Binop.arg2));
+      case Iex_Triop:
+         return toBool(hammock_expr_ok(e->Iex.Triop.details->arg1)
+                       && hammock_expr_ok(e->Iex.Triop.details->arg2)
+                       && hammock_expr_ok(e->Iex.Triop.details->arg3));
+      case Iex_Qop:
+         return toBool(hammock_expr_ok(e->Iex.Qop.details->arg1)
+                       && hammock_expr_ok(e->Iex.Qop.details->arg2)
+                       && hammock_expr_ok(e->Iex.Qop.details->arg3)
+                       && hammock_expr_ok(e->Iex.Qop.details->arg4));
+      case Iex_ITE:
+         return toBool(hammock_expr_ok(e->Iex.ITE.cond)
+                       && hammock_expr_ok(e->Iex.ITE.iftrue)
+                       && hammock_expr_ok(e->Iex.ITE.iffalse));
+      case Iex_CCall:
+         for (i = 0; e->Iex.CCall.args[i]; i++)
+            if (!hammock_expr_ok(e->Iex.CCall.args[i]))
+               return False;
+         return True;
+      default:
+         return False;
+   }
+}
+
+/* Can a load or store of TY at ADDR be done under a guard? */
+static Bool hammock_mem_ok ( const IRTypeEnv* tyenv, IREndness end,
+                             IRType ty, const IRExpr* addr,
+                             IRType guarded_mem_ty )
+{
+   return toBool(guarded_mem_ty != Ity_INVALID
+                 && end == Iend_LE
+                 && (ty == Ity_I32 || ty == guarded_mem_ty)
+                 && typeOfIRExpr(tyenv, addr) == guarded_mem_ty
+                 && hammock_expr_ok(addr));
+}
+
+/* Can a PUT of TY be made conditional with an ITE?  Not every host
+   can select every type, so only integers of at most the host word
+   size are selected directly, with I8 and I16 widened to I32 and F32
+   and F64 selected as the integers of the same size.  Anything else
+   (vectors, for instance) makes the hammock fail. */
+static Bool hammock_put_ok ( IRType ty, IRType host_word_ty )
+{
+   switch (ty) {
+      case Ity_I8: case Ity_I16: case Ity_I32: case Ity_F32:
+         return True;
+      case Ity_I64: case Ity_F64:
+         return toBool(host_word_ty == Ity_I64);
+      default:
+         return False;
+   }
+}
+
+/* PUT(off) = data, but only if SKIP is false; see hammock_put_ok. */
+static IRStmt* hammock_put ( IRTemp skip, Int off, IRType ty,
+                             IRExpr* data )
+{
+   IROp    widen, narrow;
+   IRType  ity;
+   switch (ty) {
+      case Ity_I8:  ity = Ity_I32; widen = Iop_8Uto32;
+                    narrow = Iop_32to8; break;
+      case Ity_I16: ity = Ity_I32; widen = Iop_16Uto32;
+                    narrow = Iop_32to16; break;
+      case Ity_F32: ity = Ity_I32; widen = Iop_ReinterpF32asI32;
+                    narrow = Iop_ReinterpI32asF32; break;
+      case Ity_F64: ity = Ity_I64; widen = Iop_ReinterpF64asI64;
+                    narrow = Iop_ReinterpI64asF64; break;
+      default:
+         return IRStmt_Put(off, IRExpr_ITE(IRExpr_RdTmp(skip),
+                                           IRExpr_Get(off, ty), data));
+   }
+   /* For I8 and I16 the old value is fetched at its own type and
+      widened; for F32 and F64 it is fetched as the integer. */
+   return IRStmt_Put(
+             off,
+             IRExpr_Unop(narrow,
+                IRExpr_ITE(IRExpr_RdTmp(skip),
+                           ty == Ity_I8 || ty == Ity_I16
+                              ? IRExpr_Unop(widen, IRExpr_Get(off, ty))
+                              : IRExpr_Get(off, ity),
+                           IRExpr_Unop(widen, data))));
+}
+
+/* Return E with each load in it replaced by a temporary that is
+   assigned the load, in evaluation order, by statements added to
+   IRSB.  Loads nested in a PUT or store, as in "PUT(r) = LDle(a)",
+   can then become LoadGs like any other.  E itself is left alone; the
+   parts of it that contain loads are copied. */
+static IRExpr* hammock_bind_loads ( IRSB* irsb, IRExpr* e )
+{
+   IRExpr  *a1, *a2, *a3, *a4;
+   IRExpr** args;
+   IRTemp   t;
+   Int      i;
+   switch (e->tag) {
+      case Iex_Load:
+         a1 = hammock_bind_loads(irsb, e->Iex.Load.addr);
+         t  = newIRTemp(irsb->tyenv, e->Iex.Load.ty);
+         addStmtToIRSB(irsb, IRStmt_WrTmp(t, a1 == e->Iex.Load.addr
+                                                ? e
+                                                : IRExpr_Load(
+                                                     e->Iex.Load.end,
+                                                     e->Iex.Load.ty,
+                                                     a1)));
+         return IRExpr_RdTmp(t);
+      case Iex_GetI:
+         a1 = hammock_bind_loads(irsb, e->Iex.GetI.ix);
+         return a1 == e->Iex.GetI.ix
+                   ? e : IRExpr_GetI(e->Iex.GetI.descr, a1,
+                                     e->Iex.GetI.bias);
+      case Iex_Unop:
+         a1 = hammock_bind_loads(irsb, e->Iex.Unop.arg);
+         return a1 == e->Iex.Unop.arg
+                   ? e : IRExpr_Unop(e->Iex.Unop.op, a1);
+      case Iex_Binop:
+         a1 = hammock_bind_loads(irsb, e->Iex.Binop.arg1);
+         a2 = hammock_bind_loads(irsb, e->Iex.Binop.arg2);
+         return a1 == e->Iex.Binop.arg1 && a2 == e->Iex.Binop.arg2
+                   ? e : IRExpr_Binop(e->Iex.Binop.op, a1, a2);
+      case Iex_Triop:
+         a1 = hammock_bind_loads(irsb, e->Iex.Triop.details->arg1);
+         a2 = hammock_bind_loads(irsb, e->Iex.Triop.details->arg2);
+         a3 = hammock_bind_loads(irsb, e->Iex.Triop.details->arg3);
+         return a1 == e->Iex.Triop.details->arg1
+                && a2 == e->Iex.Triop.details->arg2
+                && a3 == e->Iex.Triop.details->arg3
+                   ? e : IRExpr_Triop(e->Iex.Triop.details->op,
+                                      a1, a2, a3);
+      case Iex_Qop:
+         a1 = hammock_bind_loads(irsb, e->Iex.Qop.details->arg1);
+         a2 = hammock_bind_loads(irsb, e->Iex.Qop.details->arg2);
+         a3 = hammock_bind_loads(irsb, e->Iex.Qop.details->arg3);
+         a4 = hammock_bind_loads(irsb, e->Iex.Qop.details->arg4);
+         return a1 == e->Iex.Qop.details->arg1
+                && a2 == e->Iex.Qop.details->arg2
+                && a3 == e->Iex.Qop.details->arg3
+                && a4 == e->Iex.Qop.details->arg4
+                   ? e : IRExpr_Qop(e->Iex.Qop.details->op,
+                                    a1, a2, a3, a4);
+      case Iex_ITE:
+         a1 = hammock_bind_loads(irsb, e->Iex.ITE.cond);
+         a2 = hammock_bind_loads(irsb, e->Iex.ITE.iftrue);
+         a3 = hammock_bind_loads(irsb, e->Iex.ITE.iffalse);
+         return a1 == e->Iex.ITE.cond && a2 == e->Iex.ITE.iftrue
+                && a3 == e->Iex.ITE.iffalse
+                   ? e : IRExpr_ITE(a1, a2, a3);
+      case Iex_CCall:
+         args = shallowCopyIRExprVec(e->Iex.CCall.args);
+         for (i = 0; args[i]; i++)
+            args[i] = hammock_bind_loads(irsb, args[i]);
+         return IRExpr_CCall(e->Iex.CCall.cee, e->Iex.CCall.retty, args);
+      default:
+         return e;
+   }
+}
+
+static ULong hammock_const ( const IRExpr* e )
+{
+   vassert(e->tag == Iex_Const);
+   switch (e->Iex.Const.con->tag) {
+      case Ico_U32: return e->Iex.Const.con->Ico.U32;
+      case Ico_U64: return e->Iex.Const.con->Ico.U64;
+      default: vpanic("hammock_const");
+   }
+}
+
+/* The insn whose IR occupies irsb->stmts[first_stmt_idx ..] has just
+   been disassembled, and the next insn is at guest_IP_ft (which is
+   guest_code[delta]).  If it is a conditional branch around at most
+   max_insns insns that can be if-converted, append those insns to
+   irsb, converted, and return True, with the number of insns and
+   bytes consumed in *n_arm_insns and *arm_len.  Otherwise leave irsb
+   as it was and return False. */
+static Bool if_convert_hammock ( IRSB* irsb, Int first_stmt_idx,
+                                 DisOneInstrFn dis_instr_fn,
+                                 void* callback_opaque,
+                                 const UChar* guest_code, Long delta,
+                                 Addr guest_IP_ft, Int max_insns,
+                                 VexArch arch_guest,
+                                 const VexArchInfo* archinfo_guest,
+                                 const VexAbiInfo* abiinfo_both,
+                                 VexEndness host_endness,
+                                 Int offB_GUEST_IP,
+                                 IRType guarded_mem_ty,
+                                 IRType host_word_ty,
+                                 /*OUT*/Int* n_arm_insns,
+                                 /*OUT*/Long* arm_len )
+{
+   Int       i, ex_idx, arm_idx, n_arm;
+   Addr      target, here;
+   IRStmt**  arm;
+   DisResult dres;
+   IRTemp    skip;
+   IRConst*  target_con;
+   IRStmt*   st = irsb->stmts[irsb->stmts_used-1];
+
+   /* X must end with "if (g) goto L; PUT(IP) = ft", with L a little
+      way beyond ft. */
+   vassert(st->tag == Ist_Put && st->Ist.Put.offset == offB_GUEST_IP);
+   if (st->Ist.Put.data->tag != Iex_Const
+       || hammock_const(st->Ist.Put.data) != guest_IP_ft)
+      return False;
+   ex_idx = irsb->stmts_used-2;
+   while (ex_idx > first_stmt_idx && irsb->stmts[ex_idx]->tag == Ist_NoOp)
+      ex_idx--;
+   st = irsb->stmts[ex_idx];
+   if (st->tag != Ist_Exit
+       || st->Ist.Exit.jk != Ijk_Boring
+       || st->Ist.Exit.offsIP != offB_GUEST_IP)
+      return False;
+   target_con = st->Ist.Exit.dst;
+   target = target_con->tag == Ico_U32 ? target_con->Ico.U32
+                                       : target_con->Ico.U64;
+   if (target <= guest_IP_ft || target - guest_IP_ft > HAMMOCK_MAX_BYTES)
+      return False;
+
+   /* Disassemble the arm.  It must be straight-line code that ends
+      exactly at L. */
+   arm_idx = irsb->stmts_used;
+   here    = guest_IP_ft;
+   *n_arm_insns = 0;
+   while (here < target) {
+      Int imark_idx = irsb->stmts_used;
+      if (*n_arm_insns == max_insns)
+         goto fail;
+      /* As in bb_to_IR, a Thumb insn's T bit goes in the IMark's
+         delta field. */
+      if (arch_guest == VexArchARM && (here & 1))
+         addStmtToIRSB(irsb, IRStmt_IMark(here & ~(Addr)1, 0, 1));
+      else
+         addStmtToIRSB(irsb, IRStmt_IMark(here, 0, 0));
+      dres = dis_instr_fn(irsb, const_False, False, callback_opaque,
+                          guest_code, delta + (here - guest_IP_ft), here,
+                          arch_guest, archinfo_guest, abiinfo_both,
+                          host_endness, False/*sigill_diag*/);
+      vassert(irsb->next == NULL);
+      if (dres.whatNext != Dis_Continue || dres.len == 0)
+         goto fail;
+      irsb->stmts[imark_idx]->Ist.IMark.len = dres.len;
+      here += dres.len;
+      (*n_arm_insns)++;
+   }
+   if (here != target || irsb->stmts_used - arm_idx > HAMMOCK_MAX_STMTS)
+      goto fail;
+
+   /* Pull the loads out of PUTs, stores and nontrivial WrTmps, by
+      moving the arm to a copy and adding it back a statement at a
+      time. */
+   n_arm   = irsb->stmts_used - arm_idx;
+   arm     = LibVEX_Alloc_inline(n_arm * sizeof(IRStmt*));
+   for (i = 0; i < n_arm; i++)
+      arm[i] = irsb->stmts[arm_idx + i];
+   irsb->stmts_used = arm_idx;
+   for (i = 0; i < n_arm; i++) {
+      st = arm[i];
+      switch (st->tag) {
+         case Ist_WrTmp:
+            if (st->Ist.WrTmp.data->tag == Iex_Load) {
+               IRExpr* ld   = st->Ist.WrTmp.data;
+               IRExpr* addr = hammock_bind_loads(irsb, ld->Iex.Load.addr);
+               if (addr != ld->Iex.Load.addr)
+                  st = IRStmt_WrTmp(st->Ist.WrTmp.tmp,
+                                    IRExpr_Load(ld->Iex.Load.end,
+                                                ld->Iex.Load.ty, addr));
+            } else {
+               IRExpr* data = hammock_bind_loads(irsb, st->Ist.WrTmp.data);
+               if (data != st->Ist.WrTmp.data)
+                  st = IRStmt_WrTmp(st->Ist.WrTmp.tmp, data);
+            }
+            break;
+         case Ist_Put: {
+            IRExpr* data = hammock_bind_loads(irsb, st->Ist.Put.data);
+            if (data != st->Ist.Put.data)
+               st = IRStmt_Put(st->Ist.Put.offset, data);
+            break;
+         }
+         case Ist_Store: {
+            IRExpr* addr = hammock_bind_loads(irsb, st->Ist.Store.addr);
+            IRExpr* data = hammock_bind_loads(irsb, st->Ist.Store.data);
+            if (addr != st->Ist.Store.addr || data != st->Ist.Store.data)
+               st = IRStmt_Store(st->Ist.Store.end, addr, data);
+            break;
+         }
+         default:
+            break;
+      }
+      addStmtToIRSB(irsb, st);
+   }
+   if (irsb->stmts_used - arm_idx > HAMMOCK_MAX_STMTS)
+      goto fail;
+
+   for (i = arm_idx; i < irsb->stmts_used; i++) {
+      st = irsb->stmts[i];
+      switch (st->tag) {
+         case Ist_IMark: case Ist_NoOp: case Ist_AbiHint:
+            break;
+         case Ist_WrTmp:
+            if (st->Ist.WrTmp.data->tag == Iex_Load) {
+               const IRExpr* ld = st->Ist.WrTmp.data;
+               if (!hammock_mem_ok(irsb->tyenv, ld->Iex.Load.end,
+                                   ld->Iex.Load.ty, ld->Iex.Load.addr,
+                                   guarded_mem_ty))
+                  goto fail;
+            } else if (!hammock_expr_ok(st->Ist.WrTmp.data)) {
+               goto fail;
+            }
+            break;
+         case Ist_Put:
+            if (!hammock_expr_ok(st->Ist.Put.data))
+               goto fail;
+            if (st->Ist.Put.offset != offB_GUEST_IP
+                && !hammock_put_ok(typeOfIRExpr(irsb->tyenv,
+                                                st->Ist.Put.data),
+                                   host_word_ty))
+               goto fail;
+            break;
+         case Ist_Store:
+            if (!hammock_mem_ok(irsb->tyenv, st->Ist.Store.end,
+                                typeOfIRExpr(irsb->tyenv,
+                                             st->Ist.Store.data),
+                                st->Ist.Store.addr, guarded_mem_ty)
+                || !hammock_expr_ok(st->Ist.Store.data))
+               goto fail;
+            break;
+         default:
+            goto fail;
+      }
+   }
+
+   /* Commit.  The exit becomes the computation of g ... */
+   skip = newIRTemp(irsb->tyenv, Ity_I1);
+   irsb->stmts[ex_idx]
+      = IRStmt_WrTmp(skip, irsb->stmts[ex_idx]->Ist.Exit.guard);
+
+   /* ... and the arm is made conditional on it.  Whichever way it
+      goes, the IP finishes up at L. */
+   for (i = arm_idx; i < irsb->stmts_used; i++) {
+      st = irsb->stmts[i];
+      switch (st->tag) {
+         case Ist_AbiHint:
+            irsb->stmts[i] = IRStmt_NoOp();
+            break;
+         case Ist_WrTmp: {
+            IRExpr* ld = st->Ist.WrTmp.data;
+            Bool    is32;
+            if (ld->tag != Iex_Load)
+               break;
+            is32 = toBool(ld->Iex.Load.ty == Ity_I32);
+            irsb->stmts[i]
+               = IRStmt_LoadG(ld->Iex.Load.end,
+                              is32 ? ILGop_Ident32 : ILGop_Ident64,
+                              st->Ist.WrTmp.tmp, ld->Iex.Load.addr,
+                              IRExpr_Const(is32 ? IRConst_U32(0)
+                                                : IRConst_U64(0)),
+                              IRExpr_Unop(Iop_Not1, IRExpr_RdTmp(skip)));
+            break;
+         }
+         case Ist_Put: {
+            Int     off  = st->Ist.Put.offset;
+            IRExpr* data = st->Ist.Put.data;
+            if (off == offB_GUEST_IP) {
+               if (data->tag == Iex_Const && hammock_const(data) == target)
+                  break;
+               irsb->stmts[i]
+                  = IRStmt_Put(off, IRExpr_ITE(IRExpr_RdTmp(skip),
+                                               IRExpr_Const(target_con),
+                                               data));
+            } else {
+               irsb->stmts[i]
+                  = hammock_put(skip, off,
+                                typeOfIRExpr(irsb->tyenv, data), data);
+            }
+            break;
+         }
+         case Ist_Store:
+            irsb->stmts[i] = IRStmt_StoreG(st->Ist.Store.end,
+                                           st->Ist.Store.addr,
+                                           st->Ist.Store.data,
+                                           IRExpr_Unop(Iop_Not1,
+                                                       IRExpr_RdTmp(skip)));
+            break;
+         default:
+            break;
+      }
+   }
+   *arm_len = (Long)(target - guest_IP_ft);
+   return True;
+
+  fail:
+   irsb->stmts_used = arm_idx;
+   return False;
+}
+
+/* Disassemble a complete basic block, starting at guest_IP_start,
    returning a new IRSB.  The disassembler may chase across basic
    block boundaries if it wishes and if chase_into_ok allows it.
    The precise guest address ranges from which code has been taken
@@ -135,6 +641,22 @@ static Bool const_False ( void* callback_opaque, Addr a ) {
    guest_CMLEN.  Since this routine has to work for any guest state,
    without knowing what it is, those offsets have to passed in.
 
+   guess_indirect_target, if non-NULL, is asked for a likely target
+   whenever the block would end with an indirect jump or call.  If it
+   supplies one that chase_into_ok accepts, a guard is placed on the
+   computed target (see add_indirect_guard) and disassembly continues
+   at the predicted target, in a new extent.  A misprediction exits
+   back to the jump or call itself, which is then the first insn of
+   the translation run next; prediction is never attempted for the
+   first insn of a block, so that can't loop.
+
+   guarded_mem_ty is the widest integer type the host can load and
+   store under a guard (IRStmt_LoadG/StoreG, without widening), or
+   Ity_INVALID if it can't do that at all; when it is valid it is
+   also the host word type.  host_word_ty is the host word type.
+   Between them they limit what if_convert_hammock may do with loads,
+   stores and guest state writes when guest_chase_cond is set.
+
    callback_opaque is a caller-supplied pointer to data which the
    callbacks may want to see.  Vex has no idea what it is.
    (In fact it's a VgInstrumentClosure.)
@@ -187,6 +709,7 @@ IRSB* bb_to_IR (
          /*IN*/ const UChar*     guest_code,
          /*IN*/ Addr             guest_IP_bbstart,
          /*IN*/ Bool             (*chase_into_ok)(void*,Addr),
+         /*IN*/ Bool             (*guess_indirect_target)(void*,Addr,Addr*),
          /*IN*/ VexEndness       host_endness,
          /*IN*/ Bool             sigill_diag,
          /*IN*/ VexArch          arch_guest,
@@ -200,7 +723,9 @@ IRSB* bb_to_IR (
          /*IN*/ Int              offB_GUEST_CMSTART,
          /*IN*/ Int              offB_GUEST_CMLEN,
          /*IN*/ Int              offB_GUEST_IP,
-         /*IN*/ Int              szB_GUEST_IP
+         /*IN*/ Int              szB_GUEST_IP,
+         /*IN*/ IRType           guarded_mem_ty,
+         /*IN*/ IRType           host_word_ty
       )
 {
    Long       delta;
@@ -431,6 +956,39 @@ IRSB* bb_to_IR (
       /* Advance delta (inconspicuous but very important :-) */
       delta += (Long)dres.len;
 
+      /* A conditional branch around a short stretch of code, which
+         can be absorbed into this block? */
+      if (vex_control.guest_chase_cond
+          && ((dres.whatNext == Dis_StopHere
+               && dres.jk_StopHere == Ijk_Boring)
+              || (dres.whatNext == Dis_ResteerC
+                  && dres.continueAt == guest_IP_bbstart + delta))
+          && n_instrs < vex_control.guest_max_insns) {
+         Int  n_arm_insns = 0;
+         Long arm_len     = 0;
+         Int  max_insns   = vex_control.guest_max_insns - n_instrs;
+         if (max_insns > HAMMOCK_MAX_INSNS)
+            max_insns = HAMMOCK_MAX_INSNS;
+         if (if_convert_hammock(irsb, first_stmt_idx, dis_instr_fn,
+                                callback_opaque, guest_code, delta,
+                                guest_IP_bbstart + delta, max_insns,
+                                arch_guest, archinfo_guest, abiinfo_both,
+                                host_endness, offB_GUEST_IP,
+                                guarded_mem_ty, host_word_ty,
+                                &n_arm_insns, &arm_len)) {
+            if (debug_print)
+               vex_printf("\n              (if-converted %d insns)\n",
+                          n_arm_insns);
+            vge->len[vge->n_used-1]
+               = toUShort(toUInt( vge->len[vge->n_used-1] + arm_len ));
+            n_instrs += n_arm_insns;
+            delta    += arm_len;
+            dres.whatNext    = Dis_Continue;
+            dres.continueAt  = 0;
+            dres.jk_StopHere = Ijk_INVALID;
+         }
+      }
+
       switch (dres.whatNext) {
          case Dis_Continue:
             vassert(dres.continueAt == 0);
@@ -449,6 +1007,36 @@ IRSB* bb_to_IR (
          case Dis_StopHere:
             vassert(dres.continueAt == 0);
             vassert(dres.jk_StopHere != Ijk_INVALID);
+            /* An indirect jump or call, with a predicted target we
+               may chase into? */
+            if (guess_indirect_target
+                && resteerOK
+                && n_instrs > 1 /* so not the first insn */
+                && n_instrs < vex_control.guest_max_insns
+                && (dres.jk_StopHere == Ijk_Boring
+                    || dres.jk_StopHere == Ijk_Call)) {
+               Addr predicted = 0;
+               if (guess_indirect_target(callback_opaque,
+                                         guest_IP_curr_instr, &predicted)
+                   && predicted != guest_IP_curr_instr
+                   && chase_into_ok(callback_opaque, predicted)
+                   && add_indirect_guard(irsb, first_stmt_idx,
+                                         guest_IP_curr_instr, predicted,
+                                         guest_word_type, offB_GUEST_IP)) {
+                  if (debug_print)
+                     vex_printf("\n              "
+                                "(predicted indirect target 0x%lx)\n",
+                                predicted);
+                  delta = predicted - guest_IP_bbstart;
+                  vge->n_used++;
+                  vassert(vge->n_used <= 3);
+                  vge->base[vge->n_used-1] = predicted;
+                  vge->len[vge->n_used-1] = 0;
+                  n_resteers++;
+                  d_resteers++;
+                  break;
+               }
+            }
             /* See comment above re irsb field settings here. */
             irsb->next = IRExpr_Get(offB_GUEST_IP, guest_word_type);
             irsb->jumpkind = dres.jk_StopHere;
@@ -177,6 +177,7 @@ IRSB* bb_to_IR (
          /*IN*/ const UChar*     guest_code,
          /*IN*/ Addr             guest_IP_bbstart,
          /*IN*/ Bool             (*chase_into_ok)(void*,Addr),
+         /*IN*/ Bool             (*guess_indirect_target)(void*,Addr,Addr*),
          /*IN*/ VexEndness       host_endness,
          /*IN*/ Bool             sigill_diag,
          /*IN*/ VexArch          arch_guest,
@@ -190,7 +191,9 @@ IRSB* bb_to_IR (
          /*IN*/ Int              offB_GUEST_CMSTART,
          /*IN*/ Int              offB_GUEST_CMLEN,
          /*IN*/ Int              offB_GUEST_IP,
-         /*IN*/ Int              szB_GUEST_IP
+         /*IN*/ Int              szB_GUEST_IP,
+         /*IN*/ IRType           guarded_mem_ty,
+         /*IN*/ IRType           host_word_ty
       );
 
 
@@ -5532,20 +5532,41 @@ static Bool dis_int_ldst_mult ( UInt theInstr )
          return False;
       }
       DIP("lmw r%u,%d(r%u)\n", rD_addr, simm16, rA_addr);
-      for (r = rD_addr; r <= 31; r++) {
+      /* Two registers per doubleword load where possible.  The word
+         at the lower address is the high half in big-endian mode and
+         the low half in little-endian mode. */
+      for (r = rD_addr; r <= 31; r += 2) {
          irx_addr = binop(mkAdd, mkexpr(EA), mode64 ? mkU64(ea_off) : mkU32(ea_off));
-         putIReg( r, mkWidenFrom32(ty, load(Ity_I32, irx_addr ),
-                                       False) );
-         ea_off += 4;
+         if (r == 31) {
+            putIReg( r, mkWidenFrom32(ty, load(Ity_I32, irx_addr ),
+                                          False) );
+         } else {
+            IRTemp pair = newTemp(Ity_I64);
+            Bool   be   = host_endness == VexEndnessBE;
+            assign( pair, load(Ity_I64, irx_addr) );
+            putIReg( r,   mkWidenFrom32(ty, unop(be ? Iop_64HIto32 : Iop_64to32,
+                                                 mkexpr(pair)), False) );
+            putIReg( r+1, mkWidenFrom32(ty, unop(be ? Iop_64to32 : Iop_64HIto32,
+                                                 mkexpr(pair)), False) );
+         }
+         ea_off += 8;
       }
       break;
       
    case 0x2F: // stmw (Store Multiple Word, PPC32 p527)
       DIP("stmw r%u,%d(r%u)\n", rS_addr, simm16, rA_addr);
-      for (r = rS_addr; r <= 31; r++) {
+      for (r = rS_addr; r <= 31; r += 2) {
          irx_addr = binop(mkAdd, mkexpr(EA), mode64 ? mkU64(ea_off) : mkU32(ea_off));
-         store( irx_addr, mkNarrowTo32(ty, getIReg(r)) );
-         ea_off += 4;
+         if (r == 31) {
+            store( irx_addr, mkNarrowTo32(ty, getIReg(r)) );
+         } else {
+            IRExpr* first  = mkNarrowTo32(ty, getIReg(r));
+            IRExpr* second = mkNarrowTo32(ty, getIReg(r+1));
+            store( irx_addr, host_endness == VexEndnessBE
+                                ? binop(Iop_32HLto64, first, second)
+                                : binop(Iop_32HLto64, second, first) );
+         }
+         ea_off += 8;
       }
       break;
       
@@ -5561,92 +5582,306 @@ static Bool dis_int_ldst_mult ( UInt theInstr )
 /*
   Integer Load/Store String Instructions
 */
+
+/* The string instructions always move bytes in big-endian order:
+   the byte at EA goes to or from the most significant byte of the
+   low word of the first register.  These move 4 such bytes at
+   |addr| to or from a 32-bit value; in little-endian mode (where the
+   instructions are illegal anyway) that takes 4 byte accesses. */
+static IRExpr* /* :: Ity_I32 */ load_string_word ( IRExpr* addr )
+{
+   IRType  ty = mode64 ? Ity_I64 : Ity_I32;
+   IRExpr* w  = NULL;
+   Int     i;
+
+   if (host_endness == VexEndnessBE)
+      return load(Ity_I32, addr);
+   for (i = 0; i < 4; i++) {
+      IRExpr* b
+         = binop(Iop_Shl32,
+                 unop(Iop_8Uto32,
+                      load(Ity_I8, binop(mkSzOp(ty, Iop_Add8), addr,
+                                         mkSzImm(ty, i)))),
+                 mkU8(toUChar(24 - 8 * i)));
+      w = w ? binop(Iop_Or32, w, b) : b;
+   }
+   return w;
+}
+
+static void store_string_word ( IRExpr* addr, IRExpr* data32 )
+{
+   IRType ty = mode64 ? Ity_I64 : Ity_I32;
+   IRTemp w  = newTemp(Ity_I32);
+   Int    i;
+
+   if (host_endness == VexEndnessBE) {
+      store(addr, data32);
+      return;
+   }
+   assign(w, data32);
+   for (i = 0; i < 4; i++)
+      store(binop(mkSzOp(ty, Iop_Add8), addr, mkSzImm(ty, i)),
+            unop(Iop_32to8, binop(Iop_Shr32, mkexpr(w),
+                                  mkU8(toUChar(24 - 8 * i)))));
+}
+
+/* The low words of registers |r| and |r|+1 (mod 32), in that order,
+   as one I64. */
+static IRExpr* /* :: Ity_I64 */ string_reg_pair ( Int r )
+{
+   IRType ty = mode64 ? Ity_I64 : Ity_I32;
+   return binop(Iop_32HLto64, mkNarrowTo32(ty, getIReg(r % 32)),
+                              mkNarrowTo32(ty, getIReg((r + 1) % 32)));
+}
+
+/* The word of a string that is |back| (0 .. 3) bytes back from the
+   start of register |r|: the last |back| bytes of the previous
+   register, then the first 4-|back| of register |r|.  This is the
+   low word of string_reg_pair(r-1) >> 8*back, but done in 32 bits,
+   since a 32-bit host has no 64-bit shifts.  The left shift is split
+   in two so that it stays below 32 when |back| is 0. */
+static IRExpr* /* :: Ity_I32 */ string_tail_word ( Int r, IRExpr* back )
+{
+   IRType ty    = mode64 ? Ity_I64 : Ity_I32;
+   IRTemp bits  = newTemp(Ity_I32);
+   IRExpr* prev = mkNarrowTo32(ty, getIReg((r + 31) % 32));
+   IRExpr* cur  = mkNarrowTo32(ty, getIReg(r % 32));
+
+   assign(bits, binop(Iop_Shl32, back, mkU8(3)));
+   return binop(Iop_Or32,
+                binop(Iop_Shl32,
+                      binop(Iop_Shl32, prev, mkU8(1)),
+                      unop(Iop_32to8,
+                           binop(Iop_Sub32, mkU32(31), mkexpr(bits)))),
+                binop(Iop_Shr32, cur, unop(Iop_32to8, mkexpr(bits))));
+}
+
+/* lswi: load |nBytes| (1 .. 32) bytes at EA into registers from rD
+   on.  The count is known, so this is straight-line code: whole
+   words, in pairs where possible, then any 1 to 3 trailing bytes,
+   which are taken from the last word of the string and shifted into
+   place, or loaded singly if the string is shorter than a word. */
+static
+void generate_lsw_imm ( Int nBytes, IRTemp EA, Int rD )
+{
+   IRType  ty  = mode64 ? Ity_I64 : Ity_I32;
+   Int     off = 0;
+   IRExpr* val;
+
+   vassert(nBytes >= 1 && nBytes <= 32);
+   vassert(rD >= 0 && rD < 32);
+
+   while (off < nBytes) {
+      Int     left = nBytes - off;
+      IRExpr* addr = binop(mkSzOp(ty, Iop_Add8), mkexpr(EA),
+                           mkSzImm(ty, off));
+      if (left >= 8 && host_endness == VexEndnessBE) {
+         IRTemp pair = newTemp(Ity_I64);
+         assign(pair, load(Ity_I64, addr));
+         putIReg(rD, mkWidenFrom32(ty, unop(Iop_64HIto32, mkexpr(pair)),
+                                   False));
+         rD = (rD + 1) % 32;
+         putIReg(rD, mkWidenFrom32(ty, unop(Iop_64to32, mkexpr(pair)),
+                                   False));
+         off += 8;
+      } else {
+         if (left >= 4) {
+            val = load_string_word(addr);
+            off += 4;
+         } else if (nBytes >= 4) {
+            val = binop(Iop_Shl32,
+                        load_string_word(
+                           binop(mkSzOp(ty, Iop_Add8), mkexpr(EA),
+                                 mkSzImm(ty, nBytes - 4))),
+                        mkU8(toUChar(8 * (4 - left))));
+            off = nBytes;
+         } else {
+            Int i;
+            val = NULL;
+            for (i = 0; i < left; i++) {
+               IRExpr* b
+                  = binop(Iop_Shl32,
+                          unop(Iop_8Uto32,
+                               load(Ity_I8,
+                                    binop(mkSzOp(ty, Iop_Add8), mkexpr(EA),
+                                          mkSzImm(ty, off + i)))),
+                          mkU8(toUChar(24 - 8 * i)));
+               val = val ? binop(Iop_Or32, val, b) : b;
+            }
+            off = nBytes;
+         }
+         putIReg(rD, mkWidenFrom32(ty, val, False));
+      }
+      rD = (rD + 1) % 32;
+   }
+}
+
+/* stswi: the converse of generate_lsw_imm.  The trailing bytes are
+   stored as the last word of the string, made up from the end of
+   the previous register and the start of the last one. */
+static
+void generate_stsw_imm ( Int nBytes, IRTemp EA, Int rS )
+{
+   IRType ty  = mode64 ? Ity_I64 : Ity_I32;
+   Int    off = 0;
+
+   vassert(nBytes >= 1 && nBytes <= 32);
+   vassert(rS >= 0 && rS < 32);
+
+   while (off < nBytes) {
+      Int     left = nBytes - off;
+      IRExpr* addr = binop(mkSzOp(ty, Iop_Add8), mkexpr(EA),
+                           mkSzImm(ty, off));
+      if (left >= 8 && host_endness == VexEndnessBE) {
+         store(addr, string_reg_pair(rS));
+         rS = (rS + 2) % 32;
+         off += 8;
+      } else if (left >= 4) {
+         store_string_word(addr, mkNarrowTo32(ty, getIReg(rS)));
+         rS = (rS + 1) % 32;
+         off += 4;
+      } else if (nBytes >= 4) {
+         store_string_word(
+            binop(mkSzOp(ty, Iop_Add8), mkexpr(EA),
+                  mkSzImm(ty, nBytes - 4)),
+            binop(Iop_Or32,
+                  binop(Iop_Shl32, mkNarrowTo32(ty, getIReg((rS + 31) % 32)),
+                        mkU8(toUChar(8 * left))),
+                  binop(Iop_Shr32, mkNarrowTo32(ty, getIReg(rS)),
+                        mkU8(toUChar(8 * (4 - left))))));
+         off = nBytes;
+      } else {
+         Int i;
+         for (i = 0; i < left; i++)
+            store(binop(mkSzOp(ty, Iop_Add8), mkexpr(EA),
+                        mkSzImm(ty, off + i)),
+                  unop(Iop_32to8,
+                       binop(Iop_Shr32, mkNarrowTo32(ty, getIReg(rS)),
+                             mkU8(toUChar(24 - 8 * i)))));
+         off = nBytes;
+      }
+   }
+}
+
+/* Byte offset, from EA, of the word of a lswx/stswx string that
+   fills register |k| (k >= 1, and nBytes > 4k): normally 4k, but
+   for a final partial word, moved back so the word ends with the
+   string.  *shiftBytes is set to how far back that is, 0 .. 3. */
+static IRExpr* /* :: Ity_I32 */ string_word_offset ( IRTemp tNBytes, Int k,
+                                                     IRTemp* shiftBytes )
+{
+   *shiftBytes = newTemp(Ity_I32);
+   assign(*shiftBytes,
+          IRExpr_ITE(binop(Iop_CmpLT32U, mkexpr(tNBytes), mkU32(4*k + 4)),
+                     binop(Iop_Sub32, mkU32(4*k + 4), mkexpr(tNBytes)),
+                     mkU32(0)));
+   return binop(Iop_Sub32, mkU32(4*k), mkexpr(*shiftBytes));
+}
+
+/* Byte |j| of the first word of a lswx/stswx string, or if that is
+   beyond the end (nBytes >= 1), the last byte; so always a byte the
+   instruction may touch. */
+static IRExpr* /* :: Ity_I32 */ string_clamped_index ( IRTemp tNBytes, Int j )
+{
+   return IRExpr_ITE(binop(Iop_CmpLT32U, mkU32(j), mkexpr(tNBytes)),
+                     mkU32(j),
+                     binop(Iop_Sub32, mkexpr(tNBytes), mkU32(1)));
+}
+
+/* lswx: load |tNBytes| (0 .. 127) bytes at EA into registers from rD
+   on.  There is one exit per register, taken once the string is
+   used up, and one load: a word, or for a final partial word the
+   last word of the string shifted into place.  The first register
+   is done bytewise, at indices clamped to the string, since the
+   string may be shorter than a word. */
 static 
 void generate_lsw_sequence ( IRTemp tNBytes,   // # bytes, :: Ity_I32
                              IRTemp EA,        // EA
-                             Int    rD,        // first dst register
-                             Int    maxBytes ) // 32 or 128
+                             Int    rD )       // first dst register
 {
-   Int     i, shift = 24;
-   IRExpr* e_nbytes = mkexpr(tNBytes);
-   IRExpr* e_EA     = mkexpr(EA);
-   IRType  ty       = mode64 ? Ity_I64 : Ity_I32;
+   IRType  ty    = mode64 ? Ity_I64 : Ity_I32;
+   IRExpr* e_EA  = mkexpr(EA);
+   IRExpr* val;
+   Int     j, k;
 
    vassert(rD >= 0 && rD < 32);
-   rD--; if (rD < 0) rD = 31;
 
-   for (i = 0; i < maxBytes; i++) {
-      /* if (nBytes < (i+1)) goto NIA; */
-      stmt( IRStmt_Exit( binop(Iop_CmpLT32U, e_nbytes, mkU32(i+1)),
-                         Ijk_Boring, 
+   for (k = 0; k < 32; k++, rD = (rD + 1) % 32) {
+      /* if (nBytes <= 4k) goto NIA; */
+      stmt( IRStmt_Exit( binop(Iop_CmpLE32U, mkexpr(tNBytes), mkU32(4*k)),
+                         Ijk_Boring,
                          mkSzConst( ty, nextInsnAddr()), OFFB_CIA ));
-      /* when crossing into a new dest register, set it to zero. */
-      if ((i % 4) == 0) {
-         rD++; if (rD == 32) rD = 0;
-         putIReg(rD, mkSzImm(ty, 0));
-         shift = 24;
+      if (k == 0) {
+         val = NULL;
+         for (j = 0; j < 4; j++) {
+            IRExpr* idx = string_clamped_index(tNBytes, j);
+            IRExpr* b
+               = IRExpr_ITE(
+                    binop(Iop_CmpLT32U, mkU32(j), mkexpr(tNBytes)),
+                    binop(Iop_Shl32,
+                          unop(Iop_8Uto32,
+                               load(Ity_I8,
+                                    binop(mkSzOp(ty, Iop_Add8), e_EA,
+                                          mkWidenFrom32(ty, idx, False)))),
+                          mkU8(toUChar(24 - 8 * j))),
+                    mkU32(0));
+            val = val ? binop(Iop_Or32, val, b) : b;
+         }
+      } else {
+         IRTemp  back;
+         IRExpr* off = string_word_offset(tNBytes, k, &back);
+         val = binop(Iop_Shl32,
+                     load_string_word(
+                        binop(mkSzOp(ty, Iop_Add8), e_EA,
+                              mkWidenFrom32(ty, off, False))),
+                     unop(Iop_32to8,
+                          binop(Iop_Shl32, mkexpr(back), mkU8(3))));
       }
-      /* rD |=  (8Uto32(*(EA+i))) << shift */
-      vassert(shift == 0 || shift == 8 || shift == 16 || shift == 24);
-      putIReg( 
-         rD, 
-         mkWidenFrom32(
-            ty, 
-            binop(
-               Iop_Or32, 
-               mkNarrowTo32(ty, getIReg(rD)),
-               binop(
-                  Iop_Shl32, 
-                  unop(
-                     Iop_8Uto32, 
-                     load( Ity_I8,
-                           binop( mkSzOp(ty,Iop_Add8),
-                                  e_EA, mkSzImm(ty,i)))
-                  ), 
-                  mkU8(toUChar(shift))
-               )
-            ),
-            /*Signed*/False
-	 ) 
-      ); 
-      shift -= 8;
+      putIReg(rD, mkWidenFrom32(ty, val, False));
    }
 }
 
+/* stswx: the converse of generate_lsw_sequence.  Where a final
+   partial word is stored as the last word of the string, its first
+   bytes repeat the end of the previous register, which have already
+   been stored; likewise for the clamped indices in the first word. */
 static 
 void generate_stsw_sequence ( IRTemp tNBytes,   // # bytes, :: Ity_I32
                               IRTemp EA,        // EA
-                              Int    rS,        // first src register
-                              Int    maxBytes ) // 32 or 128
+                              Int    rS )       // first src register
 {
-   Int     i, shift = 24;
-   IRExpr* e_nbytes = mkexpr(tNBytes);
-   IRExpr* e_EA     = mkexpr(EA);
-   IRType  ty       = mode64 ? Ity_I64 : Ity_I32;
+   IRType  ty   = mode64 ? Ity_I64 : Ity_I32;
+   IRExpr* e_EA = mkexpr(EA);
+   Int     j, k;
 
    vassert(rS >= 0 && rS < 32);
-   rS--; if (rS < 0) rS = 31;
 
-   for (i = 0; i < maxBytes; i++) {
-      /* if (nBytes < (i+1)) goto NIA; */
-      stmt( IRStmt_Exit( binop(Iop_CmpLT32U, e_nbytes, mkU32(i+1)),
-                         Ijk_Boring, 
+   for (k = 0; k < 32; k++, rS = (rS + 1) % 32) {
+      /* if (nBytes <= 4k) goto NIA; */
+      stmt( IRStmt_Exit( binop(Iop_CmpLE32U, mkexpr(tNBytes), mkU32(4*k)),
+                         Ijk_Boring,
                          mkSzConst( ty, nextInsnAddr() ), OFFB_CIA ));
-      /* check for crossing into a new src register. */
-      if ((i % 4) == 0) {
-         rS++; if (rS == 32) rS = 0;
-         shift = 24;
+      if (k == 0) {
+         for (j = 0; j < 4; j++) {
+            IRTemp idx = newTemp(Ity_I32);
+            assign(idx, string_clamped_index(tNBytes, j));
+            /* *(EA+idx) = 32to8(rS >> (24 - 8*idx)) */
+            store(binop(mkSzOp(ty, Iop_Add8), e_EA,
+                        mkWidenFrom32(ty, mkexpr(idx), False)),
+                  unop(Iop_32to8,
+                       binop(Iop_Shr32, mkNarrowTo32(ty, getIReg(rS)),
+                             unop(Iop_32to8,
+                                  binop(Iop_Sub32, mkU32(24),
+                                        binop(Iop_Shl32, mkexpr(idx),
+                                              mkU8(3)))))));
+         }
+      } else {
+         IRTemp  back;
+         IRExpr* off = string_word_offset(tNBytes, k, &back);
+         store_string_word(
+            binop(mkSzOp(ty, Iop_Add8), e_EA, mkWidenFrom32(ty, off, False)),
+            string_tail_word(rS, mkexpr(back)));
       }
-      /* *(EA+i) = 32to8(rS >> shift) */
-      vassert(shift == 0 || shift == 8 || shift == 16 || shift == 24);
-      store(
-            binop( mkSzOp(ty,Iop_Add8), e_EA, mkSzImm(ty,i)),
-            unop( Iop_32to8,
-                  binop( Iop_Shr32,
-                         mkNarrowTo32( ty, getIReg(rS) ),
-                         mkU8( toUChar(shift) )))
-      );
-      shift -= 8;
    }
 }
 
@@ -5679,20 +5914,7 @@ static Bool dis_int_ldst_str ( UInt theInstr, /*OUT*/Bool* stopHere )
          registers to be loaded.  It should. */
       DIP("lswi r%u,r%u,%d\n", rD_addr, rA_addr, NumBytes);
       assign( t_EA, ea_rAor0(rA_addr) );
-      if (NumBytes == 8 && !mode64) {
-         /* Special case hack */
-         /* rD = Mem[EA]; (rD+1)%32 = Mem[EA+4] */
-         putIReg( rD_addr,          
-                  load(Ity_I32, mkexpr(t_EA)) );
-         putIReg( (rD_addr+1) % 32, 
-                  load(Ity_I32,
-                       binop(Iop_Add32, mkexpr(t_EA), mkU32(4))) );
-      } else {
-         t_nbytes = newTemp(Ity_I32);
-         assign( t_nbytes, mkU32(NumBytes==0 ? 32 : NumBytes) );
-         generate_lsw_sequence( t_nbytes, t_EA, rD_addr, 32 );
-         *stopHere = True;
-      }
+      generate_lsw_imm( NumBytes==0 ? 32 : NumBytes, t_EA, rD_addr );
       return True;
 
    case 0x215: // lswx (Load String Word Indexed, PPC32 p456)
@@ -5708,26 +5930,14 @@ static Bool dis_int_ldst_str ( UInt theInstr, /*OUT*/Bool* stopHere )
       t_nbytes = newTemp(Ity_I32);
       assign( t_EA, ea_rAor0_idxd(rA_addr,rB_addr) );
       assign( t_nbytes, unop( Iop_8Uto32, getXER_BC() ) );
-      generate_lsw_sequence( t_nbytes, t_EA, rD_addr, 128 );
+      generate_lsw_sequence( t_nbytes, t_EA, rD_addr );
       *stopHere = True;
       return True;
 
    case 0x2D5: // stswi (Store String Word Immediate, PPC32 p528)
       DIP("stswi r%u,r%u,%d\n", rS_addr, rA_addr, NumBytes);
       assign( t_EA, ea_rAor0(rA_addr) );
-      if (NumBytes == 8 && !mode64) {
-         /* Special case hack */
-         /* Mem[EA] = rD; Mem[EA+4] = (rD+1)%32 */
-         store( mkexpr(t_EA),
-                getIReg(rD_addr) );
-         store( binop(Iop_Add32, mkexpr(t_EA), mkU32(4)),
-                getIReg((rD_addr+1) % 32) );
-      } else {
-         t_nbytes = newTemp(Ity_I32);
-         assign( t_nbytes, mkU32(NumBytes==0 ? 32 : NumBytes) );
-         generate_stsw_sequence( t_nbytes, t_EA, rD_addr, 32 );
-         *stopHere = True;
-      }
+      generate_stsw_imm( NumBytes==0 ? 32 : NumBytes, t_EA, rS_addr );
       return True;
 
    case 0x295: // stswx (Store String Word Indexed, PPC32 p529)
@@ -5735,7 +5945,7 @@ static Bool dis_int_ldst_str ( UInt theInstr, /*OUT*/Bool* stopHere )
       t_nbytes = newTemp(Ity_I32);
       assign( t_EA, ea_rAor0_idxd(rA_addr,rB_addr) );
       assign( t_nbytes, unop( Iop_8Uto32, getXER_BC() ) );
-      generate_stsw_sequence( t_nbytes, t_EA, rS_addr, 128 );
+      generate_stsw_sequence( t_nbytes, t_EA, rS_addr );
       *stopHere = True;
       return True;
 
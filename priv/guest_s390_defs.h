@@ -74,7 +74,7 @@ extern VexGuestLayout s390xGuest_layout;
 /*------------------------------------------------------------*/
 /*--- Helper functions.                                    ---*/
 /*------------------------------------------------------------*/
-void s390x_dirtyhelper_EX(ULong torun);
+void s390x_dirtyhelper_EX(ULong site, ULong torun);
 ULong s390x_dirtyhelper_STCK(ULong *addr);
 ULong s390x_dirtyhelper_STCKF(ULong *addr);
 ULong s390x_dirtyhelper_STCKE(ULong *addr);
@@ -251,8 +251,10 @@ UInt s390_calculate_cond(ULong mask, ULong op, ULong dep1, ULong dep2,
 /* Size of special instructions */
 #define S390_SPECIAL_OP_SIZE 2
 
-/* Last target instruction for the EX helper */
-extern ULong last_execute_target;
+/* Last target instruction seen by the EX/EXRL at 'site', or 0 if
+   there is none.  Kept per site so that EXs of different targets do
+   not keep invalidating each other's translations. */
+extern ULong s390x_execute_target(Addr64 site);
 
 /*---------------------------------------------------------------*/
 /*--- end                                   guest_s390_defs.h ---*/
@@ -239,10 +239,67 @@ VexGuestLayout s390xGuest_layout = {
 /*------------------------------------------------------------*/
 /*--- Dirty helper for EXecute                             ---*/
 /*------------------------------------------------------------*/
+
+/* Direct-mapped, tagged by the address of the EX/EXRL.  A collision
+   only costs a retranslation of the EX.
+
+   The dirty helper runs in generated code, so on a multithreaded
+   guest it can store into the table while another thread is
+   translating and reading it.  A (site, target) pair is only ever
+   read or written with s390x_ex_table_lock held, so that a lookup
+   never pairs one EX's site with another's target. */
+#define S390X_EX_TABLE_SIZE 256
+
+static struct {
+   Addr64 site;
+   ULong  target;
+} s390x_ex_table[S390X_EX_TABLE_SIZE];
+
+static volatile Int s390x_ex_table_lock;
+
+static UInt
+s390x_ex_table_index(Addr64 site)
+{
+   /* Instructions are halfword aligned */
+   return (UInt)(site >> 1) & (S390X_EX_TABLE_SIZE - 1);
+}
+
+static void
+s390x_ex_table_acquire(void)
+{
+   while (__sync_lock_test_and_set(&s390x_ex_table_lock, 1)) {
+      while (s390x_ex_table_lock)
+         ;
+   }
+}
+
+static void
+s390x_ex_table_release(void)
+{
+   __sync_lock_release(&s390x_ex_table_lock);
+}
+
+ULong
+s390x_execute_target(Addr64 site)
+{
+   UInt ix = s390x_ex_table_index(site);
+   ULong target;
+
+   s390x_ex_table_acquire();
+   target = s390x_ex_table[ix].site == site ? s390x_ex_table[ix].target : 0;
+   s390x_ex_table_release();
+   return target;
+}
+
 void
-s390x_dirtyhelper_EX(ULong torun)
+s390x_dirtyhelper_EX(ULong site, ULong torun)
 {
-   last_execute_target = torun;
+   UInt ix = s390x_ex_table_index(site);
+
+   s390x_ex_table_acquire();
+   s390x_ex_table[ix].site   = site;
+   s390x_ex_table[ix].target = torun;
+   s390x_ex_table_release();
 }
 
 
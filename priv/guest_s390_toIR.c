@@ -77,9 +77,6 @@ static void *resteer_data;
 /* Whether to print diagnostics for illegal instructions. */
 static Bool sigill_diag;
 
-/* The last seen execute target instruction */
-ULong last_execute_target;
-
 /* The possible outcomes of a decoding operation */
 typedef enum {
    S390_DECODE_OK,
@@ -10918,7 +10915,7 @@ s390_irgen_TR_EX(IRTemp length, IRTemp start1, IRTemp start2)
 
 
 static void
-s390_irgen_EX_SS(UChar r, IRTemp addr2,
+s390_irgen_EX_SS(UChar r, IRTemp addr2, ULong target,
                  void (*irgen)(IRTemp length, IRTemp start1, IRTemp start2),
                  UInt lensize)
 {
@@ -10944,12 +10941,15 @@ s390_irgen_EX_SS(UChar r, IRTemp addr2,
    cond = newTemp(Ity_I1);
    torun = newTemp(Ity_I64);
 
+   /* The length comes from r at run time, so only the target itself
+      (with its own length field) has to match. */
    assign(torun, load(Ity_I64, mkexpr(addr2)));
    /* Start with a check that the saved code is still correct */
-   assign(cond, binop(Iop_CmpNE64, mkexpr(torun), mkU64(last_execute_target)));
+   assign(cond, binop(Iop_CmpNE64, mkexpr(torun), mkU64(target)));
    /* If not, save the new value */
    d = unsafeIRDirty_0_N (0, "s390x_dirtyhelper_EX", &s390x_dirtyhelper_EX,
-                          mkIRExprVec_1(mkexpr(torun)));
+                          mkIRExprVec_2(mkU64(guest_IA_curr_instr),
+                                        mkexpr(torun)));
    d->guard = mkexpr(cond);
    stmt(IRStmt_Dirty(d));
 
@@ -10959,7 +10959,7 @@ s390_irgen_EX_SS(UChar r, IRTemp addr2,
    stmt(IRStmt_Put(S390X_GUEST_OFFSET(guest_CMLEN), mkU64(4)));
    restart_if(mkexpr(cond));
 
-   ss.bytes = last_execute_target;
+   ss.bytes = target;
    assign(start1, binop(Iop_Add64, mkU64(ss.dec.d1),
           ss.dec.b1 != 0 ? get_gpr_dw0(ss.dec.b1) : mkU64(0)));
    assign(start2, binop(Iop_Add64, mkU64(ss.dec.d2),
@@ -10967,22 +10967,39 @@ s390_irgen_EX_SS(UChar r, IRTemp addr2,
    assign(len, unop(lensize == 64 ? Iop_8Uto64 : Iop_8Uto32, binop(Iop_Or8,
           r != 0 ? get_gpr_b7(r): mkU8(0), mkU8(ss.dec.l))));
    irgen(len, start1, start2);
-
-   last_execute_target = 0;
 }
 
+/* SS-format instructions with a length-parameterised translation.  An
+   EX of one of these is translated once per target, whatever the
+   length in r1. */
+static const struct {
+   UChar op;
+   UChar lensize;
+   void (*irgen)(IRTemp length, IRTemp start1, IRTemp start2);
+   const HChar *name;
+} s390_ex_ss_ops[] = {
+   { 0xd2, 64, s390_irgen_MVC_EX, "ex@mvc" },
+   { 0xd4, 32, s390_irgen_NC_EX,  "ex@nc"  },
+   { 0xd5, 64, s390_irgen_CLC_EX, "ex@clc" },
+   { 0xd6, 32, s390_irgen_OC_EX,  "ex@oc"  },
+   { 0xd7, 32, s390_irgen_XC_EX,  "ex@xc"  },
+   { 0xdc, 64, s390_irgen_TR_EX,  "ex@tr"  },
+};
+
 static const HChar *
 s390_irgen_EX(UChar r1, IRTemp addr2)
 {
-   switch(last_execute_target & 0xff00000000000000ULL) {
-   case 0:
-   {
+   ULong target = s390x_execute_target(guest_IA_curr_instr);
+   UInt i;
+
+   if (target == 0) {
       /* no code information yet */
       IRDirty *d;
 
       /* so safe the code... */
       d = unsafeIRDirty_0_N (0, "s390x_dirtyhelper_EX", &s390x_dirtyhelper_EX,
-                             mkIRExprVec_1(load(Ity_I64, mkexpr(addr2))));
+                             mkIRExprVec_2(mkU64(guest_IA_curr_instr),
+                                           load(Ity_I64, mkexpr(addr2))));
       stmt(IRStmt_Dirty(d));
       /* and restart */
       stmt(IRStmt_Put(S390X_GUEST_OFFSET(guest_CMSTART),
@@ -10994,40 +11011,17 @@ s390_irgen_EX(UChar r1, IRTemp addr2)
       put_IA(mkaddr_expr(guest_IA_next_instr));
       dis_res->whatNext = Dis_StopHere;
       dis_res->jk_StopHere = Ijk_InvalICache;
-      break;
+      return "ex";
    }
 
-   case 0xd200000000000000ULL:
-      /* special case MVC */
-      s390_irgen_EX_SS(r1, addr2, s390_irgen_MVC_EX, 64);
-      return "ex@mvc";
-
-   case 0xd500000000000000ULL:
-      /* special case CLC */
-      s390_irgen_EX_SS(r1, addr2, s390_irgen_CLC_EX, 64);
-      return "ex@clc";
-
-   case 0xd700000000000000ULL:
-      /* special case XC */
-      s390_irgen_EX_SS(r1, addr2, s390_irgen_XC_EX, 32);
-      return "ex@xc";
-
-   case 0xd600000000000000ULL:
-      /* special case OC */
-      s390_irgen_EX_SS(r1, addr2, s390_irgen_OC_EX, 32);
-      return "ex@oc";
-
-   case 0xd400000000000000ULL:
-      /* special case NC */
-      s390_irgen_EX_SS(r1, addr2, s390_irgen_NC_EX, 32);
-      return "ex@nc";
-
-   case 0xdc00000000000000ULL:
-      /* special case TR */
-      s390_irgen_EX_SS(r1, addr2, s390_irgen_TR_EX, 64);
-      return "ex@tr";
+   for (i = 0; i < sizeof(s390_ex_ss_ops) / sizeof(s390_ex_ss_ops[0]); i++) {
+      if ((target >> 56) == s390_ex_ss_ops[i].op) {
+         s390_irgen_EX_SS(r1, addr2, target, s390_ex_ss_ops[i].irgen,
+                          s390_ex_ss_ops[i].lensize);
+         return s390_ex_ss_ops[i].name;
+      }
+   }
 
-   default:
    {
       /* everything else will get a self checking prefix that also checks the
          register content */
@@ -11050,11 +11044,11 @@ s390_irgen_EX(UChar r1, IRTemp addr2)
              binop(Iop_Shl64, mkexpr(orperand), mkU8(48))));
 
       /* Start with a check that saved code is still correct */
-      assign(cond, binop(Iop_CmpNE64, mkexpr(torun),
-             mkU64(last_execute_target)));
+      assign(cond, binop(Iop_CmpNE64, mkexpr(torun), mkU64(target)));
       /* If not, save the new value */
       d = unsafeIRDirty_0_N (0, "s390x_dirtyhelper_EX", &s390x_dirtyhelper_EX,
-                             mkIRExprVec_1(mkexpr(torun)));
+                             mkIRExprVec_2(mkU64(guest_IA_curr_instr),
+                                           mkexpr(torun)));
       d->guard = mkexpr(cond);
       stmt(IRStmt_Dirty(d));
 
@@ -11064,14 +11058,11 @@ s390_irgen_EX(UChar r1, IRTemp addr2)
       restart_if(mkexpr(cond));
 
       /* Now comes the actual translation */
-      bytes = (UChar *) &last_execute_target;
+      bytes = (UChar *) &target;
       s390_decode_and_irgen(bytes, ((((bytes[0] >> 6) + 1) >> 1) + 1) << 1,
                             dis_res);
       if (UNLIKELY(vex_traceflags & VEX_TRACE_FE))
          vex_printf("    which was executed by\n");
-      /* dont make useless translations in the next execute */
-      last_execute_target = 0;
-   }
    }
    return "ex";
 }
@@ -11081,9 +11072,10 @@ s390_irgen_EXRL(UChar r1, UInt offset)
 {
    IRTemp addr = newTemp(Ity_I64);
    /* we might save one round trip because we know the target */
-   if (!last_execute_target)
-      last_execute_target = *(ULong *)(HWord)
-                             (guest_IA_curr_instr + offset * 2UL);
+   if (s390x_execute_target(guest_IA_curr_instr) == 0)
+      s390x_dirtyhelper_EX(guest_IA_curr_instr,
+                           *(ULong *)(HWord)(guest_IA_curr_instr
+                                             + offset * 2UL));
    assign(addr, mkU64(guest_IA_curr_instr + offset * 2UL));
    s390_irgen_EX(r1, addr);
    return "exrl";
@@ -879,13 +879,15 @@ AMD64Instr* AMD64Instr_SseSI2SF ( Int szS, Int szD, HReg src, HReg dst ) {
    vassert(szD == 4 || szD == 8);
    return i;
 }
-AMD64Instr* AMD64Instr_SseSF2SI ( Int szS, Int szD, HReg src, HReg dst ) {
-   AMD64Instr* i       = LibVEX_Alloc_inline(sizeof(AMD64Instr));
-   i->tag              = Ain_SseSF2SI;
-   i->Ain.SseSF2SI.szS = toUChar(szS);
-   i->Ain.SseSF2SI.szD = toUChar(szD);
-   i->Ain.SseSF2SI.src = src;
-   i->Ain.SseSF2SI.dst = dst;
+AMD64Instr* AMD64Instr_SseSF2SI ( Int szS, Int szD, Bool trunc,
+                                  HReg src, HReg dst ) {
+   AMD64Instr* i         = LibVEX_Alloc_inline(sizeof(AMD64Instr));
+   i->tag                = Ain_SseSF2SI;
+   i->Ain.SseSF2SI.szS   = toUChar(szS);
+   i->Ain.SseSF2SI.szD   = toUChar(szD);
+   i->Ain.SseSF2SI.trunc = trunc;
+   i->Ain.SseSF2SI.src   = src;
+   i->Ain.SseSF2SI.dst   = dst;
    vassert(szS == 4 || szS == 8);
    vassert(szD == 4 || szD == 8);
    return i;
@@ -1004,6 +1006,16 @@ AMD64Instr* AMD64Instr_SseShuf ( Int order, HReg src, HReg dst ) {
    vassert(order >= 0 && order <= 0xFF);
    return i;
 }
+AMD64Instr* AMD64Instr_SseMOVQ ( HReg gpr, HReg xmm, Bool toXMM ) {
+   AMD64Instr* i         = LibVEX_Alloc_inline(sizeof(AMD64Instr));
+   i->tag                = Ain_SseMOVQ;
+   i->Ain.SseMOVQ.gpr    = gpr;
+   i->Ain.SseMOVQ.xmm    = xmm;
+   i->Ain.SseMOVQ.toXMM  = toXMM;
+   vassert(hregClass(gpr) == HRcInt64);
+   vassert(hregClass(xmm) == HRcVec128);
+   return i;
+}
 //uu AMD64Instr* AMD64Instr_AvxLdSt ( Bool isLoad,
 //uu                                  HReg reg, AMD64AMode* addr ) {
 //uu    AMD64Instr* i         = LibVEX_Alloc_inline(sizeof(AMD64Instr));
@@ -1261,7 +1273,8 @@ void ppAMD64Instr ( const AMD64Instr* i, Bool mode64 )
          ppHRegAMD64(i->Ain.SseSI2SF.dst);
          break;
       case Ain_SseSF2SI:
-         vex_printf("cvts%s2si ", i->Ain.SseSF2SI.szS==4 ? "s" : "d");
+         vex_printf("cvt%ss%s2si ", i->Ain.SseSF2SI.trunc ? "t" : "",
+                    i->Ain.SseSF2SI.szS==4 ? "s" : "d");
          ppHRegAMD64(i->Ain.SseSF2SI.src);
          vex_printf(",");
          (i->Ain.SseSF2SI.szD==4 ? ppHRegAMD64_lo32 : ppHRegAMD64)
@@ -1356,6 +1369,18 @@ void ppAMD64Instr ( const AMD64Instr* i, Bool mode64 )
          vex_printf(",");
          ppHRegAMD64(i->Ain.SseShuf.dst);
          return;
+      case Ain_SseMOVQ:
+         vex_printf("movq ");
+         if (i->Ain.SseMOVQ.toXMM) {
+            ppHRegAMD64(i->Ain.SseMOVQ.gpr);
+            vex_printf(",");
+            ppHRegAMD64(i->Ain.SseMOVQ.xmm);
+         } else {
+            ppHRegAMD64(i->Ain.SseMOVQ.xmm);
+            vex_printf(",");
+            ppHRegAMD64(i->Ain.SseMOVQ.gpr);
+         }
+         return;
       //uu case Ain_AvxLdSt:
       //uu    vex_printf("vmovups ");
       //uu    if (i->Ain.AvxLdSt.isLoad) {
@@ -1678,6 +1703,12 @@ void getRegUsage_AMD64Instr ( HRegUsage* u, const AMD64Instr* i, Bool mode64 )
          addHRegUse(u, HRmRead,  i->Ain.SseShuf.src);
          addHRegUse(u, HRmWrite, i->Ain.SseShuf.dst);
          return;
+      case Ain_SseMOVQ:
+         addHRegUse(u, i->Ain.SseMOVQ.toXMM ? HRmRead : HRmWrite,
+                       i->Ain.SseMOVQ.gpr);
+         addHRegUse(u, i->Ain.SseMOVQ.toXMM ? HRmWrite : HRmRead,
+                       i->Ain.SseMOVQ.xmm);
+         return;
       //uu case Ain_AvxLdSt:
       //uu addRegUsage_AMD64AMode(u, i->Ain.AvxLdSt.addr);
       //uu addHRegUse(u, i->Ain.AvxLdSt.isLoad ? HRmWrite : HRmRead,
@@ -1887,6 +1918,10 @@ void mapRegs_AMD64Instr ( HRegRemap* m, AMD64Instr* i, Bool mode64 )
          mapReg(m, &i->Ain.SseShuf.src);
          mapReg(m, &i->Ain.SseShuf.dst);
          return;
+      case Ain_SseMOVQ:
+         mapReg(m, &i->Ain.SseMOVQ.gpr);
+         mapReg(m, &i->Ain.SseMOVQ.xmm);
+         return;
       //uu case Ain_AvxLdSt:
       //uu    mapReg(m, &i->Ain.AvxLdSt.reg);
       //uu    mapRegs_AMD64AMode(m, i->Ain.AvxLdSt.addr);
@@ -1946,6 +1981,29 @@ Bool isMove_AMD64Instr ( const AMD64Instr* i, HReg* src, HReg* dst )
    /*NOTREACHED*/
 }
 
+/* Is this one of the block-exiting insns?  If it is an XDirect, also
+   say where to, and via which entry point. */
+Bool isExit_AMD64Instr ( const AMD64Instr* i,
+                         /*OUT*/Bool* direct, /*OUT*/Addr* dstGA,
+                         /*OUT*/Bool* toFastEP )
+{
+   switch (i->tag) {
+      case Ain_XDirect:
+         *direct   = True;
+         *dstGA    = i->Ain.XDirect.dstGA;
+         *toFastEP = i->Ain.XDirect.toFastEP;
+         return True;
+      case Ain_XIndir:
+      case Ain_XAssisted:
+         *direct   = False;
+         *dstGA    = 0;
+         *toFastEP = False;
+         return True;
+      default:
+         return False;
+   }
+}
+
 
 /* Generate amd64 spill/reload instructions under the direction of the
    register allocator.  Note it's critical these don't write the
@@ -3452,13 +3510,13 @@ Int emit_AMD64Instr ( /*MB_MOD*/Bool* is_profInc,
       goto done;
 
    case Ain_SseSF2SI:
-      /* cvss[sd]2si %src, %dst */
+      /* cvt{t,}s[sd]2si %src, %dst */
       rex = rexAMode_R_reg_enc( i->Ain.SseSF2SI.dst,
                                 vregEnc3210(i->Ain.SseSF2SI.src) );
       *p++ = toUChar(i->Ain.SseSF2SI.szS==4 ? 0xF3 : 0xF2);
       *p++ = toUChar(i->Ain.SseSF2SI.szD==4 ? clearWBit(rex) : rex);
       *p++ = 0x0F;
-      *p++ = 0x2D;
+      *p++ = toUChar(i->Ain.SseSF2SI.trunc ? 0x2C : 0x2D);
       p = doAMode_R_reg_enc( p, i->Ain.SseSF2SI.dst,
                                 vregEnc3210(i->Ain.SseSF2SI.src) );
       goto done;
@@ -3773,6 +3831,18 @@ Int emit_AMD64Instr ( /*MB_MOD*/Bool* is_profInc,
       *p++ = (UChar)(i->Ain.SseShuf.order);
       goto done;
 
+   case Ain_SseMOVQ: {
+      /* movq %gpr, %xmm  or  movq %xmm, %gpr */
+      UInt xmm = vregEnc3210(i->Ain.SseMOVQ.xmm);
+      HReg gpr = i->Ain.SseMOVQ.gpr;
+      *p++ = 0x66;
+      *p++ = rexAMode_R_enc_reg(xmm, gpr);
+      *p++ = 0x0F;
+      *p++ = toUChar(i->Ain.SseMOVQ.toXMM ? 0x6E : 0x7E);
+      p = doAMode_R_enc_reg(p, xmm, gpr);
+      goto done;
+   }
+
    //uu case Ain_AvxLdSt: {
    //uu    UInt vex = vexAMode_M( dvreg2ireg(i->Ain.AvxLdSt.reg),
    //uu                           i->Ain.AvxLdSt.addr );
@@ -3874,6 +3944,7 @@ Int evCheckSzB_AMD64 (void)
    emitInstr case for XDirect, above. */
 VexInvalRange chainXDirect_AMD64 ( VexEndness endness_host,
                                    void* place_to_chain,
+                                   HWord wr_delta,
                                    const void* disp_cp_chain_me_EXPECTED,
                                    const void* place_to_jump_to )
 {
@@ -3886,7 +3957,7 @@ VexInvalRange chainXDirect_AMD64 ( VexEndness endness_host,
         49 BB <8 bytes value == disp_cp_chain_me_EXPECTED>
         41 FF D3
    */
-   UChar* p = (UChar*)place_to_chain;
+   UChar* p = (UChar*)place_to_chain + wr_delta;
    vassert(p[0] == 0x49);
    vassert(p[1] == 0xBB);
    vassert(read_misaligned_ULong_LE(&p[2]) == (Addr)disp_cp_chain_me_EXPECTED);
@@ -3921,7 +3992,8 @@ VexInvalRange chainXDirect_AMD64 ( VexEndness endness_host,
    */
    /* This is the delta we need to put into a JMP d32 insn.  It's
       relative to the start of the next insn, hence the -5.  */
-   Long delta   = (Long)((const UChar *)place_to_jump_to - (const UChar*)p) - 5;
+   Long delta   = (Long)((const UChar *)place_to_jump_to
+                         - (const UChar*)place_to_chain) - 5;
    Bool shortOK = delta >= -1000*1000*1000 && delta < 1000*1000*1000;
 
    static UInt shortCTR = 0; /* DO NOT MAKE NON-STATIC */
@@ -3960,6 +4032,7 @@ VexInvalRange chainXDirect_AMD64 ( VexEndness endness_host,
    emitInstr case for XDirect, above. */
 VexInvalRange unchainXDirect_AMD64 ( VexEndness endness_host,
                                      void* place_to_unchain,
+                                     HWord wr_delta,
                                      const void* place_to_jump_to_EXPECTED,
                                      const void* disp_cp_chain_me )
 {
@@ -3980,7 +4053,7 @@ VexInvalRange unchainXDirect_AMD64 ( VexEndness endness_host,
           E9 <4 bytes == disp32>
           0F 0B 0F 0B 0F 0B 0F 0B
    */
-   UChar* p     = (UChar*)place_to_unchain;
+   UChar* p     = (UChar*)place_to_unchain + wr_delta;
    Bool   valid = False;
    if (p[0] == 0x49 && p[1] == 0xBB
        && read_misaligned_ULong_LE(&p[2])
@@ -3998,7 +4071,8 @@ VexInvalRange unchainXDirect_AMD64 ( VexEndness endness_host,
       /* It's the short form.  Check the offset is right. */
       Int  s32 = (Int)read_misaligned_UInt_LE(&p[1]);
       Long s64 = (Long)s32;
-      if ((UChar*)p + 5 + s64 == place_to_jump_to_EXPECTED) {
+      if ((UChar*)place_to_unchain + 5 + s64
+          == place_to_jump_to_EXPECTED) {
          valid = True;
          if (0)
             vex_printf("QQQ unchainXDirect_AMD64: found short form\n");
@@ -4060,6 +4134,44 @@ VexInvalRange patchProfInc_AMD64 ( VexEndness endness_host,
 }
 
 
+/* Change the guest address loaded by an XDirect, as previously
+   created by the Ain_XDirect case for emit_AMD64Instr; 'place_to_patch'
+   is the start of that insn.  The new address has to fit the
+   encoding chosen for the old one, and the caller has to check that
+   it needs the same entry point, since the choice of chain_me stub
+   is not changed.  NB: this is only the value that gets written to
+   the guest RIP; if the XDirect has been chained it will still jump
+   to the old target, so unchain it first. */
+Bool patchXDirectTarget_AMD64 ( VexEndness endness_host,
+                                void* place_to_patch,
+                                Addr new_dstGA,
+                                /*OUT*/VexInvalRange* vir )
+{
+   vassert(endness_host == VexEndnessLE);
+   UChar* p = (UChar*)place_to_patch;
+
+   /* Skip the conditional jump over the rest, if any. */
+   if ((p[0] & 0xF0) == 0x70)
+      p += 2;
+
+   if (p[0] == 0x49 && p[1] == 0xC7 && p[2] == 0xC3) {
+      /* movl sign-extend(dstGA), %r11 */
+      if (!fitsIn32Bits(new_dstGA))
+         return False;
+      write_misaligned_UInt_LE(&p[3], (UInt)new_dstGA);
+      vir->start = (HWord)&p[3];
+      vir->len   = 4;
+      return True;
+   }
+   /* movabsq $dstGA, %r11 */
+   vassert(p[0] == 0x49 && p[1] == 0xBB);
+   write_misaligned_ULong_LE(&p[2], (ULong)new_dstGA);
+   vir->start = (HWord)&p[2];
+   vir->len   = 8;
+   return True;
+}
+
+
 /*---------------------------------------------------------------*/
 /*--- end                                   host_amd64_defs.c ---*/
 /*---------------------------------------------------------------*/
@@ -400,6 +400,8 @@ typedef
       Ain_SseReRg,     /* SSE binary general reg-reg, Re, Rg */
       Ain_SseCMov,     /* SSE conditional move */
       Ain_SseShuf,     /* SSE2 shuffle (pshufd) */
+      Ain_SseMOVQ,     /* movq between an int reg and the low half of
+                          an xmm reg */
       //uu Ain_AvxLdSt,     /* AVX load/store 256 bits,
       //uu                     no alignment constraints */
       //uu Ain_AvxReRg,     /* AVX binary general reg-reg, Re, Rg */
@@ -470,12 +472,14 @@ typedef
             AMD64RMI* src;
          } Push;
          /* Pseudo-insn.  Call target (an absolute address), on given
-            condition (which could be Xcc_ALWAYS). */
+            condition (which could be Xcc_ALWAYS).  The fields are
+            ordered so as to avoid padding; this is the largest
+            variant and so determines sizeof(AMD64Instr). */
          struct {
-            AMD64CondCode cond;
             Addr64        target;
-            Int           regparms; /* 0 .. 6 */
             RetLoc        rloc;     /* where the return value will be */
+            AMD64CondCode cond;
+            Int           regparms; /* 0 .. 6 */
          } Call;
          /* Update the guest RIP value, then exit requesting to chain
             to it.  May be conditional. */
@@ -624,11 +628,13 @@ typedef
             HReg  src; /* i class */
             HReg  dst; /* v class */
          } SseSI2SF;
-         /* scalar 32/64 float to 32/64 int conversion */
+         /* scalar 32/64 float to 32/64 int conversion, either using
+            the current rounding mode or (cvtts[sd]2si) truncating */
          struct {
-            UChar szS; /* 4 or 8 */
-            UChar szD; /* 4 or 8 */
-            HReg  src; /* v class */
+            UChar szS;   /* 4 or 8 */
+            UChar szD;   /* 4 or 8 */
+            Bool  trunc;
+            HReg  src;   /* v class */
             HReg  dst; /* i class */
          } SseSF2SI;
          /* scalar float32 to/from float64 */
@@ -695,6 +701,13 @@ typedef
             HReg   src;
             HReg   dst;
          } SseShuf;
+         /* 64-bit move between int and xmm regs.  When moving to
+            the xmm reg, its upper half is zeroed. */
+         struct {
+            HReg gpr;
+            HReg xmm;
+            Bool toXMM;
+         } SseMOVQ;
          //uu struct {
          //uu    Bool        isLoad;
          //uu    HReg        reg;
@@ -760,7 +773,8 @@ extern AMD64Instr* AMD64Instr_A87StSW    ( AMD64AMode* addr );
 extern AMD64Instr* AMD64Instr_LdMXCSR    ( AMD64AMode* );
 extern AMD64Instr* AMD64Instr_SseUComIS  ( Int sz, HReg srcL, HReg srcR, HReg dst );
 extern AMD64Instr* AMD64Instr_SseSI2SF   ( Int szS, Int szD, HReg src, HReg dst );
-extern AMD64Instr* AMD64Instr_SseSF2SI   ( Int szS, Int szD, HReg src, HReg dst );
+extern AMD64Instr* AMD64Instr_SseSF2SI   ( Int szS, Int szD, Bool trunc,
+                                           HReg src, HReg dst );
 extern AMD64Instr* AMD64Instr_SseSDSS    ( Bool from64, HReg src, HReg dst );
 extern AMD64Instr* AMD64Instr_SseLdSt    ( Bool isLoad, Int sz, HReg, AMD64AMode* );
 extern AMD64Instr* AMD64Instr_SseCStore  ( AMD64CondCode, HReg, AMD64AMode* );
@@ -773,6 +787,7 @@ extern AMD64Instr* AMD64Instr_Sse64FLo   ( AMD64SseOp, HReg, HReg );
 extern AMD64Instr* AMD64Instr_SseReRg    ( AMD64SseOp, HReg, HReg );
 extern AMD64Instr* AMD64Instr_SseCMov    ( AMD64CondCode, HReg src, HReg dst );
 extern AMD64Instr* AMD64Instr_SseShuf    ( Int order, HReg src, HReg dst );
+extern AMD64Instr* AMD64Instr_SseMOVQ    ( HReg gpr, HReg xmm, Bool toXMM );
 //uu extern AMD64Instr* AMD64Instr_AvxLdSt    ( Bool isLoad, HReg, AMD64AMode* );
 //uu extern AMD64Instr* AMD64Instr_AvxReRg    ( AMD64SseOp, HReg, HReg );
 extern AMD64Instr* AMD64Instr_EvCheck    ( AMD64AMode* amCounter,
@@ -787,6 +802,8 @@ extern void ppAMD64Instr ( const AMD64Instr*, Bool );
 extern void getRegUsage_AMD64Instr ( HRegUsage*, const AMD64Instr*, Bool );
 extern void mapRegs_AMD64Instr     ( HRegRemap*, AMD64Instr*, Bool );
 extern Bool isMove_AMD64Instr      ( const AMD64Instr*, HReg*, HReg* );
+extern Bool isExit_AMD64Instr      ( const AMD64Instr*, Bool*, Addr*,
+                                     Bool* );
 extern Int          emit_AMD64Instr   ( /*MB_MOD*/Bool* is_profInc,
                                         UChar* buf, Int nbuf,
                                         const AMD64Instr* i, 
@@ -814,6 +831,9 @@ extern HInstrArray* iselSB_AMD64           ( const IRSB*,
                                              Bool addProfInc,
                                              Addr max_ga );
 
+/* Does iselSB_AMD64 do this V128 op inline? */
+extern Bool hasNativeV128Op_AMD64 ( IROp op );
+
 /* How big is an event check?  This is kind of a kludge because it
    depends on the offsets of host_EvC_FAILADDR and host_EvC_COUNTER,
    and so assumes that they are both <= 128, and so can use the short
@@ -821,14 +841,19 @@ extern HInstrArray* iselSB_AMD64           ( const IRSB*,
    worst case we will merely assert at startup. */
 extern Int evCheckSzB_AMD64 (void);
 
-/* Perform a chaining and unchaining of an XDirect jump. */
+/* Perform a chaining and unchaining of an XDirect jump.  A chained
+   jump may be PC-relative, so these take the executable address of
+   the site; the code itself is read and written at place +
+   wr_delta. */
 extern VexInvalRange chainXDirect_AMD64 ( VexEndness endness_host,
                                           void* place_to_chain,
+                                          HWord wr_delta,
                                           const void* disp_cp_chain_me_EXPECTED,
                                           const void* place_to_jump_to );
 
 extern VexInvalRange unchainXDirect_AMD64 ( VexEndness endness_host,
                                             void* place_to_unchain,
+                                            HWord wr_delta,
                                             const void* place_to_jump_to_EXPECTED,
                                             const void* disp_cp_chain_me );
 
@@ -837,6 +862,12 @@ extern VexInvalRange patchProfInc_AMD64 ( VexEndness endness_host,
                                           void*  place_to_patch,
                                           const ULong* location_of_counter );
 
+/* Change the guest address that an unchained XDirect exits to. */
+extern Bool patchXDirectTarget_AMD64 ( VexEndness endness_host,
+                                       void* place_to_patch,
+                                       Addr new_dstGA,
+                                       /*OUT*/VexInvalRange* vir );
+
 
 #endif /* ndef __VEX_HOST_AMD64_DEFS_H */
 
@@ -140,6 +140,10 @@ static Bool isZeroU8 ( IRExpr* e )
      point of the destination, thereby avoiding the destination's
      event check.
 
+   - The rounding modes currently installed in %mxcsr and the x87
+     control word, and whether an insn selected right now may depend
+     on them.  See set_SSE_rounding_mode for the details.
+
    Note, this is all host-independent.  (JRS 20050201: well, kinda
    ... not completely.  Compare with ISelEnv for X86.)
 */
@@ -161,6 +165,15 @@ typedef
       /* These are modified as we go along. */
       HInstrArray* code;
       Int          vreg_ctr;
+
+      /* The rounding mode installed in each unit, as the IR atom it
+         was set from, or NULL if the default is installed.  The
+         _busy flags are True between set_XXX_rounding_mode and the
+         matching set_XXX_rounding_default. */
+      IRExpr*      sse_rm;
+      IRExpr*      fpu_rm;
+      Bool         sse_rm_busy;
+      Bool         fpu_rm_busy;
    }
    ISelEnv;
 
@@ -182,13 +195,27 @@ static void lookupIRTempPair ( HReg* vrHI, HReg* vrLO,
    *vrHI = env->vregmapHI[tmp];
 }
 
+static Bool isRoundingNeutral ( const AMD64Instr* i );
+static void emit_SSE_rounding_default ( ISelEnv* env );
+static void emit_FPU_rounding_default ( ISelEnv* env );
+
 static void addInstr ( ISelEnv* env, AMD64Instr* instr )
 {
-   addHInstr(env->code, instr);
+   /* If a non-default rounding mode has been left installed, put
+      the default back before anything that might observe it. */
+   if (((env->sse_rm && !env->sse_rm_busy)
+        || (env->fpu_rm && !env->fpu_rm_busy))
+       && !isRoundingNeutral(instr)) {
+      if (env->sse_rm && !env->sse_rm_busy)
+         emit_SSE_rounding_default(env);
+      if (env->fpu_rm && !env->fpu_rm_busy)
+         emit_FPU_rounding_default(env);
+   }
    if (vex_traceflags & VEX_TRACE_VCODE) {
       ppAMD64Instr(instr, True);
       vex_printf("\n");
    }
+   addHInstr(env->code, instr);
 }
 
 static HReg newVRegI ( ISelEnv* env )
@@ -245,6 +272,10 @@ static HReg          iselDblExpr         ( ISelEnv* env, IRExpr* e );
 static HReg          iselFltExpr_wrk     ( ISelEnv* env, IRExpr* e );
 static HReg          iselFltExpr         ( ISelEnv* env, IRExpr* e );
 
+static HReg          iselSimd64Expr_wrk  ( ISelEnv* env, IRExpr* e );
+static HReg          iselSimd64Expr      ( ISelEnv* env, IRExpr* e );
+static Bool          isSimd64OpForSse    ( IROp op );
+
 static HReg          iselVecExpr_wrk     ( ISelEnv* env, IRExpr* e );
 static HReg          iselVecExpr         ( ISelEnv* env, IRExpr* e );
 
@@ -739,32 +770,180 @@ AMD64AMode* genGuestArrayOffset ( ISelEnv* env, IRRegArray* descr,
 }
 
 
-/* Set the SSE unit's rounding mode to default (%mxcsr = 0x1F80) */
+/* Rounding modes.  Rather than setting and restoring %mxcsr (or the
+   x87 control word) around every insn that needs a non-default
+   rounding mode, we remember what is currently installed and only
+   restore the default lazily, immediately before the first insn
+   that might observe it (see addInstr and isRoundingNeutral).  So a
+   run of FP operations using the same rounding mode sets it just
+   once, and a restore directly followed by a set of a different mode
+   is avoided entirely.
+
+   Callers bracket each use with set_XXX_rounding_mode and
+   set_XXX_rounding_default, as before; the insns between the two see
+   the requested mode.  The lazy restore writes a scratch slot at
+   -64(%rsp), below all the ones used by the rest of this file, since
+   it can be inserted between a store to and a load from one of them.
+   It also leaves %rflags alone. */
+
+#define ROUNDING_SCRATCH_OFFSET (-64)
+
+static Bool isRoundingNeutralAMode ( const AMD64AMode* am )
+{
+   switch (am->tag) {
+      case Aam_IR:
+         return toBool(sameHReg(am->Aam.IR.reg, hregAMD64_RBP())
+                       || sameHReg(am->Aam.IR.reg, hregAMD64_RSP()));
+      case Aam_IRRS:
+         return sameHReg(am->Aam.IRRS.base, hregAMD64_RBP());
+      default:
+         return False;
+   }
+}
+
+static Bool isRoundingNeutralRMI ( const AMD64RMI* rmi )
+{
+   return toBool(rmi->tag != Armi_Mem
+                 || isRoundingNeutralAMode(rmi->Armi.Mem.am));
+}
+
+/* Does 'i' neither depend on the SSE or x87 rounding modes, nor
+   possibly fault or leave the block?  This errs on the side of
+   saying no: for example, memory accesses only qualify if they are
+   to the guest state or the stack. */
+static Bool isRoundingNeutral ( const AMD64Instr* i )
+{
+   switch (i->tag) {
+      case Ain_Imm64: case Ain_Sh64: case Ain_Test64: case Ain_Unary64:
+      case Ain_Lea64: case Ain_CMov64: case Ain_MovxLQ: case Ain_Set64:
+      case Ain_Bsfr64: case Ain_MFence: case Ain_A87Free:
+      case Ain_SseCMov: case Ain_SseShuf: case Ain_SseMOVQ:
+         return True;
+      case Ain_Alu64R:
+         return isRoundingNeutralRMI(i->Ain.Alu64R.src);
+      case Ain_Alu32R:
+         return isRoundingNeutralRMI(i->Ain.Alu32R.src);
+      case Ain_Push:
+         return isRoundingNeutralRMI(i->Ain.Push.src);
+      case Ain_Alu64M:
+         return isRoundingNeutralAMode(i->Ain.Alu64M.dst);
+      case Ain_MulL:
+         return toBool(i->Ain.MulL.src->tag == Arm_Reg
+                       || isRoundingNeutralAMode(i->Ain.MulL.src
+                                                  ->Arm.Mem.am));
+      case Ain_LoadEX:
+         return isRoundingNeutralAMode(i->Ain.LoadEX.src);
+      case Ain_Store:
+         return isRoundingNeutralAMode(i->Ain.Store.dst);
+      case Ain_SseLdSt:
+         return isRoundingNeutralAMode(i->Ain.SseLdSt.addr);
+      case Ain_SseLdzLO:
+         return isRoundingNeutralAMode(i->Ain.SseLdzLO.addr);
+      case Ain_A87StSW:
+         return isRoundingNeutralAMode(i->Ain.A87StSW.addr);
+      case Ain_LdMXCSR:
+         return isRoundingNeutralAMode(i->Ain.LdMXCSR.addr);
+      case Ain_A87LdCW:
+         return isRoundingNeutralAMode(i->Ain.A87LdCW.addr);
+      case Ain_SseSI2SF:
+         /* I32 -> F64 is exact */
+         return toBool(i->Ain.SseSI2SF.szS == 4 && i->Ain.SseSI2SF.szD == 8);
+      case Ain_SseSDSS:
+         /* F32 -> F64 is exact */
+         return toBool(!i->Ain.SseSDSS.from64);
+      case Ain_SseReRg:
+         switch (i->Ain.SseReRg.op) {
+            case Asse_MOV: case Asse_AND: case Asse_OR:
+            case Asse_XOR: case Asse_ANDN:
+               return True;
+            default:
+               return False;
+         }
+      default:
+         return False;
+   }
+}
+
+/* Really put the SSE unit's default rounding mode (%mxcsr = 0x1F80)
+   back.  Only for use by addInstr. */
+static void emit_SSE_rounding_default ( ISelEnv* env )
+{
+   /* movq $DEFAULT_MXCSR, -64(%rsp)
+      ldmxcsr -64(%rsp)
+   */
+   AMD64AMode* scratch = AMD64AMode_IR(ROUNDING_SCRATCH_OFFSET,
+                                       hregAMD64_RSP());
+   AMD64Instr* i1 = AMD64Instr_Alu64M(Aalu_MOV,
+                                      AMD64RI_Imm(DEFAULT_MXCSR), scratch);
+   AMD64Instr* i2 = AMD64Instr_LdMXCSR(scratch);
+   vassert(!env->sse_rm_busy);
+   if (vex_traceflags & VEX_TRACE_VCODE) {
+      ppAMD64Instr(i1, True);
+      vex_printf("\n");
+      ppAMD64Instr(i2, True);
+      vex_printf("\n");
+   }
+   addHInstr(env->code, i1);
+   addHInstr(env->code, i2);
+   env->sse_rm = NULL;
+}
+
+/* Really put the FPU's default rounding mode (DEFAULT_FPUCW) back.
+   Only for use by addInstr. */
+static void emit_FPU_rounding_default ( ISelEnv* env )
+{
+   /* movq $DEFAULT_FPUCW, -64(%rsp)
+      fldcw -64(%rsp)
+   */
+   AMD64AMode* scratch = AMD64AMode_IR(ROUNDING_SCRATCH_OFFSET,
+                                       hregAMD64_RSP());
+   AMD64Instr* i1 = AMD64Instr_Alu64M(Aalu_MOV,
+                                      AMD64RI_Imm(DEFAULT_FPUCW), scratch);
+   AMD64Instr* i2 = AMD64Instr_A87LdCW(scratch);
+   vassert(!env->fpu_rm_busy);
+   if (vex_traceflags & VEX_TRACE_VCODE) {
+      ppAMD64Instr(i1, True);
+      vex_printf("\n");
+      ppAMD64Instr(i2, True);
+      vex_printf("\n");
+   }
+   addHInstr(env->code, i1);
+   addHInstr(env->code, i2);
+   env->fpu_rm = NULL;
+}
+
+/* Is 'mode' known to be the default rounding mode? */
+static Bool isDefaultRoundingMode ( const IRExpr* mode )
+{
+   return toBool(mode->tag == Iex_Const
+                 && mode->Iex.Const.con->tag == Ico_U32
+                 && mode->Iex.Const.con->Ico.U32 == Irrm_NEAREST);
+}
+
+/* Can a previously installed rounding mode 'prev' (NULL meaning the
+   default) be reused for 'mode'?  Only if both are atoms denoting the
+   same value; IR temporaries are single-assignment so equal temps
+   will do. */
+static Bool sameRoundingMode ( const IRExpr* prev, const IRExpr* mode )
+{
+   if (prev == NULL)
+      return isDefaultRoundingMode(mode);
+   return toBool(isIRAtom(prev) && isIRAtom(mode) && eqIRAtom(prev, mode));
+}
+
+/* The SSE unit's rounding mode is no longer needed; the default
+   (%mxcsr = 0x1F80) will be put back before it can be observed. */
 static
 void set_SSE_rounding_default ( ISelEnv* env )
 {
-   /* pushq $DEFAULT_MXCSR 
-      ldmxcsr 0(%rsp)
-      addq $8, %rsp
-   */
-   AMD64AMode* zero_rsp = AMD64AMode_IR(0, hregAMD64_RSP());
-   addInstr(env, AMD64Instr_Push(AMD64RMI_Imm(DEFAULT_MXCSR)));
-   addInstr(env, AMD64Instr_LdMXCSR(zero_rsp));
-   add_to_rsp(env, 8);
+   env->sse_rm_busy = False;
 }
 
-/* Mess with the FPU's rounding mode: set to the default rounding mode
-   (DEFAULT_FPUCW). */
+/* Ditto for the FPU's rounding mode (DEFAULT_FPUCW). */
 static 
 void set_FPU_rounding_default ( ISelEnv* env )
 {
-   /* movq $DEFAULT_FPUCW, -8(%rsp)
-      fldcw -8(%esp)
-   */
-   AMD64AMode* m8_rsp = AMD64AMode_IR(-8, hregAMD64_RSP());
-   addInstr(env, AMD64Instr_Alu64M(
-                    Aalu_MOV, AMD64RI_Imm(DEFAULT_FPUCW), m8_rsp));
-   addInstr(env, AMD64Instr_A87LdCW(m8_rsp));
+   env->fpu_rm_busy = False;
 }
 
 
@@ -788,18 +967,51 @@ void set_SSE_rounding_mode ( ISelEnv* env, IRExpr* mode )
       pushq %reg
       ldmxcsr 0(%esp)
       addq $8, %rsp
+
+      or, for a constant mode,
+
+      pushq $(DEFAULT_MXCSR | mode << 13)
+      ldmxcsr 0(%esp)
+      addq $8, %rsp
    */      
-   HReg        reg      = newVRegI(env);
+   HReg        reg;
+   AMD64RMI*   rmi;
    AMD64AMode* zero_rsp = AMD64AMode_IR(0, hregAMD64_RSP());
-   addInstr(env, AMD64Instr_Alu64R(Aalu_MOV, AMD64RMI_Imm(3), reg));
-   addInstr(env, AMD64Instr_Alu64R(Aalu_AND,
-                                   iselIntExpr_RMI(env, mode), reg));
-   addInstr(env, AMD64Instr_Sh64(Ash_SHL, 13, reg));
-   addInstr(env, AMD64Instr_Alu64R(
-                    Aalu_OR, AMD64RMI_Imm(DEFAULT_MXCSR), reg));
-   addInstr(env, AMD64Instr_Push(AMD64RMI_Reg(reg)));
+
+   vassert(!env->sse_rm_busy);
+   if (sameRoundingMode(env->sse_rm, mode)) {
+      env->sse_rm_busy = True;
+      return;
+   }
+   if (isDefaultRoundingMode(mode)) {
+      emit_SSE_rounding_default(env);
+      env->sse_rm_busy = True;
+      return;
+   }
+
+   if (mode->tag == Iex_Const) {
+      vassert(mode->Iex.Const.con->tag == Ico_U32);
+      rmi = AMD64RMI_Imm(DEFAULT_MXCSR
+                         | ((mode->Iex.Const.con->Ico.U32 & 3) << 13));
+      env->sse_rm_busy = True;
+      addInstr(env, AMD64Instr_Push(rmi));
+   } else {
+      /* Compute the mode before claiming the unit, so that anything
+         it needs (a helper call, say) still sees the old mode
+         restored. */
+      rmi = iselIntExpr_RMI(env, mode);
+      reg = newVRegI(env);
+      env->sse_rm_busy = True;
+      addInstr(env, AMD64Instr_Alu64R(Aalu_MOV, AMD64RMI_Imm(3), reg));
+      addInstr(env, AMD64Instr_Alu64R(Aalu_AND, rmi, reg));
+      addInstr(env, AMD64Instr_Sh64(Ash_SHL, 13, reg));
+      addInstr(env, AMD64Instr_Alu64R(
+                       Aalu_OR, AMD64RMI_Imm(DEFAULT_MXCSR), reg));
+      addInstr(env, AMD64Instr_Push(AMD64RMI_Reg(reg)));
+   }
    addInstr(env, AMD64Instr_LdMXCSR(zero_rsp));
    add_to_rsp(env, 8);
+   env->sse_rm = mode;
 }
 
 
@@ -811,10 +1023,24 @@ void set_SSE_rounding_mode ( ISelEnv* env, IRExpr* mode )
 static
 void set_FPU_rounding_mode ( ISelEnv* env, IRExpr* mode )
 {
-   HReg rrm  = iselIntExpr_R(env, mode);
-   HReg rrm2 = newVRegI(env);
+   HReg rrm, rrm2;
    AMD64AMode* m8_rsp = AMD64AMode_IR(-8, hregAMD64_RSP());
 
+   vassert(!env->fpu_rm_busy);
+   if (sameRoundingMode(env->fpu_rm, mode)) {
+      env->fpu_rm_busy = True;
+      return;
+   }
+   if (isDefaultRoundingMode(mode)) {
+      emit_FPU_rounding_default(env);
+      env->fpu_rm_busy = True;
+      return;
+   }
+
+   rrm  = iselIntExpr_R(env, mode);
+   rrm2 = newVRegI(env);
+   env->fpu_rm_busy = True;
+
    /* movq  %rrm, %rrm2
       andq  $3, %rrm2   -- shouldn't be needed; paranoia
       shlq  $10, %rrm2
@@ -830,6 +1056,7 @@ void set_FPU_rounding_mode ( ISelEnv* env, IRExpr* mode )
    addInstr(env, AMD64Instr_Alu64M(Aalu_MOV, 
                                    AMD64RI_Reg(rrm2), m8_rsp));
    addInstr(env, AMD64Instr_A87LdCW(m8_rsp));
+   env->fpu_rm = mode;
 }
 
 
@@ -1077,47 +1304,18 @@ static HReg iselIntExpr_R_wrk ( ISelEnv* env, IRExpr* e )
          return dst;
       }
 
-      /* Deal with 64-bit SIMD binary ops */
+      /* Deal with 64-bit SIMD binary ops.  Most are done in the
+         lower halves of xmm registers. */
+      if (isSimd64OpForSse(e->Iex.Binop.op)) {
+         HReg dst = newVRegI(env);
+         HReg vec = iselSimd64Expr(env, e);
+         addInstr(env, AMD64Instr_SseMOVQ(dst, vec, False/*!toXMM*/));
+         return dst;
+      }
+
+      /* The rest need a helper. */
       second_is_UInt = False;
       switch (e->Iex.Binop.op) {
-         case Iop_Add8x8:
-            fn = (HWord)h_generic_calc_Add8x8; break;
-         case Iop_Add16x4:
-            fn = (HWord)h_generic_calc_Add16x4; break;
-         case Iop_Add32x2:
-            fn = (HWord)h_generic_calc_Add32x2; break;
-
-         case Iop_Avg8Ux8:
-            fn = (HWord)h_generic_calc_Avg8Ux8; break;
-         case Iop_Avg16Ux4:
-            fn = (HWord)h_generic_calc_Avg16Ux4; break;
-
-         case Iop_CmpEQ8x8:
-            fn = (HWord)h_generic_calc_CmpEQ8x8; break;
-         case Iop_CmpEQ16x4:
-            fn = (HWord)h_generic_calc_CmpEQ16x4; break;
-         case Iop_CmpEQ32x2:
-            fn = (HWord)h_generic_calc_CmpEQ32x2; break;
-
-         case Iop_CmpGT8Sx8:
-            fn = (HWord)h_generic_calc_CmpGT8Sx8; break;
-         case Iop_CmpGT16Sx4:
-            fn = (HWord)h_generic_calc_CmpGT16Sx4; break;
-         case Iop_CmpGT32Sx2:
-            fn = (HWord)h_generic_calc_CmpGT32Sx2; break;
-
-         case Iop_InterleaveHI8x8:
-            fn = (HWord)h_generic_calc_InterleaveHI8x8; break;
-         case Iop_InterleaveLO8x8:
-            fn = (HWord)h_generic_calc_InterleaveLO8x8; break;
-         case Iop_InterleaveHI16x4:
-            fn = (HWord)h_generic_calc_InterleaveHI16x4; break;
-         case Iop_InterleaveLO16x4:
-            fn = (HWord)h_generic_calc_InterleaveLO16x4; break;
-         case Iop_InterleaveHI32x2:
-            fn = (HWord)h_generic_calc_InterleaveHI32x2; break;
-         case Iop_InterleaveLO32x2:
-            fn = (HWord)h_generic_calc_InterleaveLO32x2; break;
          case Iop_CatOddLanes16x4:
             fn = (HWord)h_generic_calc_CatOddLanes16x4; break;
          case Iop_CatEvenLanes16x4:
@@ -1125,88 +1323,18 @@ static HReg iselIntExpr_R_wrk ( ISelEnv* env, IRExpr* e )
          case Iop_Perm8x8:
             fn = (HWord)h_generic_calc_Perm8x8; break;
 
-         case Iop_Max8Ux8:
-            fn = (HWord)h_generic_calc_Max8Ux8; break;
-         case Iop_Max16Sx4:
-            fn = (HWord)h_generic_calc_Max16Sx4; break;
-         case Iop_Min8Ux8:
-            fn = (HWord)h_generic_calc_Min8Ux8; break;
-         case Iop_Min16Sx4:
-            fn = (HWord)h_generic_calc_Min16Sx4; break;
-
-         case Iop_Mul16x4:
-            fn = (HWord)h_generic_calc_Mul16x4; break;
          case Iop_Mul32x2:
             fn = (HWord)h_generic_calc_Mul32x2; break;
-         case Iop_MulHi16Sx4:
-            fn = (HWord)h_generic_calc_MulHi16Sx4; break;
-         case Iop_MulHi16Ux4:
-            fn = (HWord)h_generic_calc_MulHi16Ux4; break;
-
-         case Iop_QAdd8Sx8:
-            fn = (HWord)h_generic_calc_QAdd8Sx8; break;
-         case Iop_QAdd16Sx4:
-            fn = (HWord)h_generic_calc_QAdd16Sx4; break;
-         case Iop_QAdd8Ux8:
-            fn = (HWord)h_generic_calc_QAdd8Ux8; break;
-         case Iop_QAdd16Ux4:
-            fn = (HWord)h_generic_calc_QAdd16Ux4; break;
-
-         case Iop_QNarrowBin32Sto16Sx4:
-            fn = (HWord)h_generic_calc_QNarrowBin32Sto16Sx4; break;
-         case Iop_QNarrowBin16Sto8Sx8:
-            fn = (HWord)h_generic_calc_QNarrowBin16Sto8Sx8; break;
-         case Iop_QNarrowBin16Sto8Ux8:
-            fn = (HWord)h_generic_calc_QNarrowBin16Sto8Ux8; break;
+
          case Iop_NarrowBin16to8x8:
             fn = (HWord)h_generic_calc_NarrowBin16to8x8; break;
          case Iop_NarrowBin32to16x4:
             fn = (HWord)h_generic_calc_NarrowBin32to16x4; break;
 
-         case Iop_QSub8Sx8:
-            fn = (HWord)h_generic_calc_QSub8Sx8; break;
-         case Iop_QSub16Sx4:
-            fn = (HWord)h_generic_calc_QSub16Sx4; break;
-         case Iop_QSub8Ux8:
-            fn = (HWord)h_generic_calc_QSub8Ux8; break;
-         case Iop_QSub16Ux4:
-            fn = (HWord)h_generic_calc_QSub16Ux4; break;
-
-         case Iop_Sub8x8:
-            fn = (HWord)h_generic_calc_Sub8x8; break;
-         case Iop_Sub16x4:
-            fn = (HWord)h_generic_calc_Sub16x4; break;
-         case Iop_Sub32x2:
-            fn = (HWord)h_generic_calc_Sub32x2; break;
-
-         case Iop_ShlN32x2:
-            fn = (HWord)h_generic_calc_ShlN32x2; 
-            second_is_UInt = True;
-            break;
-         case Iop_ShlN16x4:
-            fn = (HWord)h_generic_calc_ShlN16x4;
-            second_is_UInt = True;
-            break;
          case Iop_ShlN8x8:
             fn = (HWord)h_generic_calc_ShlN8x8;
             second_is_UInt = True;
             break;
-         case Iop_ShrN32x2:
-            fn = (HWord)h_generic_calc_ShrN32x2; 
-            second_is_UInt = True; 
-            break;
-         case Iop_ShrN16x4:
-            fn = (HWord)h_generic_calc_ShrN16x4;
-            second_is_UInt = True; 
-            break;
-         case Iop_SarN32x2:
-            fn = (HWord)h_generic_calc_SarN32x2;
-            second_is_UInt = True; 
-            break;
-         case Iop_SarN16x4:
-            fn = (HWord)h_generic_calc_SarN16x4;
-            second_is_UInt = True; 
-            break;
          case Iop_SarN8x8:
             fn = (HWord)h_generic_calc_SarN8x8;
             second_is_UInt = True; 
@@ -1362,8 +1490,18 @@ static HReg iselIntExpr_R_wrk ( ISelEnv* env, IRExpr* e )
          Int  szD = e->Iex.Binop.op==Iop_F64toI32S ? 4 : 8;
          HReg rf  = iselDblExpr(env, e->Iex.Binop.arg2);
          HReg dst = newVRegI(env);
-         set_SSE_rounding_mode( env, e->Iex.Binop.arg1 );
-         addInstr(env, AMD64Instr_SseSF2SI( 8, szD, rf, dst ));
+         IRExpr* rm = e->Iex.Binop.arg1;
+         if (rm->tag == Iex_Const && rm->Iex.Const.con->tag == Ico_U32
+             && rm->Iex.Const.con->Ico.U32 == Irrm_ZERO) {
+            /* Round towards zero is what cvttsd2si does anyway, so
+               there's no need to touch %mxcsr. */
+            addInstr(env, AMD64Instr_SseSF2SI( 8, szD, True/*trunc*/,
+                                               rf, dst ));
+            return dst;
+         }
+         set_SSE_rounding_mode( env, rm );
+         addInstr(env, AMD64Instr_SseSF2SI( 8, szD, False/*!trunc*/,
+                                            rf, dst ));
          set_SSE_rounding_default(env);
          return dst;
       }
@@ -1744,28 +1882,10 @@ static HReg iselIntExpr_R_wrk ( ISelEnv* env, IRExpr* e )
       }
 
       /* Deal with unary 64-bit SIMD ops. */
-      switch (e->Iex.Unop.op) {
-         case Iop_CmpNEZ32x2:
-            fn = (HWord)h_generic_calc_CmpNEZ32x2; break;
-         case Iop_CmpNEZ16x4:
-            fn = (HWord)h_generic_calc_CmpNEZ16x4; break;
-         case Iop_CmpNEZ8x8:
-            fn = (HWord)h_generic_calc_CmpNEZ8x8; break;
-         default:
-            fn = (HWord)0; break;
-      }
-      if (fn != (HWord)0) {
-         /* Note: the following assumes all helpers are of
-            signature 
-               ULong fn ( ULong ), and they are
-            not marked as regparm functions. 
-         */
+      if (isSimd64OpForSse(e->Iex.Unop.op)) {
          HReg dst = newVRegI(env);
-         HReg arg = iselIntExpr_R(env, e->Iex.Unop.arg);
-         addInstr(env, mk_iMOVsd_RR(arg, hregAMD64_RDI()) );
-         addInstr(env, AMD64Instr_Call( Acc_ALWAYS, (ULong)fn, 1,
-                                        mk_RetLoc_simple(RLPri_Int) ));
-         addInstr(env, mk_iMOVsd_RR(hregAMD64_RAX(), dst));
+         HReg vec = iselSimd64Expr(env, e);
+         addInstr(env, AMD64Instr_SseMOVQ(dst, vec, False/*!toXMM*/));
          return dst;
       }
 
@@ -3100,6 +3220,241 @@ static HReg iselDblExpr_wrk ( ISelEnv* env, IRExpr* e )
 }
 
 
+/*---------------------------------------------------------*/
+/*--- ISEL: SIMD (Vector) expressions, 64 bit, in XMM   ---*/
+/*---------------------------------------------------------*/
+
+/* 64-bit SIMD values (the MMX-style ops on Ity_I64) live in integer
+   registers, but most of the ops on them have direct SSE2
+   equivalents.  So, when such an op is seen, the whole tree of such
+   ops rooted at it is computed in the lower halves of xmm registers,
+   and the result is moved back to an integer register at the end.
+   Ops with no cheap SSE2 equivalent (Mul32x2, Perm8x8, 8-bit lane
+   shifts, etc) are still done by the h_generic_calc_* helpers. */
+
+/* Can 'op' be done by iselSimd64Expr in xmm registers? */
+static Bool isSimd64OpForSse ( IROp op )
+{
+   switch (op) {
+      case Iop_Add8x8: case Iop_Add16x4: case Iop_Add32x2:
+      case Iop_Sub8x8: case Iop_Sub16x4: case Iop_Sub32x2:
+      case Iop_QAdd8Sx8: case Iop_QAdd16Sx4:
+      case Iop_QAdd8Ux8: case Iop_QAdd16Ux4:
+      case Iop_QSub8Sx8: case Iop_QSub16Sx4:
+      case Iop_QSub8Ux8: case Iop_QSub16Ux4:
+      case Iop_Avg8Ux8: case Iop_Avg16Ux4:
+      case Iop_CmpEQ8x8: case Iop_CmpEQ16x4: case Iop_CmpEQ32x2:
+      case Iop_CmpGT8Sx8: case Iop_CmpGT16Sx4: case Iop_CmpGT32Sx2:
+      case Iop_Max8Ux8: case Iop_Max16Sx4:
+      case Iop_Min8Ux8: case Iop_Min16Sx4:
+      case Iop_Mul16x4: case Iop_MulHi16Sx4: case Iop_MulHi16Ux4:
+      case Iop_InterleaveLO8x8: case Iop_InterleaveLO16x4:
+      case Iop_InterleaveLO32x2:
+      case Iop_InterleaveHI8x8: case Iop_InterleaveHI16x4:
+      case Iop_InterleaveHI32x2:
+      case Iop_QNarrowBin32Sto16Sx4: case Iop_QNarrowBin16Sto8Sx8:
+      case Iop_QNarrowBin16Sto8Ux8:
+      case Iop_ShlN16x4: case Iop_ShlN32x2:
+      case Iop_ShrN16x4: case Iop_ShrN32x2:
+      case Iop_SarN16x4: case Iop_SarN32x2:
+      case Iop_CmpNEZ8x8: case Iop_CmpNEZ16x4: case Iop_CmpNEZ32x2:
+         return True;
+      default:
+         return False;
+   }
+}
+
+/* Compute an I64-typed expression into the lower half of a vector
+   register.  The upper half of the result is unspecified.  As with
+   iselVecExpr, the returned register must not be modified by the
+   caller. */
+static HReg iselSimd64Expr ( ISelEnv* env, IRExpr* e )
+{
+   HReg r = iselSimd64Expr_wrk( env, e );
+#  if 0
+   vex_printf("\n"); ppIRExpr(e); vex_printf("\n");
+#  endif
+   vassert(hregClass(r) == HRcVec128);
+   vassert(hregIsVirtual(r));
+   return r;
+}
+
+/* DO NOT CALL THIS DIRECTLY */
+static HReg iselSimd64Expr_wrk ( ISelEnv* env, IRExpr* e )
+{
+   Bool       arg1isEReg = False;
+   AMD64SseOp op = Asse_INVALID;
+   IRType     ty = typeOfIRExpr(env->type_env,e);
+   vassert(ty == Ity_I64);
+
+   if (e->tag == Iex_Get) {
+      HReg dst = newVRegV(env);
+      addInstr(env, AMD64Instr_SseLdzLO(
+                       8, dst,
+                       AMD64AMode_IR(e->Iex.Get.offset, hregAMD64_RBP())));
+      return dst;
+   }
+
+   if (e->tag == Iex_Load && e->Iex.Load.end == Iend_LE) {
+      HReg        dst = newVRegV(env);
+      AMD64AMode* am  = iselIntExpr_AMode(env, e->Iex.Load.addr);
+      addInstr(env, AMD64Instr_SseLdzLO(8, dst, am));
+      return dst;
+   }
+
+   if (e->tag == Iex_Unop && isSimd64OpForSse(e->Iex.Unop.op)) {
+      switch (e->Iex.Unop.op) {
+         case Iop_CmpNEZ32x2: op = Asse_CMPEQ32; break;
+         case Iop_CmpNEZ16x4: op = Asse_CMPEQ16; break;
+         case Iop_CmpNEZ8x8:  op = Asse_CMPEQ8;  break;
+         default: vassert(0);
+      }
+      HReg arg  = iselSimd64Expr(env, e->Iex.Unop.arg);
+      HReg tmp  = newVRegV(env);
+      HReg zero = generate_zeroes_V128(env);
+      addInstr(env, mk_vMOVsd_RR(arg, tmp));
+      addInstr(env, AMD64Instr_SseReRg(op, zero, tmp));
+      return do_sse_NotV128(env, tmp);
+   }
+
+   if (e->tag == Iex_Binop && isSimd64OpForSse(e->Iex.Binop.op)) {
+      switch (e->Iex.Binop.op) {
+
+      case Iop_QNarrowBin32Sto16Sx4:
+         op = Asse_PACKSSD; goto do_Narrow;
+      case Iop_QNarrowBin16Sto8Sx8:
+         op = Asse_PACKSSW; goto do_Narrow;
+      case Iop_QNarrowBin16Sto8Ux8:
+         op = Asse_PACKUSW; goto do_Narrow;
+      do_Narrow: {
+         /* Glue the args together as argL:argR and narrow that onto
+            itself; the lower half of the result is what we want. */
+         HReg argL = iselSimd64Expr(env, e->Iex.Binop.arg1);
+         HReg argR = iselSimd64Expr(env, e->Iex.Binop.arg2);
+         HReg dst  = newVRegV(env);
+         addInstr(env, mk_vMOVsd_RR(argR, dst));
+         addInstr(env, AMD64Instr_SseReRg(Asse_UNPCKLQ, argL, dst));
+         addInstr(env, AMD64Instr_SseReRg(op, dst, dst));
+         return dst;
+      }
+
+      case Iop_InterleaveHI8x8:
+         op = Asse_UNPCKLB; goto do_InterleaveHI;
+      case Iop_InterleaveHI16x4:
+         op = Asse_UNPCKLW; goto do_InterleaveHI;
+      case Iop_InterleaveHI32x2:
+         op = Asse_UNPCKLD; goto do_InterleaveHI;
+      do_InterleaveHI: {
+         /* Interleave the whole of the lower halves, then move the
+            upper half of the result down. */
+         HReg argL = iselSimd64Expr(env, e->Iex.Binop.arg1);
+         HReg argR = iselSimd64Expr(env, e->Iex.Binop.arg2);
+         HReg tmp  = newVRegV(env);
+         HReg dst  = newVRegV(env);
+         addInstr(env, mk_vMOVsd_RR(argR, tmp));
+         addInstr(env, AMD64Instr_SseReRg(op, argL, tmp));
+         addInstr(env, AMD64Instr_SseShuf(0xEE, tmp, dst));
+         return dst;
+      }
+
+      case Iop_ShlN16x4: op = Asse_SHL16; goto do_SseShift;
+      case Iop_ShlN32x2: op = Asse_SHL32; goto do_SseShift;
+      case Iop_ShrN16x4: op = Asse_SHR16; goto do_SseShift;
+      case Iop_ShrN32x2: op = Asse_SHR32; goto do_SseShift;
+      case Iop_SarN16x4: op = Asse_SAR16; goto do_SseShift;
+      case Iop_SarN32x2: op = Asse_SAR32; goto do_SseShift;
+      do_SseShift: {
+         /* The shift amount has to be in an xmm register too.  It is
+            an I8, so clear out whatever is above it. */
+         HReg greg = iselSimd64Expr(env, e->Iex.Binop.arg1);
+         HReg amt  = newVRegI(env);
+         HReg ereg = newVRegV(env);
+         HReg dst  = newVRegV(env);
+         if (e->Iex.Binop.arg2->tag == Iex_Const) {
+            vassert(e->Iex.Binop.arg2->Iex.Const.con->tag == Ico_U8);
+            addInstr(env, AMD64Instr_Alu64R(
+                             Aalu_MOV,
+                             AMD64RMI_Imm(e->Iex.Binop.arg2
+                                           ->Iex.Const.con->Ico.U8),
+                             amt));
+         } else {
+            HReg r = iselIntExpr_R(env, e->Iex.Binop.arg2);
+            addInstr(env, mk_iMOVsd_RR(r, amt));
+            addInstr(env, AMD64Instr_Alu64R(Aalu_AND, AMD64RMI_Imm(0xFF),
+                                            amt));
+         }
+         addInstr(env, AMD64Instr_SseMOVQ(amt, ereg, True/*toXMM*/));
+         addInstr(env, mk_vMOVsd_RR(greg, dst));
+         addInstr(env, AMD64Instr_SseReRg(op, ereg, dst));
+         return dst;
+      }
+
+      case Iop_InterleaveLO8x8:
+         op = Asse_UNPCKLB; arg1isEReg = True; goto do_SseReRg;
+      case Iop_InterleaveLO16x4:
+         op = Asse_UNPCKLW; arg1isEReg = True; goto do_SseReRg;
+      case Iop_InterleaveLO32x2:
+         op = Asse_UNPCKLD; arg1isEReg = True; goto do_SseReRg;
+
+      case Iop_Add8x8:     op = Asse_ADD8;     goto do_SseReRg;
+      case Iop_Add16x4:    op = Asse_ADD16;    goto do_SseReRg;
+      case Iop_Add32x2:    op = Asse_ADD32;    goto do_SseReRg;
+      case Iop_QAdd8Sx8:   op = Asse_QADD8S;   goto do_SseReRg;
+      case Iop_QAdd16Sx4:  op = Asse_QADD16S;  goto do_SseReRg;
+      case Iop_QAdd8Ux8:   op = Asse_QADD8U;   goto do_SseReRg;
+      case Iop_QAdd16Ux4:  op = Asse_QADD16U;  goto do_SseReRg;
+      case Iop_Avg8Ux8:    op = Asse_AVG8U;    goto do_SseReRg;
+      case Iop_Avg16Ux4:   op = Asse_AVG16U;   goto do_SseReRg;
+      case Iop_CmpEQ8x8:   op = Asse_CMPEQ8;   goto do_SseReRg;
+      case Iop_CmpEQ16x4:  op = Asse_CMPEQ16;  goto do_SseReRg;
+      case Iop_CmpEQ32x2:  op = Asse_CMPEQ32;  goto do_SseReRg;
+      case Iop_CmpGT8Sx8:  op = Asse_CMPGT8S;  goto do_SseReRg;
+      case Iop_CmpGT16Sx4: op = Asse_CMPGT16S; goto do_SseReRg;
+      case Iop_CmpGT32Sx2: op = Asse_CMPGT32S; goto do_SseReRg;
+      case Iop_Max16Sx4:   op = Asse_MAX16S;   goto do_SseReRg;
+      case Iop_Max8Ux8:    op = Asse_MAX8U;    goto do_SseReRg;
+      case Iop_Min16Sx4:   op = Asse_MIN16S;   goto do_SseReRg;
+      case Iop_Min8Ux8:    op = Asse_MIN8U;    goto do_SseReRg;
+      case Iop_MulHi16Ux4: op = Asse_MULHI16U; goto do_SseReRg;
+      case Iop_MulHi16Sx4: op = Asse_MULHI16S; goto do_SseReRg;
+      case Iop_Mul16x4:    op = Asse_MUL16;    goto do_SseReRg;
+      case Iop_Sub8x8:     op = Asse_SUB8;     goto do_SseReRg;
+      case Iop_Sub16x4:    op = Asse_SUB16;    goto do_SseReRg;
+      case Iop_Sub32x2:    op = Asse_SUB32;    goto do_SseReRg;
+      case Iop_QSub8Sx8:   op = Asse_QSUB8S;   goto do_SseReRg;
+      case Iop_QSub16Sx4:  op = Asse_QSUB16S;  goto do_SseReRg;
+      case Iop_QSub8Ux8:   op = Asse_QSUB8U;   goto do_SseReRg;
+      case Iop_QSub16Ux4:  op = Asse_QSUB16U;  goto do_SseReRg;
+      do_SseReRg: {
+         HReg arg1 = iselSimd64Expr(env, e->Iex.Binop.arg1);
+         HReg arg2 = iselSimd64Expr(env, e->Iex.Binop.arg2);
+         HReg dst = newVRegV(env);
+         if (arg1isEReg) {
+            addInstr(env, mk_vMOVsd_RR(arg2, dst));
+            addInstr(env, AMD64Instr_SseReRg(op, arg1, dst));
+         } else {
+            addInstr(env, mk_vMOVsd_RR(arg1, dst));
+            addInstr(env, AMD64Instr_SseReRg(op, arg2, dst));
+         }
+         return dst;
+      }
+
+      default:
+         vassert(0);
+      } /* switch (e->Iex.Binop.op) */
+   }
+
+   /* Anything else: compute it in an integer register and move it
+      across. */
+   {
+      HReg src = iselIntExpr_R(env, e);
+      HReg dst = newVRegV(env);
+      addInstr(env, AMD64Instr_SseMOVQ(src, dst, True/*toXMM*/));
+      return dst;
+   }
+}
+
+
 /*---------------------------------------------------------*/
 /*--- ISEL: SIMD (Vector) expressions, 128 bit.         ---*/
 /*---------------------------------------------------------*/
@@ -4914,6 +5269,29 @@ static void iselNext ( ISelEnv* env,
 }
 
 
+/*---------------------------------------------------------*/
+/*--- Which vector ops are done inline                  ---*/
+/*---------------------------------------------------------*/
+
+/* Is 'op' one of the integer lane-wise V128 ops which the above
+   generate a single SSE2 instruction for, rather than a helper call?
+   Used by iropt when deciding whether to vectorise scalar code; ops
+   other than those it asks about get False. */
+
+Bool hasNativeV128Op_AMD64 ( IROp op )
+{
+   switch (op) {
+      case Iop_Add8x16: case Iop_Add16x8: case Iop_Add32x4: case Iop_Add64x2:
+      case Iop_Sub8x16: case Iop_Sub16x8: case Iop_Sub32x4: case Iop_Sub64x2:
+      case Iop_Mul16x8:
+      case Iop_AndV128: case Iop_OrV128:  case Iop_XorV128:
+         return True;
+      default:
+         return False;
+   }
+}
+
+
 /*---------------------------------------------------------*/
 /*--- Insn selector top-level                           ---*/
 /*---------------------------------------------------------*/
@@ -4954,8 +5332,9 @@ HInstrArray* iselSB_AMD64 ( const IRSB* bb,
    env = LibVEX_Alloc_inline(sizeof(ISelEnv));
    env->vreg_ctr = 0;
 
-   /* Set up output code array. */
-   env->code = newHInstrArray();
+   /* Set up output code array, big enough for the three instructions
+      that two statements typically turn into. */
+   env->code = newHInstrArray(sizeof(AMD64Instr), 3 * bb->stmts_used / 2);
 
    /* Copy BB's type env. */
    env->type_env = bb->tyenv;
@@ -4970,6 +5349,10 @@ HInstrArray* iselSB_AMD64 ( const IRSB* bb,
    env->chainingAllowed = chainingAllowed;
    env->hwcaps          = hwcaps_host;
    env->max_ga          = max_ga;
+   env->sse_rm          = NULL;
+   env->fpu_rm          = NULL;
+   env->sse_rm_busy     = False;
+   env->fpu_rm_busy     = False;
 
    /* For each IR temporary, allocate a suitably-kinded virtual
       register. */
@@ -5023,6 +5406,10 @@ HInstrArray* iselSB_AMD64 ( const IRSB* bb,
 
    iselNext(env, bb->next, bb->jumpkind, bb->offsIP);
 
+   /* The block exit must have put the default rounding modes back. */
+   vassert(env->sse_rm == NULL && !env->sse_rm_busy);
+   vassert(env->fpu_rm == NULL && !env->fpu_rm_busy);
+
    /* record the number of vregs we used. */
    env->code->n_vregs = env->vreg_ctr;
    return env->code;
@@ -987,6 +987,9 @@ extern HInstrArray* iselSB_ARM64 ( const IRSB*,
                                    Bool addProfInc,
                                    Addr max_ga );
 
+/* Does iselSB_ARM64 do this V128 op inline? */
+extern Bool hasNativeV128Op_ARM64 ( IROp op );
+
 /* How big is an event check?  This is kind of a kludge because it
    depends on the offsets of host_EvC_FAILADDR and
    host_EvC_COUNTER. */
@@ -131,11 +131,11 @@ static void lookupIRTempPair ( HReg* vrHI, HReg* vrLO,
 
 static void addInstr ( ISelEnv* env, ARM64Instr* instr )
 {
-   addHInstr(env->code, instr);
    if (vex_traceflags & VEX_TRACE_VCODE) {
       ppARM64Instr(instr);
       vex_printf("\n");
    }
+   addHInstr(env->code, instr);
 }
 
 static HReg newVRegI ( ISelEnv* env )
@@ -362,7 +362,8 @@ static Bool isZeroU64 ( IRExpr* e ) {
    first comparing 'mode' to the 'mode' tree supplied in the previous
    call to this function, if any.  (The previous value is stored in
    env->previous_rm.)  If 'mode' is a single IR temporary 't' and
-   env->previous_rm is also just 't', then the setting is skipped.
+   env->previous_rm is also just 't', or both are the same constant,
+   then the setting is skipped.
 
    This is safe because of the SSA property of IR: an IR temporary can
    only be defined once and so will have the same value regardless of
@@ -384,9 +385,9 @@ void set_FPCR_rounding_mode ( ISelEnv* env, IRExpr* mode )
    
    /* Do we need to do anything? */
    if (env->previous_rm
-       && env->previous_rm->tag == Iex_RdTmp
-       && mode->tag == Iex_RdTmp
-       && env->previous_rm->Iex.RdTmp.tmp == mode->Iex.RdTmp.tmp) {
+       && isIRAtom(env->previous_rm)
+       && isIRAtom(mode)
+       && eqIRAtom(env->previous_rm, mode)) {
       /* no - setting it to what it was before.  */
       vassert(typeOfIRExpr(env->type_env, env->previous_rm) == Ity_I32);
       return;
@@ -3065,6 +3066,12 @@ static HReg iselDblExpr_wrk ( ISelEnv* env, IRExpr* e )
             addInstr(env, ARM64Instr_VCvtHD(True/*hToD*/, dst, src));
             return dst;
          }
+         case Iop_ReinterpI64asF64: {
+            HReg src = iselIntExpr_R(env, e->Iex.Unop.arg);
+            HReg dst = newVRegD(env);
+            addInstr(env, ARM64Instr_VDfromX(dst, src));
+            return dst;
+         }
          case Iop_I32UtoF64:
          case Iop_I32StoF64: {
             /* Rounding mode is not involved here, since the
@@ -3246,6 +3253,15 @@ static HReg iselFltExpr_wrk ( ISelEnv* env, IRExpr* e )
             addInstr(env, ARM64Instr_VCvtHS(True/*hToS*/, dst, src));
             return dst;
          }
+         case Iop_ReinterpI32asF32: {
+            /* Only the low 32 bits of the D register are looked at
+               by the S-form instructions, so whatever is in the
+               upper half of the X register is harmless. */
+            HReg src = iselIntExpr_R(env, e->Iex.Unop.arg);
+            HReg dst = newVRegD(env);
+            addInstr(env, ARM64Instr_VDfromX(dst, src));
+            return dst;
+         }
          default:
             break;
       }
@@ -4013,6 +4029,29 @@ static void iselNext ( ISelEnv* env,
 }
 
 
+/*---------------------------------------------------------*/
+/*--- Which vector ops are done inline                  ---*/
+/*---------------------------------------------------------*/
+
+/* Is 'op' one of the integer lane-wise V128 ops which the above
+   generate a single instruction for?  Used by iropt when deciding
+   whether to vectorise scalar code; ops other than those it asks
+   about get False. */
+
+Bool hasNativeV128Op_ARM64 ( IROp op )
+{
+   switch (op) {
+      case Iop_Add8x16: case Iop_Add16x8: case Iop_Add32x4: case Iop_Add64x2:
+      case Iop_Sub8x16: case Iop_Sub16x8: case Iop_Sub32x4: case Iop_Sub64x2:
+      case Iop_Mul8x16: case Iop_Mul16x8: case Iop_Mul32x4:
+      case Iop_AndV128: case Iop_OrV128:  case Iop_XorV128:
+         return True;
+      default:
+         return False;
+   }
+}
+
+
 /*---------------------------------------------------------*/
 /*--- Insn selector top-level                           ---*/
 /*---------------------------------------------------------*/
@@ -4048,8 +4087,9 @@ HInstrArray* iselSB_ARM64 ( const IRSB* bb,
    env = LibVEX_Alloc_inline(sizeof(ISelEnv));
    env->vreg_ctr = 0;
 
-   /* Set up output code array. */
-   env->code = newHInstrArray();
+   /* Set up output code array.  Being load-store, ARM64 needs about
+      three instructions per statement. */
+   env->code = newHInstrArray(sizeof(ARM64Instr), 3 * bb->stmts_used + 8);
     
    /* Copy BB's type env. */
    env->type_env = bb->tyenv;
@@ -4687,6 +4687,7 @@ Int evCheckSzB_ARM (void)
    emitInstr case for XDirect, above. */
 VexInvalRange chainXDirect_ARM ( VexEndness endness_host,
                                  void* place_to_chain,
+                                 HWord wr_delta,
                                  const void* disp_cp_chain_me_EXPECTED,
                                  const void* place_to_jump_to )
 {
@@ -4700,7 +4701,7 @@ VexInvalRange chainXDirect_ARM ( VexEndness endness_host,
         <8 bytes generated by imm32_to_ireg_EXACTLY2>
         E1 2F FF 3C
    */
-   UInt* p = (UInt*)place_to_chain;
+   UInt* p = (UInt*)((UChar*)place_to_chain + wr_delta);
    vassert(0 == (3 & (HWord)p));
    vassert(is_imm32_to_ireg_EXACTLY2(
               p, /*r*/12, (UInt)(Addr)disp_cp_chain_me_EXPECTED));
@@ -4732,8 +4733,10 @@ VexInvalRange chainXDirect_ARM ( VexEndness endness_host,
    */
 
    /* This is the delta we need to put into a B insn.  It's relative
-      to the start of the next-but-one insn, hence the -8.  */
-   Long delta   = (Long)((const UChar *)place_to_jump_to - (const UChar*)p) - 8;
+      to the start of the next-but-one insn, hence the -8, and to
+      where the code runs, not the alias it is written through.  */
+   Long delta   = (Long)((const UChar *)place_to_jump_to
+                         - (const UChar*)place_to_chain) - 8;
    Bool shortOK = delta >= -30*1000*1000 && delta < 30*1000*1000;
    vassert(0 == (delta & (Long)3));
 
@@ -4761,7 +4764,7 @@ VexInvalRange chainXDirect_ARM ( VexEndness endness_host,
       p[2] = 0xE12FFF1C;
    }
 
-   VexInvalRange vir = {(HWord)p, 12};
+   VexInvalRange vir = {(HWord)place_to_chain, 12};
    return vir;
 }
 
@@ -4770,6 +4773,7 @@ VexInvalRange chainXDirect_ARM ( VexEndness endness_host,
    emitInstr case for XDirect, above. */
 VexInvalRange unchainXDirect_ARM ( VexEndness endness_host,
                                    void* place_to_unchain,
+                                   HWord wr_delta,
                                    const void* place_to_jump_to_EXPECTED,
                                    const void* disp_cp_chain_me )
 {
@@ -4791,7 +4795,7 @@ VexInvalRange unchainXDirect_ARM ( VexEndness endness_host,
           FF 00 00 00
           FF 00 00 00
    */
-   UInt* p = (UInt*)place_to_unchain;
+   UInt* p = (UInt*)((UChar*)place_to_unchain + wr_delta);
    vassert(0 == (3 & (HWord)p));
 
    Bool valid = False;
@@ -4806,7 +4810,8 @@ VexInvalRange unchainXDirect_ARM ( VexEndness endness_host,
       /* It's the short form.  Check the displacement is right. */
       Int simm24 = p[0] & 0x00FFFFFF;
       simm24 <<= 8; simm24 >>= 8;
-      if ((UChar*)p + (simm24 << 2) + 8 == place_to_jump_to_EXPECTED) {
+      if ((UChar*)place_to_unchain + (simm24 << 2) + 8
+          == place_to_jump_to_EXPECTED) {
          valid = True;
          if (0)
             vex_printf("QQQ unchainXDirect_ARM: found short form\n");
@@ -4825,7 +4830,7 @@ VexInvalRange unchainXDirect_ARM ( VexEndness endness_host,
    (void)imm32_to_ireg_EXACTLY2(
             p, /*r*/12, (UInt)(Addr)disp_cp_chain_me);
    p[2] = 0xE12FFF3C;
-   VexInvalRange vir = {(HWord)p, 12};
+   VexInvalRange vir = {(HWord)place_to_unchain, 12};
    return vir;
 }
 
@@ -1061,11 +1061,13 @@ extern Int evCheckSzB_ARM (void);
 /* Perform a chaining and unchaining of an XDirect jump. */
 extern VexInvalRange chainXDirect_ARM ( VexEndness endness_host,
                                         void* place_to_chain,
+                                        HWord wr_delta,
                                         const void* disp_cp_chain_me_EXPECTED,
                                         const void* place_to_jump_to );
 
 extern VexInvalRange unchainXDirect_ARM ( VexEndness endness_host,
                                           void* place_to_unchain,
+                                          HWord wr_delta,
                                           const void* place_to_jump_to_EXPECTED,
                                           const void* disp_cp_chain_me );
 
@@ -144,11 +144,11 @@ static void lookupIRTemp64 ( HReg* vrHI, HReg* vrLO, ISelEnv* env, IRTemp tmp )
 
 static void addInstr ( ISelEnv* env, ARMInstr* instr )
 {
-   addHInstr(env->code, instr);
    if (vex_traceflags & VEX_TRACE_VCODE) {
       ppARMInstr(instr);
       vex_printf("\n");
    }
+   addHInstr(env->code, instr);
 }
 
 static HReg newVRegI ( ISelEnv* env )
@@ -6360,8 +6360,9 @@ HInstrArray* iselSB_ARM ( const IRSB* bb,
    env = LibVEX_Alloc_inline(sizeof(ISelEnv));
    env->vreg_ctr = 0;
 
-   /* Set up output code array. */
-   env->code = newHInstrArray();
+   /* Set up output code array.  Being load-store, ARM needs about
+      three instructions per statement. */
+   env->code = newHInstrArray(sizeof(ARMInstr), 3 * bb->stmts_used + 8);
     
    /* Copy BB's type env. */
    env->type_env = bb->tyenv;
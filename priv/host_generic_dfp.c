@@ -0,0 +1,1605 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                host_generic_dfp.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Software IEEE754 decimal arithmetic, and the IR pass that makes
+   DFP values and ops visible to it.  See host_generic_dfp.h.
+
+   Values are unpacked into arrays of decimal digits and worked on
+   digit by digit, schoolbook style.  That is slow, but simple enough
+   to be obviously right, and a D128 coefficient times another still
+   fits comfortably on the stack.  Both DFP guests use the DPD
+   encoding, so that is the only one supported.  NaN handling is as
+   for host_generic_f128.c: a signalling NaN operand is returned
+   quietened, otherwise the first quiet NaN operand, and invalid
+   operations produce the positive default NaN.  Conversions to
+   integer saturate, and give the most negative value (signed) or
+   zero (unsigned) for a NaN. */
+
+#include "libvex_basictypes.h"
+#include "libvex_ir.h"
+#include "libvex.h"
+
+#include "main_util.h"
+#include "host_generic_dfp.h"
+
+
+/*---------------------------------------------------------*/
+/*--- Densely packed decimal                            ---*/
+/*---------------------------------------------------------*/
+
+typedef  struct { ULong hi; ULong lo; }  UI128;
+
+static inline UI128 mkU128 ( ULong hi, ULong lo )
+{
+   UI128 r;
+   r.hi = hi;
+   r.lo = lo;
+   return r;
+}
+
+/* Bits [pos+len-1 .. pos] of |x|; len <= 32. */
+static UInt getBits ( UI128 x, UInt pos, UInt len )
+{
+   ULong v;
+   if (pos >= 64)
+      v = x.hi >> (pos - 64);
+   else if (pos + len <= 64)
+      v = x.lo >> pos;
+   else
+      v = (x.lo >> pos) | (x.hi << (64 - pos));
+   return (UInt)(v & ((1ULL << len) - 1));
+}
+
+/* OR |v| into bits [pos+len-1 .. pos] of |x|; len <= 32. */
+static void orBits ( /*MOD*/UI128* x, UInt pos, UInt len, UInt v )
+{
+   ULong vv = v;
+   if (pos >= 64) {
+      x->hi |= vv << (pos - 64);
+   } else {
+      x->lo |= vv << pos;
+      if (pos + len > 64)
+         x->hi |= vv >> (64 - pos);
+   }
+}
+
+/* Decode a 10-bit declet into its three digits, most significant
+   first.  Every one of the 1024 declets decodes to something; the
+   24 non-canonical ones alias canonical ones, as they should. */
+static void declet2digits ( UInt dpd, /*OUT*/UInt* d2, /*OUT*/UInt* d1,
+                            /*OUT*/UInt* d0 )
+{
+   UInt b7 = (dpd >> 7) & 1, b4 = (dpd >> 4) & 1, b0 = dpd & 1;
+   UInt hi3 = (dpd >> 7) & 7, mid3 = (dpd >> 4) & 7;
+   UInt b98 = (dpd >> 8) & 3, b65 = (dpd >> 5) & 3;
+
+   if (((dpd >> 3) & 1) == 0) {
+      *d2 = hi3; *d1 = mid3; *d0 = dpd & 7;
+      return;
+   }
+   switch ((dpd >> 1) & 3) {
+      case 0:  *d2 = hi3;    *d1 = mid3;   *d0 = 8 + b0;          return;
+      case 1:  *d2 = hi3;    *d1 = 8 + b4; *d0 = (b65 << 1) | b0; return;
+      case 2:  *d2 = 8 + b7; *d1 = mid3;   *d0 = (b98 << 1) | b0; return;
+      default: break;
+   }
+   switch (b65) {
+      case 0:  *d2 = 8 + b7; *d1 = 8 + b4; *d0 = (b98 << 1) | b0; return;
+      case 1:  *d2 = 8 + b7; *d1 = (b98 << 1) | b4; *d0 = 8 + b0; return;
+      case 2:  *d2 = hi3;    *d1 = 8 + b4; *d0 = 8 + b0;          return;
+      default: *d2 = 8 + b7; *d1 = 8 + b4; *d0 = 8 + b0;          return;
+   }
+}
+
+/* Encode three digits as a declet.  Digits above 9 (from invalid BCD)
+   are encoded bitwise like 8 or 9, so the result is deterministic if
+   meaningless. */
+static UInt digits2declet ( UInt d2, UInt d1, UInt d0 )
+{
+   UInt big = ((d2 >> 3) << 2) | ((d1 >> 3) << 1) | (d0 >> 3);
+   UInt bcd = d2 & 7, fgh = d1 & 7, jkm = d0 & 7;
+   UInt d = d2 & 1, h = d1 & 1, m = d0 & 1;
+   UInt fg = (d1 >> 1) & 3, jk = (d0 >> 1) & 3;
+
+   switch (big) {
+      case 0:  return (bcd << 7) | (fgh << 4) | jkm;
+      case 1:  return (bcd << 7) | (fgh << 4) | 0x8 | m;
+      case 2:  return (bcd << 7) | (jk << 5) | (h << 4) | 0xA | m;
+      case 4:  return (jk << 8) | (d << 7) | (fgh << 4) | 0xC | m;
+      case 3:  return (bcd << 7) | (2 << 5) | (h << 4) | 0xE | m;
+      case 5:  return (fg << 8) | (d << 7) | (1 << 5) | (h << 4) | 0xE | m;
+      case 6:  return (jk << 8) | (d << 7) | (0 << 5) | (h << 4) | 0xE | m;
+      default: return (d << 7) | (3 << 5) | (h << 4) | 0xE | m;
+   }
+}
+
+
+/*---------------------------------------------------------*/
+/*--- Unpacking, rounding and packing                   ---*/
+/*---------------------------------------------------------*/
+
+/* A finite value is (-1)^sign * coefficient * 10^exp, the
+   coefficient held as n digits d[n-1..0] with no leading zeroes, so
+   zero has n == 0.  Infinities and NaNs keep the digits of their
+   trailing significand field in d[], for the ops that move them
+   around. */
+
+#define DEC_MAXD 112
+
+typedef
+   enum { DC_FINITE, DC_INF, DC_QNAN, DC_SNAN }
+   DClass;
+
+typedef
+   struct {
+      DClass cls;
+      Bool   sign;
+      Int    exp;
+      Int    n;
+      Bool   sticky;   /* nonzero digits lie below d[0] */
+      UChar  d[DEC_MAXD];
+   }
+   Dec;
+
+typedef
+   struct {
+      Int p;          /* coefficient digits */
+      Int bias;
+      Int w;          /* exponent continuation bits */
+      Int nDeclets;
+      Int nBits;
+   }
+   DFmt;
+
+static const DFmt fmtD32  = {  7,  101,  6,  2,  32 };
+static const DFmt fmtD64  = { 16,  398,  8,  5,  64 };
+static const DFmt fmtD128 = { 34, 6176, 12, 11, 128 };
+
+static inline Int qMin ( const DFmt* f )
+{
+   return -f->bias;
+}
+
+static inline Int qMax ( const DFmt* f )
+{
+   return (3 << f->w) - 1 - f->bias;
+}
+
+static inline UInt digitAt ( const Dec* r, Int i )
+{
+   return i < r->n ? r->d[i] : 0;
+}
+
+static void trimLeadingZeroes ( /*MOD*/Dec* r )
+{
+   while (r->n > 0 && r->d[r->n - 1] == 0)
+      r->n--;
+}
+
+static void shiftDigitsLeft ( /*MOD*/Dec* r, Int k )
+{
+   Int i;
+   if (r->n == 0 || k == 0)
+      return;
+   vassert(r->n + k <= DEC_MAXD);
+   for (i = r->n - 1; i >= 0; i--)
+      r->d[i + k] = r->d[i];
+   for (i = 0; i < k; i++)
+      r->d[i] = 0;
+   r->n += k;
+}
+
+/* Truncate; whatever is shifted out is lost. */
+static void shiftDigitsRight ( /*MOD*/Dec* r, Int k )
+{
+   Int i;
+   if (k >= r->n) {
+      r->n = 0;
+      return;
+   }
+   for (i = 0; i + k < r->n; i++)
+      r->d[i] = r->d[i + k];
+   r->n -= k;
+}
+
+static void setFromULong ( /*OUT*/Dec* r, Bool sign, ULong mag )
+{
+   r->cls    = DC_FINITE;
+   r->sign   = sign;
+   r->exp    = 0;
+   r->n      = 0;
+   r->sticky = False;
+   while (mag != 0) {
+      r->d[r->n++] = (UChar)(mag % 10);
+      mag /= 10;
+   }
+}
+
+static void unpack ( UI128 x, const DFmt* f, /*OUT*/Dec* r )
+{
+   UInt G  = getBits(x, f->nBits - 6, 5);
+   UInt ec = getBits(x, f->nBits - 6 - f->w, f->w);
+   UInt lead = 0, expMSB = 0, d2, d1, d0;
+   Int  j;
+
+   r->sign   = toBool(getBits(x, f->nBits - 1, 1));
+   r->sticky = False;
+   r->exp    = 0;
+   for (j = 0; j < f->nDeclets; j++) {
+      declet2digits(getBits(x, 10 * j, 10), &d2, &d1, &d0);
+      r->d[3 * j]     = (UChar)d0;
+      r->d[3 * j + 1] = (UChar)d1;
+      r->d[3 * j + 2] = (UChar)d2;
+   }
+   if ((G >> 3) != 3) {
+      r->cls = DC_FINITE;
+      expMSB = G >> 3;
+      lead   = G & 7;
+   } else if (((G >> 1) & 3) != 3) {
+      r->cls = DC_FINITE;
+      expMSB = (G >> 1) & 3;
+      lead   = 8 + (G & 1);
+   } else if ((G & 1) == 0) {
+      r->cls = DC_INF;
+   } else {
+      r->cls = ((ec >> (f->w - 1)) & 1) ? DC_SNAN : DC_QNAN;
+   }
+   r->d[f->p - 1] = (UChar)lead;
+   r->n = f->p;
+   trimLeadingZeroes(r);
+   if (r->cls == DC_FINITE)
+      r->exp = (Int)((expMSB << f->w) | ec) - f->bias;
+}
+
+/* Pack |r|, which must already fit format |f|. */
+static UI128 pack ( const Dec* r, const DFmt* f )
+{
+   UI128 x = mkU128(0, 0);
+   UInt  G, ec;
+   Int   j;
+
+   for (j = 0; j < f->nDeclets; j++)
+      orBits(&x, 10 * j, 10, digits2declet(digitAt(r, 3 * j + 2),
+                                           digitAt(r, 3 * j + 1),
+                                           digitAt(r, 3 * j)));
+   switch (r->cls) {
+      case DC_FINITE: {
+         UInt be   = (UInt)(r->exp + f->bias);
+         UInt lead = digitAt(r, f->p - 1);
+         vassert(r->n <= f->p);
+         vassert(r->exp >= qMin(f) && r->exp <= qMax(f));
+         if (lead < 8)
+            G = ((be >> f->w) << 3) | lead;
+         else
+            G = 0x18 | ((be >> f->w) << 1) | (lead & 1);
+         ec = be & ((1 << f->w) - 1);
+         break;
+      }
+      case DC_INF:
+         G = 0x1E; ec = 0;
+         break;
+      case DC_QNAN:
+         G = 0x1F; ec = 0;
+         break;
+      default:
+         G = 0x1F; ec = 1 << (f->w - 1);
+         break;
+   }
+   vassert(r->cls == DC_FINITE || digitAt(r, f->p - 1) == 0);
+   orBits(&x, f->nBits - 6, 5, G);
+   orBits(&x, f->nBits - 6 - f->w, f->w, ec);
+   if (r->sign)
+      orBits(&x, f->nBits - 1, 1, 1);
+   return x;
+}
+
+static UI128 packSpecial ( Bool sign, DClass cls, const DFmt* f )
+{
+   Dec r;
+   r.cls  = cls;
+   r.sign = sign;
+   r.n    = 0;
+   return pack(&r, f);
+}
+
+static UI128 defaultNaN ( const DFmt* f )
+{
+   return packSpecial(False, DC_QNAN, f);
+}
+
+/* |r| quietened, keeping as much of the payload as fits in |f|. */
+static UI128 packNaN ( const Dec* a, const DFmt* f )
+{
+   Dec r = *a;
+   r.cls = DC_QNAN;
+   if (r.n > f->p - 1)
+      r.n = f->p - 1;
+   trimLeadingZeroes(&r);
+   return pack(&r, f);
+}
+
+/* Where the discarded digits lie relative to half an ulp. */
+typedef
+   enum { RD_EXACT, RD_BELOW_HALF, RD_HALF, RD_ABOVE_HALF }
+   RoundDigits;
+
+/* Whether a result with the given discarded digits and last digit
+   |lsd| should be rounded up in magnitude.  Irrm_PREPARE_SHORTER is
+   the decimal flavour, round-05-up: the last digit is only bumped if
+   that keeps it from ending in 0 or 5. */
+static Bool roundUp ( UInt rm, Bool sign, UInt lsd, RoundDigits rd )
+{
+   switch (rm) {
+      case Irrm_NEAREST:
+         return rd == RD_ABOVE_HALF || (rd == RD_HALF && (lsd & 1));
+      case Irrm_NegINF:
+         return rd != RD_EXACT && sign;
+      case Irrm_PosINF:
+         return rd != RD_EXACT && !sign;
+      case Irrm_ZERO:
+         return False;
+      case Irrm_NEAREST_TIE_AWAY_0:
+         return rd >= RD_HALF;
+      case Irrm_PREPARE_SHORTER:
+         return rd != RD_EXACT && (lsd == 0 || lsd == 5);
+      case Irrm_AWAY_FROM_ZERO:
+         return rd != RD_EXACT;
+      case Irrm_NEAREST_TIE_TOWARD_0:
+         return rd == RD_ABOVE_HALF;
+      default:
+         vpanic("host_generic_dfp: invalid rounding mode");
+   }
+}
+
+/* Drop the |drop| least significant digits of finite |r| (and its
+   sticky digits), rounding per |rm|.  The coefficient may grow by a
+   digit through a carry.  Returns True if anything nonzero was
+   discarded. */
+static Bool roundOff ( /*MOD*/Dec* r, Int drop, UInt rm )
+{
+   RoundDigits rd;
+   UInt first;
+   Bool rest = r->sticky;
+   Int  i;
+
+   if (drop <= 0 && !r->sticky)
+      return False;
+   if (drop < 0)
+      drop = 0;
+   first = drop >= 1 ? digitAt(r, drop - 1) : 0;
+   for (i = 0; i < drop - 1 && i < r->n && !rest; i++)
+      if (r->d[i] != 0)
+         rest = True;
+   if (first == 0 && !rest)
+      rd = RD_EXACT;
+   else if (first < 5)
+      rd = RD_BELOW_HALF;
+   else if (first == 5 && !rest)
+      rd = RD_HALF;
+   else
+      rd = RD_ABOVE_HALF;
+
+   shiftDigitsRight(r, drop);
+   r->exp   += drop;
+   r->sticky = False;
+   if (roundUp(rm, r->sign, digitAt(r, 0), rd)) {
+      for (i = 0; i < r->n && r->d[i] == 9; i++)
+         r->d[i] = 0;
+      if (i == r->n)
+         r->d[r->n++] = 1;
+      else
+         r->d[i]++;
+   }
+   return rd != RD_EXACT;
+}
+
+/* Round the finite value |r| to format |f| and pack it.  Results
+   too small for the format become subnormal, and exponents too large
+   are brought into range by padding the coefficient with zeroes if
+   it has room, else overflow. */
+static UI128 roundPack ( /*MOD*/Dec* r, UInt rm, const DFmt* f )
+{
+   Int  drop;
+   Bool inexact;
+
+   trimLeadingZeroes(r);
+   drop = r->n - f->p;
+   if (qMin(f) - r->exp > drop)
+      drop = qMin(f) - r->exp;
+   inexact = roundOff(r, drop, rm);
+   if (r->n > f->p) {
+      /* The carry made it all zeroes but one. */
+      shiftDigitsRight(r, 1);
+      r->exp++;
+   }
+
+   if (r->n == 0) {
+      if (r->exp > qMax(f)) r->exp = qMax(f);
+      if (r->exp < qMin(f)) r->exp = qMin(f);
+      return pack(r, f);
+   }
+   if (r->exp > qMax(f)) {
+      Int pad = r->exp - qMax(f);
+      if (!inexact && r->n + pad <= f->p) {
+         shiftDigitsLeft(r, pad);
+         r->exp = qMax(f);
+         return pack(r, f);
+      }
+      switch (rm) {
+         case Irrm_ZERO:
+         case Irrm_PREPARE_SHORTER:
+            break;
+         case Irrm_NegINF:
+            if (r->sign) return packSpecial(True, DC_INF, f);
+            break;
+         case Irrm_PosINF:
+            if (!r->sign) return packSpecial(False, DC_INF, f);
+            break;
+         default:
+            return packSpecial(r->sign, DC_INF, f);
+      }
+      /* The largest finite number: all nines. */
+      for (r->n = 0; r->n < f->p; r->n++)
+         r->d[r->n] = 9;
+      r->exp = qMax(f);
+   }
+   return pack(r, f);
+}
+
+
+/*---------------------------------------------------------*/
+/*--- Digit string arithmetic                           ---*/
+/*---------------------------------------------------------*/
+
+/* Compare magnitudes of the digit strings a[an-1..0], b[bn-1..0],
+   neither with leading zeroes. */
+static Int cmpDigits ( const UChar* a, Int an, const UChar* b, Int bn )
+{
+   Int i;
+   if (an != bn)
+      return an < bn ? -1 : 1;
+   for (i = an - 1; i >= 0; i--)
+      if (a[i] != b[i])
+         return a[i] < b[i] ? -1 : 1;
+   return 0;
+}
+
+/* r = a + b; r may alias a.  Returns the length of r. */
+static Int addDigits ( UChar* r, const UChar* a, Int an,
+                       const UChar* b, Int bn )
+{
+   Int i, n = an > bn ? an : bn;
+   UInt carry = 0;
+   for (i = 0; i < n; i++) {
+      UInt s = (i < an ? a[i] : 0) + (i < bn ? b[i] : 0) + carry;
+      carry = s >= 10;
+      r[i]  = (UChar)(carry ? s - 10 : s);
+   }
+   if (carry)
+      r[n++] = 1;
+   vassert(n <= DEC_MAXD);
+   return n;
+}
+
+/* r = a - b, where a >= b; r may alias a.  Returns the length of r. */
+static Int subDigits ( UChar* r, const UChar* a, Int an,
+                       const UChar* b, Int bn )
+{
+   Int i;
+   Int borrow = 0;
+   for (i = 0; i < an; i++) {
+      Int s = (Int)a[i] - (i < bn ? b[i] : 0) - borrow;
+      borrow = s < 0;
+      r[i]   = (UChar)(borrow ? s + 10 : s);
+   }
+   vassert(borrow == 0);
+   while (an > 0 && r[an - 1] == 0)
+      an--;
+   return an;
+}
+
+
+/*---------------------------------------------------------*/
+/*--- The operations                                    ---*/
+/*---------------------------------------------------------*/
+
+static inline Bool isNaN ( const Dec* a )
+{
+   return a->cls == DC_QNAN || a->cls == DC_SNAN;
+}
+
+/* NaN result for a binary op with at least one NaN operand. */
+static UI128 propagateNaN ( const Dec* a, const Dec* b, const DFmt* f )
+{
+   if (a->cls == DC_SNAN)   return packNaN(a, f);
+   if (b->cls == DC_SNAN)   return packNaN(b, f);
+   if (a->cls == DC_QNAN)   return packNaN(a, f);
+   return packNaN(b, f);
+}
+
+static UI128 dfp_add ( UI128 aBits, UI128 bBits, UInt rm, Bool isSub,
+                       const DFmt* f )
+{
+   Dec a, b, r;
+   Int dexp, i;
+
+   unpack(aBits, f, &a);
+   unpack(bBits, f, &b);
+   if (isNaN(&a) || isNaN(&b))
+      return propagateNaN(&a, &b, f);
+   b.sign ^= isSub;
+   if (a.cls == DC_INF || b.cls == DC_INF) {
+      if (a.cls == DC_INF && b.cls == DC_INF && a.sign != b.sign)
+         return defaultNaN(f);
+      return packSpecial(a.cls == DC_INF ? a.sign : b.sign, DC_INF, f);
+   }
+
+   if (a.exp < b.exp) {
+      r = a; a = b; b = r;
+   }
+   dexp = a.exp - b.exp;
+   if (a.n == 0 && b.n == 0) {
+      /* The ideal exponent of an exact zero is the smaller one. */
+      r = b;
+      r.sign = a.sign == b.sign ? a.sign : toBool(rm == Irrm_NegINF);
+      return roundPack(&r, rm, f);
+   }
+   if (b.n == 0) {
+      /* Get as close to b's exponent as a's digits allow. */
+      Int k = f->p - a.n < dexp ? f->p - a.n : dexp;
+      shiftDigitsLeft(&a, k);
+      a.exp -= k;
+      return roundPack(&a, rm, f);
+   }
+   if (a.n == 0)
+      return roundPack(&b, rm, f);
+
+   if (dexp > 2 * f->p + 3) {
+      /* b is too small to do more than nudge the rounding; stand it
+         in with a single digit below everything a can round to. */
+      shiftDigitsLeft(&a, f->p + 3);
+      a.exp -= f->p + 3;
+      b.n    = 1;
+      b.d[0] = 1;
+      b.exp  = a.exp;
+   } else {
+      shiftDigitsLeft(&a, dexp);
+      a.exp = b.exp;
+   }
+
+   r = a;
+   if (a.sign == b.sign) {
+      r.n = addDigits(r.d, a.d, a.n, b.d, b.n);
+   } else {
+      i = cmpDigits(a.d, a.n, b.d, b.n);
+      if (i == 0) {
+         r.n    = 0;
+         r.sign = toBool(rm == Irrm_NegINF);
+      } else if (i > 0) {
+         r.n = subDigits(r.d, a.d, a.n, b.d, b.n);
+      } else {
+         r.n    = subDigits(r.d, b.d, b.n, a.d, a.n);
+         r.sign = b.sign;
+      }
+   }
+   return roundPack(&r, rm, f);
+}
+
+static UI128 dfp_mul ( UI128 aBits, UI128 bBits, UInt rm, const DFmt* f )
+{
+   Dec  a, b, r;
+   UInt acc[DEC_MAXD];
+   Int  i, j;
+
+   unpack(aBits, f, &a);
+   unpack(bBits, f, &b);
+   if (isNaN(&a) || isNaN(&b))
+      return propagateNaN(&a, &b, f);
+   if (a.cls == DC_INF || b.cls == DC_INF) {
+      if ((a.cls == DC_FINITE && a.n == 0) || (b.cls == DC_FINITE && b.n == 0))
+         return defaultNaN(f);
+      return packSpecial(toBool(a.sign ^ b.sign), DC_INF, f);
+   }
+
+   r.cls    = DC_FINITE;
+   r.sign   = toBool(a.sign ^ b.sign);
+   r.exp    = a.exp + b.exp;
+   r.sticky = False;
+   r.n      = a.n + b.n;
+   for (i = 0; i < r.n; i++)
+      acc[i] = 0;
+   for (i = 0; i < a.n; i++)
+      for (j = 0; j < b.n; j++)
+         acc[i + j] += a.d[i] * b.d[j];
+   for (i = 0; i < r.n; i++) {
+      if (i + 1 < r.n)
+         acc[i + 1] += acc[i] / 10;
+      r.d[i] = (UChar)(acc[i] % 10);
+   }
+   return roundPack(&r, rm, f);
+}
+
+static UI128 dfp_div ( UI128 aBits, UI128 bBits, UInt rm, const DFmt* f )
+{
+   Dec   a, b, q;
+   UChar rem[DEC_MAXD];
+   Int   remN = 0, s, i, k, ideal;
+
+   unpack(aBits, f, &a);
+   unpack(bBits, f, &b);
+   if (isNaN(&a) || isNaN(&b))
+      return propagateNaN(&a, &b, f);
+
+   q.cls    = DC_FINITE;
+   q.sign   = toBool(a.sign ^ b.sign);
+   q.sticky = False;
+   q.n      = 0;
+   ideal    = a.exp - b.exp;
+   if (a.cls == DC_INF)
+      return b.cls == DC_INF ? defaultNaN(f)
+                             : packSpecial(q.sign, DC_INF, f);
+   if (b.cls == DC_INF) {
+      q.exp = qMin(f);
+      return pack(&q, f);
+   }
+   if (b.n == 0)
+      return a.n == 0 ? defaultNaN(f) : packSpecial(q.sign, DC_INF, f);
+   if (a.n == 0) {
+      q.exp = ideal;
+      return roundPack(&q, rm, f);
+   }
+
+   /* Scale a so the quotient has at least p+1 digits, then long
+      divide. */
+   s = f->p + b.n - a.n + 1;
+   shiftDigitsLeft(&a, s);
+   q.exp = ideal - s;
+   q.n   = a.n;
+   for (i = a.n - 1; i >= 0; i--) {
+      UInt qd = 0;
+      if (remN > 0 || a.d[i] != 0) {
+         for (k = remN; k > 0; k--)
+            rem[k] = rem[k - 1];
+         rem[0] = a.d[i];
+         remN++;
+      }
+      while (cmpDigits(rem, remN, b.d, b.n) >= 0) {
+         remN = subDigits(rem, rem, remN, b.d, b.n);
+         qd++;
+      }
+      q.d[i] = (UChar)qd;
+   }
+   trimLeadingZeroes(&q);
+   if (remN != 0) {
+      q.sticky = True;
+   } else {
+      /* Exact: strip trailing zeroes back towards the ideal
+         exponent. */
+      k = 0;
+      while (q.exp + k < ideal && k < q.n && q.d[k] == 0)
+         k++;
+      shiftDigitsRight(&q, k);
+      q.exp += k;
+   }
+   return roundPack(&q, rm, f);
+}
+
+/* |bBits| rounded to the exponent of |aBits|. */
+static UI128 dfp_quantize ( UI128 aBits, UI128 bBits, UInt rm,
+                            const DFmt* f )
+{
+   Dec a, b;
+
+   unpack(aBits, f, &a);
+   unpack(bBits, f, &b);
+   if (isNaN(&a) || isNaN(&b))
+      return propagateNaN(&b, &a, f);
+   if (a.cls == DC_INF || b.cls == DC_INF) {
+      if (a.cls == DC_INF && b.cls == DC_INF)
+         return packSpecial(b.sign, DC_INF, f);
+      return defaultNaN(f);
+   }
+   if (b.exp >= a.exp) {
+      if (b.n > 0 && b.n + (b.exp - a.exp) > f->p)
+         return defaultNaN(f);
+      shiftDigitsLeft(&b, b.exp - a.exp);
+   } else {
+      roundOff(&b, a.exp - b.exp, rm);
+   }
+   b.exp = a.exp;
+   if (b.n > f->p)
+      return defaultNaN(f);
+   return pack(&b, f);
+}
+
+/* Round |aBits| to |ref| significant digits; 0 means leave it. */
+static UI128 dfp_significanceRound ( UI128 aBits, UInt ref, UInt rm,
+                                     const DFmt* f )
+{
+   Dec a;
+
+   unpack(aBits, f, &a);
+   if (isNaN(&a))
+      return packNaN(&a, f);
+   if (a.cls == DC_INF || ref == 0 || a.n <= (Int)ref)
+      return pack(&a, f);
+   roundOff(&a, a.n - ref, rm);
+   if (a.n > (Int)ref) {
+      shiftDigitsRight(&a, 1);
+      a.exp++;
+   }
+   return roundPack(&a, rm, f);
+}
+
+static UI128 dfp_roundToInt ( UI128 aBits, UInt rm, const DFmt* f )
+{
+   Dec a;
+
+   unpack(aBits, f, &a);
+   if (isNaN(&a))
+      return packNaN(&a, f);
+   if (a.cls == DC_FINITE && a.exp < 0) {
+      roundOff(&a, -a.exp, rm);
+      vassert(a.exp == 0);
+   }
+   return pack(&a, f);
+}
+
+/* Shift the coefficient, or the trailing significand of an infinity
+   or NaN, by |k| digits. */
+static UI128 dfp_shift ( UI128 aBits, UInt k, Bool left, const DFmt* f )
+{
+   Dec a;
+   Int room;
+
+   unpack(aBits, f, &a);
+   room = a.cls == DC_FINITE ? f->p : f->p - 1;
+   if (left) {
+      if ((Int)k >= room) {
+         a.n = 0;
+      } else {
+         shiftDigitsLeft(&a, k);
+         if (a.n > room)
+            a.n = room;
+         trimLeadingZeroes(&a);
+      }
+   } else {
+      shiftDigitsRight(&a, k);
+   }
+   return pack(&a, f);
+}
+
+static ULong dfp_extractExp ( UI128 aBits, const DFmt* f )
+{
+   Dec a;
+   unpack(aBits, f, &a);
+   switch (a.cls) {
+      case DC_INF:  return -1ULL;
+      case DC_QNAN: return -2ULL;
+      case DC_SNAN: return -3ULL;
+      default:      return (ULong)(Long)(a.exp + f->bias);
+   }
+}
+
+static ULong dfp_extractSig ( UI128 aBits, const DFmt* f )
+{
+   Dec a;
+   unpack(aBits, f, &a);
+   switch (a.cls) {
+      case DC_INF:  return -1ULL;
+      case DC_QNAN: return -2ULL;
+      case DC_SNAN: return -3ULL;
+      default:      return a.n;
+   }
+}
+
+/* |aBits| with its biased exponent replaced by |be|.  The special
+   values -1, -2 and -3 (and anything less) make an infinity, quiet
+   NaN and signalling NaN, and out of range exponents a quiet NaN;
+   those keep only a's trailing significand. */
+static UI128 dfp_insertExp ( UI128 aBits, Long be, const DFmt* f )
+{
+   Dec a;
+
+   unpack(aBits, f, &a);
+   if (be >= 0 && be <= qMax(f) + f->bias) {
+      a.cls = DC_FINITE;
+      a.exp = (Int)be - f->bias;
+      return pack(&a, f);
+   }
+   if (a.n > f->p - 1) {
+      a.n = f->p - 1;
+      trimLeadingZeroes(&a);
+   }
+   a.cls = be == -1 ? DC_INF : be <= -3 ? DC_SNAN : DC_QNAN;
+   return pack(&a, f);
+}
+
+/* Rank a value for comparison: -1 if less than b, etc.  Neither is
+   a NaN. */
+static Int cmpDec ( const Dec* a, const Dec* b )
+{
+   Bool aZero = a->cls == DC_FINITE && a->n == 0;
+   Bool bZero = b->cls == DC_FINITE && b->n == 0;
+   Int  mag;
+
+   if (aZero && bZero)
+      return 0;
+   if (aZero)
+      return b->sign ? 1 : -1;
+   if (bZero)
+      return a->sign ? -1 : 1;
+   if (a->sign != b->sign)
+      return a->sign ? -1 : 1;
+
+   if (a->cls == DC_INF || b->cls == DC_INF) {
+      mag = (a->cls == DC_INF) - (b->cls == DC_INF);
+   } else if (a->n + a->exp != b->n + b->exp) {
+      mag = a->n + a->exp < b->n + b->exp ? -1 : 1;
+   } else {
+      /* Same magnitude order; line the digits up. */
+      Dec x = *a, y = *b;
+      if (x.exp > y.exp)
+         shiftDigitsLeft(&x, x.exp - y.exp);
+      else
+         shiftDigitsLeft(&y, y.exp - x.exp);
+      mag = cmpDigits(x.d, x.n, y.d, y.n);
+   }
+   return a->sign ? -mag : mag;
+}
+
+static ULong dfp_cmp ( UI128 aBits, UI128 bBits, const DFmt* f )
+{
+   Dec a, b;
+   Int c;
+
+   unpack(aBits, f, &a);
+   unpack(bBits, f, &b);
+   if (isNaN(&a) || isNaN(&b))
+      return Ircr_UN;
+   c = cmpDec(&a, &b);
+   return c < 0 ? Ircr_LT : c > 0 ? Ircr_GT : Ircr_EQ;
+}
+
+/* Compare biased exponents.  Two infinities, two quiet NaNs or two
+   signalling NaNs count as equal; anything else involving a special
+   value is unordered. */
+static ULong dfp_cmpExp ( UI128 aBits, UI128 bBits, const DFmt* f )
+{
+   Dec a, b;
+
+   unpack(aBits, f, &a);
+   unpack(bBits, f, &b);
+   if (a.cls != DC_FINITE || b.cls != DC_FINITE)
+      return a.cls == b.cls ? Ircr_EQ : Ircr_UN;
+   return a.exp < b.exp ? Ircr_LT : a.exp > b.exp ? Ircr_GT : Ircr_EQ;
+}
+
+/* Convert between decimal formats.  Widening is always exact. */
+static UI128 convertD ( UI128 aBits, UInt rm, const DFmt* from,
+                        const DFmt* to )
+{
+   Dec a;
+   unpack(aBits, from, &a);
+   switch (a.cls) {
+      case DC_QNAN:
+      case DC_SNAN: return packNaN(&a, to);
+      case DC_INF:  return packSpecial(a.sign, DC_INF, to);
+      default:      return roundPack(&a, rm, to);
+   }
+}
+
+static UI128 int_to_dfp ( ULong x, Bool isSigned, UInt rm, const DFmt* f )
+{
+   Dec  r;
+   Bool neg = isSigned && (Long)x < 0;
+   setFromULong(&r, neg, neg ? -x : x);
+   return roundPack(&r, rm, f);
+}
+
+static ULong dfp_to_int ( UI128 aBits, UInt rm, Bool isSigned, Int szB,
+                          const DFmt* f )
+{
+   Dec   a;
+   Int   bits   = 8 * szB, i;
+   ULong maxPos = isSigned ? (1ULL << (bits - 1)) - 1
+                           : (bits == 64 ? ~0ULL : (1ULL << bits) - 1);
+   ULong minNeg = isSigned ? -(1ULL << (bits - 1)) : 0;
+   ULong mag    = 0;
+   Bool  huge   = False;
+
+   unpack(aBits, f, &a);
+   switch (a.cls) {
+      case DC_QNAN:
+      case DC_SNAN: return minNeg;
+      case DC_INF:  return a.sign ? minNeg : maxPos;
+      default:      break;
+   }
+   if (a.exp < 0)
+      roundOff(&a, -a.exp, rm);
+   if (a.n == 0) {
+      mag = 0;
+   } else if (a.n + a.exp > 20) {
+      huge = True;
+   } else {
+      shiftDigitsLeft(&a, a.exp);
+      for (i = a.n - 1; i >= 0 && !huge; i--) {
+         if (mag > (~0ULL - a.d[i]) / 10)
+            huge = True;
+         mag = mag * 10 + a.d[i];
+      }
+   }
+   if (a.sign && (huge || mag != 0)) {
+      if (huge || mag > -minNeg)
+         return minNeg;
+      return -mag;
+   }
+   if (huge || mag > maxPos)
+      return maxPos;
+   return mag;
+}
+
+/* 50 bits of declets <-> 60 bits of BCD. */
+static ULong dpb_to_bcd ( ULong x )
+{
+   ULong r = 0;
+   UInt  j, d2, d1, d0;
+   for (j = 0; j < 5; j++) {
+      declet2digits((x >> (10 * j)) & 0x3FF, &d2, &d1, &d0);
+      r |= (ULong)((d2 << 8) | (d1 << 4) | d0) << (12 * j);
+   }
+   return r;
+}
+
+static ULong bcd_to_dpb ( ULong x )
+{
+   ULong r = 0;
+   UInt  j, v;
+   for (j = 0; j < 5; j++) {
+      v  = (x >> (12 * j)) & 0xFFF;
+      r |= (ULong)digits2declet(v >> 8, (v >> 4) & 0xF, v & 0xF)
+           << (10 * j);
+   }
+   return r;
+}
+
+ULong h_generic_calc_DFP ( ULong opAndHalf, ULong rm,
+                           ULong aHi, ULong aLo, ULong bHi, ULong bLo )
+{
+   IROp  op = (IROp)(opAndHalf >> 1);
+   UI128 a  = mkU128(aHi, aLo);
+   UI128 b  = mkU128(bHi, bLo);
+   UI128 r;
+
+   switch (op) {
+      case Iop_AddD64:  r = dfp_add(a, b, rm, False, &fmtD64);  break;
+      case Iop_SubD64:  r = dfp_add(a, b, rm, True,  &fmtD64);  break;
+      case Iop_MulD64:  r = dfp_mul(a, b, rm, &fmtD64);         break;
+      case Iop_DivD64:  r = dfp_div(a, b, rm, &fmtD64);         break;
+      case Iop_AddD128: r = dfp_add(a, b, rm, False, &fmtD128); break;
+      case Iop_SubD128: r = dfp_add(a, b, rm, True,  &fmtD128); break;
+      case Iop_MulD128: r = dfp_mul(a, b, rm, &fmtD128);        break;
+      case Iop_DivD128: r = dfp_div(a, b, rm, &fmtD128);        break;
+
+      case Iop_QuantizeD64:  r = dfp_quantize(a, b, rm, &fmtD64);  break;
+      case Iop_QuantizeD128: r = dfp_quantize(a, b, rm, &fmtD128); break;
+      case Iop_SignificanceRoundD64:
+         r = dfp_significanceRound(a, bLo & 0x3F, rm, &fmtD64);
+         break;
+      case Iop_SignificanceRoundD128:
+         r = dfp_significanceRound(a, bLo & 0x3F, rm, &fmtD128);
+         break;
+      case Iop_RoundD64toInt:  r = dfp_roundToInt(a, rm, &fmtD64);  break;
+      case Iop_RoundD128toInt: r = dfp_roundToInt(a, rm, &fmtD128); break;
+
+      case Iop_ShlD64:  r = dfp_shift(a, bLo & 0xFF, True,  &fmtD64);  break;
+      case Iop_ShrD64:  r = dfp_shift(a, bLo & 0xFF, False, &fmtD64);  break;
+      case Iop_ShlD128: r = dfp_shift(a, bLo & 0xFF, True,  &fmtD128); break;
+      case Iop_ShrD128: r = dfp_shift(a, bLo & 0xFF, False, &fmtD128); break;
+
+      case Iop_InsertExpD64:
+         r = dfp_insertExp(a, (Long)bLo, &fmtD64);
+         break;
+      case Iop_InsertExpD128:
+         r = dfp_insertExp(a, (Long)bLo, &fmtD128);
+         break;
+
+      case Iop_D32toD64:  r = convertD(a, Irrm_ZERO, &fmtD32, &fmtD64);  break;
+      case Iop_D64toD128: r = convertD(a, Irrm_ZERO, &fmtD64, &fmtD128); break;
+      case Iop_D64toD32:  r = convertD(a, rm, &fmtD64, &fmtD32);         break;
+      case Iop_D128toD64: r = convertD(a, rm, &fmtD128, &fmtD64);        break;
+
+      /* The 32-bit integer sources arrive widened to 64 bits. */
+      case Iop_I32StoD64:
+      case Iop_I64StoD64:  r = int_to_dfp(bLo, True,  rm, &fmtD64);  break;
+      case Iop_I32UtoD64:
+      case Iop_I64UtoD64:  r = int_to_dfp(bLo, False, rm, &fmtD64);  break;
+      case Iop_I32StoD128:
+      case Iop_I64StoD128: r = int_to_dfp(bLo, True,  rm, &fmtD128); break;
+      case Iop_I32UtoD128:
+      case Iop_I64UtoD128: r = int_to_dfp(bLo, False, rm, &fmtD128); break;
+
+      case Iop_D64toI32S:  return dfp_to_int(a, rm, True,  4, &fmtD64);
+      case Iop_D64toI32U:  return dfp_to_int(a, rm, False, 4, &fmtD64);
+      case Iop_D64toI64S:  return dfp_to_int(a, rm, True,  8, &fmtD64);
+      case Iop_D64toI64U:  return dfp_to_int(a, rm, False, 8, &fmtD64);
+      case Iop_D128toI32S: return dfp_to_int(a, rm, True,  4, &fmtD128);
+      case Iop_D128toI32U: return dfp_to_int(a, rm, False, 4, &fmtD128);
+      case Iop_D128toI64S: return dfp_to_int(a, rm, True,  8, &fmtD128);
+      case Iop_D128toI64U: return dfp_to_int(a, rm, False, 8, &fmtD128);
+
+      case Iop_ExtractExpD64:  return dfp_extractExp(a, &fmtD64);
+      case Iop_ExtractExpD128: return dfp_extractExp(a, &fmtD128);
+      case Iop_ExtractSigD64:  return dfp_extractSig(a, &fmtD64);
+      case Iop_ExtractSigD128: return dfp_extractSig(a, &fmtD128);
+      case Iop_CmpD64:         return dfp_cmp(a, b, &fmtD64);
+      case Iop_CmpD128:        return dfp_cmp(a, b, &fmtD128);
+      case Iop_CmpExpD64:      return dfp_cmpExp(a, b, &fmtD64);
+      case Iop_CmpExpD128:     return dfp_cmpExp(a, b, &fmtD128);
+
+      case Iop_DPBtoBCD:       return dpb_to_bcd(aLo);
+      case Iop_BCDtoDPB:       return bcd_to_dpb(aLo);
+
+      default:
+         vpanic("h_generic_calc_DFP: unhandled op");
+   }
+   return (opAndHalf & 1) ? r.hi : r.lo;
+}
+
+
+/*---------------------------------------------------------*/
+/*--- Lowering DFP values in IR                         ---*/
+/*---------------------------------------------------------*/
+
+/* D32 and D64 temps are simply retyped to I32 and I64.  Each D128
+   temp t is retyped to I64 and carries the high half of the value;
+   lo[t] is a new I64 temp carrying the low half.  The input is flat,
+   so every DFP operand is an RdTmp, and the output is kept flat by
+   binding each new intermediate to a temp. */
+
+typedef
+   struct {
+      IRSB*   out;
+      IRTemp* lo;
+      IRType* origTy;   /* type of each original temp */
+   }
+   LowerEnv;
+
+static IRExpr* mkU64 ( ULong n )
+{
+   return IRExpr_Const(IRConst_U64(n));
+}
+
+static IRTemp bind ( LowerEnv* env, IRType ty, IRExpr* e )
+{
+   IRTemp t = newIRTemp(env->out->tyenv, ty);
+   addStmtToIRSB(env->out, IRStmt_WrTmp(t, e));
+   return t;
+}
+
+static IRType origTypeOf ( const LowerEnv* env, const IRExpr* e )
+{
+   return e->tag == Iex_RdTmp ? env->origTy[e->Iex.RdTmp.tmp]
+                              : Ity_INVALID;
+}
+
+static Bool isDFPType ( IRType ty )
+{
+   return ty == Ity_D32 || ty == Ity_D64 || ty == Ity_D128;
+}
+
+static Bool isDFPAtom ( const LowerEnv* env, const IRExpr* e )
+{
+   return isDFPType(origTypeOf(env, e));
+}
+
+static IRExpr* hiOf ( const LowerEnv* env, IRExpr* e )
+{
+   vassert(origTypeOf(env, e) == Ity_D128);
+   return IRExpr_RdTmp(e->Iex.RdTmp.tmp);
+}
+
+static IRExpr* loOf ( const LowerEnv* env, IRExpr* e )
+{
+   vassert(origTypeOf(env, e) == Ity_D128);
+   return IRExpr_RdTmp(env->lo[e->Iex.RdTmp.tmp]);
+}
+
+/* The (hi,lo) helper arguments for the DFP atom |e|, or zeroes if it
+   is NULL. */
+static void dfpArgs ( LowerEnv* env, IRExpr* e,
+                      /*OUT*/IRExpr** hi, /*OUT*/IRExpr** lo )
+{
+   *hi = mkU64(0);
+   *lo = mkU64(0);
+   if (!e)
+      return;
+   switch (origTypeOf(env, e)) {
+      case Ity_D128:
+         *hi = hiOf(env, e);
+         *lo = loOf(env, e);
+         return;
+      case Ity_D64:
+         *lo = e;
+         return;
+      case Ity_D32:
+         *lo = IRExpr_RdTmp(bind(env, Ity_I64, IRExpr_Unop(Iop_32Uto64, e)));
+         return;
+      default:
+         vpanic("do_DFP_lowering_BB: not a DFP operand");
+   }
+}
+
+/* |a| and |b| are DFP atoms or NULL; |int64| is an I64 operand to go
+   in bLo, or NULL. */
+static IRExpr* mkCall ( LowerEnv* env, IROp op, Bool hiHalf,
+                        IRExpr* rm64, IRExpr* a, IRExpr* b,
+                        IRExpr* int64 )
+{
+   IRExpr *aHi, *aLo, *bHi, *bLo;
+   IRExpr** args;
+
+   dfpArgs(env, a, &aHi, &aLo);
+   dfpArgs(env, b, &bHi, &bLo);
+   if (int64) {
+      vassert(!b);
+      bLo = int64;
+   }
+   args = mkIRExprVec_6(mkU64(((ULong)op << 1) | (hiHalf ? 1 : 0)),
+                        rm64 ? rm64 : mkU64(0), aHi, aLo, bHi, bLo);
+   return mkIRExprCCall(Ity_I64, 0/*regparms*/, "h_generic_calc_DFP",
+                        &h_generic_calc_DFP, args);
+}
+
+static IRExpr* widenTo64 ( LowerEnv* env, IROp widen, IRExpr* e )
+{
+   return IRExpr_RdTmp(bind(env, Ity_I64, IRExpr_Unop(widen, e)));
+}
+
+/* Address |off| bytes beyond the atom |addr|. */
+static IRExpr* addrPlus ( LowerEnv* env, IRExpr* addr, Int off )
+{
+   IRType ty = typeOfIRExpr(env->out->tyenv, addr);
+   if (off == 0)
+      return addr;
+   if (ty == Ity_I64)
+      return IRExpr_RdTmp(bind(env, ty, IRExpr_Binop(Iop_Add64, addr,
+                                                     mkU64(off))));
+   vassert(ty == Ity_I32);
+   return IRExpr_RdTmp(bind(env, ty, IRExpr_Binop(Iop_Add32, addr,
+                              IRExpr_Const(IRConst_U32(off)))));
+}
+
+/* Compute the value of the DFP-typed expression |e|, of type |ty|:
+   the whole of it in *lo for D32 and D64, or both halves of a
+   D128. */
+static void lowerDFPExpr ( LowerEnv* env, IRExpr* e, IRType ty,
+                           VexEndness end,
+                           /*OUT*/IRExpr** hi, /*OUT*/IRExpr** lo )
+{
+   Bool    wide  = ty == Ity_D128;
+   IRType  ity   = ty == Ity_D32 ? Ity_I32 : Ity_I64;
+   Int     offHi = end == VexEndnessLE ? 8 : 0;
+   Int     offLo = 8 - offHi;
+   IRExpr* rm64  = NULL;
+   IRExpr* a     = NULL;
+   IRExpr* b     = NULL;
+   IRExpr* int64 = NULL;
+   IROp    op;
+
+   *hi = NULL;
+   switch (e->tag) {
+      case Iex_RdTmp:
+         if (wide) {
+            *hi = hiOf(env, e);
+            *lo = loOf(env, e);
+         } else {
+            *lo = e;
+         }
+         return;
+      case Iex_Get:
+         if (wide) {
+            *hi = IRExpr_Get(e->Iex.Get.offset + offHi, Ity_I64);
+            *lo = IRExpr_Get(e->Iex.Get.offset + offLo, Ity_I64);
+         } else {
+            *lo = IRExpr_Get(e->Iex.Get.offset, ity);
+         }
+         return;
+      case Iex_GetI: {
+         IRRegArray* descr = e->Iex.GetI.descr;
+         if (wide)
+            goto unhandled;
+         *lo = IRExpr_GetI(mkIRRegArray(descr->base, ity, descr->nElems),
+                           e->Iex.GetI.ix, e->Iex.GetI.bias);
+         return;
+      }
+      case Iex_Load: {
+         IRExpr* addr = e->Iex.Load.addr;
+         if (wide) {
+            offHi = e->Iex.Load.end == Iend_LE ? 8 : 0;
+            offLo = 8 - offHi;
+            *hi = IRExpr_Load(e->Iex.Load.end, Ity_I64,
+                              addrPlus(env, addr, offHi));
+            *lo = IRExpr_Load(e->Iex.Load.end, Ity_I64,
+                              addrPlus(env, addr, offLo));
+         } else {
+            *lo = IRExpr_Load(e->Iex.Load.end, ity, addr);
+         }
+         return;
+      }
+      case Iex_ITE:
+         if (wide) {
+            *hi = IRExpr_ITE(e->Iex.ITE.cond,
+                             hiOf(env, e->Iex.ITE.iftrue),
+                             hiOf(env, e->Iex.ITE.iffalse));
+            *lo = IRExpr_ITE(e->Iex.ITE.cond,
+                             loOf(env, e->Iex.ITE.iftrue),
+                             loOf(env, e->Iex.ITE.iffalse));
+         } else {
+            *lo = e;
+         }
+         return;
+      case Iex_Unop: {
+         IRExpr* arg = e->Iex.Unop.arg;
+         op = e->Iex.Unop.op;
+         switch (op) {
+            case Iop_ReinterpI64asD64:
+               *lo = arg;
+               return;
+            case Iop_D128HItoD64:
+               *lo = hiOf(env, arg);
+               return;
+            case Iop_D128LOtoD64:
+               *lo = loOf(env, arg);
+               return;
+            case Iop_D32toD64:
+            case Iop_D64toD128:
+               a = arg;
+               break;
+            case Iop_I32StoD64:
+            case Iop_I32StoD128:
+               int64 = widenTo64(env, Iop_32Sto64, arg);
+               break;
+            case Iop_I32UtoD64:
+            case Iop_I32UtoD128:
+               int64 = widenTo64(env, Iop_32Uto64, arg);
+               break;
+            case Iop_I64StoD128:
+            case Iop_I64UtoD128:
+               int64 = arg;
+               break;
+            default:
+               goto unhandled;
+         }
+         break;
+      }
+      case Iex_Binop: {
+         IRExpr* arg1 = e->Iex.Binop.arg1;
+         IRExpr* arg2 = e->Iex.Binop.arg2;
+         op = e->Iex.Binop.op;
+         switch (op) {
+            case Iop_D64HLtoD128:
+               *hi = arg1;
+               *lo = arg2;
+               return;
+            case Iop_ShlD64:  case Iop_ShrD64:
+            case Iop_ShlD128: case Iop_ShrD128:
+               a     = arg1;
+               int64 = widenTo64(env, Iop_8Uto64, arg2);
+               break;
+            case Iop_InsertExpD64:
+            case Iop_InsertExpD128:
+               a     = arg2;
+               int64 = arg1;
+               break;
+            case Iop_D64toD32:
+            case Iop_D128toD64:
+            case Iop_RoundD64toInt:
+            case Iop_RoundD128toInt:
+               rm64 = widenTo64(env, Iop_32Uto64, arg1);
+               a    = arg2;
+               break;
+            case Iop_I64StoD64:
+            case Iop_I64UtoD64:
+               rm64  = widenTo64(env, Iop_32Uto64, arg1);
+               int64 = arg2;
+               break;
+            default:
+               goto unhandled;
+         }
+         break;
+      }
+      case Iex_Triop: {
+         IRTriop* tri = e->Iex.Triop.details;
+         op = tri->op;
+         switch (op) {
+            case Iop_AddD64:  case Iop_SubD64:
+            case Iop_MulD64:  case Iop_DivD64:
+            case Iop_AddD128: case Iop_SubD128:
+            case Iop_MulD128: case Iop_DivD128:
+            case Iop_QuantizeD64:
+            case Iop_QuantizeD128:
+               rm64 = widenTo64(env, Iop_32Uto64, tri->arg1);
+               a    = tri->arg2;
+               b    = tri->arg3;
+               break;
+            case Iop_SignificanceRoundD64:
+            case Iop_SignificanceRoundD128:
+               rm64  = widenTo64(env, Iop_32Uto64, tri->arg1);
+               a     = tri->arg3;
+               int64 = widenTo64(env, Iop_8Uto64, tri->arg2);
+               break;
+            default:
+               goto unhandled;
+         }
+         break;
+      }
+      default:
+         goto unhandled;
+   }
+
+   /* Everything left is a helper call, two for a D128 result. */
+   if (wide) {
+      *hi = mkCall(env, op, True,  rm64, a, b, int64);
+      *lo = mkCall(env, op, False, rm64, a, b, int64);
+   } else {
+      *lo = mkCall(env, op, False, rm64, a, b, int64);
+      if (ty == Ity_D32)
+         *lo = IRExpr_Unop(Iop_64to32, IRExpr_RdTmp(bind(env, Ity_I64,
+                                                         *lo)));
+   }
+   return;
+
+  unhandled:
+   ppIRExpr(e);
+   vpanic("do_DFP_lowering_BB: unhandled DFP expression");
+}
+
+/* Compute into |dst| the non-DFP result of |e|, which has at least
+   one DFP operand. */
+static void lowerFromDFP ( LowerEnv* env, IRTemp dst, IRExpr* e )
+{
+   IRExpr* res  = NULL;
+   Bool    to32 = False;
+
+   if (e->tag == Iex_Unop) {
+      IROp op = e->Iex.Unop.op;
+      switch (op) {
+         case Iop_ReinterpD64asI64:
+            res = e->Iex.Unop.arg;
+            break;
+         case Iop_ExtractExpD64:  case Iop_ExtractExpD128:
+         case Iop_ExtractSigD64:  case Iop_ExtractSigD128:
+            res = mkCall(env, op, False, NULL, e->Iex.Unop.arg, NULL, NULL);
+            break;
+         default:
+            break;
+      }
+   }
+   else if (e->tag == Iex_Binop) {
+      IROp op = e->Iex.Binop.op;
+      switch (op) {
+         case Iop_CmpD64:    case Iop_CmpD128:
+         case Iop_CmpExpD64: case Iop_CmpExpD128:
+            res  = mkCall(env, op, False, NULL, e->Iex.Binop.arg1,
+                          e->Iex.Binop.arg2, NULL);
+            to32 = True;
+            break;
+         case Iop_D64toI32S:  case Iop_D64toI32U:
+         case Iop_D128toI32S: case Iop_D128toI32U:
+            to32 = True;
+            /* fallthrough */
+         case Iop_D64toI64S:  case Iop_D64toI64U:
+         case Iop_D128toI64S: case Iop_D128toI64U:
+            res = mkCall(env, op, False,
+                         widenTo64(env, Iop_32Uto64, e->Iex.Binop.arg1),
+                         e->Iex.Binop.arg2, NULL, NULL);
+            break;
+         default:
+            break;
+      }
+   }
+   if (!res) {
+      ppIRExpr(e);
+      vpanic("do_DFP_lowering_BB: unhandled use of a DFP value");
+   }
+   if (to32)
+      res = IRExpr_Unop(Iop_64to32, IRExpr_RdTmp(bind(env, Ity_I64, res)));
+   addStmtToIRSB(env->out, IRStmt_WrTmp(dst, res));
+}
+
+/* Whether any operand of the flat expression |e| is a DFP temp. */
+static Bool usesDFP ( const LowerEnv* env, const IRExpr* e )
+{
+   switch (e->tag) {
+      case Iex_Unop:
+         return isDFPAtom(env, e->Iex.Unop.arg);
+      case Iex_Binop:
+         return isDFPAtom(env, e->Iex.Binop.arg1)
+                || isDFPAtom(env, e->Iex.Binop.arg2);
+      case Iex_Triop:
+         return isDFPAtom(env, e->Iex.Triop.details->arg2)
+                || isDFPAtom(env, e->Iex.Triop.details->arg3);
+      case Iex_Qop:
+         return isDFPAtom(env, e->Iex.Qop.details->arg2)
+                || isDFPAtom(env, e->Iex.Qop.details->arg3)
+                || isDFPAtom(env, e->Iex.Qop.details->arg4);
+      default:
+         return False;
+   }
+}
+
+static Bool isBCDConversion ( const IRExpr* e )
+{
+   return e->tag == Iex_Unop
+          && (e->Iex.Unop.op == Iop_DPBtoBCD
+              || e->Iex.Unop.op == Iop_BCDtoDPB);
+}
+
+IRSB* do_DFP_lowering_BB ( IRSB* bb, VexEndness hostEnd )
+{
+   LowerEnv env;
+   IRTemp   t;
+   Int      i, nTmps = bb->tyenv->types_used;
+   Bool     any = False;
+   Int      offHi = hostEnd == VexEndnessLE ? 8 : 0;
+   Int      offLo = 8 - offHi;
+
+   for (t = 0; t < nTmps; t++)
+      if (isDFPType(bb->tyenv->types[t]))
+         any = True;
+   for (i = 0; i < bb->stmts_used && !any; i++)
+      if (bb->stmts[i]->tag == Ist_WrTmp
+          && isBCDConversion(bb->stmts[i]->Ist.WrTmp.data))
+         any = True;
+   if (!any)
+      return bb;
+
+   env.out    = deepCopyIRSBExceptStmts(bb);
+   env.lo     = LibVEX_Alloc_inline(nTmps * sizeof(IRTemp));
+   env.origTy = LibVEX_Alloc_inline(nTmps * sizeof(IRType));
+   for (t = 0; t < nTmps; t++) {
+      IRType ty = env.out->tyenv->types[t];
+      env.lo[t]     = IRTemp_INVALID;
+      env.origTy[t] = ty;
+      if (ty == Ity_D32) {
+         env.out->tyenv->types[t] = Ity_I32;
+      } else if (ty == Ity_D64) {
+         env.out->tyenv->types[t] = Ity_I64;
+      } else if (ty == Ity_D128) {
+         env.out->tyenv->types[t] = Ity_I64;
+         env.lo[t] = newIRTemp(env.out->tyenv, Ity_I64);
+      }
+   }
+
+   for (i = 0; i < bb->stmts_used; i++) {
+      IRStmt* st = bb->stmts[i];
+      switch (st->tag) {
+         case Ist_WrTmp: {
+            IRTemp  dst = st->Ist.WrTmp.tmp;
+            IRExpr* e   = st->Ist.WrTmp.data;
+            if (isDFPType(env.origTy[dst])) {
+               IRExpr *hi, *lo;
+               lowerDFPExpr(&env, e, env.origTy[dst], hostEnd, &hi, &lo);
+               if (hi)
+                  addStmtToIRSB(env.out, IRStmt_WrTmp(dst, hi));
+               addStmtToIRSB(env.out,
+                  IRStmt_WrTmp(hi ? env.lo[dst] : dst, lo));
+               continue;
+            }
+            if (usesDFP(&env, e)) {
+               lowerFromDFP(&env, dst, e);
+               continue;
+            }
+            if (isBCDConversion(e)) {
+               IRExpr* arg = e->Iex.Unop.arg;
+               IRExpr** args
+                  = mkIRExprVec_6(mkU64((ULong)e->Iex.Unop.op << 1),
+                                  mkU64(0), mkU64(0), arg,
+                                  mkU64(0), mkU64(0));
+               addStmtToIRSB(env.out, IRStmt_WrTmp(dst,
+                  mkIRExprCCall(Ity_I64, 0/*regparms*/,
+                                "h_generic_calc_DFP",
+                                &h_generic_calc_DFP, args)));
+               continue;
+            }
+            break;
+         }
+         case Ist_Put:
+            if (origTypeOf(&env, st->Ist.Put.data) == Ity_D128) {
+               addStmtToIRSB(env.out,
+                  IRStmt_Put(st->Ist.Put.offset + offHi,
+                             hiOf(&env, st->Ist.Put.data)));
+               addStmtToIRSB(env.out,
+                  IRStmt_Put(st->Ist.Put.offset + offLo,
+                             loOf(&env, st->Ist.Put.data)));
+               continue;
+            }
+            break;
+         case Ist_Store:
+            if (origTypeOf(&env, st->Ist.Store.data) == Ity_D128) {
+               IREndness end = st->Ist.Store.end;
+               Int sOffHi = end == Iend_LE ? 8 : 0;
+               IRExpr* aHi = addrPlus(&env, st->Ist.Store.addr, sOffHi);
+               IRExpr* aLo = addrPlus(&env, st->Ist.Store.addr,
+                                      8 - sOffHi);
+               addStmtToIRSB(env.out,
+                  IRStmt_Store(end, aHi, hiOf(&env, st->Ist.Store.data)));
+               addStmtToIRSB(env.out,
+                  IRStmt_Store(end, aLo, loOf(&env, st->Ist.Store.data)));
+               continue;
+            }
+            break;
+         case Ist_PutI: {
+            IRPutI*     p     = st->Ist.PutI.details;
+            IRRegArray* descr = p->descr;
+            IRType      ty    = origTypeOf(&env, p->data);
+            if (ty == Ity_D128)
+               goto unhandled;
+            if (isDFPType(descr->elemTy)) {
+               descr = mkIRRegArray(descr->base,
+                                    ty == Ity_D32 ? Ity_I32 : Ity_I64,
+                                    descr->nElems);
+               addStmtToIRSB(env.out, IRStmt_PutI(
+                  mkIRPutI(descr, p->ix, p->bias, p->data)));
+               continue;
+            }
+            break;
+         }
+         case Ist_StoreG:
+            if (origTypeOf(&env, st->Ist.StoreG.details->data) == Ity_D128)
+               goto unhandled;
+            break;
+         case Ist_Dirty: {
+            IRDirty* d = st->Ist.Dirty.details;
+            Int j;
+            if (d->tmp != IRTemp_INVALID && env.origTy[d->tmp] == Ity_D128)
+               goto unhandled;
+            for (j = 0; d->args[j]; j++)
+               if (!is_IRExpr_VECRET_or_BBPTR(d->args[j])
+                   && origTypeOf(&env, d->args[j]) == Ity_D128)
+                  goto unhandled;
+            break;
+         }
+         default:
+            break;
+      }
+      addStmtToIRSB(env.out, st);
+      continue;
+     unhandled:
+      ppIRStmt(st);
+      vpanic("do_DFP_lowering_BB: unhandled DFP statement");
+   }
+   return env.out;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                  host_generic_dfp.c ---*/
+/*---------------------------------------------------------------*/
@@ -0,0 +1,75 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                host_generic_dfp.h ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Software IEEE754 decimal floating point, in the densely packed
+   decimal (DPD) encoding used by the ppc and s390 guests, for hosts
+   whose instruction selectors cannot handle Ity_D32, Ity_D64 and
+   Ity_D128 values or the DFP primops.
+
+   do_DFP_lowering_BB rewrites a flat IRSB so that D32 and D64 values
+   are carried as I32 and I64 bit patterns and D128 values as pairs
+   of I64 halves.  The reinterpretations and the D128 <-> D64 pair
+   ops become plain moves; every other DFP primop, and DPBtoBCD and
+   BCDtoDPB, becomes a call to the clean helper h_generic_calc_DFP.
+
+   The conversions between binary and decimal floating point are not
+   handled; blocks using them still can't be compiled for such hosts.
+*/
+
+#ifndef __VEX_HOST_GENERIC_DFP_H
+#define __VEX_HOST_GENERIC_DFP_H
+
+#include "libvex_basictypes.h"
+#include "libvex_ir.h"
+#include "libvex.h"
+
+/* Compute half of the result of the primop |opAndHalf >> 1|.  DFP
+   operands are passed as (hi,lo) pairs of their bit patterns, D32
+   and D64 ones in the low half.  The integer operand of ShlD*,
+   ShrD*, InsertExpD* and SignificanceRoundD*, and the single operand
+   of the integer -> DFP conversions, are passed in bLo.  For ops
+   producing a D128, bit 0 of |opAndHalf| selects the high (1) or low
+   (0) half of the result; all other results are returned in the low
+   bits. */
+extern
+ULong h_generic_calc_DFP ( ULong opAndHalf, ULong rm,
+                           ULong aHi, ULong aLo, ULong bHi, ULong bLo );
+
+/* Replace all DFP values and operations in |bb| as described above.
+   |hostEnd| determines how a D128 is laid out in the guest state.
+   Returns a new BB, or bb itself if it contains nothing to lower. */
+extern
+IRSB* do_DFP_lowering_BB ( IRSB* bb, VexEndness hostEnd );
+
+#endif /* ndef __VEX_HOST_GENERIC_DFP_H */
+
+/*---------------------------------------------------------------*/
+/*--- end                                  host_generic_dfp.h ---*/
+/*---------------------------------------------------------------*/
@@ -0,0 +1,1162 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                               host_generic_f128.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Software IEEE754 binary128 arithmetic, and the IR pass that makes
+   F128 values and ops visible to it.  See host_generic_f128.h.
+
+   All arithmetic is done on pairs of ULongs, since not every host
+   compiler has a 128-bit integer type.  Nothing here is fast; the
+   point is to be exact.  The only guest to generate F128 ops is s390,
+   so NaN handling follows it: an operation with a signalling NaN
+   operand returns that NaN quietened, otherwise the first quiet NaN
+   operand, and invalid operations produce the positive default NaN.
+   Conversions to integer saturate, and give the most negative value
+   (signed) or zero (unsigned) for a NaN. */
+
+#include "libvex_basictypes.h"
+#include "libvex_ir.h"
+#include "libvex.h"
+
+#include "main_util.h"
+#include "host_generic_f128.h"
+
+
+/*---------------------------------------------------------*/
+/*--- 128- and 256-bit integer arithmetic               ---*/
+/*---------------------------------------------------------*/
+
+typedef  struct { ULong hi; ULong lo; }  UI128;
+
+static inline UI128 mkU128 ( ULong hi, ULong lo )
+{
+   UI128 r;
+   r.hi = hi;
+   r.lo = lo;
+   return r;
+}
+
+static inline Bool isZeroU128 ( UI128 a )
+{
+   return (a.hi | a.lo) == 0;
+}
+
+static inline Bool ltU128 ( UI128 a, UI128 b )
+{
+   return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+static inline UI128 addU128 ( UI128 a, UI128 b )
+{
+   UI128 r;
+   r.lo = a.lo + b.lo;
+   r.hi = a.hi + b.hi + (r.lo < a.lo ? 1 : 0);
+   return r;
+}
+
+static inline UI128 subU128 ( UI128 a, UI128 b )
+{
+   UI128 r;
+   r.lo = a.lo - b.lo;
+   r.hi = a.hi - b.hi - (a.lo < b.lo ? 1 : 0);
+   return r;
+}
+
+static UI128 shlU128 ( UI128 a, UInt n )
+{
+   if (n == 0)   return a;
+   if (n >= 128) return mkU128(0, 0);
+   if (n >= 64)  return mkU128(a.lo << (n - 64), 0);
+   return mkU128((a.hi << n) | (a.lo >> (64 - n)), a.lo << n);
+}
+
+static UI128 shrU128 ( UI128 a, UInt n )
+{
+   if (n == 0)   return a;
+   if (n >= 128) return mkU128(0, 0);
+   if (n >= 64)  return mkU128(0, a.hi >> (n - 64));
+   return mkU128(a.hi >> n, (a.lo >> n) | (a.hi << (64 - n)));
+}
+
+/* The low |n| bits of |a|. */
+static UI128 lowBitsU128 ( UI128 a, UInt n )
+{
+   UI128 mask;
+   if (n >= 128) return a;
+   mask = subU128(shlU128(mkU128(0, 1), n), mkU128(0, 1));
+   return mkU128(a.hi & mask.hi, a.lo & mask.lo);
+}
+
+/* Shift right, ORing any bits shifted out into bit 0 ("jamming"), so
+   that a later rounding step can still tell an exact result from an
+   inexact one. */
+static UI128 shrJamU128 ( UI128 a, UInt n )
+{
+   UI128 r;
+   if (n == 0)
+      return a;
+   if (n >= 128)
+      return mkU128(0, isZeroU128(a) ? 0 : 1);
+   r = shrU128(a, n);
+   if (!isZeroU128(lowBitsU128(a, n)))
+      r.lo |= 1;
+   return r;
+}
+
+/* Number of leading zeroes; |a| must be nonzero. */
+static UInt clzU128 ( UI128 a )
+{
+   vassert(!isZeroU128(a));
+   return a.hi != 0 ? __builtin_clzll(a.hi)
+                    : 64 + __builtin_clzll(a.lo);
+}
+
+static UI128 mulU64 ( ULong a, ULong b )
+{
+   ULong a0 = a & 0xFFFFFFFFULL, a1 = a >> 32;
+   ULong b0 = b & 0xFFFFFFFFULL, b1 = b >> 32;
+   ULong p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+   ULong mid = (p00 >> 32) + (p01 & 0xFFFFFFFFULL)
+                           + (p10 & 0xFFFFFFFFULL);
+   return mkU128(p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32),
+                 (mid << 32) | (p00 & 0xFFFFFFFFULL));
+}
+
+/* 256-bit values are 4 ULongs, least significant first. */
+static void addAtU256 ( /*MOD*/ULong* w, UInt ix, UI128 v )
+{
+   ULong carry, old;
+   vassert(ix <= 2);
+   old = w[ix];   w[ix] += v.lo;             carry = w[ix] < old ? 1 : 0;
+   ix++;
+   old = w[ix];   w[ix] += v.hi + carry;
+   carry = (w[ix] < old || (carry && w[ix] == old)) ? 1 : 0;
+   for (ix++; carry && ix < 4; ix++) {
+      w[ix]++;
+      carry = w[ix] == 0 ? 1 : 0;
+   }
+}
+
+static void mulU128 ( /*OUT*/ULong* w, UI128 a, UI128 b )
+{
+   w[0] = w[1] = w[2] = w[3] = 0;
+   addAtU256(w, 0, mulU64(a.lo, b.lo));
+   addAtU256(w, 1, mulU64(a.lo, b.hi));
+   addAtU256(w, 1, mulU64(a.hi, b.lo));
+   addAtU256(w, 2, mulU64(a.hi, b.hi));
+}
+
+static Bool leU256 ( const ULong* a, const ULong* b )
+{
+   Int i;
+   for (i = 3; i >= 0; i--)
+      if (a[i] != b[i])
+         return a[i] < b[i];
+   return True;
+}
+
+/* Bits [n+127 .. n] of |w|, jamming everything below; 64 <= n < 128. */
+static UI128 shrJamU256 ( const ULong* w, UInt n )
+{
+   UI128  r;
+   UInt  s = n - 64;
+   vassert(n >= 64 && n < 128);
+   if (s == 0) {
+      r = mkU128(w[2], w[1]);
+   } else {
+      r = mkU128((w[2] >> s) | (w[3] << (64 - s)),
+                 (w[1] >> s) | (w[2] << (64 - s)));
+   }
+   if (w[0] != 0 || (s > 0 && (w[1] << (64 - s)) != 0))
+      r.lo |= 1;
+   return r;
+}
+
+
+/*---------------------------------------------------------*/
+/*--- Unpacking, rounding and packing                   ---*/
+/*---------------------------------------------------------*/
+
+/* Everything is computed on an unpacked form: a finite nonzero
+   value is sig * 2^(exp - 126), with the leading bit of sig at
+   bit 126.  That leaves 14 bits below a binary128 significand for
+   rounding, and the top bit free to catch a carry. */
+
+typedef
+   enum { FC_ZERO, FC_FINITE, FC_INF, FC_NAN }
+   FClass;
+
+typedef
+   struct {
+      FClass cls;
+      Bool   sign;
+      Int    exp;
+      UI128   sig;   /* for NaNs, the fraction, left aligned at bit 126 */
+   }
+   Unpacked;
+
+typedef
+   struct {
+      Int prec;     /* significand bits, including the implicit one */
+      Int expBits;
+      Int bias;
+   }
+   Fmt;
+
+static const Fmt fmtF128 = { 113, 15, 16383 };
+static const Fmt fmtF64  = {  53, 11,  1023 };
+static const Fmt fmtF32  = {  24,  8,   127 };
+
+static Unpacked unpack ( UI128 bits, const Fmt* f )
+{
+   Unpacked u;
+   Int  fracBits = f->prec - 1;
+   UInt maxBe    = (1 << f->expBits) - 1;
+   UInt be       = (UInt)shrU128(bits, fracBits).lo & maxBe;
+   UI128 frac     = lowBitsU128(bits, fracBits);
+
+   u.sign = toBool(shrU128(bits, fracBits + f->expBits).lo & 1);
+   u.exp  = 0;
+   u.sig  = mkU128(0, 0);
+   if (be == maxBe) {
+      u.cls = isZeroU128(frac) ? FC_INF : FC_NAN;
+      u.sig = shlU128(frac, 127 - fracBits);
+   } else if (be == 0) {
+      if (isZeroU128(frac)) {
+         u.cls = FC_ZERO;
+      } else {
+         /* Subnormal: normalise it. */
+         Int p = 127 - clzU128(frac);
+         u.cls = FC_FINITE;
+         u.sig = shlU128(frac, 126 - p);
+         u.exp = (1 - f->bias) - (fracBits - p);
+      }
+   } else {
+      u.cls = FC_FINITE;
+      u.sig = shlU128(addU128(frac, shlU128(mkU128(0, 1), fracBits)),
+                      126 - fracBits);
+      u.exp = (Int)be - f->bias;
+   }
+   return u;
+}
+
+static UI128 packSpecial ( Bool sign, Bool isInf, const Fmt* f )
+{
+   Int  fracBits = f->prec - 1;
+   UI128 r = shlU128(mkU128(0, (1ULL << f->expBits) - 1), fracBits);
+   if (!isInf)
+      r = addU128(r, shlU128(mkU128(0, 1), fracBits - 1));
+   if (sign)
+      r = addU128(r, shlU128(mkU128(0, 1), fracBits + f->expBits));
+   return r;
+}
+
+static UI128 packZero ( Bool sign, const Fmt* f )
+{
+   return sign ? shlU128(mkU128(0, 1), f->prec - 1 + f->expBits)
+               : mkU128(0, 0);
+}
+
+/* A NaN in format |f| carrying as much of |u|'s payload as fits,
+   quietened. */
+static UI128 packNaN ( const Unpacked* u, const Fmt* f )
+{
+   Int fracBits = f->prec - 1;
+   UI128 r = packSpecial(u->sign, False/*NaN*/, f);
+   UI128 pl = shrU128(u->sig, 127 - fracBits);
+   return mkU128(r.hi | pl.hi, r.lo | pl.lo);
+}
+
+static UI128 defaultNaN ( const Fmt* f )
+{
+   return packSpecial(False, False/*NaN*/, f);
+}
+
+/* Where the discarded bits lie relative to half an ulp. */
+typedef
+   enum { RB_EXACT, RB_BELOW_HALF, RB_HALF, RB_ABOVE_HALF }
+   RoundBits;
+
+static RoundBits classifyRoundBits ( UI128 rem, UInt nBits )
+{
+   UI128 half;
+   if (isZeroU128(rem))
+      return RB_EXACT;
+   half = shlU128(mkU128(0, 1), nBits - 1);
+   if (ltU128(rem, half))
+      return RB_BELOW_HALF;
+   return ltU128(half, rem) ? RB_ABOVE_HALF : RB_HALF;
+}
+
+/* Whether a result with the given discarded bits should be rounded
+   up in magnitude.  Irrm_PREPARE_SHORTER (round to odd) truncates
+   here; the caller then sets the lsb if the result is inexact. */
+static Bool roundUp ( UInt rm, Bool sign, Bool lsb, RoundBits rb )
+{
+   switch (rm) {
+      case Irrm_NEAREST:
+         return rb == RB_ABOVE_HALF || (rb == RB_HALF && lsb);
+      case Irrm_NegINF:
+         return rb != RB_EXACT && sign;
+      case Irrm_PosINF:
+         return rb != RB_EXACT && !sign;
+      case Irrm_ZERO:
+      case Irrm_PREPARE_SHORTER:
+         return False;
+      case Irrm_NEAREST_TIE_AWAY_0:
+         return rb >= RB_HALF;
+      case Irrm_AWAY_FROM_ZERO:
+         return rb != RB_EXACT;
+      case Irrm_NEAREST_TIE_TOWARD_0:
+         return rb == RB_ABOVE_HALF;
+      default:
+         vpanic("host_generic_f128: invalid rounding mode");
+   }
+}
+
+/* Round the finite nonzero value sig * 2^(exp - 126) to format |f|
+   and pack it. */
+static UI128 roundPack ( Bool sign, Int exp, UI128 sig, UInt rm,
+                        const Fmt* f )
+{
+   Int       fracBits = f->prec - 1;
+   Int       maxBe    = (1 << f->expBits) - 1;
+   UInt      nRound   = 127 - f->prec;
+   Int       be       = exp + f->bias;
+   UI128      q, rem, res;
+   RoundBits rb;
+
+   vassert(!isZeroU128(sig) && sig.hi >> 62 == 1);
+
+   if (be < 1) {
+      /* Subnormal (or underflowing to zero).  Adjust so that the
+         packed exponent field comes out as zero, unless rounding
+         carries into the implicit bit. */
+      sig = shrJamU128(sig, 1 - be < 128 ? 1 - be : 128);
+      be  = 1;
+   }
+   if (be >= maxBe)
+      goto overflow;
+
+   q   = shrU128(sig, nRound);
+   rem = lowBitsU128(sig, nRound);
+   rb  = classifyRoundBits(rem, nRound);
+   if (roundUp(rm, sign, toBool(q.lo & 1), rb))
+      q = addU128(q, mkU128(0, 1));
+   if (rm == Irrm_PREPARE_SHORTER && rb != RB_EXACT)
+      q.lo |= 1;
+
+   /* q includes the implicit bit, so adding it to (be - 1) in the
+      exponent field gives the right result for normals, subnormals,
+      and for a carry out of the significand. */
+   if (be - 1 + (Int)shrU128(q, fracBits).lo >= maxBe)
+      goto overflow;
+   res = addU128(shlU128(mkU128(0, be - 1), fracBits), q);
+   if (sign)
+      res = addU128(res, shlU128(mkU128(0, 1), fracBits + f->expBits));
+   return res;
+
+  overflow:
+   switch (rm) {
+      case Irrm_ZERO:
+      case Irrm_PREPARE_SHORTER:
+         break;
+      case Irrm_NegINF:
+         if (sign) return packSpecial(sign, True/*inf*/, f);
+         break;
+      case Irrm_PosINF:
+         if (!sign) return packSpecial(sign, True/*inf*/, f);
+         break;
+      default:
+         return packSpecial(sign, True/*inf*/, f);
+   }
+   /* The largest finite number is one less than infinity. */
+   res = subU128(packSpecial(False, True/*inf*/, f), mkU128(0, 1));
+   if (sign)
+      res = addU128(res, shlU128(mkU128(0, 1), fracBits + f->expBits));
+   return res;
+}
+
+/* Pack a nonzero integer magnitude, which is always exact. */
+static UI128 packIntMag ( Bool sign, UI128 mag )
+{
+   Int p = 127 - clzU128(mag);
+   return roundPack(sign, p, shlU128(mag, 126 - p), Irrm_ZERO, &fmtF128);
+}
+
+/* Round the finite nonzero value |u| to an integer magnitude.  Sets
+   *huge if it is 2^127 or more. */
+static UI128 roundToIntMag ( const Unpacked* u, UInt rm, /*OUT*/Bool* huge )
+{
+   UI128      mag;
+   RoundBits rb;
+   Int       sh = 126 - u->exp;
+
+   *huge = False;
+   if (sh < 0) {
+      *huge = True;
+      return mkU128(0, 0);
+   }
+   if (sh == 0)
+      return u->sig;
+   if (sh <= 127) {
+      mag = shrU128(u->sig, sh);
+      rb  = classifyRoundBits(lowBitsU128(u->sig, sh), sh);
+   } else {
+      /* Less than a half. */
+      mag = mkU128(0, 0);
+      rb  = RB_BELOW_HALF;
+   }
+   if (roundUp(rm, u->sign, toBool(mag.lo & 1), rb))
+      mag = addU128(mag, mkU128(0, 1));
+   if (rm == Irrm_PREPARE_SHORTER && rb != RB_EXACT)
+      mag.lo |= 1;
+   return mag;
+}
+
+
+/*---------------------------------------------------------*/
+/*--- The operations                                    ---*/
+/*---------------------------------------------------------*/
+
+static Bool isSNaN ( const Unpacked* u )
+{
+   return u->cls == FC_NAN && (u->sig.hi >> 62) == 0;
+}
+
+/* NaN result for a binary op with at least one NaN operand. */
+static UI128 propagateNaN ( const Unpacked* a, const Unpacked* b )
+{
+   if (isSNaN(a))           return packNaN(a, &fmtF128);
+   if (isSNaN(b))           return packNaN(b, &fmtF128);
+   if (a->cls == FC_NAN)    return packNaN(a, &fmtF128);
+   return packNaN(b, &fmtF128);
+}
+
+static UI128 f128_add ( UI128 aBits, UI128 bBits, UInt rm, Bool isSub )
+{
+   Unpacked a = unpack(aBits, &fmtF128);
+   Unpacked b = unpack(bBits, &fmtF128);
+   UI128     sig;
+   Int      exp;
+
+   if (a.cls == FC_NAN || b.cls == FC_NAN)
+      return propagateNaN(&a, &b);
+   b.sign ^= isSub;
+
+   if (a.cls == FC_INF) {
+      if (b.cls == FC_INF && a.sign != b.sign)
+         return defaultNaN(&fmtF128);
+      return packSpecial(a.sign, True/*inf*/, &fmtF128);
+   }
+   if (b.cls == FC_INF)
+      return packSpecial(b.sign, True/*inf*/, &fmtF128);
+   if (a.cls == FC_ZERO && b.cls == FC_ZERO) {
+      if (a.sign == b.sign)
+         return packZero(a.sign, &fmtF128);
+      return packZero(rm == Irrm_NegINF, &fmtF128);
+   }
+   if (a.cls == FC_ZERO)
+      return roundPack(b.sign, b.exp, b.sig, rm, &fmtF128);
+   if (b.cls == FC_ZERO)
+      return roundPack(a.sign, a.exp, a.sig, rm, &fmtF128);
+
+   /* Make |a| the one with the larger magnitude. */
+   if (a.exp < b.exp || (a.exp == b.exp && ltU128(a.sig, b.sig))) {
+      Unpacked t = a; a = b; b = t;
+   }
+   exp = a.exp;
+   b.sig = shrJamU128(b.sig, a.exp - b.exp < 128 ? a.exp - b.exp : 128);
+
+   if (a.sign == b.sign) {
+      sig = addU128(a.sig, b.sig);
+      if (sig.hi >> 63) {
+         sig = shrJamU128(sig, 1);
+         exp++;
+      }
+   } else {
+      /* Any bits jammed into |b| are far below the leading bit of
+         the difference, so normalising left keeps them below the
+         rounding point. */
+      UInt sh;
+      sig = subU128(a.sig, b.sig);
+      if (isZeroU128(sig))
+         return packZero(rm == Irrm_NegINF, &fmtF128);
+      sh   = clzU128(sig) - 1;
+      sig  = shlU128(sig, sh);
+      exp -= sh;
+   }
+   return roundPack(a.sign, exp, sig, rm, &fmtF128);
+}
+
+static UI128 f128_mul ( UI128 aBits, UI128 bBits, UInt rm )
+{
+   Unpacked a = unpack(aBits, &fmtF128);
+   Unpacked b = unpack(bBits, &fmtF128);
+   Bool     sign = toBool(a.sign ^ b.sign);
+   ULong    w[4];
+   UI128     sig;
+   Int      exp;
+
+   if (a.cls == FC_NAN || b.cls == FC_NAN)
+      return propagateNaN(&a, &b);
+   if (a.cls == FC_INF || b.cls == FC_INF) {
+      if (a.cls == FC_ZERO || b.cls == FC_ZERO)
+         return defaultNaN(&fmtF128);
+      return packSpecial(sign, True/*inf*/, &fmtF128);
+   }
+   if (a.cls == FC_ZERO || b.cls == FC_ZERO)
+      return packZero(sign, &fmtF128);
+
+   /* 113-bit significands give a product with its leading bit at
+      224 or 225. */
+   mulU128(w, shrU128(a.sig, 14), shrU128(b.sig, 14));
+   sig = shrJamU256(w, 98);
+   exp = a.exp + b.exp;
+   if (sig.hi >> 63) {
+      sig = shrJamU128(sig, 1);
+      exp++;
+   }
+   return roundPack(sign, exp, sig, rm, &fmtF128);
+}
+
+static UI128 f128_div ( UI128 aBits, UI128 bBits, UInt rm )
+{
+   Unpacked a = unpack(aBits, &fmtF128);
+   Unpacked b = unpack(bBits, &fmtF128);
+   Bool     sign = toBool(a.sign ^ b.sign);
+   UI128     num, den, q;
+   Int      exp, i;
+
+   if (a.cls == FC_NAN || b.cls == FC_NAN)
+      return propagateNaN(&a, &b);
+   if (a.cls == FC_INF) {
+      if (b.cls == FC_INF)
+         return defaultNaN(&fmtF128);
+      return packSpecial(sign, True/*inf*/, &fmtF128);
+   }
+   if (b.cls == FC_INF)
+      return packZero(sign, &fmtF128);
+   if (b.cls == FC_ZERO) {
+      if (a.cls == FC_ZERO)
+         return defaultNaN(&fmtF128);
+      return packSpecial(sign, True/*inf*/, &fmtF128);
+   }
+   if (a.cls == FC_ZERO)
+      return packZero(sign, &fmtF128);
+
+   /* Long division, one quotient bit at a time, arranging for the
+      first bit to be set so the quotient is already normalised. */
+   num = shrU128(a.sig, 14);
+   den = shrU128(b.sig, 14);
+   exp = a.exp - b.exp;
+   if (ltU128(num, den)) {
+      num = shlU128(num, 1);
+      exp--;
+   }
+   q = mkU128(0, 0);
+   for (i = 126; i >= 0; i--) {
+      if (!ltU128(num, den)) {
+         num = subU128(num, den);
+         q = addU128(q, shlU128(mkU128(0, 1), i));
+      }
+      num = shlU128(num, 1);
+   }
+   if (!isZeroU128(num))
+      q.lo |= 1;
+   return roundPack(sign, exp, q, rm, &fmtF128);
+}
+
+static UI128 f128_sqrt ( UI128 aBits, UInt rm )
+{
+   Unpacked a = unpack(aBits, &fmtF128);
+   ULong    n[4], sq[4];
+   UI128     m, r;
+   Int      exp, i;
+
+   if (a.cls == FC_NAN)
+      return packNaN(&a, &fmtF128);
+   if (a.cls == FC_ZERO)
+      return aBits;
+   if (a.sign)
+      return defaultNaN(&fmtF128);
+   if (a.cls == FC_INF)
+      return aBits;
+
+   /* sqrt(m * 2^(exp-112)) with exp made even, computed as the
+      integer square root of m * 2^140, whose leading bit is then at
+      126. */
+   m   = shrU128(a.sig, 14);
+   exp = a.exp;
+   if (exp & 1) {
+      m = shlU128(m, 1);
+      exp--;
+   }
+   n[0] = n[1] = 0;
+   n[2] = (m.lo << 12);
+   n[3] = (m.hi << 12) | (m.lo >> 52);
+
+   r = mkU128(0, 0);
+   for (i = 126; i >= 0; i--) {
+      UI128 cand = addU128(r, shlU128(mkU128(0, 1), i));
+      mulU128(sq, cand, cand);
+      if (leU256(sq, n))
+         r = cand;
+   }
+   mulU128(sq, r, r);
+   if (!leU256(n, sq))
+      r.lo |= 1;
+   return roundPack(False, exp / 2, r, rm, &fmtF128);
+}
+
+static UI128 f128_roundToInt ( UI128 aBits, UInt rm )
+{
+   Unpacked a = unpack(aBits, &fmtF128);
+   UI128     mag;
+   Bool     huge;
+
+   if (a.cls == FC_NAN)
+      return packNaN(&a, &fmtF128);
+   if (a.cls != FC_FINITE || a.exp >= 112)
+      return aBits;
+   mag = roundToIntMag(&a, rm, &huge);
+   vassert(!huge);
+   if (isZeroU128(mag))
+      return packZero(a.sign, &fmtF128);
+   return packIntMag(a.sign, mag);
+}
+
+/* Convert between binary formats.  Widening is always exact. */
+static UI128 convertF ( UI128 aBits, UInt rm, const Fmt* from, const Fmt* to )
+{
+   Unpacked a = unpack(aBits, from);
+   switch (a.cls) {
+      case FC_NAN:  return packNaN(&a, to);
+      case FC_INF:  return packSpecial(a.sign, True/*inf*/, to);
+      case FC_ZERO: return packZero(a.sign, to);
+      default:      return roundPack(a.sign, a.exp, a.sig, rm, to);
+   }
+}
+
+static UI128 i64_to_f128 ( ULong x, Bool isSigned )
+{
+   Bool neg = isSigned && (Long)x < 0;
+   if (x == 0)
+      return packZero(False, &fmtF128);
+   return packIntMag(neg, mkU128(0, neg ? -x : x));
+}
+
+static ULong f128_to_int ( UI128 aBits, UInt rm, Bool isSigned, Int szB )
+{
+   Unpacked a = unpack(aBits, &fmtF128);
+   Int      bits   = 8 * szB;
+   ULong    maxPos = isSigned ? (1ULL << (bits - 1)) - 1
+                              : (bits == 64 ? ~0ULL : (1ULL << bits) - 1);
+   ULong    minNeg = isSigned ? -(1ULL << (bits - 1)) : 0;
+   UI128     mag;
+   Bool     huge;
+
+   switch (a.cls) {
+      case FC_NAN:  return minNeg;
+      case FC_INF:  return a.sign ? minNeg : maxPos;
+      case FC_ZERO: return 0;
+      default:      break;
+   }
+   mag = roundToIntMag(&a, rm, &huge);
+   if (a.sign) {
+      if (huge || mag.hi != 0 || mag.lo > -minNeg)
+         return minNeg;
+      return -mag.lo;
+   }
+   if (huge || mag.hi != 0 || mag.lo > maxPos)
+      return maxPos;
+   return mag.lo;
+}
+
+static ULong f128_cmp ( UI128 aBits, UI128 bBits )
+{
+   Unpacked a = unpack(aBits, &fmtF128);
+   Unpacked b = unpack(bBits, &fmtF128);
+   UI128     aMag = mkU128(aBits.hi & ~(1ULL << 63), aBits.lo);
+   UI128     bMag = mkU128(bBits.hi & ~(1ULL << 63), bBits.lo);
+   Bool     aLess;
+
+   if (a.cls == FC_NAN || b.cls == FC_NAN)
+      return Ircr_UN;
+   if (a.cls == FC_ZERO && b.cls == FC_ZERO)
+      return Ircr_EQ;
+   if (a.sign != b.sign)
+      return a.sign ? Ircr_LT : Ircr_GT;
+   if (aMag.hi == bMag.hi && aMag.lo == bMag.lo)
+      return Ircr_EQ;
+   aLess = toBool(ltU128(aMag, bMag) ^ a.sign);
+   return aLess ? Ircr_LT : Ircr_GT;
+}
+
+ULong h_generic_calc_F128 ( ULong opAndHalf, ULong rm,
+                            ULong aHi, ULong aLo, ULong bHi, ULong bLo )
+{
+   IROp op = (IROp)(opAndHalf >> 1);
+   UI128 a  = mkU128(aHi, aLo);
+   UI128 b  = mkU128(bHi, bLo);
+   UI128 r;
+
+   switch (op) {
+      case Iop_AddF128:      r = f128_add(a, b, rm, False); break;
+      case Iop_SubF128:      r = f128_add(a, b, rm, True);  break;
+      case Iop_MulF128:      r = f128_mul(a, b, rm);        break;
+      case Iop_DivF128:      r = f128_div(a, b, rm);        break;
+      case Iop_SqrtF128:     r = f128_sqrt(a, rm);          break;
+      case Iop_RoundF128toInt:
+                             r = f128_roundToInt(a, rm);    break;
+      /* The 32-bit integer sources arrive widened to 64 bits. */
+      case Iop_I32StoF128:
+      case Iop_I64StoF128:   r = i64_to_f128(aLo, True);    break;
+      case Iop_I32UtoF128:
+      case Iop_I64UtoF128:   r = i64_to_f128(aLo, False);   break;
+      case Iop_F32toF128:
+         r = convertF(mkU128(0, aLo), Irrm_ZERO, &fmtF32, &fmtF128);
+         break;
+      case Iop_F64toF128:
+         r = convertF(mkU128(0, aLo), Irrm_ZERO, &fmtF64, &fmtF128);
+         break;
+
+      case Iop_F128toI32S:   return f128_to_int(a, rm, True,  4);
+      case Iop_F128toI64S:   return f128_to_int(a, rm, True,  8);
+      case Iop_F128toI32U:   return f128_to_int(a, rm, False, 4);
+      case Iop_F128toI64U:   return f128_to_int(a, rm, False, 8);
+      case Iop_F128toF64:    return convertF(a, rm, &fmtF128, &fmtF64).lo;
+      case Iop_F128toF32:    return convertF(a, rm, &fmtF128, &fmtF32).lo;
+      case Iop_CmpF128:      return f128_cmp(a, b);
+
+      default:
+         vpanic("h_generic_calc_F128: unhandled op");
+   }
+   return (opAndHalf & 1) ? r.hi : r.lo;
+}
+
+
+/*---------------------------------------------------------*/
+/*--- Lowering F128 values in IR                        ---*/
+/*---------------------------------------------------------*/
+
+/* Each F128 temp t is retyped to I64 and carries the high half of
+   the value; lo[t] is a new I64 temp carrying the low half.  The
+   input is flat, so every F128 operand is an RdTmp, and the output
+   is kept flat by binding each new intermediate to a temp. */
+
+typedef
+   struct {
+      IRSB*   out;
+      IRTemp* lo;
+      Bool*   wasF128;
+   }
+   LowerEnv;
+
+static IRExpr* mkU64 ( ULong n )
+{
+   return IRExpr_Const(IRConst_U64(n));
+}
+
+static IRTemp bind ( LowerEnv* env, IRType ty, IRExpr* e )
+{
+   IRTemp t = newIRTemp(env->out->tyenv, ty);
+   addStmtToIRSB(env->out, IRStmt_WrTmp(t, e));
+   return t;
+}
+
+static Bool isF128Atom ( const LowerEnv* env, const IRExpr* e )
+{
+   return e->tag == Iex_RdTmp && env->wasF128[e->Iex.RdTmp.tmp];
+}
+
+static IRExpr* hiOf ( const LowerEnv* env, IRExpr* e )
+{
+   vassert(isF128Atom(env, e));
+   return IRExpr_RdTmp(e->Iex.RdTmp.tmp);
+}
+
+static IRExpr* loOf ( const LowerEnv* env, IRExpr* e )
+{
+   vassert(isF128Atom(env, e));
+   return IRExpr_RdTmp(env->lo[e->Iex.RdTmp.tmp]);
+}
+
+/* |a| or |b| may be NULL when the op has fewer F128 operands. */
+static IRExpr* mkCall ( LowerEnv* env, IROp op, Bool hiHalf,
+                        IRExpr* rm64, IRExpr* a, IRExpr* b )
+{
+   IRExpr** args
+      = mkIRExprVec_6(mkU64(((ULong)op << 1) | (hiHalf ? 1 : 0)),
+                      rm64 ? rm64 : mkU64(0),
+                      a ? hiOf(env, a) : mkU64(0),
+                      a ? loOf(env, a) : mkU64(0),
+                      b ? hiOf(env, b) : mkU64(0),
+                      b ? loOf(env, b) : mkU64(0));
+   return mkIRExprCCall(Ity_I64, 0/*regparms*/, "h_generic_calc_F128",
+                        &h_generic_calc_F128, args);
+}
+
+/* As mkCall, but for ops with a single 64-bit non-F128 operand. */
+static IRExpr* mkCallFrom64 ( IROp op, Bool hiHalf, IRExpr* arg64 )
+{
+   IRExpr** args
+      = mkIRExprVec_6(mkU64(((ULong)op << 1) | (hiHalf ? 1 : 0)),
+                      mkU64(0), mkU64(0), arg64, mkU64(0), mkU64(0));
+   return mkIRExprCCall(Ity_I64, 0/*regparms*/, "h_generic_calc_F128",
+                        &h_generic_calc_F128, args);
+}
+
+static IRExpr* rmTo64 ( LowerEnv* env, IRExpr* rm )
+{
+   return IRExpr_RdTmp(bind(env, Ity_I64, IRExpr_Unop(Iop_32Uto64, rm)));
+}
+
+/* Address |off| bytes beyond the atom |addr|. */
+static IRExpr* addrPlus ( LowerEnv* env, IRExpr* addr, Int off )
+{
+   IRType ty = typeOfIRExpr(env->out->tyenv, addr);
+   if (off == 0)
+      return addr;
+   if (ty == Ity_I64)
+      return IRExpr_RdTmp(bind(env, ty, IRExpr_Binop(Iop_Add64, addr,
+                                                     mkU64(off))));
+   vassert(ty == Ity_I32);
+   return IRExpr_RdTmp(bind(env, ty, IRExpr_Binop(Iop_Add32, addr,
+                              IRExpr_Const(IRConst_U32(off)))));
+}
+
+/* Compute the two halves of the F128-typed expression |e|. */
+static void lowerF128Expr ( LowerEnv* env, IRExpr* e, VexEndness end,
+                            /*OUT*/IRExpr** hi, /*OUT*/IRExpr** lo )
+{
+   Int  offHi = end == VexEndnessLE ? 8 : 0;
+   Int  offLo = 8 - offHi;
+   IROp op;
+
+   switch (e->tag) {
+      case Iex_RdTmp:
+         *hi = hiOf(env, e);
+         *lo = loOf(env, e);
+         return;
+      case Iex_Get:
+         *hi = IRExpr_Get(e->Iex.Get.offset + offHi, Ity_I64);
+         *lo = IRExpr_Get(e->Iex.Get.offset + offLo, Ity_I64);
+         return;
+      case Iex_Load: {
+         IRExpr* addr = e->Iex.Load.addr;
+         offHi = e->Iex.Load.end == Iend_LE ? 8 : 0;
+         offLo = 8 - offHi;
+         *hi = IRExpr_Load(e->Iex.Load.end, Ity_I64,
+                           addrPlus(env, addr, offHi));
+         *lo = IRExpr_Load(e->Iex.Load.end, Ity_I64,
+                           addrPlus(env, addr, offLo));
+         return;
+      }
+      case Iex_ITE:
+         *hi = IRExpr_ITE(e->Iex.ITE.cond, hiOf(env, e->Iex.ITE.iftrue),
+                                           hiOf(env, e->Iex.ITE.iffalse));
+         *lo = IRExpr_ITE(e->Iex.ITE.cond, loOf(env, e->Iex.ITE.iftrue),
+                                           loOf(env, e->Iex.ITE.iffalse));
+         return;
+      case Iex_Unop: {
+         IRExpr* arg = e->Iex.Unop.arg;
+         IRExpr* a64;
+         op = e->Iex.Unop.op;
+         switch (op) {
+            case Iop_NegF128:
+               *hi = IRExpr_Binop(Iop_Xor64, hiOf(env, arg),
+                                  mkU64(0x8000000000000000ULL));
+               *lo = loOf(env, arg);
+               return;
+            case Iop_AbsF128:
+               *hi = IRExpr_Binop(Iop_And64, hiOf(env, arg),
+                                  mkU64(0x7FFFFFFFFFFFFFFFULL));
+               *lo = loOf(env, arg);
+               return;
+            case Iop_I32StoF128:
+               a64 = IRExpr_RdTmp(bind(env, Ity_I64,
+                                       IRExpr_Unop(Iop_32Sto64, arg)));
+               break;
+            case Iop_I32UtoF128:
+               a64 = IRExpr_RdTmp(bind(env, Ity_I64,
+                                       IRExpr_Unop(Iop_32Uto64, arg)));
+               break;
+            case Iop_I64StoF128:
+            case Iop_I64UtoF128:
+               a64 = arg;
+               break;
+            case Iop_F32toF128: {
+               IRTemp i32 = bind(env, Ity_I32,
+                                 IRExpr_Unop(Iop_ReinterpF32asI32, arg));
+               a64 = IRExpr_RdTmp(bind(env, Ity_I64,
+                                       IRExpr_Unop(Iop_32Uto64,
+                                                   IRExpr_RdTmp(i32))));
+               break;
+            }
+            case Iop_F64toF128:
+               a64 = IRExpr_RdTmp(bind(env, Ity_I64,
+                                       IRExpr_Unop(Iop_ReinterpF64asI64,
+                                                   arg)));
+               break;
+            default:
+               goto unhandled;
+         }
+         *hi = mkCallFrom64(op, True,  a64);
+         *lo = mkCallFrom64(op, False, a64);
+         return;
+      }
+      case Iex_Binop: {
+         IRExpr* arg1 = e->Iex.Binop.arg1;
+         IRExpr* arg2 = e->Iex.Binop.arg2;
+         IRExpr* rm64;
+         op = e->Iex.Binop.op;
+         switch (op) {
+            case Iop_F64HLtoF128:
+               *hi = IRExpr_Unop(Iop_ReinterpF64asI64, arg1);
+               *lo = IRExpr_Unop(Iop_ReinterpF64asI64, arg2);
+               return;
+            case Iop_SqrtF128:
+            case Iop_RoundF128toInt:
+               rm64 = rmTo64(env, arg1);
+               *hi = mkCall(env, op, True,  rm64, arg2, NULL);
+               *lo = mkCall(env, op, False, rm64, arg2, NULL);
+               return;
+            default:
+               goto unhandled;
+         }
+      }
+      case Iex_Triop: {
+         IRTriop* tri = e->Iex.Triop.details;
+         IRExpr*  rm64;
+         op = tri->op;
+         switch (op) {
+            case Iop_AddF128: case Iop_SubF128:
+            case Iop_MulF128: case Iop_DivF128:
+               rm64 = rmTo64(env, tri->arg1);
+               *hi = mkCall(env, op, True,  rm64, tri->arg2, tri->arg3);
+               *lo = mkCall(env, op, False, rm64, tri->arg2, tri->arg3);
+               return;
+            default:
+               goto unhandled;
+         }
+      }
+      default:
+         break;
+   }
+  unhandled:
+   ppIRExpr(e);
+   vpanic("do_F128_lowering_BB: unhandled F128 expression");
+}
+
+/* Compute into |dst| the non-F128 result of |e|, which has at least
+   one F128 operand. */
+static void lowerFromF128 ( LowerEnv* env, IRTemp dst, IRExpr* e )
+{
+   IRExpr* res;
+   IRTemp  r64;
+
+   if (e->tag == Iex_Unop) {
+      switch (e->Iex.Unop.op) {
+         case Iop_F128HItoF64:
+            res = IRExpr_Unop(Iop_ReinterpI64asF64,
+                              hiOf(env, e->Iex.Unop.arg));
+            addStmtToIRSB(env->out, IRStmt_WrTmp(dst, res));
+            return;
+         case Iop_F128LOtoF64:
+            res = IRExpr_Unop(Iop_ReinterpI64asF64,
+                              loOf(env, e->Iex.Unop.arg));
+            addStmtToIRSB(env->out, IRStmt_WrTmp(dst, res));
+            return;
+         default:
+            break;
+      }
+   }
+   else if (e->tag == Iex_Binop) {
+      IROp op = e->Iex.Binop.op;
+      switch (op) {
+         case Iop_CmpF128:
+            r64 = bind(env, Ity_I64, mkCall(env, op, False, NULL,
+                                            e->Iex.Binop.arg1,
+                                            e->Iex.Binop.arg2));
+            res = IRExpr_Unop(Iop_64to32, IRExpr_RdTmp(r64));
+            addStmtToIRSB(env->out, IRStmt_WrTmp(dst, res));
+            return;
+         case Iop_F128toI32S: case Iop_F128toI32U:
+         case Iop_F128toI64S: case Iop_F128toI64U:
+         case Iop_F128toF64:  case Iop_F128toF32:
+            r64 = bind(env, Ity_I64,
+                       mkCall(env, op, False,
+                              rmTo64(env, e->Iex.Binop.arg1),
+                              e->Iex.Binop.arg2, NULL));
+            res = IRExpr_RdTmp(r64);
+            if (op == Iop_F128toI32S || op == Iop_F128toI32U)
+               res = IRExpr_Unop(Iop_64to32, res);
+            else if (op == Iop_F128toF64)
+               res = IRExpr_Unop(Iop_ReinterpI64asF64, res);
+            else if (op == Iop_F128toF32)
+               res = IRExpr_Unop(Iop_ReinterpI32asF32,
+                        IRExpr_RdTmp(bind(env, Ity_I32,
+                                          IRExpr_Unop(Iop_64to32, res))));
+            addStmtToIRSB(env->out, IRStmt_WrTmp(dst, res));
+            return;
+         default:
+            break;
+      }
+   }
+   ppIRExpr(e);
+   vpanic("do_F128_lowering_BB: unhandled use of an F128 value");
+}
+
+/* Whether any operand of the flat expression |e| is an F128 temp. */
+static Bool usesF128 ( const LowerEnv* env, const IRExpr* e )
+{
+   switch (e->tag) {
+      case Iex_Unop:
+         return isF128Atom(env, e->Iex.Unop.arg);
+      case Iex_Binop:
+         return isF128Atom(env, e->Iex.Binop.arg1)
+                || isF128Atom(env, e->Iex.Binop.arg2);
+      case Iex_Triop:
+         return isF128Atom(env, e->Iex.Triop.details->arg2)
+                || isF128Atom(env, e->Iex.Triop.details->arg3);
+      case Iex_Qop:
+         return isF128Atom(env, e->Iex.Qop.details->arg2)
+                || isF128Atom(env, e->Iex.Qop.details->arg3)
+                || isF128Atom(env, e->Iex.Qop.details->arg4);
+      default:
+         return False;
+   }
+}
+
+IRSB* do_F128_lowering_BB ( IRSB* bb, VexEndness hostEnd )
+{
+   LowerEnv env;
+   IRTemp   t;
+   Int      i, nTmps = bb->tyenv->types_used;
+   Bool     any = False;
+   Int      offHi = hostEnd == VexEndnessLE ? 8 : 0;
+   Int      offLo = 8 - offHi;
+
+   for (t = 0; t < nTmps; t++)
+      if (bb->tyenv->types[t] == Ity_F128)
+         any = True;
+   if (!any)
+      return bb;
+
+   env.out     = deepCopyIRSBExceptStmts(bb);
+   env.lo      = LibVEX_Alloc_inline(nTmps * sizeof(IRTemp));
+   env.wasF128 = LibVEX_Alloc_inline(nTmps * sizeof(Bool));
+   for (t = 0; t < nTmps; t++) {
+      env.lo[t]      = IRTemp_INVALID;
+      env.wasF128[t] = env.out->tyenv->types[t] == Ity_F128;
+      if (env.wasF128[t]) {
+         env.out->tyenv->types[t] = Ity_I64;
+         env.lo[t] = newIRTemp(env.out->tyenv, Ity_I64);
+      }
+   }
+
+   for (i = 0; i < bb->stmts_used; i++) {
+      IRStmt* st = bb->stmts[i];
+      switch (st->tag) {
+         case Ist_WrTmp: {
+            IRTemp  dst = st->Ist.WrTmp.tmp;
+            IRExpr* e   = st->Ist.WrTmp.data;
+            if (env.wasF128[dst]) {
+               IRExpr *hi, *lo;
+               lowerF128Expr(&env, e, hostEnd, &hi, &lo);
+               addStmtToIRSB(env.out, IRStmt_WrTmp(dst, hi));
+               addStmtToIRSB(env.out, IRStmt_WrTmp(env.lo[dst], lo));
+               continue;
+            }
+            if (usesF128(&env, e)) {
+               lowerFromF128(&env, dst, e);
+               continue;
+            }
+            break;
+         }
+         case Ist_Put:
+            if (isF128Atom(&env, st->Ist.Put.data)) {
+               addStmtToIRSB(env.out,
+                  IRStmt_Put(st->Ist.Put.offset + offHi,
+                             hiOf(&env, st->Ist.Put.data)));
+               addStmtToIRSB(env.out,
+                  IRStmt_Put(st->Ist.Put.offset + offLo,
+                             loOf(&env, st->Ist.Put.data)));
+               continue;
+            }
+            break;
+         case Ist_Store:
+            if (isF128Atom(&env, st->Ist.Store.data)) {
+               IREndness end = st->Ist.Store.end;
+               Int sOffHi = end == Iend_LE ? 8 : 0;
+               IRExpr* aHi = addrPlus(&env, st->Ist.Store.addr, sOffHi);
+               IRExpr* aLo = addrPlus(&env, st->Ist.Store.addr,
+                                      8 - sOffHi);
+               addStmtToIRSB(env.out,
+                  IRStmt_Store(end, aHi, hiOf(&env, st->Ist.Store.data)));
+               addStmtToIRSB(env.out,
+                  IRStmt_Store(end, aLo, loOf(&env, st->Ist.Store.data)));
+               continue;
+            }
+            break;
+         case Ist_PutI:
+            if (isF128Atom(&env, st->Ist.PutI.details->data))
+               goto unhandled;
+            break;
+         case Ist_StoreG:
+            if (isF128Atom(&env, st->Ist.StoreG.details->data))
+               goto unhandled;
+            break;
+         case Ist_Dirty: {
+            IRDirty* d = st->Ist.Dirty.details;
+            Int j;
+            if (d->tmp != IRTemp_INVALID && env.wasF128[d->tmp])
+               goto unhandled;
+            for (j = 0; d->args[j]; j++)
+               if (!is_IRExpr_VECRET_or_BBPTR(d->args[j])
+                   && isF128Atom(&env, d->args[j]))
+                  goto unhandled;
+            break;
+         }
+         default:
+            break;
+      }
+      addStmtToIRSB(env.out, st);
+      continue;
+     unhandled:
+      ppIRStmt(st);
+      vpanic("do_F128_lowering_BB: unhandled F128 statement");
+   }
+   return env.out;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                 host_generic_f128.c ---*/
+/*---------------------------------------------------------------*/
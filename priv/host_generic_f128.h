@@ -0,0 +1,72 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                               host_generic_f128.h ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Software IEEE754 binary128 arithmetic, for hosts whose instruction
+   selectors cannot handle Ity_F128 values or the F128 primops.
+
+   do_F128_lowering_BB rewrites a flat IRSB so that every F128 value
+   is carried as a pair of I64 halves, and every F128 primop other
+   than the trivial ones (NegF128, AbsF128, F64HLtoF128, F128HItoF64,
+   F128LOtoF64) becomes a call to the clean helper
+   h_generic_calc_F128.  The helper is purely integer code, so it
+   neither depends on nor disturbs the host's FP state, and honours
+   all eight IRRoundingModes.
+
+   The DFP <-> F128 conversions are not handled; blocks using them
+   still can't be compiled for such hosts.
+*/
+
+#ifndef __VEX_HOST_GENERIC_F128_H
+#define __VEX_HOST_GENERIC_F128_H
+
+#include "libvex_basictypes.h"
+#include "libvex_ir.h"
+#include "libvex.h"
+
+/* Compute half of the result of the F128 primop |opAndHalf >> 1|.
+   F128 operands are passed as (hi,lo) pairs of their bit patterns,
+   and narrower operands in aLo.  For ops producing an F128, bit 0 of
+   |opAndHalf| selects the high (1) or low (0) half of the result;
+   all other results are returned in the low bits. */
+extern
+ULong h_generic_calc_F128 ( ULong opAndHalf, ULong rm,
+                            ULong aHi, ULong aLo, ULong bHi, ULong bLo );
+
+/* Replace all F128 values and operations in |bb| as described above.
+   |hostEnd| determines how an F128 is laid out in the guest state.
+   Returns a new BB, or bb itself if it contains no F128 values. */
+extern
+IRSB* do_F128_lowering_BB ( IRSB* bb, VexEndness hostEnd );
+
+#endif /* ndef __VEX_HOST_GENERIC_F128_H */
+
+/*---------------------------------------------------------------*/
+/*--- end                                 host_generic_f128.h ---*/
+/*---------------------------------------------------------------*/
@@ -226,6 +226,32 @@ static void ensureRRLRspace ( RRegLR** info, Int* size, Int used )
 }
 
 
+/* Append 'ix' to the emission order of 'hs', doubling the order
+   array if needed. */
+__attribute__((noinline))
+static void addToOrder_SLOW ( HInstrSeq* hs, Int ix )
+{
+   Int  k;
+   Int* order2;
+   vassert(hs->order_used == hs->order_size);
+   order2 = LibVEX_Alloc_inline(2 * hs->order_size * sizeof(Int));
+   for (k = 0; k < hs->order_size; k++)
+      order2[k] = hs->order[k];
+   hs->order_size *= 2;
+   hs->order = order2;
+   hs->order[hs->order_used++] = ix;
+}
+inline
+static void addToOrder ( HInstrSeq* hs, Int ix )
+{
+   if (LIKELY(hs->order_used < hs->order_size)) {
+      hs->order[hs->order_used++] = ix;
+      return;
+   }
+   addToOrder_SLOW(hs, ix);
+}
+
+
 /* Sort an array of RRegLR entries by either the .live_after or
    .dead_before fields.  This is performance-critical. */
 static void sortRRLRarray ( RRegLR* arr, 
@@ -341,20 +367,22 @@ static void* local_memset ( void *destV, Int c, SizeT sz )
    functions which it uses to deal abstractly with instructions and
    registers, since it cannot have any target-specific knowledge.
 
-   Returns a new list of instructions, which, as a result of the
-   behaviour of mapRegs, will be in-place modifications of the
-   original instructions.
+   Returns the instructions to emit, most of which, as a result of
+   the behaviour of mapRegs, will be in-place modifications of the
+   original instructions, with the spills and reloads it needs
+   linked in between them by index rather than copied.
 
    Requires that the incoming code has been generated using
    vreg numbers 0, 1 .. n_vregs-1.  Appearance of a vreg outside
    that range is a checked run-time error.
 
-   Takes an expandable array of pointers to unallocated insns.
-   Returns an expandable array of pointers to allocated insns.
+   Takes an expandable array of unallocated insns.
+   Returns a sequence of allocated insns.
 */
-HInstrArray* doRegisterAllocation (
+HInstrSeq* doRegisterAllocation (
 
-   /* Incoming virtual-registerised code. */ 
+   /* Incoming virtual-registerised code.  This is rewritten in place
+      and ends up as the 'insns' of the result. */
    HInstrArray* instrs_in,
 
    /* The real-register universe to use.  This contains facts about
@@ -440,8 +468,8 @@ HInstrArray* doRegisterAllocation (
       instr. */
    HRegRemap remap;
 
-   /* The output array of instructions. */
-   HInstrArray* instrs_out;
+   /* The output sequence of instructions. */
+   HInstrSeq* instrs_out;
 
    /* Sanity checks are expensive.  They are only done periodically,
       not at each insn processed. */
@@ -458,15 +486,29 @@ HInstrArray* doRegisterAllocation (
 
 #  define INVALID_INSTRNO (-2)
 
-#  define EMIT_INSTR(_instr)                  \
-      do {                                    \
-        HInstr* _tmp = (_instr);              \
-        if (DEBUG_REGALLOC) {                 \
-           vex_printf("**  ");                \
-           (*ppInstr)(_tmp, mode64);          \
-           vex_printf("\n\n");                \
-        }                                     \
-        addHInstr ( instrs_out, _tmp );       \
+   /* Emit a spill or reload, by copying it into instrs_out->extra. */
+#  define EMIT_INSTR(_instr)                                  \
+      do {                                                    \
+        HInstr* _tmp = (_instr);                              \
+        if (DEBUG_REGALLOC) {                                 \
+           vex_printf("**  ");                                \
+           (*ppInstr)(_tmp, mode64);                          \
+           vex_printf("\n\n");                                \
+        }                                                     \
+        addHInstr ( instrs_out->extra, _tmp );                \
+        addToOrder ( instrs_out,                              \
+                     -instrs_out->extra->arr_used );          \
+      } while (0)
+
+   /* Emit instrs_in[_ii], which stays where it is. */
+#  define EMIT_INSTR_IN(_ii)                                  \
+      do {                                                    \
+        if (DEBUG_REGALLOC) {                                 \
+           vex_printf("**  ");                                \
+           (*ppInstr)(getHInstr(instrs_in, (_ii)), mode64);   \
+           vex_printf("\n\n");                                \
+        }                                                     \
+        addToOrder ( instrs_out, (_ii) );                     \
       } while (0)
 
 #   define PRINT_STATE						   \
@@ -501,7 +543,13 @@ HInstrArray* doRegisterAllocation (
    /* --------- Stage 0: set up output array --------- */
    /* --------- and allocate/initialise running state. --------- */
 
-   instrs_out = newHInstrArray();
+   instrs_out = LibVEX_Alloc_inline(sizeof(HInstrSeq));
+   instrs_out->insns      = instrs_in;
+   instrs_out->extra      = newHInstrArray(instrs_in->stride, 0);
+   instrs_out->order_size = instrs_in->arr_used + 8;
+   instrs_out->order_used = 0;
+   instrs_out->order
+      = LibVEX_Alloc_inline(instrs_out->order_size * sizeof(Int));
 
    /* ... and initialise running state. */
    /* n_rregs is no more than a short name for n_available_real_regs. */
@@ -587,11 +635,11 @@ HInstrArray* doRegisterAllocation (
 
    for (Int ii = 0; ii < instrs_in->arr_used; ii++) {
 
-      (*getRegUsage)( &reg_usage_arr[ii], instrs_in->arr[ii], mode64 );
+      (*getRegUsage)( &reg_usage_arr[ii], getHInstr(instrs_in, ii), mode64 );
 
       if (0) {
          vex_printf("\n%d  stage1: ", ii);
-         (*ppInstr)(instrs_in->arr[ii], mode64);
+         (*ppInstr)(getHInstr(instrs_in, ii), mode64);
          vex_printf("\n");
          ppHRegUsage(univ, &reg_usage_arr[ii]);
       }
@@ -607,7 +655,7 @@ HInstrArray* doRegisterAllocation (
          Int k = hregIndex(vreg);
          if (k < 0 || k >= n_vregs) {
             vex_printf("\n");
-            (*ppInstr)(instrs_in->arr[ii], mode64);
+            (*ppInstr)(getHInstr(instrs_in, ii), mode64);
             vex_printf("\n");
             vex_printf("vreg %d, n_vregs %d\n", k, n_vregs);
             vpanic("doRegisterAllocation: out-of-range vreg");
@@ -715,7 +763,7 @@ HInstrArray* doRegisterAllocation (
                (*ppReg)(univ->regs[j]);
                vex_printf("\n");
                vex_printf("\nOFFENDING instr = ");
-               (*ppInstr)(instrs_in->arr[ii], mode64);
+               (*ppInstr)(getHInstr(instrs_in, ii), mode64);
                vex_printf("\n");
                vpanic("doRegisterAllocation: "
                       "first event for rreg is Read");
@@ -728,7 +776,7 @@ HInstrArray* doRegisterAllocation (
                (*ppReg)(univ->regs[j]);
                vex_printf("\n");
                vex_printf("\nOFFENDING instr = ");
-               (*ppInstr)(instrs_in->arr[ii], mode64);
+               (*ppInstr)(getHInstr(instrs_in, ii), mode64);
                vex_printf("\n");
                vpanic("doRegisterAllocation: "
                       "first event for rreg is Modify");
@@ -984,7 +1032,7 @@ HInstrArray* doRegisterAllocation (
       if (DEBUG_REGALLOC) {
          vex_printf("\n====----====---- Insn %d ----====----====\n", ii);
          vex_printf("---- ");
-         (*ppInstr)(instrs_in->arr[ii], mode64);
+         (*ppInstr)(getHInstr(instrs_in, ii), mode64);
          vex_printf("\n\nInitial state:\n");
          PRINT_STATE;
          vex_printf("\n");
@@ -1100,7 +1148,7 @@ HInstrArray* doRegisterAllocation (
          the dst to the src's rreg, and that's all. */
       HReg vregS = INVALID_HREG;
       HReg vregD = INVALID_HREG;
-      if ( (*isMove)( instrs_in->arr[ii], &vregS, &vregD ) ) {
+      if ( (*isMove)( getHInstr(instrs_in, ii), &vregS, &vregD ) ) {
          if (!hregIsVirtual(vregS)) goto cannot_coalesce;
          if (!hregIsVirtual(vregD)) goto cannot_coalesce;
          /* Check that *isMove is not telling us a bunch of lies ... */
@@ -1267,8 +1315,8 @@ HInstrArray* doRegisterAllocation (
          can convert the instruction into one that reads directly from
          the spill slot.  This is clearly only possible for x86 and
          amd64 targets, since ppc and arm are load-store
-         architectures.  If successful, replace instrs_in->arr[ii]
-         with this new instruction, and recompute its reg usage, so
+         architectures.  If successful, replace instrs_in[ii] with
+         this new instruction, and recompute its reg usage, so
          that the change is invisible to the standard-case handling
          that follows. */
       
@@ -1306,19 +1354,21 @@ HInstrArray* doRegisterAllocation (
                vassert(! sameHReg(reg_usage_arr[ii].vRegs[0],
                                   reg_usage_arr[ii].vRegs[1]));
 
-            reloaded = directReload ( instrs_in->arr[ii], cand, spilloff );
+            reloaded = directReload ( getHInstr(instrs_in, ii),
+                                      cand, spilloff );
             if (debug_direct_reload && !reloaded) {
                vex_printf("[%3d] ", spilloff); ppHReg(cand); vex_printf(" "); 
-               ppInstr(instrs_in->arr[ii], mode64); 
+               ppInstr(getHInstr(instrs_in, ii), mode64); 
             }
             if (reloaded) {
                /* Update info about the insn, so it looks as if it had
                   been in this form all along. */
-               instrs_in->arr[ii] = reloaded;
-               (*getRegUsage)( &reg_usage_arr[ii], instrs_in->arr[ii], mode64 );
+               setHInstr(instrs_in, ii, reloaded);
+               (*getRegUsage)( &reg_usage_arr[ii],
+                               getHInstr(instrs_in, ii), mode64 );
                if (debug_direct_reload && !reloaded) {
                   vex_printf("  -->  ");
-                  ppInstr(reloaded, mode64);
+                  ppInstr(getHInstr(instrs_in, ii), mode64);
                }
             }
 
@@ -1545,9 +1595,9 @@ HInstrArray* doRegisterAllocation (
         and emit that.
       */
 
-      /* NOTE, DESTRUCTIVELY MODIFIES instrs_in->arr[ii]. */
-      (*mapRegs)( &remap, instrs_in->arr[ii], mode64 );
-      EMIT_INSTR( instrs_in->arr[ii] );
+      /* NOTE, DESTRUCTIVELY MODIFIES instrs_in[ii]. */
+      (*mapRegs)( &remap, getHInstr(instrs_in, ii), mode64 );
+      EMIT_INSTR_IN( ii );
 
       if (DEBUG_REGALLOC) {
          vex_printf("After dealing with current insn:\n");
@@ -1604,6 +1654,7 @@ HInstrArray* doRegisterAllocation (
 
 #  undef INVALID_INSTRNO
 #  undef EMIT_INSTR
+#  undef EMIT_INSTR_IN
 #  undef PRINT_STATE
 }
 
@@ -282,12 +282,17 @@ HReg lookupHRegRemap ( HRegRemap* map, HReg orig )
 /*--- Abstract instructions                             ---*/
 /*---------------------------------------------------------*/
 
-HInstrArray* newHInstrArray ( void )
+HInstrArray* newHInstrArray ( UInt stride, Int size_hint )
 {
+   vassert(stride > 0 && stride % sizeof(HWord) == 0);
+   vassert(size_hint >= 0);
    HInstrArray* ha = LibVEX_Alloc_inline(sizeof(HInstrArray));
-   ha->arr_size = 4;
+   ha->stride   = stride;
+   ha->arr_size = size_hint;
    ha->arr_used = 0;
-   ha->arr      = LibVEX_Alloc_inline(ha->arr_size * sizeof(HInstr*));
+   ha->arr      = size_hint == 0
+                     ? NULL
+                     : LibVEX_Alloc_inline((SizeT)size_hint * stride);
    ha->n_vregs  = 0;
    return ha;
 }
@@ -296,13 +301,15 @@ __attribute__((noinline))
 void addHInstr_SLOW ( HInstrArray* ha, HInstr* instr )
 {
    vassert(ha->arr_used == ha->arr_size);
-   Int      i;
-   HInstr** arr2 = LibVEX_Alloc_inline(ha->arr_size * 2 * sizeof(HInstr*));
-   for (i = 0; i < ha->arr_size; i++) {
-      arr2[i] = ha->arr[i];
+   Int    size2 = ha->arr_size == 0 ? 8 : 2 * ha->arr_size;
+   SizeT  i, n  = (SizeT)ha->arr_size * ha->stride / sizeof(HWord);
+   HWord* arr   = (HWord*)ha->arr;
+   HWord* arr2  = LibVEX_Alloc_inline((SizeT)size2 * ha->stride);
+   for (i = 0; i < n; i++) {
+      arr2[i] = arr[i];
    }
-   ha->arr_size *= 2;
-   ha->arr = arr2;
+   ha->arr_size = size2;
+   ha->arr = (UChar*)arr2;
    addHInstr(ha, instr);
 }
 
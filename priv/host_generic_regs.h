@@ -37,6 +37,7 @@
 #define __VEX_HOST_GENERIC_REGS_H
 
 #include "libvex_basictypes.h"
+#include "main_util.h"            // LibVEX_Unalloc_inline
 
 
 /*---------------------------------------------------------*/
@@ -342,38 +343,92 @@ static inline void initHRegRemap ( HRegRemap* map )
 typedef  void  HInstr;
 
 
-/* An expandable array of HInstr*'s.  Handy for insn selection and
-   register allocation.  n_vregs indicates the number of virtual
+/* An expandable array of host instructions, held by value: element i
+   is the 'stride' bytes at arr + i * stride, where 'stride' is the
+   size of the target's instruction type.  Handy for insn selection
+   and register allocation.  n_vregs indicates the number of virtual
    registers mentioned in the code, something that reg-alloc needs to
-   know.  These are required to be numbered 0 .. n_vregs-1. 
+   know.  These are required to be numbered 0 .. n_vregs-1.
+
+   Operands too big to sit in the instruction itself (amodes, RMIs
+   and the like) stay where their constructors put them, and the
+   instruction points at them.  Pointers returned by getHInstr are
+   only good until the next addHInstr, which may move the array.
 */
 typedef
    struct {
-      HInstr** arr;
-      Int      arr_size;
-      Int      arr_used;
-      Int      n_vregs;
+      UChar* arr;
+      UInt   stride;
+      Int    arr_size;
+      Int    arr_used;
+      Int    n_vregs;
    }
    HInstrArray;
 
-extern HInstrArray* newHInstrArray ( void );
+/* 'size_hint' is how many instructions the caller expects to add.
+   Getting it a bit high is cheaper than getting it a bit low, since
+   growing the array leaves the old one behind in the arena.  Zero
+   means nothing is allocated until the first addHInstr. */
+extern HInstrArray* newHInstrArray ( UInt stride, Int size_hint );
+
+static inline HInstr* getHInstr ( const HInstrArray* ha, Int i )
+{
+   return ha->arr + (SizeT)i * ha->stride;
+}
+
+/* Copy 'instr' into slot 'i'.  If 'instr' was the last thing
+   allocated, as it is when it comes straight from one of the
+   target's constructors, its space is given back, so it must not be
+   looked at afterwards. */
+static inline void setHInstr ( HInstrArray* ha, Int i, HInstr* instr )
+{
+   HWord*       dst = getHInstr(ha, i);
+   const HWord* src = instr;
+   UInt         j;
+   for (j = 0; j < ha->stride / sizeof(HWord); j++)
+      dst[j] = src[j];
+   LibVEX_Unalloc_inline(instr, ha->stride);
+}
 
 /* Never call this directly.  It's the slow and incomplete path for
    addHInstr. */
 __attribute__((noinline))
 extern void addHInstr_SLOW ( HInstrArray*, HInstr* );
 
+/* Copy 'instr' onto the end of 'ha', as for setHInstr. */
 static inline void addHInstr ( HInstrArray* ha, HInstr* instr )
 {
    if (LIKELY(ha->arr_used < ha->arr_size)) {
-      ha->arr[ha->arr_used] = instr;
       ha->arr_used++;
+      setHInstr(ha, ha->arr_used-1, instr);
    } else {
       addHInstr_SLOW(ha, instr);
    }
 }
 
 
+/* The register allocator's output: the instructions in the order they
+   are to be emitted.  Most of them are the allocator's input, mapped
+   in place; the spills and reloads it adds go in 'extra'.  Entry i of
+   'order' is an index into 'insns' if it is zero or more, and
+   otherwise names element -1-i of 'extra'. */
+typedef
+   struct {
+      HInstrArray* insns;
+      HInstrArray* extra;
+      Int*         order;
+      Int          order_size;
+      Int          order_used;
+   }
+   HInstrSeq;
+
+static inline HInstr* getHInstrInSeq ( const HInstrSeq* hs, Int i )
+{
+   Int ix = hs->order[i];
+   return ix >= 0 ? getHInstr(hs->insns, ix) : getHInstr(hs->extra, -1-ix);
+}
+
+
 /*---------------------------------------------------------*/
 /*--- C-Call return-location descriptions               ---*/
 /*---------------------------------------------------------*/
@@ -443,9 +498,10 @@ static inline Bool is_RetLoc_INVALID ( RetLoc rl ) {
 /*---------------------------------------------------------*/
 
 extern
-HInstrArray* doRegisterAllocation (
+HInstrSeq* doRegisterAllocation (
 
-   /* Incoming virtual-registerised code. */ 
+   /* Incoming virtual-registerised code.  This is rewritten in place
+      and ends up as the 'insns' of the result. */
    HInstrArray* instrs_in,
 
    /* The real-register universe to use.  This contains facts about
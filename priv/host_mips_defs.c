@@ -712,6 +712,14 @@ const HChar *showMIPSAluOp(MIPSAluOp op, Bool immR)
       case Malu_SLT:
          ret = immR ? "slti" : "slt";
          break;
+      case Malu_SELEQZ:
+         vassert(immR == False);
+         ret = "seleqz";
+         break;
+      case Malu_SELNEZ:
+         vassert(immR == False);
+         ret = "selnez";
+         break;
       default:
          vpanic("showMIPSAluOp");
          break;
@@ -2624,6 +2632,18 @@ Int emit_MIPSInstr ( /*MB_MOD*/Bool* is_profInc,
                   p = mkFormR(p, 0, r_srcL, r_srcR, r_dst, 0, 42);
                }
                break;
+            case Malu_SELEQZ:
+               /* seleqz: r_dst = r_srcR == 0 ? r_srcL : 0 */
+               if (immR)
+                  goto bad;
+               p = mkFormR(p, 0, r_srcL, r_srcR, r_dst, 0, 0x35);
+               break;
+            case Malu_SELNEZ:
+               /* selnez: r_dst = r_srcR != 0 ? r_srcL : 0 */
+               if (immR)
+                  goto bad;
+               p = mkFormR(p, 0, r_srcL, r_srcR, r_dst, 0, 0x37);
+               break;
 
             default:
                goto bad;
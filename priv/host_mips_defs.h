@@ -241,7 +241,8 @@ typedef enum {
    Malu_ADD, Malu_SUB,
    Malu_AND, Malu_OR, Malu_NOR, Malu_XOR,
    Malu_DADD, Malu_DSUB,
-   Malu_SLT
+   Malu_SLT,
+   Malu_SELEQZ, Malu_SELNEZ  /* MIPS32/64 R6 only */
 } MIPSAluOp;
 
 extern const HChar *showMIPSAluOp(MIPSAluOp,
@@ -159,11 +159,11 @@ lookupIRTempPair(HReg * vrHI, HReg * vrLO, ISelEnv * env, IRTemp tmp)
 
 static void addInstr(ISelEnv * env, MIPSInstr * instr)
 {
-   addHInstr(env->code, instr);
    if (vex_traceflags & VEX_TRACE_VCODE) {
       ppMIPSInstr(instr, mode64);
       vex_printf("\n");
    }
+   addHInstr(env->code, instr);
 }
 
 static HReg newVRegI(ISelEnv * env)
@@ -330,6 +330,44 @@ static MIPSInstr *mk_iMOVds_RR(HReg r_dst, HReg r_src)
    return MIPSInstr_Alu(Malu_OR, r_dst, r_src, MIPSRH_Reg(r_src));
 }
 
+/* R6 removed movn/movz in favour of seleqz/selnez. */
+static inline Bool hasMIPSR6 ( UInt hwcaps )
+{
+   return toBool(VEX_MIPS_EX_INFO(hwcaps)
+                 & (VEX_MIPS_CPU_ISA_M32R6 | VEX_MIPS_CPU_ISA_M64R6));
+}
+
+/* r_dst = r_cond != 0 ? r_src : r_dst */
+static void mk_iMOVN ( ISelEnv* env, HReg r_dst, HReg r_src, HReg r_cond )
+{
+   if (hasMIPSR6(env->hwcaps)) {
+      HReg t = newVRegI(env);
+      addInstr(env, MIPSInstr_Alu(Malu_SELNEZ, t, r_src, MIPSRH_Reg(r_cond)));
+      addInstr(env, MIPSInstr_Alu(Malu_SELEQZ, r_dst, r_dst,
+                                  MIPSRH_Reg(r_cond)));
+      addInstr(env, MIPSInstr_Alu(Malu_OR, r_dst, r_dst, MIPSRH_Reg(t)));
+   } else {
+      addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, r_dst, r_src, r_cond));
+   }
+}
+
+/* r_dst = r_cond != 0 ? r_iftrue : r_iffalse, for a fresh r_dst. */
+static void mk_iSELECT ( ISelEnv* env, HReg r_dst, HReg r_iftrue,
+                         HReg r_iffalse, HReg r_cond )
+{
+   if (hasMIPSR6(env->hwcaps)) {
+      HReg t = newVRegI(env);
+      addInstr(env, MIPSInstr_Alu(Malu_SELNEZ, t, r_iftrue,
+                                  MIPSRH_Reg(r_cond)));
+      addInstr(env, MIPSInstr_Alu(Malu_SELEQZ, r_dst, r_iffalse,
+                                  MIPSRH_Reg(r_cond)));
+      addInstr(env, MIPSInstr_Alu(Malu_OR, r_dst, r_dst, MIPSRH_Reg(t)));
+   } else {
+      addInstr(env, mk_iMOVds_RR(r_dst, r_iffalse));
+      mk_iMOVN(env, r_dst, r_iftrue, r_cond);
+   }
+}
+
 /*---------------------------------------------------------*/
 /*--- ISEL: Function call helpers                       ---*/
 /*---------------------------------------------------------*/
@@ -1059,8 +1097,7 @@ static HReg iselWordExpr_R_wrk(ISelEnv * env, IRExpr * e)
                movn v0, s0, v1 */
 
             addInstr(env, MIPSInstr_Alu(Malu_SLT, tmp, argL, argRH));
-            addInstr(env, mk_iMOVds_RR(r_dst, argL));
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, r_dst, argR, tmp));
+            mk_iSELECT(env, r_dst, argR, argL, tmp);
             return r_dst;
          }
 
@@ -1793,14 +1830,11 @@ static HReg iselWordExpr_R_wrk(ISelEnv * env, IRExpr * e)
       if ((ty == Ity_I8 || ty == Ity_I16 ||
            ty == Ity_I32 || ((ty == Ity_I64))) &&
            typeOfIRExpr(env->type_env, e->Iex.ITE.cond) == Ity_I1) {
-         HReg r_dst  = iselWordExpr_R(env, e->Iex.ITE.iffalse);
+         HReg r0     = iselWordExpr_R(env, e->Iex.ITE.iffalse);
          HReg r1     = iselWordExpr_R(env, e->Iex.ITE.iftrue);
          HReg r_cond = iselWordExpr_R(env, e->Iex.ITE.cond);
-         /*
-          * r_dst = r0
-          * movn r_dst, r1, r_cond
-          */
-         addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, r_dst, r1, r_cond));
+         HReg r_dst  = newVRegI(env);
+         mk_iSELECT(env, r_dst, r1, r0, r_cond);
          return r_dst;
       }
       break;
@@ -2358,14 +2392,8 @@ static void iselInt64Expr_wrk(HReg * rHi, HReg * rLo, ISelEnv * env, IRExpr * e)
       iselInt64Expr(&expr0Hi, &expr0Lo, env, e->Iex.ITE.iffalse);
       iselInt64Expr(&expr1Hi, &expr1Lo, env, e->Iex.ITE.iftrue);
 
-      /* move desLo, expr0Lo
-       * move desHi, expr0Hi
-       * movn desLo, expr1Lo, cond
-       * movn desHi, expr1Hi, cond */
-      addInstr(env, mk_iMOVds_RR(desLo, expr0Lo));
-      addInstr(env, mk_iMOVds_RR(desHi, expr0Hi));
-      addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, desLo, expr1Lo, cond));
-      addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, desHi, expr1Hi, cond));
+      mk_iSELECT(env, desLo, expr1Lo, expr0Lo, cond);
+      mk_iSELECT(env, desHi, expr1Hi, expr0Hi, cond);
 
       *rHi = desHi;
       *rLo = desLo;
@@ -2549,9 +2577,9 @@ static void iselInt64Expr_wrk(HReg * rHi, HReg * rLo, ISelEnv * env, IRExpr * e)
             addInstr(env, MIPSInstr_Alu(Malu_OR, v0, a3, MIPSRH_Reg(v0)));
 
             /* movn    v0, v1, a0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, v0, v1, a0tmp));
+            mk_iMOVN(env, v0, v1, a0tmp);
             /* movn    v1, zero, a0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, v1, zero, a0tmp));
+            mk_iMOVN(env, v1, zero, a0tmp);
 
             *rHi = v1;
             *rLo = v0;
@@ -2613,9 +2641,9 @@ static void iselInt64Expr_wrk(HReg * rHi, HReg * rLo, ISelEnv * env, IRExpr * e)
                              a2tmp, a0, MIPSRH_Reg(a2)));
 
             /* movn v1, a2, v0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, v1, a2tmp, v0));
+            mk_iMOVN(env, v1, a2tmp, v0);
             /* movn  a2, zero, v0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, a2tmp, zero, v0));
+            mk_iMOVN(env, a2tmp, zero, v0);
             /* move v0, a2 */
             addInstr(env, mk_iMOVds_RR(v0, a2tmp));
 
@@ -2681,9 +2709,9 @@ static void iselInt64Expr_wrk(HReg * rHi, HReg * rLo, ISelEnv * env, IRExpr * e)
                                          a2, a0, MIPSRH_Reg(a2)));
 
             /* movn v1, a2, v0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, v1, a2, v0));
+            mk_iMOVN(env, v1, a2, v0);
             /* movn a2, zero, v0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, a2, zero, v0));
+            mk_iMOVN(env, a2, zero, v0);
             addInstr(env, mk_iMOVds_RR(v0, a2));
 
             *rHi = v1;
@@ -2752,9 +2780,9 @@ static void iselInt64Expr_wrk(HReg * rHi, HReg * rLo, ISelEnv * env, IRExpr * e)
             addInstr(env, MIPSInstr_Alu(Malu_OR, v0, a3, MIPSRH_Reg(v0)));
 
             /* movn    v0, v1, a0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, v0, v1, a0tmp));
+            mk_iMOVN(env, v0, v1, a0tmp);
             /* movn    v1, a1, a0 */
-            addInstr(env, MIPSInstr_MoveCond(MMoveCond_movn, v1, a1tmp, a0tmp));
+            mk_iMOVN(env, v1, a1tmp, a0tmp);
 
             *rHi = v1;
             *rLo = v0;
@@ -4194,8 +4222,9 @@ HInstrArray *iselSB_MIPS ( const IRSB* bb,
    env->mode64 = mode64;
    env->fp_mode64 = fp_mode64;
 
-   /* Set up output code array. */
-   env->code = newHInstrArray();
+   /* Set up output code array, allowing two instructions per
+      statement plus a few for the block's entry and exits. */
+   env->code = newHInstrArray(sizeof(MIPSInstr), 2 * bb->stmts_used + 8);
 
    /* Copy BB's type env. */
    env->type_env = bb->tyenv;
@@ -842,6 +842,17 @@ PPCInstr* PPCInstr_CMov  ( PPCCondCode cond,
    vassert(cond.test != Pct_ALWAYS);
    return i;
 }
+PPCInstr* PPCInstr_ISel  ( PPCCondCode cond,
+                           HReg dst, HReg srcT, HReg srcF ) {
+   PPCInstr* i      = LibVEX_Alloc_inline(sizeof(PPCInstr));
+   i->tag           = Pin_ISel;
+   i->Pin.ISel.cond = cond;
+   i->Pin.ISel.dst  = dst;
+   i->Pin.ISel.srcT = srcT;
+   i->Pin.ISel.srcF = srcF;
+   vassert(cond.test != Pct_ALWAYS);
+   return i;
+}
 PPCInstr* PPCInstr_Load ( UChar sz,
                           HReg dst, PPCAMode* src, Bool mode64 ) {
    PPCInstr* i       = LibVEX_Alloc_inline(sizeof(PPCInstr));
@@ -1182,9 +1193,10 @@ Valid combo | fromI | int32 | syned | flt64 |
 --------------------------------------------
 */
 PPCInstr* PPCInstr_FpCftI ( Bool fromI, Bool int32, Bool syned,
-                            Bool flt64, HReg dst, HReg src ) {
-   Bool tmp = fromI | int32 | syned | flt64;
+                            Bool flt64, Bool trunc, HReg dst, HReg src ) {
+   Bool tmp = fromI | int32 | syned | flt64 | trunc;
    vassert(tmp == True || tmp == False); // iow, no high bits set
+   vassert(!(fromI && trunc));
    UShort conversion = 0;
    conversion = (fromI << 3) | (int32 << 2) | (syned << 1) | flt64;
    switch (conversion) {
@@ -1201,6 +1213,7 @@ PPCInstr* PPCInstr_FpCftI ( Bool fromI, Bool int32, Bool syned,
    i->Pin.FpCftI.int32 = int32;
    i->Pin.FpCftI.syned = syned;
    i->Pin.FpCftI.flt64 = flt64;
+   i->Pin.FpCftI.trunc = trunc;
    i->Pin.FpCftI.dst   = dst;
    i->Pin.FpCftI.src   = src;
    return i;
@@ -1634,6 +1647,14 @@ void ppPPCInstr ( const PPCInstr* i, Bool mode64 )
       }
       vex_printf(" }");
       return;
+   case Pin_ISel:
+      vex_printf("isel (%s) ", showPPCCondCode(i->Pin.ISel.cond));
+      ppHRegPPC(i->Pin.ISel.dst);
+      vex_printf(",");
+      ppHRegPPC(i->Pin.ISel.srcT);
+      vex_printf(",");
+      ppHRegPPC(i->Pin.ISel.srcF);
+      return;
    case Pin_Load: {
       Bool idxd = toBool(i->Pin.Load.src->tag == Pam_RR);
       UChar sz = i->Pin.Load.sz;
@@ -1789,7 +1810,7 @@ void ppPPCInstr ( const PPCInstr* i, Bool mode64 )
                str = "fcfidus";
          }
       }
-      vex_printf("%s ", str);
+      vex_printf("%s%s ", str, i->Pin.FpCftI.trunc ? "z" : "");
       ppHRegPPC(i->Pin.FpCftI.dst);
       vex_printf(",");
       ppHRegPPC(i->Pin.FpCftI.src);
@@ -2333,6 +2354,11 @@ void getRegUsage_PPCInstr ( HRegUsage* u, const PPCInstr* i, Bool mode64 )
       addRegUsage_PPCRI(u,  i->Pin.CMov.src);
       addHRegUse(u, HRmWrite, i->Pin.CMov.dst);
       return;
+   case Pin_ISel:
+      addHRegUse(u, HRmRead,  i->Pin.ISel.srcT);
+      addHRegUse(u, HRmRead,  i->Pin.ISel.srcF);
+      addHRegUse(u, HRmWrite, i->Pin.ISel.dst);
+      return;
    case Pin_Load:
       addRegUsage_PPCAMode(u, i->Pin.Load.src);
       addHRegUse(u, HRmWrite, i->Pin.Load.dst);
@@ -2686,6 +2712,11 @@ void mapRegs_PPCInstr ( HRegRemap* m, PPCInstr* i, Bool mode64 )
       mapRegs_PPCRI(m, i->Pin.CMov.src);
       mapReg(m, &i->Pin.CMov.dst);
       return;
+   case Pin_ISel:
+      mapReg(m, &i->Pin.ISel.dst);
+      mapReg(m, &i->Pin.ISel.srcT);
+      mapReg(m, &i->Pin.ISel.srcF);
+      return;
    case Pin_Load:
       mapRegs_PPCAMode(m, i->Pin.Load.src);
       mapReg(m, &i->Pin.Load.dst);
@@ -4370,6 +4401,23 @@ Int emit_PPCInstr ( /*MB_MOD*/Bool* is_profInc,
       goto done;
    }
 
+   case Pin_ISel: {
+      /* isel rT,rA,rB,BC: rT = CR[BC] ? rA : rB.  rA == 0 means the
+         value zero, but GPR0 is never allocated, so that can't
+         happen. */
+      UInt r_dst = iregEnc(i->Pin.ISel.dst,  mode64);
+      UInt r_t   = iregEnc(i->Pin.ISel.srcT, mode64);
+      UInt r_f   = iregEnc(i->Pin.ISel.srcF, mode64);
+      PPCCondCode cond = i->Pin.ISel.cond;
+      vassert(cond.test == Pct_TRUE || cond.test == Pct_FALSE);
+      if (cond.test == Pct_FALSE) {
+         UInt tmp = r_t; r_t = r_f; r_f = tmp;
+      }
+      vassert(r_t != 0);
+      p = mkFormA(p, 31, r_dst, r_t, r_f, cond.flag, 15, 0, endness_host);
+      goto done;
+   }
+
    case Pin_Load: {
       PPCAMode* am_addr = i->Pin.Load.src;
       UInt r_dst = iregEnc(i->Pin.Load.dst, mode64);
@@ -4686,25 +4734,28 @@ Int emit_PPCInstr ( /*MB_MOD*/Bool* is_profInc,
    case Pin_FpCftI: {
       UInt fr_dst = fregEnc(i->Pin.FpCftI.dst);
       UInt fr_src = fregEnc(i->Pin.FpCftI.src);
+      /* The round-to-zero forms of the F->I conversions have the
+         next opcode up. */
+      UInt z      = i->Pin.FpCftI.trunc ? 1 : 0;
       if (i->Pin.FpCftI.fromI == False && i->Pin.FpCftI.int32 == True) {
          if (i->Pin.FpCftI.syned == True) {
-            // fctiw (conv f64 to i32), PPC32 p404
-            p = mkFormX(p, 63, fr_dst, 0, fr_src, 14, 0, endness_host);
+            // fctiw[z] (conv f64 to i32), PPC32 p404
+            p = mkFormX(p, 63, fr_dst, 0, fr_src, 14 + z, 0, endness_host);
             goto done;
          } else {
-            // fctiwu (conv f64 to u32)
-            p = mkFormX(p, 63, fr_dst, 0, fr_src, 142, 0, endness_host);
+            // fctiwu[z] (conv f64 to u32)
+            p = mkFormX(p, 63, fr_dst, 0, fr_src, 142 + z, 0, endness_host);
             goto done;
          }
       }
       if (i->Pin.FpCftI.fromI == False && i->Pin.FpCftI.int32 == False) {
          if (i->Pin.FpCftI.syned == True) {
-            // fctid (conv f64 to i64), PPC64 p437
-            p = mkFormX(p, 63, fr_dst, 0, fr_src, 814, 0, endness_host);
+            // fctid[z] (conv f64 to i64), PPC64 p437
+            p = mkFormX(p, 63, fr_dst, 0, fr_src, 814 + z, 0, endness_host);
             goto done;
          } else {
-            // fctidu (conv f64 to u64)
-            p = mkFormX(p, 63, fr_dst, 0, fr_src, 942, 0, endness_host);
+            // fctidu[z] (conv f64 to u64)
+            p = mkFormX(p, 63, fr_dst, 0, fr_src, 942 + z, 0, endness_host);
             goto done;
          }
       }
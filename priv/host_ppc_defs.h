@@ -456,6 +456,7 @@ typedef
       Pin_XIndir,     /* indirect transfer to GA */
       Pin_XAssisted,  /* assisted transfer to GA */
       Pin_CMov,       /* conditional move */
+      Pin_ISel,       /* select, via isel */
       Pin_Load,       /* zero-extending load a 8|16|32|64 bit value from mem */
       Pin_LoadL,      /* load-linked (lwarx/ldarx) 32|64 bit value from mem */
       Pin_Store,      /* store a 8|16|32|64 bit value to mem */
@@ -470,7 +471,7 @@ typedef
       Pin_FpLdSt,     /* FP load/store */
       Pin_FpSTFIW,    /* stfiwx */
       Pin_FpRSP,      /* FP round IEEE754 double to IEEE754 single */
-      Pin_FpCftI,     /* fcfid[u,s,us]/fctid[u]/fctiw[u] */
+      Pin_FpCftI,     /* fcfid[u,s,us]/fctid[u][z]/fctiw[u][z] */
       Pin_FpCMov,     /* FP floating point conditional move */
       Pin_FpLdFPSCR,  /* mtfsf */
       Pin_FpCmp,      /* FP compare, generating value into int reg */
@@ -647,6 +648,15 @@ typedef
             HReg        dst;
             PPCRI*      src;
          } CMov;
+         /* dst = cond ? srcT : srcF, without a branch.  Needs the
+            isel insn (ISA 2.06 or later).  cond may not be
+            Pct_ALWAYS. */
+         struct {
+            PPCCondCode cond;
+            HReg        dst;
+            HReg        srcT;
+            HReg        srcF;
+         } ISel;
          /* Zero extending loads.  Dst size is host word size */
          struct {
             UChar     sz; /* 1|2|4|8 */
@@ -720,15 +730,16 @@ typedef
             HReg src;
             HReg dst;
          } FpRSP;
-         /* fcfid[u,s,us]/fctid[u]/fctiw[u].  Only some combinations
-            of the various fields are allowed.  This is asserted for
-            and documented in the code for the constructor,
-            PPCInstr_FpCftI, in host_ppc_defs.c.  */
+         /* fcfid[u,s,us]/fctid[u][z]/fctiw[u][z].  Only some
+            combinations of the various fields are allowed.  This is
+            asserted for and documented in the code for the
+            constructor, PPCInstr_FpCftI, in host_ppc_defs.c.  */
          struct {
             Bool fromI; /* True== I->F,    False== F->I */
             Bool int32; /* True== I is 32, False== I is 64 */
             Bool syned;
             Bool flt64; /* True== F is 64, False== F is 32 */
+            Bool trunc; /* F->I only: round to zero, not per FPSCR[RN] */
             HReg src;
             HReg dst;
          } FpCftI;
@@ -1014,6 +1025,8 @@ extern PPCInstr* PPCInstr_XIndir     ( HReg dstGA, PPCAMode* amCIA,
 extern PPCInstr* PPCInstr_XAssisted  ( HReg dstGA, PPCAMode* amCIA,
                                        PPCCondCode cond, IRJumpKind jk );
 extern PPCInstr* PPCInstr_CMov       ( PPCCondCode, HReg dst, PPCRI* src );
+extern PPCInstr* PPCInstr_ISel       ( PPCCondCode, HReg dst,
+                                       HReg srcT, HReg srcF );
 extern PPCInstr* PPCInstr_Load       ( UChar sz,
                                        HReg dst, PPCAMode* src, Bool mode64 );
 extern PPCInstr* PPCInstr_LoadL      ( UChar sz,
@@ -1034,7 +1047,8 @@ extern PPCInstr* PPCInstr_FpLdSt     ( Bool isLoad, UChar sz, HReg, PPCAMode* );
 extern PPCInstr* PPCInstr_FpSTFIW    ( HReg addr, HReg data );
 extern PPCInstr* PPCInstr_FpRSP      ( HReg dst, HReg src );
 extern PPCInstr* PPCInstr_FpCftI     ( Bool fromI, Bool int32, Bool syned,
-                                       Bool dst64, HReg dst, HReg src );
+                                       Bool dst64, Bool trunc,
+                                       HReg dst, HReg src );
 extern PPCInstr* PPCInstr_FpCMov     ( PPCCondCode, HReg dst, HReg src );
 extern PPCInstr* PPCInstr_FpLdFPSCR  ( HReg src, Bool dfp_rm );
 extern PPCInstr* PPCInstr_FpCmp      ( HReg dst, HReg srcL, HReg srcR );
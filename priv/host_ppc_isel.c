@@ -109,7 +109,8 @@
   each floating point insn emitted (or left unchanged if known to be
   correct already).  There are a few fp insns (fmr,fneg,fabs,fnabs),
   which are unaffected by the rm and so the rounding mode is not set
-  prior to them.  
+  prior to them.  Conversions to integer that round to zero use the
+  fcti*z forms, which ignore the rm, and so do not set it either.
 
   At least on MPC7447A (Mac Mini), frsqrte is also not affected by
   rounding mode.  At some point the ppc docs get sufficiently vague
@@ -251,11 +252,13 @@ static Bool isZeroU8 ( IRExpr* e )
     - A Bool to tell us if the host is 32 or 64bit.
       This is set at the start and does not change.
  
-    - An IRExpr*, which may be NULL, holding the IR expression (an
-      IRRoundingMode-encoded value) to which the FPU's rounding mode
-      was most recently set.  Setting to NULL is always safe.  Used to
-      avoid redundant settings of the FPU's rounding mode, as
-      described in set_FPU_rounding_mode below.
+    - Two IRExpr*s, which may be NULL, holding the IR expressions (an
+      IRRoundingMode-encoded value) to which the FPU's binary and
+      decimal rounding modes were most recently set.  They live in
+      different halves of the FPSCR, so are tracked separately.
+      Setting either to NULL is always safe.  Used to avoid redundant
+      settings of the FPU's rounding mode, as described in
+      set_FPU_rounding_mode below.
 
     - A VexMiscInfo*, needed for knowing how to generate
       function calls for this target.
@@ -295,6 +298,7 @@ typedef
       Int          vreg_ctr;
 
       IRExpr*      previous_rm;
+      IRExpr*      previous_dfp_rm;
    }
    ISelEnv;
  
@@ -332,11 +336,11 @@ static void lookupIRTempQuad ( HReg* vrHi, HReg* vrMedHi, HReg* vrMedLo,
 
 static void addInstr ( ISelEnv* env, PPCInstr* instr )
 {
-   addHInstr(env->code, instr);
    if (vex_traceflags & VEX_TRACE_VCODE) {
       ppPPCInstr(instr, env->mode64);
       vex_printf("\n");
    }
+   addHInstr(env->code, instr);
 }
 
 static HReg newVRegI ( ISelEnv* env )
@@ -518,6 +522,16 @@ static PPCInstr* mk_iMOVds_RR ( HReg r_dst, HReg r_src )
    return PPCInstr_Alu(Palu_OR, r_dst, r_src, PPCRH_Reg(r_src));
 }
 
+/* Can we select between two int regs with isel rather than a
+   branch?  It is in ISA 2.06 and later, which VSX implies. */
+static Bool hasISel ( const ISelEnv* env )
+{
+   UInt caps = env->mode64
+                  ? (VEX_HWCAPS_PPC64_VX | VEX_HWCAPS_PPC64_ISA2_07)
+                  : (VEX_HWCAPS_PPC32_VX | VEX_HWCAPS_PPC32_ISA2_07);
+   return toBool((env->hwcaps & caps) != 0);
+}
+
 /* Advance/retreat %r1 by n. */
 
 static void add_to_sp ( ISelEnv* env, UInt n )
@@ -1143,9 +1157,12 @@ static HReg roundModeIRtoPPC ( ISelEnv* env, HReg r_rmIR )
    Setting the rounding mode is expensive.  So this function tries to
    avoid repeatedly setting the rounding mode to the same thing by
    first comparing 'mode' to the 'mode' tree supplied in the previous
-   call to this function, if any.  (The previous value is stored in
-   env->previous_rm.)  If 'mode' is a single IR temporary 't' and
-   env->previous_rm is also just 't', then the setting is skipped.
+   call to this function for the same kind of rounding, if any.  (The
+   previous values are stored in env->previous_rm and
+   env->previous_dfp_rm.)  If 'mode' is a single IR temporary 't' and
+   the previous value is also just 't', or both are the same constant,
+   then the setting is skipped.  Nothing ever puts the default back,
+   so the mode stays set until the end of the block.
 
    This is safe because of the SSA property of IR: an IR temporary can
    only be defined once and so will have the same value regardless of
@@ -1164,23 +1181,24 @@ static
 void _set_FPU_rounding_mode ( ISelEnv* env, IRExpr* mode, Bool dfp_rm,
                               IREndness IEndianess )
 {
-   HReg fr_src = newVRegF(env);
-   HReg r_src;
+   HReg     fr_src = newVRegF(env);
+   HReg     r_src;
+   IRExpr** previous = dfp_rm ? &env->previous_dfp_rm : &env->previous_rm;
 
    vassert(typeOfIRExpr(env->type_env,mode) == Ity_I32);
    
    /* Do we need to do anything? */
-   if (env->previous_rm
-       && env->previous_rm->tag == Iex_RdTmp
-       && mode->tag == Iex_RdTmp
-       && env->previous_rm->Iex.RdTmp.tmp == mode->Iex.RdTmp.tmp) {
+   if (*previous
+       && isIRAtom(*previous)
+       && isIRAtom(mode)
+       && eqIRAtom(*previous, mode)) {
       /* no - setting it to what it was before.  */
-      vassert(typeOfIRExpr(env->type_env, env->previous_rm) == Ity_I32);
+      vassert(typeOfIRExpr(env->type_env, *previous) == Ity_I32);
       return;
    }
 
    /* No luck - we better set it, and remember what we set it to. */
-   env->previous_rm = mode;
+   *previous = mode;
 
    /* Only supporting the rounding-mode bits - the rest of FPSCR is
       0x0 - so we can set the whole register at once (faster). */
@@ -1225,6 +1243,21 @@ static void set_FPU_DFP_rounding_mode ( ISelEnv* env, IRExpr* mode,
    _set_FPU_rounding_mode(env, mode, True, IEndianess);
 }
 
+/* As set_FPU_rounding_mode, for an F->I conversion.  The fcti*z forms
+   round to zero whatever the FPSCR says, so if 'mode' is the constant
+   Irrm_ZERO, leave the FPSCR alone and return True to say that the
+   caller should use one of those. */
+static Bool set_FPU_rounding_mode_FtoI ( ISelEnv* env, IRExpr* mode,
+                                         IREndness IEndianess )
+{
+   if (mode->tag == Iex_Const
+       && mode->Iex.Const.con->tag == Ico_U32
+       && mode->Iex.Const.con->Ico.U32 == Irrm_ZERO)
+      return True;
+   set_FPU_rounding_mode(env, mode, IEndianess);
+   return False;
+}
+
 
 /*---------------------------------------------------------*/
 /*--- ISEL: vector helpers                              ---*/
@@ -1639,6 +1672,12 @@ static HReg iselWordExpr_R_wrk ( ISelEnv* env, IRExpr* e,
          HReg        r2   = iselWordExpr_R(env, e->Iex.Binop.arg2, IEndianess);
          HReg        rdst = newVRegI(env);
          PPCCondCode cc   = mk_PPCCondCode( Pct_TRUE, Pcf_7LT );
+         if (hasISel(env)) {
+            addInstr(env, PPCInstr_Cmp(False/*unsigned*/, True/*32bit cmp*/,
+                                       7/*cr*/, r1, PPCRH_Reg(r2)));
+            addInstr(env, PPCInstr_ISel(cc, rdst, r2, r1));
+            return rdst;
+         }
          addInstr(env, mk_iMOVds_RR(rdst, r1));
          addInstr(env, PPCInstr_Cmp(False/*unsigned*/, True/*32bit cmp*/,
                                     7/*cr*/, rdst, PPCRH_Reg(r2)));
@@ -1752,15 +1791,17 @@ static HReg iselWordExpr_R_wrk ( ISelEnv* env, IRExpr* e,
          HReg      fsrc    = iselDblExpr(env, e->Iex.Binop.arg2, IEndianess);
          HReg      ftmp    = newVRegF(env);
          HReg      idst    = newVRegI(env);
+         Bool      trunc;
 
          /* Set host rounding mode */
-         set_FPU_rounding_mode( env, e->Iex.Binop.arg1, IEndianess );
+         trunc = set_FPU_rounding_mode_FtoI( env, e->Iex.Binop.arg1,
+                                             IEndianess );
 
          sub_from_sp( env, 16 );
          addInstr(env, PPCInstr_FpCftI(False/*F->I*/, True/*int32*/,
                                        e->Iex.Binop.op == Iop_F64toI32S ? True/*syned*/
                                                                      : False,
-                                       True/*flt64*/,
+                                       True/*flt64*/, trunc,
                                        ftmp, fsrc));
          addInstr(env, PPCInstr_FpSTFIW(r1, ftmp));
          addInstr(env, PPCInstr_Load(4, idst, zero_r1, mode64));
@@ -1784,15 +1825,17 @@ static HReg iselWordExpr_R_wrk ( ISelEnv* env, IRExpr* e,
                                             IEndianess);
             HReg      idst    = newVRegI(env);         
             HReg      ftmp    = newVRegF(env);
+            Bool      trunc;
 
             /* Set host rounding mode */
-            set_FPU_rounding_mode( env, e->Iex.Binop.arg1, IEndianess );
+            trunc = set_FPU_rounding_mode_FtoI( env, e->Iex.Binop.arg1,
+                                                IEndianess );
 
             sub_from_sp( env, 16 );
             addInstr(env, PPCInstr_FpCftI(False/*F->I*/, False/*int64*/,
                                           ( e->Iex.Binop.op == Iop_F64toI64S ) ? True
                                                                             : False,
-                                          True, ftmp, fsrc));
+                                          True, trunc, ftmp, fsrc));
             addInstr(env, PPCInstr_FpLdSt(False/*store*/, 8, ftmp, zero_r1));
             addInstr(env, PPCInstr_Load(8, idst, zero_r1, True/*mode64*/));
             add_to_sp( env, 16 );
@@ -2438,6 +2481,15 @@ static HReg iselWordExpr_R_wrk ( ISelEnv* env, IRExpr* e,
       if ((ty == Ity_I8  || ty == Ity_I16 ||
            ty == Ity_I32 || ((ty == Ity_I64) && mode64)) &&
           typeOfIRExpr(env->type_env,e->Iex.ITE.cond) == Ity_I1) {
+         if (hasISel(env)) {
+            /* Nested ITEs become a tree of isels. */
+            HReg rT    = iselWordExpr_R(env, e->Iex.ITE.iftrue, IEndianess);
+            HReg rF    = iselWordExpr_R(env, e->Iex.ITE.iffalse, IEndianess);
+            HReg r_dst = newVRegI(env);
+            PPCCondCode cc = iselCondCode(env, e->Iex.ITE.cond, IEndianess);
+            addInstr(env, PPCInstr_ISel(cc, r_dst, rT, rF));
+            return r_dst;
+         }
          PPCRI* r1    = iselWordExpr_RI(env, e->Iex.ITE.iftrue, IEndianess);
          HReg   r0    = iselWordExpr_R(env, e->Iex.ITE.iffalse, IEndianess);
          HReg   r_dst = newVRegI(env);
@@ -3233,6 +3285,14 @@ static void iselInt64Expr_wrk ( HReg* rHi, HReg* rLo,
       iselInt64Expr(&e0Hi, &e0Lo, env, e->Iex.ITE.iffalse, IEndianess);
       HReg tLo = newVRegI(env);
       HReg tHi = newVRegI(env);
+      if (hasISel(env)) {
+         PPCCondCode cc = iselCondCode(env, e->Iex.ITE.cond, IEndianess);
+         addInstr(env, PPCInstr_ISel(cc,tHi,eXHi,e0Hi));
+         addInstr(env, PPCInstr_ISel(cc,tLo,eXLo,e0Lo));
+         *rHi = tHi;
+         *rLo = tLo;
+         return;
+      }
       addInstr(env, mk_iMOVds_RR(tHi,e0Hi));
       addInstr(env, mk_iMOVds_RR(tLo,e0Lo));
       PPCCondCode cc = iselCondCode(env, e->Iex.ITE.cond, IEndianess);
@@ -3318,15 +3378,17 @@ static void iselInt64Expr_wrk ( HReg* rHi, HReg* rLo,
             HReg      fsrc    = iselDblExpr(env, e->Iex.Binop.arg2,
                                             IEndianess);
             HReg      ftmp    = newVRegF(env);
+            Bool      trunc;
 
             vassert(!env->mode64);
             /* Set host rounding mode */
-            set_FPU_rounding_mode( env, e->Iex.Binop.arg1, IEndianess );
+            trunc = set_FPU_rounding_mode_FtoI( env, e->Iex.Binop.arg1,
+                                                IEndianess );
 
             sub_from_sp( env, 16 );
             addInstr(env, PPCInstr_FpCftI(False/*F->I*/, False/*int64*/,
                                           (op_binop == Iop_F64toI64S) ? True : False,
-                                          True, ftmp, fsrc));
+                                          True, trunc, ftmp, fsrc));
             addInstr(env, PPCInstr_FpLdSt(False/*store*/, 8, ftmp, zero_r1));
             addInstr(env, PPCInstr_Load(4, tHi, zero_r1, False/*mode32*/));
             addInstr(env, PPCInstr_Load(4, tLo, four_r1, False/*mode32*/));
@@ -3860,7 +3922,7 @@ static HReg iselFltExpr_wrk ( ISelEnv* env, IRExpr* e, IREndness IEndianess )
          addInstr(env, PPCInstr_Store(8, zero_r1, isrc, True/*mode64*/));
          addInstr(env, PPCInstr_FpLdSt(True/*load*/, 8, fdst, zero_r1));
          addInstr(env, PPCInstr_FpCftI(True/*I->F*/, False/*int64*/, 
-                                       False, False,
+                                       False, False, False,
                                        fdst, fdst));
 
          add_to_sp( env, 16 );
@@ -3887,7 +3949,7 @@ static HReg iselFltExpr_wrk ( ISelEnv* env, IRExpr* e, IREndness IEndianess )
          addInstr(env, PPCInstr_Store(4, four_r1, isrcLo, False/*mode32*/));
          addInstr(env, PPCInstr_FpLdSt(True/*load*/, 8, fdst, zero_r1));
          addInstr(env, PPCInstr_FpCftI(True/*I->F*/, False/*int64*/, 
-                                       False, False,
+                                       False, False, False,
                                        fdst, fdst));
 
          add_to_sp( env, 16 );
@@ -4096,7 +4158,7 @@ static HReg iselDblExpr_wrk ( ISelEnv* env, IRExpr* e, IREndness IEndianess )
             addInstr(env, PPCInstr_FpLdSt(True/*load*/, 8, fdst, zero_r1));
             addInstr(env, PPCInstr_FpCftI(True/*I->F*/, False/*int64*/, 
                                           e->Iex.Binop.op == Iop_I64StoF64,
-                                          True/*fdst is 64 bit*/,
+                                          True/*fdst is 64 bit*/, False,
                                           fdst, fdst));
 
             add_to_sp( env, 16 );
@@ -4125,7 +4187,7 @@ static HReg iselDblExpr_wrk ( ISelEnv* env, IRExpr* e, IREndness IEndianess )
             addInstr(env, PPCInstr_FpLdSt(True/*load*/, 8, fdst, zero_r1));
             addInstr(env, PPCInstr_FpCftI(True/*I->F*/, False/*int64*/, 
                                           e->Iex.Binop.op == Iop_I64StoF64,
-                                          True/*fdst is 64 bit*/,
+                                          True/*fdst is 64 bit*/, False,
                                           fdst, fdst));
 
             add_to_sp( env, 16 );
@@ -6172,8 +6234,9 @@ HInstrArray* iselSB_PPC ( const IRSB* bb,
    /* Are we being ppc32 or ppc64? */
    env->mode64 = mode64;
 
-   /* Set up output code array. */
-   env->code = newHInstrArray();
+   /* Set up output code array, allowing three instructions for every
+      two statements plus a few for the block's entry and exits. */
+   env->code = newHInstrArray(sizeof(PPCInstr), 3 * bb->stmts_used / 2 + 8);
 
    /* Copy BB's type env. */
    env->type_env = bb->tyenv;
@@ -6200,6 +6263,7 @@ HInstrArray* iselSB_PPC ( const IRSB* bb,
    env->max_ga          = max_ga;
    env->hwcaps          = hwcaps_host;
    env->previous_rm     = NULL;
+   env->previous_dfp_rm = NULL;
    env->vbi             = vbi;
 
    /* For each IR temporary, allocate a suitably-kinded virtual
@@ -10053,18 +10053,23 @@ patchProfInc_S390(VexEndness endness_host,
 VexInvalRange
 chainXDirect_S390(VexEndness endness_host,
                   void *place_to_chain,
+                  HWord wr_delta,
                   const void *disp_cp_chain_me_EXPECTED,
                   const void *place_to_jump_to)
 {
    vassert(endness_host == VexEndnessBE);
 
-   /* What we're expecting to see @ PLACE_TO_CHAIN is:
+   /* The code runs at PLACE_TO_CHAIN but is written through its alias
+      at PLACE_TO_CHAIN + WR_DELTA.
+
+      What we're expecting to see @ PLACE_TO_CHAIN is:
 
         load  tchain_scratch, #disp_cp_chain_me_EXPECTED
         goto *tchain_scratch
    */
+   UChar *start = (UChar *)place_to_chain + wr_delta;
    const UChar *next;
-   next = s390_tchain_verify_load64(place_to_chain, S390_REGNO_TCHAIN_SCRATCH,
+   next = s390_tchain_verify_load64(start, S390_REGNO_TCHAIN_SCRATCH,
                                     (Addr)disp_cp_chain_me_EXPECTED);
    vassert(s390_insn_is_BR(next, S390_REGNO_TCHAIN_SCRATCH));
 
@@ -10092,7 +10097,9 @@ chainXDirect_S390(VexEndness endness_host,
    */
 
    /* This is the delta we need to put into a BRCL insn. Note, that the
-      offset in BRCL is in half-words. Hence division by 2. */
+      offset in BRCL is in half-words. Hence division by 2.  It is
+      relative to where the code runs, not the alias it is written
+      through. */
    Long delta =
       (Long)((const UChar *)place_to_jump_to - (const UChar *)place_to_chain) / 2;
    Bool shortOK = delta >= -1000*1000*1000 && delta < 1000*1000*1000;
@@ -10109,7 +10116,7 @@ chainXDirect_S390(VexEndness endness_host,
    }
 
    /* And make the modifications. */
-   UChar *p = (UChar *)place_to_chain;
+   UChar *p = start;
    if (shortOK) {
       p = s390_emit_BRCL(p, S390_CC_ALWAYS, delta);  /* 6 bytes */
 
@@ -10131,7 +10138,7 @@ chainXDirect_S390(VexEndness endness_host,
       /* There is not need to emit a BCR here, as it is already there. */
    }
 
-   UInt len = p - (UChar *)place_to_chain;
+   UInt len = p - start;
    VexInvalRange vir = { (HWord)place_to_chain, len };
    return vir;
 }
@@ -10142,12 +10149,16 @@ chainXDirect_S390(VexEndness endness_host,
 VexInvalRange
 unchainXDirect_S390(VexEndness endness_host,
                     void *place_to_unchain,
+                    HWord wr_delta,
                     const void *place_to_jump_to_EXPECTED,
                     const void *disp_cp_chain_me)
 {
    vassert(endness_host == VexEndnessBE);
 
-   /* What we're expecting to see @ PLACE_TO_UNCHAIN:
+   /* As for chainXDirect_S390, the code runs at PLACE_TO_UNCHAIN and
+      is written at PLACE_TO_UNCHAIN + WR_DELTA.
+
+      What we're expecting to see @ PLACE_TO_UNCHAIN:
 
           load  tchain_scratch, #place_to_jump_to_EXPECTED
           goto *tchain_scratch
@@ -10158,7 +10169,8 @@ unchainXDirect_S390(VexEndness endness_host,
           BRCL delta
           invalid opcodes
    */
-   UChar *p = place_to_unchain;
+   UChar *start = (UChar *)place_to_unchain + wr_delta;
+   UChar *p = start;
 
    Bool uses_short_form = False;
 
@@ -10167,7 +10179,7 @@ unchainXDirect_S390(VexEndness endness_host,
       Int num_hw = *(Int *)&p[2];
       Int delta = 2 *num_hw;
 
-      vassert(p + delta == place_to_jump_to_EXPECTED);
+      vassert((UChar *)place_to_unchain + delta == place_to_jump_to_EXPECTED);
 
       Int i;
       for (i = 0; i < s390_xdirect_patchable_len() - 6; ++i)
@@ -10205,7 +10217,7 @@ unchainXDirect_S390(VexEndness endness_host,
    if (uses_short_form)
       s390_emit_BCR(p, S390_CC_ALWAYS, S390_REGNO_TCHAIN_SCRATCH);
 
-   UInt len = p - (UChar *)place_to_unchain;
+   UInt len = p - start;
    VexInvalRange vir = { (HWord)place_to_unchain, len };
    return vir;
 }
@@ -758,11 +758,13 @@ Int evCheckSzB_S390(void);
 /* Perform a chaining and unchaining of an XDirect jump. */
 VexInvalRange chainXDirect_S390(VexEndness endness_host,
                                 void *place_to_chain,
+                                HWord wr_delta,
                                 const void *disp_cp_chain_me_EXPECTED,
                                 const void *place_to_jump_to);
 
 VexInvalRange unchainXDirect_S390(VexEndness endness_host,
                                   void *place_to_unchain,
+                                  HWord wr_delta,
                                   const void *place_to_jump_to_EXPECTED,
                                   const void *disp_cp_chain_me);
 
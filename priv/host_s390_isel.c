@@ -173,11 +173,11 @@ get_guest_reg(Int offset)
 static void
 addInstr(ISelEnv *env, s390_insn *insn)
 {
-   addHInstr(env->code, insn);
-
    if (vex_traceflags & VEX_TRACE_VCODE) {
       vex_printf("%s\n", s390_insn_as_string(insn));
    }
+
+   addHInstr(env->code, insn);
 }
 
 
@@ -4111,8 +4111,9 @@ iselSB_S390(const IRSB *bb, VexArch arch_host, const VexArchInfo *archinfo_host,
    env = LibVEX_Alloc_inline(sizeof(ISelEnv));
    env->vreg_ctr = 0;
 
-   /* Set up output code array. */
-   env->code = newHInstrArray();
+   /* Set up output code array, allowing three instructions for every
+      two statements plus a few for the block's entry and exits. */
+   env->code = newHInstrArray(sizeof(s390_insn), 3 * bb->stmts_used / 2 + 8);
 
    /* Copy BB's type env. */
    env->type_env = bb->tyenv;
@@ -125,11 +125,11 @@ static HReg lookupIRTemp ( ISelEnv * env, IRTemp tmp )
 
 static void addInstr ( ISelEnv * env, TILEGXInstr * instr )
 {
-  addHInstr(env->code, instr);
   if (vex_traceflags & VEX_TRACE_VCODE) {
     ppTILEGXInstr(instr);
     vex_printf("\n");
   }
+  addHInstr(env->code, instr);
 }
 
 static HReg newVRegI ( ISelEnv * env )
@@ -1792,8 +1792,9 @@ HInstrArray *iselSB_TILEGX ( const IRSB* bb,
   env->vreg_ctr = 0;
   env->mode64 = True;
 
-  /* Set up output code array. */
-  env->code = newHInstrArray();
+  /* Set up output code array, allowing two instructions per
+     statement plus a few for the block's entry and exits. */
+  env->code = newHInstrArray(sizeof(TILEGXInstr), 2 * bb->stmts_used + 8);
 
   /* Copy BB's type env. */
   env->type_env = bb->tyenv;
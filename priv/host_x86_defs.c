@@ -3348,6 +3348,7 @@ Int evCheckSzB_X86 (void)
    emitInstr case for XDirect, above. */
 VexInvalRange chainXDirect_X86 ( VexEndness endness_host,
                                  void* place_to_chain,
+                                 HWord wr_delta,
                                  const void* disp_cp_chain_me_EXPECTED,
                                  const void* place_to_jump_to )
 {
@@ -3360,7 +3361,7 @@ VexInvalRange chainXDirect_X86 ( VexEndness endness_host,
         BA <4 bytes value == disp_cp_chain_me_EXPECTED>
         FF D2
    */
-   UChar* p = (UChar*)place_to_chain;
+   UChar* p = (UChar*)place_to_chain + wr_delta;
    vassert(p[0] == 0xBA);
    vassert(read_misaligned_UInt_LE(&p[1])
            == (UInt)(Addr)disp_cp_chain_me_EXPECTED);
@@ -3376,7 +3377,8 @@ VexInvalRange chainXDirect_X86 ( VexEndness endness_host,
    */
    /* This is the delta we need to put into a JMP d32 insn.  It's
       relative to the start of the next insn, hence the -5.  */
-   Long delta = (Long)((const UChar *)place_to_jump_to - p) - 5;
+   Long delta = (Long)((const UChar *)place_to_jump_to
+                       - (const UChar *)place_to_chain) - 5;
 
    /* And make the modifications. */
    p[0] = 0xE9;
@@ -3394,6 +3396,7 @@ VexInvalRange chainXDirect_X86 ( VexEndness endness_host,
    emitInstr case for XDirect, above. */
 VexInvalRange unchainXDirect_X86 ( VexEndness endness_host,
                                    void* place_to_unchain,
+                                   HWord wr_delta,
                                    const void* place_to_jump_to_EXPECTED,
                                    const void* disp_cp_chain_me )
 {
@@ -3406,13 +3409,13 @@ VexInvalRange unchainXDirect_X86 ( VexEndness endness_host,
           E9 <4 bytes == disp32>
           0F 0B
    */
-   UChar* p     = (UChar*)place_to_unchain;
+   UChar* p     = (UChar*)place_to_unchain + wr_delta;
    Bool   valid = False;
    if (p[0] == 0xE9 
        && p[5] == 0x0F && p[6]  == 0x0B) {
       /* Check the offset is right. */
       Int s32 = (Int)read_misaligned_UInt_LE(&p[1]);
-      if ((UChar*)p + 5 + s32 == place_to_jump_to_EXPECTED) {
+      if ((UChar*)place_to_unchain + 5 + s32 == place_to_jump_to_EXPECTED) {
          valid = True;
          if (0)
             vex_printf("QQQ unchainXDirect_X86: found valid\n");
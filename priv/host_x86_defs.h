@@ -752,14 +752,19 @@ extern HInstrArray* iselSB_X86           ( const IRSB*,
    worst case we will merely assert at startup. */
 extern Int evCheckSzB_X86 (void);
 
-/* Perform a chaining and unchaining of an XDirect jump. */
+/* Perform a chaining and unchaining of an XDirect jump.  A chained
+   jump may be PC-relative, so these take the executable address of
+   the site; the code itself is read and written at place +
+   wr_delta. */
 extern VexInvalRange chainXDirect_X86 ( VexEndness endness_host,
                                         void* place_to_chain,
+                                        HWord wr_delta,
                                         const void* disp_cp_chain_me_EXPECTED,
                                         const void* place_to_jump_to );
 
 extern VexInvalRange unchainXDirect_X86 ( VexEndness endness_host,
                                           void* place_to_unchain,
+                                          HWord wr_delta,
                                           const void* place_to_jump_to_EXPECTED,
                                           const void* disp_cp_chain_me );
 
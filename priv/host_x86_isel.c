@@ -208,11 +208,11 @@ static void lookupIRTemp64 ( HReg* vrHI, HReg* vrLO, ISelEnv* env, IRTemp tmp )
 
 static void addInstr ( ISelEnv* env, X86Instr* instr )
 {
-   addHInstr(env->code, instr);
    if (vex_traceflags & VEX_TRACE_VCODE) {
       ppX86Instr(instr, False);
       vex_printf("\n");
    }
+   addHInstr(env->code, instr);
 }
 
 static HReg newVRegI ( ISelEnv* env )
@@ -4449,8 +4449,9 @@ HInstrArray* iselSB_X86 ( const IRSB* bb,
    env = LibVEX_Alloc_inline(sizeof(ISelEnv));
    env->vreg_ctr = 0;
 
-   /* Set up output code array. */
-   env->code = newHInstrArray();
+   /* Set up output code array, big enough for the three instructions
+      that two statements typically turn into. */
+   env->code = newHInstrArray(sizeof(X86Instr), 3 * bb->stmts_used / 2);
 
    /* Copy BB's type env. */
    env->type_env = bb->tyenv;
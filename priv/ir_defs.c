@@ -1496,6 +1496,20 @@ void ppIRLoadG ( const IRLoadG* lg )
    ppIRExpr(lg->alt);
 }
 
+void ppIREvAppend ( const IREvAppend* ea )
+{
+   Int i;
+   vex_printf("EvAppend%s[%d,%d](", ea->end==Iend_LE ? "le" : "be",
+              ea->offCursor, ea->offLimit);
+   for (i = 0; ea->data[i] != NULL; i++) {
+      if (i > 0)
+         vex_printf(",");
+      ppIRExpr(ea->data[i]);
+   }
+   vex_printf(") ::: ");
+   ppIRCallee(ea->flush);
+}
+
 void ppIRJumpKind ( IRJumpKind kind )
 {
    switch (kind) {
@@ -1623,6 +1637,9 @@ void ppIRStmt ( const IRStmt* s )
          ppIRJumpKind(s->Ist.Exit.jk);
          vex_printf(" } ");
          break;
+      case Ist_EvAppend:
+         ppIREvAppend(s->Ist.EvAppend.details);
+         break;
       default: 
          vpanic("ppIRStmt");
    }
@@ -2063,6 +2080,18 @@ IRLoadG* mkIRLoadG ( IREndness end, IRLoadGOp cvt,
    return lg;
 }
 
+IREvAppend* mkIREvAppend ( IREndness end, Int offCursor, Int offLimit,
+                           IRCallee* flush, IRExpr** data )
+{
+   IREvAppend* ea = LibVEX_Alloc_inline(sizeof(IREvAppend));
+   ea->end        = end;
+   ea->offCursor  = offCursor;
+   ea->offLimit   = offLimit;
+   ea->flush      = flush;
+   ea->data       = data;
+   return ea;
+}
+
 
 /* Constructors -- IRStmt */
 
@@ -2173,6 +2202,14 @@ IRStmt* IRStmt_Exit ( IRExpr* guard, IRJumpKind jk, IRConst* dst,
    s->Ist.Exit.offsIP = offsIP;
    return s;
 }
+IRStmt* IRStmt_EvAppend ( IREvAppend* details )
+{
+   IRStmt* s               = LibVEX_Alloc_inline(sizeof(IRStmt));
+   s->tag                  = Ist_EvAppend;
+   s->Ist.EvAppend.details = details;
+   vassert(details->end == Iend_LE || details->end == Iend_BE);
+   return s;
+}
 
 
 /* Constructors -- IRTypeEnv */
@@ -2372,6 +2409,13 @@ IRPutI* deepCopyIRPutI ( const IRPutI * puti )
                    deepCopyIRExpr(puti->data));
 }
 
+IREvAppend* deepCopyIREvAppend ( const IREvAppend* ea )
+{
+   return mkIREvAppend( ea->end, ea->offCursor, ea->offLimit,
+                        deepCopyIRCallee(ea->flush),
+                        deepCopyIRExprVec(ea->data) );
+}
+
 IRStmt* deepCopyIRStmt ( const IRStmt* s )
 {
    switch (s->tag) {
@@ -2429,6 +2473,8 @@ IRStmt* deepCopyIRStmt ( const IRStmt* s )
                             s->Ist.Exit.jk,
                             deepCopyIRConst(s->Ist.Exit.dst),
                             s->Ist.Exit.offsIP);
+      case Ist_EvAppend:
+         return IRStmt_EvAppend(deepCopyIREvAppend(s->Ist.EvAppend.details));
       default: 
          vpanic("deepCopyIRStmt");
    }
@@ -3730,6 +3776,13 @@ Bool isFlatIRStmt ( const IRStmt* st )
          return True;
       case Ist_Exit:
          return isIRAtom(st->Ist.Exit.guard);
+      case Ist_EvAppend: {
+         const IREvAppend* ea = st->Ist.EvAppend.details;
+         for (i = 0; ea->data[i]; i++)
+            if (!isIRAtom(ea->data[i]))
+               return False;
+         return True;
+      }
       default: 
          vpanic("isFlatIRStmt(st)");
    }
@@ -3892,6 +3945,7 @@ void useBeforeDef_Stmt ( const IRSB* bb, const IRStmt* stmt, Int* def_counts )
    const IRPutI*   puti;
    const IRLoadG*  lg;
    const IRStoreG* sg;
+   const IREvAppend* ea;
    switch (stmt->tag) {
       case Ist_IMark:
          break;
@@ -3961,6 +4015,11 @@ void useBeforeDef_Stmt ( const IRSB* bb, const IRStmt* stmt, Int* def_counts )
       case Ist_Exit:
          useBeforeDef_Expr(bb,stmt,stmt->Ist.Exit.guard,def_counts);
          break;
+      case Ist_EvAppend:
+         ea = stmt->Ist.EvAppend.details;
+         for (i = 0; ea->data[i] != NULL; i++)
+            useBeforeDef_Expr(bb,stmt,ea->data[i],def_counts);
+         break;
       default: 
          vpanic("useBeforeDef_Stmt");
    }
@@ -4456,6 +4515,25 @@ void tcStmt ( const IRSB* bb, const IRStmt* stmt, IRType gWordTy )
          if (stmt->Ist.Exit.offsIP < 16)
             sanityCheckFail(bb,stmt,"IRStmt.Exit.offsIP: too low");
          break;
+      case Ist_EvAppend: {
+         const IREvAppend* ea = stmt->Ist.EvAppend.details;
+         if (ea->flush == NULL || !saneIRCallee(ea->flush))
+            sanityCheckFail(bb,stmt,"IRStmt.EvAppend.flush: bad callee");
+         if (ea->offCursor < 0 || ea->offLimit < 0
+             || ea->offCursor == ea->offLimit)
+            sanityCheckFail(bb,stmt,"IRStmt.EvAppend: bad offsets");
+         if (ea->end != Iend_LE && ea->end != Iend_BE)
+            sanityCheckFail(bb,stmt,"IRStmt.EvAppend.end: bogus endianness");
+         if (ea->data == NULL || ea->data[0] == NULL)
+            sanityCheckFail(bb,stmt,"IRStmt.EvAppend.data: empty record");
+         for (i = 0; ea->data[i] != NULL; i++) {
+            tcExpr( bb, stmt, ea->data[i], gWordTy );
+            if (typeOfIRExpr(tyenv, ea->data[i]) == Ity_I1)
+               sanityCheckFail(bb,stmt,
+                               "IRStmt.EvAppend.data: cannot store :: Ity_I1");
+         }
+         break;
+      }
       default:
          vpanic("tcStmt");
    }
@@ -3213,6 +3213,191 @@ IRSB* spec_helpers_BB(
 }
 
 
+/*---------------------------------------------------------------*/
+/*--- Inlining of client-supplied helper bodies               ---*/
+/*---------------------------------------------------------------*/
+
+/* Bodies registered with LibVEX_RegisterInlineHelper.  Each is an
+   expression in which IRExpr_Binder(i) stands for the i'th argument
+   of a call.  They live in permanent storage. */
+
+#define N_INLINE_HELPERS 32
+
+typedef
+   struct {
+      void*   addr;
+      Int     nArgs;
+      IRExpr* body;
+      Int     maxPerBlock;
+   }
+   InlineHelper;
+
+static InlineHelper inline_helpers[N_INLINE_HELPERS];
+static Int          n_inline_helpers = 0;
+
+/* How many calls to each helper have been inlined in the block being
+   translated.  do_helper_inlining_BB runs both before and after
+   instrumentation, and maxPerBlock bounds the total of the two. */
+static Int          inline_helper_nDone[N_INLINE_HELPERS];
+
+/* Is 'e' something we can substitute arguments into and evaluate
+   anywhere?  It mustn't read the guest state or memory, or refer to
+   temporaries. */
+static Bool inline_body_ok ( const IRExpr* e, Int nArgs )
+{
+   Int i;
+   switch (e->tag) {
+      case Iex_Binder:
+         return e->Iex.Binder.binder >= 0 && e->Iex.Binder.binder < nArgs;
+      case Iex_Const:
+         return True;
+      case Iex_Unop:
+         return inline_body_ok(e->Iex.Unop.arg, nArgs);
+      case Iex_Binop:
+         return inline_body_ok(e->Iex.Binop.arg1, nArgs)
+                && inline_body_ok(e->Iex.Binop.arg2, nArgs);
+      case Iex_Triop:
+         return inline_body_ok(e->Iex.Triop.details->arg1, nArgs)
+                && inline_body_ok(e->Iex.Triop.details->arg2, nArgs)
+                && inline_body_ok(e->Iex.Triop.details->arg3, nArgs);
+      case Iex_Qop:
+         return inline_body_ok(e->Iex.Qop.details->arg1, nArgs)
+                && inline_body_ok(e->Iex.Qop.details->arg2, nArgs)
+                && inline_body_ok(e->Iex.Qop.details->arg3, nArgs)
+                && inline_body_ok(e->Iex.Qop.details->arg4, nArgs);
+      case Iex_ITE:
+         return inline_body_ok(e->Iex.ITE.cond, nArgs)
+                && inline_body_ok(e->Iex.ITE.iftrue, nArgs)
+                && inline_body_ok(e->Iex.ITE.iffalse, nArgs);
+      case Iex_CCall:
+         for (i = 0; e->Iex.CCall.args[i]; i++)
+            if (!inline_body_ok(e->Iex.CCall.args[i], nArgs))
+               return False;
+         return True;
+      default:
+         return False;
+   }
+}
+
+void iropt_register_inline_helper ( void* addr, Int nArgs, IRExpr* body,
+                                    Int maxPerBlock )
+{
+   Int i;
+   vassert(addr != NULL);
+   vassert(nArgs >= 0);
+   vassert(maxPerBlock >= 0);
+   if (!inline_body_ok(body, nArgs))
+      vpanic("LibVEX_RegisterInlineHelper: invalid body");
+   for (i = 0; i < n_inline_helpers; i++)
+      if (inline_helpers[i].addr == addr)
+         break;
+   if (i == N_INLINE_HELPERS)
+      vpanic("LibVEX_RegisterInlineHelper: too many helpers");
+   inline_helpers[i].addr        = addr;
+   inline_helpers[i].nArgs       = nArgs;
+   inline_helpers[i].body        = body;
+   inline_helpers[i].maxPerBlock = maxPerBlock;
+   if (i == n_inline_helpers)
+      n_inline_helpers++;
+}
+
+/* A copy of 'e' with the binders replaced by (copies of) 'args'. */
+static IRExpr* inline_subst ( const IRExpr* e, IRExpr** args )
+{
+   Int      i;
+   IRExpr** cargs;
+   switch (e->tag) {
+      case Iex_Binder:
+         return deepCopyIRExpr(args[e->Iex.Binder.binder]);
+      case Iex_Const:
+         return deepCopyIRExpr(e);
+      case Iex_Unop:
+         return IRExpr_Unop(e->Iex.Unop.op,
+                            inline_subst(e->Iex.Unop.arg, args));
+      case Iex_Binop:
+         return IRExpr_Binop(e->Iex.Binop.op,
+                             inline_subst(e->Iex.Binop.arg1, args),
+                             inline_subst(e->Iex.Binop.arg2, args));
+      case Iex_Triop:
+         return IRExpr_Triop(e->Iex.Triop.details->op,
+                             inline_subst(e->Iex.Triop.details->arg1, args),
+                             inline_subst(e->Iex.Triop.details->arg2, args),
+                             inline_subst(e->Iex.Triop.details->arg3, args));
+      case Iex_Qop:
+         return IRExpr_Qop(e->Iex.Qop.details->op,
+                           inline_subst(e->Iex.Qop.details->arg1, args),
+                           inline_subst(e->Iex.Qop.details->arg2, args),
+                           inline_subst(e->Iex.Qop.details->arg3, args),
+                           inline_subst(e->Iex.Qop.details->arg4, args));
+      case Iex_ITE:
+         return IRExpr_ITE(inline_subst(e->Iex.ITE.cond, args),
+                           inline_subst(e->Iex.ITE.iftrue, args),
+                           inline_subst(e->Iex.ITE.iffalse, args));
+      case Iex_CCall:
+         cargs = shallowCopyIRExprVec(e->Iex.CCall.args);
+         for (i = 0; cargs[i]; i++)
+            cargs[i] = inline_subst(cargs[i], args);
+         return IRExpr_CCall(deepCopyIRCallee(e->Iex.CCall.cee),
+                             e->Iex.CCall.retty, cargs);
+      default:
+         vpanic("inline_subst");
+   }
+}
+
+IRSB* do_helper_inlining_BB ( IRSB* bb, Bool newBlock )
+{
+   Int      i, h, nArgs;
+   Int*     nDone = inline_helper_nDone;
+   IRStmt*  st;
+   IRExpr*  call;
+   IRExpr*  ex;
+   Bool     any = False;
+
+   if (newBlock) {
+      for (h = 0; h < N_INLINE_HELPERS; h++)
+         nDone[h] = 0;
+   }
+
+   if (n_inline_helpers == 0)
+      return bb;
+
+   for (i = 0; i < bb->stmts_used; i++) {
+      st = bb->stmts[i];
+
+      if (st->tag != Ist_WrTmp
+          || st->Ist.WrTmp.data->tag != Iex_CCall)
+         continue;
+
+      call = st->Ist.WrTmp.data;
+      for (h = 0; h < n_inline_helpers; h++)
+         if (inline_helpers[h].addr == call->Iex.CCall.cee->addr)
+            break;
+      if (h == n_inline_helpers
+          || nDone[h] >= inline_helpers[h].maxPerBlock)
+         continue;
+
+      for (nArgs = 0; call->Iex.CCall.args[nArgs]; nArgs++)
+         ;
+      if (nArgs != inline_helpers[h].nArgs)
+         vpanic("do_helper_inlining_BB: wrong number of args");
+
+      ex = inline_subst(inline_helpers[h].body, call->Iex.CCall.args);
+      if (typeOfIRExpr(bb->tyenv, ex) != call->Iex.CCall.retty)
+         vpanic("do_helper_inlining_BB: body has the wrong type");
+
+      bb->stmts[i] = IRStmt_WrTmp(st->Ist.WrTmp.tmp, ex);
+      nDone[h]++;
+      any = True;
+   }
+
+   if (any)
+      bb = flatten_BB(bb);
+   return bb;
+}
+
+#undef N_INLINE_HELPERS
+
+
 /*---------------------------------------------------------------*/
 /*--- Determination of guest state aliasing relationships     ---*/
 /*---------------------------------------------------------------*/
@@ -5949,6 +6134,1011 @@ static Interval stmt_modifies_guest_state (
 }
 
 
+/*---------------------------------------------------------------*/
+/*--- Lowering of event buffer appends                        ---*/
+/*---------------------------------------------------------------*/
+
+/* Replace each Ist_EvAppend in bb with plain IR.  For each distinct
+   buffer, the block gets a prologue
+
+      t_cur  = GET(offCursor)
+      t_lim  = GET(offLimit)
+      t_room = Sub(t_lim, t_cur)
+      t_full = CmpLT(t_room, <bytes appended to this buffer by bb>)
+      DIRTY t_full RdFX-gst(offLimit) MoFX-gst(offCursor)
+            ::: flush(BBPTR)
+      t_base = GET(offCursor)
+
+   and an append of a record starting N bytes into the block's
+   share of the buffer becomes
+
+      t_a0 = Add(t_base, N)
+      ST(t_a0) = data[0]
+      t_a1 = Add(t_base, N + sizeof(data[0]))
+      ST(t_a1) = data[1]
+      ...
+      t_new = Add(t_base, N + sizeof(record))
+      PUT(offCursor) = t_new
+
+   Writing the cursor back after every record keeps it correct at
+   side exits and at memory exception points.  The prologue is placed
+   at the start of the block, where the guest state is up to date and
+   the fewest values are live across the (rarely taken) call. */
+
+#define N_EVAPPEND_BUFS 4
+
+static UInt evappend_record_szB ( const IRTypeEnv* tyenv,
+                                  const IREvAppend* ea )
+{
+   Int  i;
+   UInt szB = 0;
+   for (i = 0; ea->data[i] != NULL; i++)
+      szB += sizeofIRType(typeOfIRExpr(tyenv, ea->data[i]));
+   return szB;
+}
+
+static IRExpr* evappend_mkWord ( IRType gWordTy, ULong w )
+{
+   return gWordTy == Ity_I64 ? IRExpr_Const(IRConst_U64(w))
+                             : IRExpr_Const(IRConst_U32((UInt)w));
+}
+
+IRSB* do_evappend_lowering_BB ( IRSB* bb, IRType gWordTy )
+{
+   Int       offCursor[N_EVAPPEND_BUFS];
+   Int       offLimit[N_EVAPPEND_BUFS];
+   IRCallee* flush[N_EVAPPEND_BUFS];
+   UInt      totalB[N_EVAPPEND_BUFS];
+   UInt      soFarB[N_EVAPPEND_BUFS];
+   IRTemp    base[N_EVAPPEND_BUFS];
+   Int       i, j, b, nBufs = 0;
+   IRSB*     out;
+   IRStmt*   st;
+
+   Bool is64  = gWordTy == Ity_I64;
+   IROp opAdd = is64 ? Iop_Add64 : Iop_Add32;
+   IROp opSub = is64 ? Iop_Sub64 : Iop_Sub32;
+   IROp opLT  = is64 ? Iop_CmpLT64U : Iop_CmpLT32U;
+   Int  wordB = is64 ? 8 : 4;
+
+   vassert(gWordTy == Ity_I32 || gWordTy == Ity_I64);
+
+   /* Find the buffers, and how much each one is appended to. */
+   for (i = 0; i < bb->stmts_used; i++) {
+      st = bb->stmts[i];
+      if (st->tag != Ist_EvAppend)
+         continue;
+      const IREvAppend* ea = st->Ist.EvAppend.details;
+      for (b = 0; b < nBufs; b++)
+         if (offCursor[b] == ea->offCursor)
+            break;
+      if (b == nBufs) {
+         if (nBufs == N_EVAPPEND_BUFS)
+            vpanic("do_evappend_lowering_BB: too many event buffers");
+         offCursor[b] = ea->offCursor;
+         offLimit[b]  = ea->offLimit;
+         flush[b]     = ea->flush;
+         totalB[b]    = 0;
+         soFarB[b]    = 0;
+         nBufs++;
+      }
+      vassert(offLimit[b] == ea->offLimit);
+      totalB[b] += evappend_record_szB(bb->tyenv, ea);
+   }
+
+   if (nBufs == 0)
+      return bb;
+
+   out = deepCopyIRSBExceptStmts(bb);
+
+   /* The per-buffer space checks. */
+   for (b = 0; b < nBufs; b++) {
+      IRTemp cur  = newIRTemp(out->tyenv, gWordTy);
+      IRTemp lim  = newIRTemp(out->tyenv, gWordTy);
+      IRTemp room = newIRTemp(out->tyenv, gWordTy);
+      IRTemp full = newIRTemp(out->tyenv, Ity_I1);
+      addStmtToIRSB(out, IRStmt_WrTmp(cur, IRExpr_Get(offCursor[b],
+                                                       gWordTy)));
+      addStmtToIRSB(out, IRStmt_WrTmp(lim, IRExpr_Get(offLimit[b],
+                                                       gWordTy)));
+      addStmtToIRSB(out, IRStmt_WrTmp(room,
+                            IRExpr_Binop(opSub, IRExpr_RdTmp(lim),
+                                                IRExpr_RdTmp(cur))));
+      addStmtToIRSB(out, IRStmt_WrTmp(full,
+                            IRExpr_Binop(opLT, IRExpr_RdTmp(room),
+                                         evappend_mkWord(gWordTy,
+                                                         totalB[b]))));
+
+      IRDirty* d = emptyIRDirty();
+      d->cee      = flush[b];
+      d->guard    = IRExpr_RdTmp(full);
+      d->args     = mkIRExprVec_1(IRExpr_BBPTR());
+      d->nFxState = 2;
+      vex_bzero(&d->fxState, sizeof(d->fxState));
+      d->fxState[0].fx     = Ifx_Modify;
+      d->fxState[0].offset = offCursor[b];
+      d->fxState[0].size   = wordB;
+      d->fxState[1].fx     = Ifx_Read;
+      d->fxState[1].offset = offLimit[b];
+      d->fxState[1].size   = wordB;
+      addStmtToIRSB(out, IRStmt_Dirty(d));
+
+      base[b] = newIRTemp(out->tyenv, gWordTy);
+      addStmtToIRSB(out, IRStmt_WrTmp(base[b], IRExpr_Get(offCursor[b],
+                                                           gWordTy)));
+   }
+
+   /* The appends themselves. */
+   for (i = 0; i < bb->stmts_used; i++) {
+      st = bb->stmts[i];
+      if (st->tag != Ist_EvAppend) {
+         addStmtToIRSB(out, st);
+         continue;
+      }
+      const IREvAppend* ea = st->Ist.EvAppend.details;
+      for (b = 0; b < nBufs; b++)
+         if (offCursor[b] == ea->offCursor)
+            break;
+      vassert(b < nBufs);
+      for (j = 0; ea->data[j] != NULL; j++) {
+         IRTemp addr = newIRTemp(out->tyenv, gWordTy);
+         addStmtToIRSB(out, IRStmt_WrTmp(addr,
+                               IRExpr_Binop(opAdd, IRExpr_RdTmp(base[b]),
+                                            evappend_mkWord(gWordTy,
+                                                            soFarB[b]))));
+         addStmtToIRSB(out, IRStmt_Store(ea->end, IRExpr_RdTmp(addr),
+                                         ea->data[j]));
+         soFarB[b] += sizeofIRType(typeOfIRExpr(bb->tyenv, ea->data[j]));
+      }
+      IRTemp cur = newIRTemp(out->tyenv, gWordTy);
+      addStmtToIRSB(out, IRStmt_WrTmp(cur,
+                            IRExpr_Binop(opAdd, IRExpr_RdTmp(base[b]),
+                                         evappend_mkWord(gWordTy,
+                                                         soFarB[b]))));
+      addStmtToIRSB(out, IRStmt_Put(offCursor[b], IRExpr_RdTmp(cur)));
+   }
+
+   for (b = 0; b < nBufs; b++)
+      vassert(soFarB[b] == totalB[b]);
+
+   return out;
+}
+
+#undef N_EVAPPEND_BUFS
+
+
+/*---------------------------------------------------------------*/
+/*--- Merging of adjacent constant stores                     ---*/
+/*---------------------------------------------------------------*/
+
+/* Front ends expand some instructions into runs of small constant
+   stores to consecutive addresses -- ppc dcbz is 16 8-byte (or 32
+   4-byte) zero stores per cache line.  Find such runs and replace
+   them with stores as wide as the host is happy with.
+
+   A run is a sequence of constant stores, all with the same
+   endianness and to addresses of the form base+const for a single
+   base, separated by nothing other than other members of the run,
+   NoOps, and WrTmps that do not load.  So no other memory access
+   comes between two members, and nothing observable happens between
+   them apart from temporaries being computed.  A run never crosses an
+   IMark; the members therefore belong to a single guest instruction,
+   so merging them cannot move a store across a point at which
+   precise exceptions would need the guest state to be up to date.
+   Members of a run never overlap, so the order in which they are done
+   is immaterial.
+
+   Within a run, groups of 2 or more members exactly covering an
+   aligned 2, 4, 8 or 16 byte range are each replaced by a single
+   store, placed where the last member of the group was.  16-byte
+   groups are only made if all the bytes are zero.  Ranges need only
+   be aligned relative to the base unless the host requires aligned
+   stores, in which case the base must be known to be suitably
+   aligned too, which is so when it is the result of And-ing with a
+   constant, or is itself a constant. */
+
+#define N_STMERGE_RUN 64
+
+typedef
+   struct {
+      Int    ix;       /* statement index */
+      Long   off;      /* offset from the run's base */
+      Int    szB;
+      UChar  bytes[8]; /* the stored value, in memory order */
+   }
+   StMergeEnt;
+
+/* Track addresses of the form base+offset.  For each temporary t,
+   baseOf[t] and offOf[t] say that t = baseOf[t] + offOf[t]; they
+   start as t and 0.  alignOf[t], if wanted, is a power of two (at
+   most 16) that t is known to be a multiple of; it starts as 1.
+   Call addr_note_def on each WrTmp in turn. */
+static void addr_note_def ( const IRStmt* st,
+                            /*MOD*/IRTemp* baseOf, /*MOD*/Long* offOf,
+                            /*MOD*/UInt* alignOf )
+{
+   IRTemp         t, a;
+   const IRExpr*  e;
+   const IRConst* c;
+   ULong          cv;
+
+   vassert(st->tag == Ist_WrTmp);
+   t = st->Ist.WrTmp.tmp;
+   e = st->Ist.WrTmp.data;
+   if (e->tag != Iex_Binop
+       || e->Iex.Binop.arg1->tag != Iex_RdTmp
+       || e->Iex.Binop.arg2->tag != Iex_Const)
+      return;
+   a = e->Iex.Binop.arg1->Iex.RdTmp.tmp;
+   c = e->Iex.Binop.arg2->Iex.Const.con;
+   if (c->tag == Ico_U64)
+      cv = c->Ico.U64;
+   else if (c->tag == Ico_U32)
+      cv = c->Ico.U32;
+   else
+      return;
+
+   switch (e->Iex.Binop.op) {
+      case Iop_Add64:
+         baseOf[t] = baseOf[a];
+         offOf[t]  = offOf[a] + (Long)cv;
+         break;
+      case Iop_Sub64:
+         baseOf[t] = baseOf[a];
+         offOf[t]  = offOf[a] - (Long)cv;
+         break;
+      /* Keep 32-bit offsets canonical, so that the same address
+         always gets the same offset. */
+      case Iop_Add32:
+         baseOf[t] = baseOf[a];
+         offOf[t]  = (Int)(offOf[a] + (Long)cv);
+         break;
+      case Iop_Sub32:
+         baseOf[t] = baseOf[a];
+         offOf[t]  = (Int)(offOf[a] - (Long)cv);
+         break;
+      case Iop_And32: case Iop_And64: {
+         UInt al = 1;
+         if (!alignOf)
+            break;
+         while (al < 16 && (cv & al) == 0)
+            al <<= 1;
+         alignOf[t] = al;
+         break;
+      }
+      default:
+         break;
+   }
+}
+
+/* Base and offset of an address expression.  A constant address has
+   base IRTemp_INVALID. */
+static Bool addr_base_off ( const IRExpr* e,
+                            const IRTemp* baseOf, const Long* offOf,
+                            /*OUT*/IRTemp* base, /*OUT*/Long* off )
+{
+   if (e->tag == Iex_RdTmp) {
+      *base = baseOf[e->Iex.RdTmp.tmp];
+      *off  = offOf[e->Iex.RdTmp.tmp];
+      return True;
+   }
+   if (e->tag == Iex_Const) {
+      switch (e->Iex.Const.con->tag) {
+         case Ico_U32: *off = (Int)e->Iex.Const.con->Ico.U32; break;
+         case Ico_U64: *off = (Long)e->Iex.Const.con->Ico.U64; break;
+         default: return False;
+      }
+      *base = IRTemp_INVALID;
+      return True;
+   }
+   return False;
+}
+
+static Bool stmerge_const_bytes ( const IRExpr* data, IREndness end,
+                                  /*OUT*/UChar* bytes, /*OUT*/Int* szB )
+{
+   ULong v;
+   Int   i, n;
+   if (data->tag != Iex_Const)
+      return False;
+   switch (data->Iex.Const.con->tag) {
+      case Ico_U8:  v = data->Iex.Const.con->Ico.U8;  n = 1; break;
+      case Ico_U16: v = data->Iex.Const.con->Ico.U16; n = 2; break;
+      case Ico_U32: v = data->Iex.Const.con->Ico.U32; n = 4; break;
+      case Ico_U64: v = data->Iex.Const.con->Ico.U64; n = 8; break;
+      default: return False;
+   }
+   for (i = 0; i < n; i++)
+      bytes[end == Iend_LE ? i : n-1-i] = (UChar)(v >> (8*i));
+   *szB = n;
+   return True;
+}
+
+static IRExpr* stmerge_mkConst ( const UChar* bytes, Int szB,
+                                 IREndness end )
+{
+   ULong v = 0;
+   Int   i;
+   if (szB == 16) {
+      for (i = 0; i < 16; i++)
+         vassert(bytes[i] == 0);
+      return IRExpr_Const(IRConst_V128(0));
+   }
+   for (i = 0; i < szB; i++)
+      v |= ((ULong)bytes[end == Iend_LE ? i : szB-1-i]) << (8*i);
+   switch (szB) {
+      case 2: return IRExpr_Const(IRConst_U16((UShort)v));
+      case 4: return IRExpr_Const(IRConst_U32((UInt)v));
+      case 8: return IRExpr_Const(IRConst_U64(v));
+      default: vpanic("stmerge_mkConst");
+   }
+}
+
+/* Find the groups in 'run' and record them in 'repl': the last
+   member of each group gets the merged store, the others get an
+   IRStmt_NoOp.  Returns the number of stores removed. */
+static Int stmerge_run ( const IRSB* bb, StMergeEnt* run, Int nRun,
+                         UInt baseAlign, IREndness end,
+                         Int maxSzB, Bool unalignedOK,
+                         /*MOD*/IRStmt** repl )
+{
+   StMergeEnt tmp;
+   UChar      bytes[16];
+   Int        i, j, k, szB, nMerged, last, nRemoved = 0;
+
+   if (nRun < 2)
+      return 0;
+
+   /* Sort by offset. */
+   for (i = 1; i < nRun; i++) {
+      tmp = run[i];
+      for (j = i; j > 0 && run[j-1].off > tmp.off; j--)
+         run[j] = run[j-1];
+      run[j] = tmp;
+   }
+
+   i = 0;
+   while (i < nRun) {
+      /* Look for the widest group starting at run[i]. */
+      nMerged = 0;
+      for (szB = maxSzB; szB > run[i].szB; szB /= 2) {
+         Long covered = 0;
+         Bool zero    = True;
+         if (run[i].off % szB != 0)
+            continue;
+         if (!unalignedOK && baseAlign < szB)
+            continue;
+         for (j = i; j < nRun && covered < szB; j++) {
+            if (run[j].off != run[i].off + covered
+                || covered + run[j].szB > szB)
+               break;
+            for (k = 0; k < run[j].szB; k++) {
+               bytes[covered + k] = run[j].bytes[k];
+               zero = zero && run[j].bytes[k] == 0;
+            }
+            covered += run[j].szB;
+         }
+         if (covered == szB && (szB < 16 || zero)) {
+            nMerged = j - i;
+            break;
+         }
+      }
+      if (nMerged < 2) {
+         i++;
+         continue;
+      }
+      last = i;
+      for (j = i; j < i + nMerged; j++) {
+         if (run[j].ix > run[last].ix)
+            last = j;
+         repl[run[j].ix] = IRStmt_NoOp();
+      }
+      repl[run[last].ix]
+         = IRStmt_Store(end, bb->stmts[run[i].ix]->Ist.Store.addr,
+                        stmerge_mkConst(bytes, szB, end));
+      nRemoved += nMerged - 1;
+      i += nMerged;
+   }
+   return nRemoved;
+}
+
+IRSB* do_store_merging_BB ( IRSB* bb, IRType widestTy, Bool unalignedOK )
+{
+   IRTemp*    baseOf;
+   Long*      offOf;
+   UInt*      alignOf;
+   IRStmt**   repl;
+   StMergeEnt run[N_STMERGE_RUN];
+   Int        i, nRun = 0, nRemoved = 0, nStores = 0;
+   IRTemp     runBase = IRTemp_INVALID;
+   IREndness  runEnd  = Iend_LE;
+   Int        maxSzB  = sizeofIRType(widestTy);
+   Int        nTmps   = bb->tyenv->types_used;
+
+   vassert(maxSzB == 4 || maxSzB == 8 || maxSzB == 16);
+
+   for (i = 0; i < bb->stmts_used; i++)
+      if (bb->stmts[i]->tag == Ist_Store)
+         nStores++;
+   if (nStores < 2)
+      return bb;
+
+   baseOf  = LibVEX_Alloc_inline((nTmps+1) * sizeof(IRTemp));
+   offOf   = LibVEX_Alloc_inline((nTmps+1) * sizeof(Long));
+   alignOf = LibVEX_Alloc_inline((nTmps+1) * sizeof(UInt));
+   repl    = LibVEX_Alloc_inline(bb->stmts_used * sizeof(IRStmt*));
+   for (i = 0; i < nTmps; i++) {
+      baseOf[i]  = (IRTemp)i;
+      offOf[i]   = 0;
+      alignOf[i] = 1;
+   }
+   for (i = 0; i < bb->stmts_used; i++)
+      repl[i] = NULL;
+
+#  define FLUSH_RUN                                                     \
+      do {                                                              \
+         nRemoved += stmerge_run(bb, run, nRun,                         \
+                                 runBase == IRTemp_INVALID              \
+                                    ? 16 : alignOf[runBase],            \
+                                 runEnd, maxSzB, unalignedOK, repl);    \
+         nRun = 0;                                                      \
+      } while (0)
+
+   for (i = 0; i < bb->stmts_used; i++) {
+      IRStmt* st = bb->stmts[i];
+
+      if (st->tag == Ist_WrTmp) {
+         addr_note_def(st, baseOf, offOf, alignOf);
+         if (st->Ist.WrTmp.data->tag == Iex_Load)
+            FLUSH_RUN;
+         continue;
+      }
+
+      if (st->tag == Ist_NoOp)
+         continue;
+
+      if (st->tag == Ist_Store) {
+         StMergeEnt ent;
+         IRTemp     base;
+         Int        j;
+         Bool       ok = addr_base_off(st->Ist.Store.addr, baseOf, offOf,
+                                      &base, &ent.off)
+                         && stmerge_const_bytes(st->Ist.Store.data,
+                                                st->Ist.Store.end,
+                                                ent.bytes, &ent.szB);
+         if (ok && nRun > 0
+             && (base != runBase || st->Ist.Store.end != runEnd))
+            FLUSH_RUN;
+         for (j = 0; ok && j < nRun; j++) {
+            if (ent.off < run[j].off + run[j].szB
+                && run[j].off < ent.off + ent.szB) {
+               /* Overlap; stop here. */
+               FLUSH_RUN;
+               break;
+            }
+         }
+         if (!ok) {
+            FLUSH_RUN;
+            continue;
+         }
+         if (nRun == N_STMERGE_RUN)
+            FLUSH_RUN;
+         ent.ix        = i;
+         runBase       = base;
+         runEnd        = st->Ist.Store.end;
+         run[nRun++]   = ent;
+         continue;
+      }
+
+      /* Anything else, including an IMark, ends the run. */
+      FLUSH_RUN;
+   }
+   FLUSH_RUN;
+
+#  undef FLUSH_RUN
+
+   if (nRemoved == 0)
+      return bb;
+
+   for (i = 0; i < bb->stmts_used; i++)
+      if (repl[i])
+         bb->stmts[i] = repl[i];
+   /* Clear away the address computations of the removed stores. */
+   do_deadcode_BB(bb);
+   return bb;
+}
+
+#undef N_STMERGE_RUN
+
+
+/*---------------------------------------------------------------*/
+/*--- Superword-level parallelism                             ---*/
+/*---------------------------------------------------------------*/
+
+/* Front ends expand packed operations that the guest does with
+   scalar code -- and unrolled loops do the same -- into runs like
+
+      t1 = LDle:I32(a)      t2 = LDle:I32(b)      t3 = Add32(t1,t2)
+      STle(c) = t3
+      t4 = LDle:I32(a+4)    t5 = LDle:I32(b+4)    t6 = Add32(t4,t5)
+      STle(c+4) = t6
+      ...
+
+   do_slp_BB looks for a group of lanes like this which fill exactly
+   16 bytes of memory or guest state, and, where the host does the
+   corresponding V128 operation inline, replaces the group by
+
+      v1 = LDle:V128(a)  v2 = LDle:V128(b)  v3 = Add32x4(v1,v2)
+      STle(c) = v3
+
+   at the position of the last lane's store.  Operands must be
+   adjacent loads from a common base, or adjacent Gets.  Since all
+   the lanes' loads and stores are moved down to that point, the
+   group is only vectorised if no memory or guest state access it
+   moves past could alias them; addresses with different bases are
+   assumed to alias.  Only integer operations are done, so there are
+   no rounding modes to worry about.
+
+   Vectorising costs a load or Get per operand, the operation and the
+   store.  The saving is a store and an operation per lane, and a
+   load per lane for operands not used elsewhere.  A group has to
+   save at least twice what it costs; this keeps out two-lane groups
+   whose loads have to stay anyway. */
+
+#define N_SLP_MAX_LANES 16
+
+typedef
+   struct {
+      IRTemp base;    /* address base, or IRTemp_INVALID if none */
+      Long   off;     /* offset from base, or guest state offset */
+      Int    szB;
+      Bool   isMem;
+      Bool   isWrite;
+      Bool   anyAddr; /* address unknown: may alias any memory */
+      Bool   isLane;
+   }
+   SlpAccess;
+
+/* Vector version of a scalar integer operation. */
+static IROp slp_vector_op ( IROp op )
+{
+   switch (op) {
+      case Iop_Add8:  return Iop_Add8x16;
+      case Iop_Add16: return Iop_Add16x8;
+      case Iop_Add32: return Iop_Add32x4;
+      case Iop_Add64: return Iop_Add64x2;
+      case Iop_Sub8:  return Iop_Sub8x16;
+      case Iop_Sub16: return Iop_Sub16x8;
+      case Iop_Sub32: return Iop_Sub32x4;
+      case Iop_Sub64: return Iop_Sub64x2;
+      case Iop_Mul8:  return Iop_Mul8x16;
+      case Iop_Mul16: return Iop_Mul16x8;
+      case Iop_Mul32: return Iop_Mul32x4;
+      case Iop_And8: case Iop_And16: case Iop_And32: case Iop_And64:
+         return Iop_AndV128;
+      case Iop_Or8:  case Iop_Or16:  case Iop_Or32:  case Iop_Or64:
+         return Iop_OrV128;
+      case Iop_Xor8: case Iop_Xor16: case Iop_Xor32: case Iop_Xor64:
+         return Iop_XorV128;
+      default:
+         return Iop_INVALID;
+   }
+}
+
+/* The memory or guest state access made by st, if any.  Returns
+   False for statements that access neither. */
+static Bool slp_access ( const IRSB* bb, const IRStmt* st,
+                         const IRTemp* baseOf, const Long* offOf,
+                         /*OUT*/SlpAccess* acc )
+{
+   const IRExpr* addr;
+
+   acc->isLane  = False;
+   acc->anyAddr = False;
+   switch (st->tag) {
+      case Ist_Put:
+         acc->isMem   = False;
+         acc->isWrite = True;
+         acc->base    = IRTemp_INVALID;
+         acc->off     = st->Ist.Put.offset;
+         acc->szB     = sizeofIRType(typeOfIRExpr(bb->tyenv,
+                                                  st->Ist.Put.data));
+         return True;
+      case Ist_Store:
+         acc->isMem   = True;
+         acc->isWrite = True;
+         acc->szB     = sizeofIRType(typeOfIRExpr(bb->tyenv,
+                                                  st->Ist.Store.data));
+         addr = st->Ist.Store.addr;
+         break;
+      case Ist_WrTmp:
+         switch (st->Ist.WrTmp.data->tag) {
+            case Iex_Get:
+               acc->isMem   = False;
+               acc->isWrite = False;
+               acc->base    = IRTemp_INVALID;
+               acc->off     = st->Ist.WrTmp.data->Iex.Get.offset;
+               acc->szB     = sizeofIRType(st->Ist.WrTmp.data->Iex.Get.ty);
+               return True;
+            case Iex_Load:
+               acc->isMem   = True;
+               acc->isWrite = False;
+               acc->szB     = sizeofIRType(st->Ist.WrTmp.data->Iex.Load.ty);
+               addr = st->Ist.WrTmp.data->Iex.Load.addr;
+               break;
+            default:
+               return False;
+         }
+         break;
+      default:
+         return False;
+   }
+   if (!addr_base_off(addr, baseOf, offOf, &acc->base, &acc->off))
+      acc->anyAddr = True;
+   return True;
+}
+
+static Bool slp_may_alias ( const SlpAccess* a1, const SlpAccess* a2 )
+{
+   if (a1->isMem != a2->isMem)
+      return False;
+   if (a1->isMem && (a1->anyAddr || a2->anyAddr || a1->base != a2->base))
+      return True;
+   return a1->off < a2->off + a2->szB && a2->off < a1->off + a1->szB;
+}
+
+/* Is t defined by a little-endian Load or a Get, of type ty?  If so,
+   say where from, and give the defining statement. */
+static Bool slp_operand ( const IRSB* bb, IRTemp t, IRType ty,
+                          const Int* defIx,
+                          const IRTemp* baseOf, const Long* offOf,
+                          /*OUT*/Bool* isMem, /*OUT*/IRTemp* base,
+                          /*OUT*/Long* off, /*OUT*/Int* ix )
+{
+   const IRExpr* e;
+
+   if (defIx[t] < 0)
+      return False;
+   e = bb->stmts[defIx[t]]->Ist.WrTmp.data;
+   *ix = defIx[t];
+   if (e->tag == Iex_Get && e->Iex.Get.ty == ty) {
+      *isMem = False;
+      *base  = IRTemp_INVALID;
+      *off   = e->Iex.Get.offset;
+      return True;
+   }
+   if (e->tag == Iex_Load && e->Iex.Load.end == Iend_LE
+       && e->Iex.Load.ty == ty) {
+      *isMem = True;
+      return addr_base_off(e->Iex.Load.addr, baseOf, offOf, base, off);
+   }
+   return False;
+}
+
+/* A statement that may be a lane's destination: a little-endian
+   Store or a Put of a single-use temporary computed by a Binop with
+   a vector equivalent. */
+typedef
+   struct {
+      Int    ix;      /* stmt index */
+      Int    opIx;    /* stmt index of the Binop */
+      Bool   isMem;
+      IRTemp base;
+      Long   off;
+      IRType ty;
+      IROp   op;
+      IRTemp arg[2];
+   }
+   SlpDst;
+
+IRSB* do_slp_BB ( IRSB* bb, Bool (*nativeOp)(IROp), Bool acrossInsns )
+{
+   IRTemp*    baseOf;
+   Long*      offOf;
+   Int*       defIx;
+   UShort*    uses;
+   SlpDst*    dsts;
+   Int*       emitAt;    /* index into groups, or -1 */
+   Bool*      drop;
+   Bool*      taken;
+   SlpAccess* accs;
+   IRSB*      out;
+   Int        i, j, k, nDsts = 0, nGroups = 0;
+   Int        nTmps = bb->tyenv->types_used;
+   Int        nStmts = bb->stmts_used;
+   /* Accepted groups.  For each: lane 0's dst, and lane 0's operand
+      definitions. */
+   Int*       grpDst;
+   Int*       grpArg0;
+   Int*       grpArg1;
+
+   baseOf = LibVEX_Alloc_inline((nTmps+1) * sizeof(IRTemp));
+   offOf  = LibVEX_Alloc_inline((nTmps+1) * sizeof(Long));
+   defIx  = LibVEX_Alloc_inline((nTmps+1) * sizeof(Int));
+   uses   = LibVEX_Alloc_inline((nTmps+1) * sizeof(UShort));
+   for (i = 0; i < nTmps; i++) {
+      baseOf[i] = (IRTemp)i;
+      offOf[i]  = 0;
+      defIx[i]  = -1;
+      uses[i]   = 0;
+   }
+   for (i = 0; i < nStmts; i++) {
+      IRStmt* st = bb->stmts[i];
+      aoccCount_Stmt(uses, st);
+      if (st->tag == Ist_WrTmp) {
+         addr_note_def(st, baseOf, offOf, NULL);
+         defIx[st->Ist.WrTmp.tmp] = i;
+      }
+   }
+   aoccCount_Expr(uses, bb->next);
+
+   /* Find the candidate lane destinations. */
+   dsts = LibVEX_Alloc_inline((nStmts+1) * sizeof(SlpDst));
+   for (i = 0; i < nStmts; i++) {
+      IRStmt*       st = bb->stmts[i];
+      const IRExpr* data;
+      const IRExpr* val;
+      SlpDst*       d = &dsts[nDsts];
+
+      if (st->tag == Ist_Store && st->Ist.Store.end == Iend_LE) {
+         data     = st->Ist.Store.data;
+         d->isMem = True;
+         if (!addr_base_off(st->Ist.Store.addr, baseOf, offOf,
+                            &d->base, &d->off))
+            continue;
+      } else if (st->tag == Ist_Put) {
+         data     = st->Ist.Put.data;
+         d->isMem = False;
+         d->base  = IRTemp_INVALID;
+         d->off   = st->Ist.Put.offset;
+      } else {
+         continue;
+      }
+      if (data->tag != Iex_RdTmp
+          || uses[data->Iex.RdTmp.tmp] != 1
+          || defIx[data->Iex.RdTmp.tmp] < 0)
+         continue;
+      d->ty = typeOfIRExpr(bb->tyenv, data);
+      if (d->ty != Ity_I8 && d->ty != Ity_I16
+          && d->ty != Ity_I32 && d->ty != Ity_I64)
+         continue;
+      d->opIx = defIx[data->Iex.RdTmp.tmp];
+      val = bb->stmts[d->opIx]->Ist.WrTmp.data;
+      if (val->tag != Iex_Binop
+          || val->Iex.Binop.arg1->tag != Iex_RdTmp
+          || val->Iex.Binop.arg2->tag != Iex_RdTmp)
+         continue;
+      d->op = val->Iex.Binop.op;
+      if (slp_vector_op(d->op) == Iop_INVALID
+          || !nativeOp(slp_vector_op(d->op)))
+         continue;
+      d->arg[0] = val->Iex.Binop.arg1->Iex.RdTmp.tmp;
+      d->arg[1] = val->Iex.Binop.arg2->Iex.RdTmp.tmp;
+      d->ix     = i;
+      nDsts++;
+   }
+   if (nDsts < 2)
+      return bb;
+
+   emitAt  = LibVEX_Alloc_inline(nStmts * sizeof(Int));
+   drop    = LibVEX_Alloc_inline(nStmts * sizeof(Bool));
+   taken   = LibVEX_Alloc_inline(nStmts * sizeof(Bool));
+   accs    = LibVEX_Alloc_inline(nStmts * sizeof(SlpAccess));
+   grpDst  = LibVEX_Alloc_inline(nDsts * sizeof(Int));
+   grpArg0 = LibVEX_Alloc_inline(nDsts * sizeof(Int));
+   grpArg1 = LibVEX_Alloc_inline(nDsts * sizeof(Int));
+   for (i = 0; i < nStmts; i++) {
+      emitAt[i] = -1;
+      drop[i]   = False;
+      taken[i]  = False;
+   }
+
+   /* Try each candidate as lane 0 of a group. */
+   for (i = 0; i < nDsts; i++) {
+      const SlpDst* lane[N_SLP_MAX_LANES];
+      Int  laneIx[N_SLP_MAX_LANES][4];  /* dst, op, arg0, arg1 */
+      Int  szB   = sizeofIRType(dsts[i].ty);
+      Int  nLanes = 16 / szB;
+      Int  lo, hi, nAccs, saved, a;
+      Bool ok = True, firstPut;
+      Bool argIsMem[2];
+      IRTemp argBase[2];
+      Long   argOff[2];
+
+      lane[0] = &dsts[i];
+      for (k = 1; k < nLanes; k++) {
+         lane[k] = NULL;
+         for (j = 0; j < nDsts; j++) {
+            const SlpDst* d = &dsts[j];
+            if (d->isMem == dsts[i].isMem && d->base == dsts[i].base
+                && d->off == dsts[i].off + k * szB
+                && d->ty == dsts[i].ty && d->op == dsts[i].op) {
+               lane[k] = d;
+               break;
+            }
+         }
+         if (!lane[k]) {
+            ok = False;
+            break;
+         }
+      }
+      if (!ok)
+         continue;
+
+      /* The operands must be adjacent too. */
+      for (k = 0; ok && k < nLanes; k++) {
+         laneIx[k][0] = lane[k]->ix;
+         laneIx[k][1] = lane[k]->opIx;
+         for (a = 0; ok && a < 2; a++) {
+            Bool   isMem;
+            IRTemp base;
+            Long   off;
+            if (!slp_operand(bb, lane[k]->arg[a], dsts[i].ty, defIx,
+                             baseOf, offOf, &isMem, &base, &off,
+                             &laneIx[k][2+a]))
+               ok = False;
+            else if (k == 0) {
+               argIsMem[a] = isMem;
+               argBase[a]  = base;
+               argOff[a]   = off;
+            }
+            else if (isMem != argIsMem[a] || base != argBase[a]
+                     || off != argOff[a] + k * szB)
+               ok = False;
+         }
+      }
+      if (!ok)
+         continue;
+
+      /* Cost model. */
+      saved = 2 * nLanes;
+      for (a = 0; a < 2; a++) {
+         for (k = 0; k < nLanes; k++)
+            if (uses[lane[k]->arg[a]] != 1)
+               break;
+         if (k == nLanes)
+            saved += nLanes;
+      }
+      if (saved < 2 * 4)
+         continue;
+
+      /* The region the group spans. */
+      lo = hi = laneIx[0][0];
+      for (k = 0; k < nLanes; k++)
+         for (a = 0; a < 4; a++) {
+            if (laneIx[k][a] < lo) lo = laneIx[k][a];
+            if (laneIx[k][a] > hi) hi = laneIx[k][a];
+         }
+      for (j = lo; j <= hi; j++)
+         if (taken[j])
+            ok = False;
+      if (!ok)
+         continue;
+
+      /* Check that nothing in the region gets in the way of moving
+         the lanes' accesses down to hi. */
+      nAccs    = 0;
+      firstPut = False;
+      for (j = lo; ok && j <= hi; j++) {
+         IRStmt* st = bb->stmts[j];
+         Bool    isLane = False;
+         switch (st->tag) {
+            case Ist_NoOp: case Ist_AbiHint:
+            case Ist_WrTmp: case Ist_Put: case Ist_Store:
+               break;
+            case Ist_IMark:
+               if (!acrossInsns)
+                  ok = False;
+               break;
+            default:
+               ok = False;
+               break;
+         }
+         if (!ok)
+            break;
+         if (st->tag == Ist_WrTmp && st->Ist.WrTmp.data->tag == Iex_GetI) {
+            ok = False;
+            break;
+         }
+         for (k = 0; k < nLanes && !isLane; k++)
+            for (a = 0; a < 4; a++)
+               if (laneIx[k][a] == j)
+                  isLane = True;
+         if (!slp_access(bb, st, baseOf, offOf, &accs[nAccs]))
+            continue;
+         accs[nAccs].isLane = isLane;
+         /* Keep the guest state seen by a faulting memory access
+            unless told not to worry about it. */
+         if (isLane && st->tag == Ist_Put)
+            firstPut = True;
+         else if (firstPut && accs[nAccs].isMem && !acrossInsns)
+            ok = False;
+         nAccs++;
+      }
+      for (j = 0; ok && j < nAccs; j++) {
+         const SlpAccess* a1 = &accs[j];
+         if (!a1->isLane)
+            continue;
+         for (k = j+1; ok && k < nAccs; k++) {
+            const SlpAccess* a2 = &accs[k];
+            Bool reordered;
+            if (a1->isWrite)
+               /* A lane write goes past everything after it except
+                  other lane writes. */
+               reordered = !(a2->isLane && a2->isWrite);
+            else
+               /* A lane read goes past non-lane writes only. */
+               reordered = !a2->isLane && a2->isWrite;
+            if (reordered && slp_may_alias(a1, a2))
+               ok = False;
+         }
+      }
+      if (!ok)
+         continue;
+
+      /* Accept. */
+      if (vex_control.iropt_verbosity > 0) {
+         vex_printf("SLP: vectorising %d lanes of ", nLanes);
+         ppIROp(dsts[i].op);
+         vex_printf(" at stmt %d\n", hi);
+      }
+      for (j = lo; j <= hi; j++)
+         taken[j] = True;
+      for (k = 0; k < nLanes; k++) {
+         drop[laneIx[k][0]] = True;
+         drop[laneIx[k][1]] = True;
+      }
+      grpDst[nGroups]  = i;
+      grpArg0[nGroups] = laneIx[0][2];
+      grpArg1[nGroups] = laneIx[0][3];
+      emitAt[hi] = nGroups;
+      nGroups++;
+   }
+
+   if (nGroups == 0)
+      return bb;
+
+   out = deepCopyIRSBExceptStmts(bb);
+   for (i = 0; i < nStmts; i++) {
+      const SlpDst* d;
+      IRTemp        v[3];
+      if (emitAt[i] < 0) {
+         if (!drop[i])
+            addStmtToIRSB(out, bb->stmts[i]);
+         continue;
+      }
+      d = &dsts[grpDst[emitAt[i]]];
+      for (j = 0; j < 2; j++) {
+         const IRExpr* e
+            = bb->stmts[j == 0 ? grpArg0[emitAt[i]]
+                               : grpArg1[emitAt[i]]]->Ist.WrTmp.data;
+         v[j] = newIRTemp(out->tyenv, Ity_V128);
+         addStmtToIRSB(out, IRStmt_WrTmp(v[j],
+            e->tag == Iex_Get
+               ? IRExpr_Get(e->Iex.Get.offset, Ity_V128)
+               : IRExpr_Load(Iend_LE, Ity_V128, e->Iex.Load.addr)));
+      }
+      v[2] = newIRTemp(out->tyenv, Ity_V128);
+      addStmtToIRSB(out, IRStmt_WrTmp(v[2],
+                            IRExpr_Binop(slp_vector_op(d->op),
+                                         IRExpr_RdTmp(v[0]),
+                                         IRExpr_RdTmp(v[1]))));
+      if (d->isMem)
+         addStmtToIRSB(out, IRStmt_Store(Iend_LE,
+                                         bb->stmts[d->ix]->Ist.Store.addr,
+                                         IRExpr_RdTmp(v[2])));
+      else
+         addStmtToIRSB(out, IRStmt_Put(d->off, IRExpr_RdTmp(v[2])));
+   }
+   /* Clear away the scalar loads and address computations that are
+      no longer needed. */
+   do_deadcode_BB(out);
+   return out;
+}
+
+#undef N_SLP_MAX_LANES
+
+
 /*---------------------------------------------------------------*/
 /*--- MSVC specific transformation hacks                      ---*/
 /*---------------------------------------------------------------*/
@@ -6398,6 +7588,7 @@ IRSB* cheap_transformations (
       )
 {
    redundant_get_removal_BB ( bb );
+   vex_pass_done("redundant-get", bb);
    if (iropt_verbose) {
       vex_printf("\n========= REDUNDANT GET\n\n" );
       ppIRSB(bb);
@@ -6405,6 +7596,7 @@ IRSB* cheap_transformations (
 
    if (pxControl < VexRegUpdAllregsAtEachInsn) {
       redundant_put_removal_BB ( bb, preciseMemExnsFn, pxControl );
+      vex_pass_done("redundant-put", bb);
    }
    if (iropt_verbose) {
       vex_printf("\n========= REDUNDANT PUT\n\n" );
@@ -6412,12 +7604,14 @@ IRSB* cheap_transformations (
    }
 
    bb = cprop_BB ( bb );
+   vex_pass_done("cprop", bb);
    if (iropt_verbose) {
       vex_printf("\n========= CPROPD\n\n" );
       ppIRSB(bb);
    }
 
    do_deadcode_BB ( bb );
+   vex_pass_done("deadcode", bb);
    if (iropt_verbose) {
       vex_printf("\n========= DEAD\n\n" );
       ppIRSB(bb);
@@ -6425,6 +7619,7 @@ IRSB* cheap_transformations (
 
    bb = spec_helpers_BB ( bb, specHelper );
    do_deadcode_BB ( bb );
+   vex_pass_done("spec-helpers", bb);
    if (iropt_verbose) {
       vex_printf("\n========= SPECd \n\n" );
       ppIRSB(bb);
@@ -6441,12 +7636,17 @@ static
 IRSB* expensive_transformations( IRSB* bb, VexRegisterUpdates pxControl )
 {
    (void)do_cse_BB( bb, False/*!allowLoadsToBeCSEd*/ );
+   vex_pass_done("cse", bb);
    collapse_AddSub_chains_BB( bb );
+   vex_pass_done("addsub-chains", bb);
    do_redundant_GetI_elimination( bb );
+   vex_pass_done("redundant-geti", bb);
    if (pxControl < VexRegUpdAllregsAtEachInsn) {
       do_redundant_PutI_elimination( bb, pxControl );
+      vex_pass_done("redundant-puti", bb);
    }
    do_deadcode_BB( bb );
+   vex_pass_done("deadcode", bb);
    return bb;
 }
 
@@ -6590,6 +7790,7 @@ IRSB* do_iropt_BB(
       phases assume flat code. */
 
    bb = flatten_BB ( bb0 );
+   vex_pass_done("flatten", bb);
 
    if (iropt_verbose) {
       vex_printf("\n========= FLAT\n\n" );
@@ -6599,6 +7800,11 @@ IRSB* do_iropt_BB(
    /* If at level 0, stop now. */
    if (vex_control.iropt_level <= 0) return bb;
 
+   /* Inline any helpers the client has given bodies for, so that the
+      cheap transformations can get at them. */
+   bb = do_helper_inlining_BB ( bb, True/*newBlock*/ );
+   vex_pass_done("helper-inlining", bb);
+
    /* Now do a preliminary cleanup pass, and figure out if we also
       need to do 'expensive' optimisations.  Expensive optimisations
       are deemed necessary if the block contains any GetIs or PutIs.
@@ -6617,6 +7823,7 @@ IRSB* do_iropt_BB(
       }
       do_cse_BB( bb, False/*!allowLoadsToBeCSEd*/ );
       do_deadcode_BB( bb );
+      vex_pass_done("arm-cleanup", bb);
    }
 
    if (vex_control.iropt_level > 1) {
@@ -6633,6 +7840,7 @@ IRSB* do_iropt_BB(
             CSE anyway. */
          (void)do_cse_BB( bb, False/*!allowLoadsToBeCSEd*/ );
          do_deadcode_BB( bb );
+         vex_pass_done("cse", bb);
       }
 
       if (hasGetIorPutI) {
@@ -6645,6 +7853,7 @@ IRSB* do_iropt_BB(
                                      preciseMemExnsFn, pxControl );
          /* Potentially common up GetIs */
          cses = do_cse_BB( bb, False/*!allowLoadsToBeCSEd*/ );
+         vex_pass_done("cse", bb);
          if (cses)
             bb = cheap_transformations( bb, specHelper,
                                         preciseMemExnsFn, pxControl );
@@ -6662,6 +7871,7 @@ IRSB* do_iropt_BB(
 
       bb2 = maybe_loop_unroll_BB( bb, guest_addr );
       if (bb2) {
+         vex_pass_done("loop-unroll", bb2);
          bb = cheap_transformations( bb2, specHelper,
                                      preciseMemExnsFn, pxControl );
          if (hasGetIorPutI) {
@@ -6672,6 +7882,7 @@ IRSB* do_iropt_BB(
             /* at least do CSE and dead code removal */
             do_cse_BB( bb, False/*!allowLoadsToBeCSEd*/ );
             do_deadcode_BB( bb );
+            vex_pass_done("cse", bb);
          }
          if (0) vex_printf("vex iropt: unrolled a loop\n");
       }
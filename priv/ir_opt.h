@@ -72,6 +72,44 @@ Addr ado_treebuild_BB (
         VexRegisterUpdates pxControl
      );
 
+/* Replace any event buffer appends (Ist_EvAppend) added by
+   instrumentation with plain IR.  Returns a new BB, or bb itself if
+   it contains no such statements. */
+extern
+IRSB* do_evappend_lowering_BB ( IRSB* bb, IRType guest_word_type );
+
+/* Record a body for the clean helper at |addr|; see
+   LibVEX_RegisterInlineHelper.  |body| must be in permanent
+   storage. */
+extern
+void iropt_register_inline_helper ( void* addr, Int nArgs, IRExpr* body,
+                                    Int maxPerBlock );
+
+/* Replace calls to helpers registered as above with their bodies.  bb
+   must be flat.  Returns a new (flat) BB, or bb itself if there was
+   nothing to do.  The per-block limits count the calls inlined since
+   the last call with newBlock set, so a later pass over the same
+   block (after instrumentation) only inlines what is left of them. */
+extern
+IRSB* do_helper_inlining_BB ( IRSB* bb, Bool newBlock );
+
+/* Merge runs of adjacent constant stores within a single guest
+   instruction into stores of at most |widestTy|, which must be Ity_I32,
+   Ity_I64 or Ity_V128.  If |unalignedOK| is False, merged stores are
+   only made where they are known to be naturally aligned.  bb must be
+   flat; it is modified in place and returned. */
+extern
+IRSB* do_store_merging_BB ( IRSB* bb, IRType widestTy, Bool unalignedOK );
+
+/* Combine groups of identical scalar integer operations on adjacent
+   memory or guest state into single V128 operations, where
+   nativeOp says the host does the vector operation inline and doing
+   so looks profitable.  If acrossInsns is False, a group must lie
+   within a single guest instruction.  bb must be flat; it is
+   modified in place and returned. */
+extern
+IRSB* do_slp_BB ( IRSB* bb, Bool (*nativeOp)(IROp), Bool acrossInsns );
+
 #endif /* ndef __VEX_IR_OPT_H */
 
 /*---------------------------------------------------------------*/
@@ -61,6 +61,18 @@ Int vex_traceflags = 0;
 /* Max # guest insns per bb */
 VexControl vex_control = { 0,0,False,0,0,0 };
 
+/* IR pass observer for the current translation */
+void (*vex_ir_pass_done) ( void*, const HChar*, const IRSB*, SizeT ) = NULL;
+void* vex_ir_pass_opaque = NULL;
+
+void vex_pass_done ( const HChar* pass, const IRSB* bb )
+{
+   if (vex_ir_pass_done)
+      vex_ir_pass_done(vex_ir_pass_opaque, pass, bb,
+                       (SizeT)(private_LibVEX_alloc_curr
+                               - private_LibVEX_alloc_first));
+}
+
 
 
 /*---------------------------------------------------------------*/
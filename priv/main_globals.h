@@ -62,6 +62,16 @@ extern Int vex_traceflags;
 /* Optimiser/front-end control */
 extern VexControl vex_control;
 
+/* The ir_pass_done and callback_opaque of the LibVEX_Translate or
+   LibVEX_CompileIR call in progress, or NULL.  They are copied here
+   from the call's arguments so that the IR passes can get at them. */
+extern void (*vex_ir_pass_done) ( void*, const HChar*, const IRSB*, SizeT );
+extern void* vex_ir_pass_opaque;
+
+/* Tell the client, if it asked, that |pass| has finished, leaving
+   |bb|, or NULL if it is a back end stage. */
+extern void vex_pass_done ( const HChar* pass, const IRSB* bb );
+
 
 /* vex_traceflags values */
 #define VEX_TRACE_FE     (1 << 7)  /* show conversion into IR */
@@ -50,6 +50,8 @@
 #include "main_globals.h"
 #include "main_util.h"
 #include "host_generic_regs.h"
+#include "host_generic_dfp.h"
+#include "host_generic_f128.h"
 #include "ir_opt.h"
 
 #include "host_x86_defs.h"
@@ -194,12 +196,31 @@ void LibVEX_default_VexControl ( /*OUT*/ VexControl* vcon )
    vcon->iropt_level                    = 2;
    vcon->iropt_register_updates_default = VexRegUpdUnwindregsAtMemAccess;
    vcon->iropt_unroll_thresh            = 120;
+   vcon->iropt_slp_level                = 0;
    vcon->guest_max_insns                = 60;
    vcon->guest_chase_thresh             = 10;
    vcon->guest_chase_cond               = False;
 }
 
 
+static void check_VexControl ( const VexControl* vcon )
+{
+   vassert(vcon->iropt_verbosity >= 0);
+   vassert(vcon->iropt_level >= 0);
+   vassert(vcon->iropt_level <= 2);
+   vassert(vcon->iropt_unroll_thresh >= 0);
+   vassert(vcon->iropt_unroll_thresh <= 400);
+   vassert(vcon->iropt_slp_level >= 0);
+   vassert(vcon->iropt_slp_level <= 2);
+   vassert(vcon->guest_max_insns >= 1);
+   vassert(vcon->guest_max_insns <= 100);
+   vassert(vcon->guest_chase_thresh >= 0);
+   vassert(vcon->guest_chase_thresh < vcon->guest_max_insns);
+   vassert(vcon->guest_chase_cond == True 
+           || vcon->guest_chase_cond == False);
+}
+
+
 /* Exported to library client. */
 
 void LibVEX_Init (
@@ -225,17 +246,7 @@ void LibVEX_Init (
    vassert(log_bytes);
    vassert(debuglevel >= 0);
 
-   vassert(vcon->iropt_verbosity >= 0);
-   vassert(vcon->iropt_level >= 0);
-   vassert(vcon->iropt_level <= 2);
-   vassert(vcon->iropt_unroll_thresh >= 0);
-   vassert(vcon->iropt_unroll_thresh <= 400);
-   vassert(vcon->guest_max_insns >= 1);
-   vassert(vcon->guest_max_insns <= 100);
-   vassert(vcon->guest_chase_thresh >= 0);
-   vassert(vcon->guest_chase_thresh < vcon->guest_max_insns);
-   vassert(vcon->guest_chase_cond == True 
-           || vcon->guest_chase_cond == False);
+   check_VexControl(vcon);
 
    /* Check that Vex has been built with sizes of basic types as
       stated in priv/libvex_basictypes.h.  Failure of any of these is
@@ -282,6 +293,12 @@ void LibVEX_Init (
 
    /* Ditto */
    vassert(sizeof(HReg) == 4);
+   /* Ditto for the host instructions of the 64-bit back ends, which
+      are allocated one at a time for every insn selected. */
+   if (VEX_HOST_WORDSIZE == 8) {
+      vassert(sizeof(AMD64Instr) == 32);
+      vassert(sizeof(ARM64Instr) == 32);
+   }
    /* If N_RREGUNIVERSE_REGS ever exceeds 64, the bitset fields in
       RRegSet and HRegUsage will need to be changed to something
       better than ULong. */
@@ -305,6 +322,444 @@ void LibVEX_Init (
 }
 
 
+/* Exported to library client. */
+
+void LibVEX_Update_Control ( const VexControl* vcon )
+{
+   vassert(vex_initdone);
+   check_VexControl(vcon);
+   vex_control = *vcon;
+}
+
+
+/* --------- Per-arch descriptors. --------- */
+
+/* Everything LibVEX_Translate needs to know about a host or guest
+   architecture is gathered into a static descriptor, indexed by
+   VexArch, so that picking the back and front ends for a translation
+   is a table lookup rather than a walk through a switch.  Entries are
+   built with the <arch>FN macros, so in a single-arch build the
+   descriptors for the other architectures contain only NULLs and
+   their object files are not dragged into the link.  A descriptor
+   whose iselSB (resp. disInstrFn) is NULL is treated as
+   unsupported. */
+
+#define N_VEX_ARCHS    (VexArchTILEGX - VexArch_INVALID)
+#define ARCH_IX(_arch) ((_arch) - VexArch_INVALID - 1)
+
+/* Acceptable endiannesses, as a bitmask. */
+#define ENDNESS_LE  (1 << 0)
+#define ENDNESS_BE  (1 << 1)
+
+static UInt endness_bit ( VexEndness endness )
+{
+   switch (endness) {
+      case VexEndnessLE: return ENDNESS_LE;
+      case VexEndnessBE: return ENDNESS_BE;
+      default:           return 0;
+   }
+}
+
+typedef
+   struct {
+      Bool   mode64;
+      IRType wordTy;
+      UInt   endnesses;
+      /* The widest store that adjacent constant stores may be merged
+         into, and whether such a store may be misaligned. */
+      IRType widestStoreTy;
+      Bool   unalignedStoresOK;
+      /* The widest type the instruction selector can load and store
+         under a guard, or Ity_INVALID if it has no LoadG/StoreG. */
+      IRType guardedMemTy;
+      /* Whether F128 values and ops must be lowered to helper calls
+         because the instruction selector cannot handle them. */
+      Bool   softF128;
+      /* Likewise for D32, D64 and D128 values and the DFP ops. */
+      Bool   softDFP;
+      /* Which V128 operations the instruction selector does inline,
+         or NULL if vectorising scalar code is not worth it. */
+      Bool   (*nativeV128Op) ( IROp );
+      /* This the bundle of functions we need to do the back-end stuff
+         (insn selection, reg-alloc, assembly) whilst being insulated
+         from the target instruction set. */
+      Bool         (*isMove)       ( const HInstr*, HReg*, HReg* );
+      void         (*getRegUsage)  ( HRegUsage*, const HInstr*, Bool );
+      void         (*mapRegs)      ( HRegRemap*, HInstr*, Bool );
+      void         (*genSpill)     ( HInstr**, HInstr**, HReg, Int, Bool );
+      void         (*genReload)    ( HInstr**, HInstr**, HReg, Int, Bool );
+      HInstr*      (*directReload) ( HInstr*, HReg, Short );
+      Bool         (*isExit)       ( const HInstr*, Bool*, Addr*, Bool* );
+      void         (*ppInstr)      ( const HInstr*, Bool );
+      void         (*ppReg)        ( HReg );
+      HInstrArray* (*iselSB)       ( const IRSB*, VexArch, const VexArchInfo*,
+                                     const VexAbiInfo*, Int, Int, Bool, Bool,
+                                     Addr );
+      Int          (*emit)         ( /*MB_MOD*/Bool*,
+                                     UChar*, Int, const HInstr*, Bool,
+                                     VexEndness,
+                                     const void*, const void*, const void*,
+                                     const void* );
+   }
+   HostArchDesc;
+
+typedef
+   struct {
+      IRType          wordTy;
+      UInt            endnesses;
+      Int             sizeB;
+      DisOneInstrFn   disInstrFn;
+      IRExpr*         (*specHelper)   ( const HChar*, IRExpr**, IRStmt**, Int );
+      Bool            (*preciseMemExnsFn) ( Int, Int, VexRegisterUpdates );
+      VexGuestLayout* layout;
+      Int             offB_CMSTART;
+      Int             offB_CMLEN;
+      Int             offB_GUEST_IP;
+      Int             szB_GUEST_IP;
+      Int             offB_HOST_EvC_COUNTER;
+      Int             offB_HOST_EvC_FAILADDR;
+   }
+   GuestArchDesc;
+
+/* Cast a host function to the type of the descriptor field it
+   fills in. */
+#define HFN(_field, _fn) \
+   ._field = (__typeof__(((HostArchDesc*)0)->_field)) (_fn)
+
+static const HostArchDesc host_arch_descs[N_VEX_ARCHS] = {
+   [ARCH_IX(VexArchX86)] = {
+      .mode64 = False, .wordTy = Ity_I32, .endnesses = ENDNESS_LE,
+      .widestStoreTy = Ity_I32, .unalignedStoresOK = True,
+      .guardedMemTy = Ity_INVALID, .softF128 = True,
+      .softDFP = True,
+      HFN(isMove,       X86FN(isMove_X86Instr)),
+      HFN(getRegUsage,  X86FN(getRegUsage_X86Instr)),
+      HFN(mapRegs,      X86FN(mapRegs_X86Instr)),
+      HFN(genSpill,     X86FN(genSpill_X86)),
+      HFN(genReload,    X86FN(genReload_X86)),
+      HFN(directReload, X86FN(directReload_X86)),
+      HFN(ppInstr,      X86FN(ppX86Instr)),
+      HFN(ppReg,        X86FN(ppHRegX86)),
+      HFN(iselSB,       X86FN(iselSB_X86)),
+      HFN(emit,         X86FN(emit_X86Instr))
+   },
+   [ARCH_IX(VexArchAMD64)] = {
+      .mode64 = True, .wordTy = Ity_I64, .endnesses = ENDNESS_LE,
+      .widestStoreTy = Ity_V128, .unalignedStoresOK = True,
+      .guardedMemTy = Ity_I64, .softF128 = True,
+      .softDFP = True,
+      HFN(isMove,       AMD64FN(isMove_AMD64Instr)),
+      HFN(getRegUsage,  AMD64FN(getRegUsage_AMD64Instr)),
+      HFN(mapRegs,      AMD64FN(mapRegs_AMD64Instr)),
+      HFN(genSpill,     AMD64FN(genSpill_AMD64)),
+      HFN(genReload,    AMD64FN(genReload_AMD64)),
+      HFN(isExit,       AMD64FN(isExit_AMD64Instr)),
+      HFN(ppInstr,      AMD64FN(ppAMD64Instr)),
+      HFN(ppReg,        AMD64FN(ppHRegAMD64)),
+      HFN(iselSB,       AMD64FN(iselSB_AMD64)),
+      HFN(emit,         AMD64FN(emit_AMD64Instr)),
+      HFN(nativeV128Op, AMD64FN(hasNativeV128Op_AMD64))
+   },
+   [ARCH_IX(VexArchPPC32)] = {
+      .mode64 = False, .wordTy = Ity_I32, .endnesses = ENDNESS_BE,
+      .widestStoreTy = Ity_I32, .unalignedStoresOK = False,
+      .guardedMemTy = Ity_INVALID,
+      HFN(isMove,       PPC32FN(isMove_PPCInstr)),
+      HFN(getRegUsage,  PPC32FN(getRegUsage_PPCInstr)),
+      HFN(mapRegs,      PPC32FN(mapRegs_PPCInstr)),
+      HFN(genSpill,     PPC32FN(genSpill_PPC)),
+      HFN(genReload,    PPC32FN(genReload_PPC)),
+      HFN(ppInstr,      PPC32FN(ppPPCInstr)),
+      HFN(ppReg,        PPC32FN(ppHRegPPC)),
+      HFN(iselSB,       PPC32FN(iselSB_PPC)),
+      HFN(emit,         PPC32FN(emit_PPCInstr))
+   },
+   [ARCH_IX(VexArchPPC64)] = {
+      .mode64 = True, .wordTy = Ity_I64,
+      .endnesses = ENDNESS_LE | ENDNESS_BE,
+      .widestStoreTy = Ity_I64, .unalignedStoresOK = False,
+      .guardedMemTy = Ity_INVALID,
+      HFN(isMove,       PPC64FN(isMove_PPCInstr)),
+      HFN(getRegUsage,  PPC64FN(getRegUsage_PPCInstr)),
+      HFN(mapRegs,      PPC64FN(mapRegs_PPCInstr)),
+      HFN(genSpill,     PPC64FN(genSpill_PPC)),
+      HFN(genReload,    PPC64FN(genReload_PPC)),
+      HFN(ppInstr,      PPC64FN(ppPPCInstr)),
+      HFN(ppReg,        PPC64FN(ppHRegPPC)),
+      HFN(iselSB,       PPC64FN(iselSB_PPC)),
+      HFN(emit,         PPC64FN(emit_PPCInstr))
+   },
+   [ARCH_IX(VexArchS390X)] = {
+      .mode64 = True, .wordTy = Ity_I64, .endnesses = ENDNESS_BE,
+      .widestStoreTy = Ity_I64, .unalignedStoresOK = True,
+      .guardedMemTy = Ity_INVALID,
+      HFN(isMove,       S390FN(isMove_S390Instr)),
+      HFN(getRegUsage,  S390FN(getRegUsage_S390Instr)),
+      HFN(mapRegs,      S390FN(mapRegs_S390Instr)),
+      HFN(genSpill,     S390FN(genSpill_S390)),
+      HFN(genReload,    S390FN(genReload_S390)),
+      // fixs390: consider implementing directReload_S390
+      HFN(ppInstr,      S390FN(ppS390Instr)),
+      HFN(ppReg,        S390FN(ppHRegS390)),
+      HFN(iselSB,       S390FN(iselSB_S390)),
+      HFN(emit,         S390FN(emit_S390Instr))
+   },
+   [ARCH_IX(VexArchARM)] = {
+      .mode64 = False, .wordTy = Ity_I32, .endnesses = ENDNESS_LE,
+      .widestStoreTy = Ity_I32, .unalignedStoresOK = False,
+      .guardedMemTy = Ity_I32,
+      HFN(isMove,       ARMFN(isMove_ARMInstr)),
+      HFN(getRegUsage,  ARMFN(getRegUsage_ARMInstr)),
+      HFN(mapRegs,      ARMFN(mapRegs_ARMInstr)),
+      HFN(genSpill,     ARMFN(genSpill_ARM)),
+      HFN(genReload,    ARMFN(genReload_ARM)),
+      HFN(ppInstr,      ARMFN(ppARMInstr)),
+      HFN(ppReg,        ARMFN(ppHRegARM)),
+      HFN(iselSB,       ARMFN(iselSB_ARM)),
+      HFN(emit,         ARMFN(emit_ARMInstr))
+   },
+   [ARCH_IX(VexArchARM64)] = {
+      .mode64 = True, .wordTy = Ity_I64, .endnesses = ENDNESS_LE,
+      .widestStoreTy = Ity_V128, .unalignedStoresOK = True,
+      .guardedMemTy = Ity_INVALID, .softF128 = True,
+      .softDFP = True,
+      HFN(isMove,       ARM64FN(isMove_ARM64Instr)),
+      HFN(getRegUsage,  ARM64FN(getRegUsage_ARM64Instr)),
+      HFN(mapRegs,      ARM64FN(mapRegs_ARM64Instr)),
+      HFN(genSpill,     ARM64FN(genSpill_ARM64)),
+      HFN(genReload,    ARM64FN(genReload_ARM64)),
+      HFN(ppInstr,      ARM64FN(ppARM64Instr)),
+      HFN(ppReg,        ARM64FN(ppHRegARM64)),
+      HFN(iselSB,       ARM64FN(iselSB_ARM64)),
+      HFN(emit,         ARM64FN(emit_ARM64Instr)),
+      HFN(nativeV128Op, ARM64FN(hasNativeV128Op_ARM64))
+   },
+   [ARCH_IX(VexArchMIPS32)] = {
+      .mode64 = False, .wordTy = Ity_I32,
+      .endnesses = ENDNESS_LE | ENDNESS_BE,
+      .widestStoreTy = Ity_I32, .unalignedStoresOK = False,
+      .guardedMemTy = Ity_INVALID,
+      HFN(isMove,       MIPS32FN(isMove_MIPSInstr)),
+      HFN(getRegUsage,  MIPS32FN(getRegUsage_MIPSInstr)),
+      HFN(mapRegs,      MIPS32FN(mapRegs_MIPSInstr)),
+      HFN(genSpill,     MIPS32FN(genSpill_MIPS)),
+      HFN(genReload,    MIPS32FN(genReload_MIPS)),
+      HFN(ppInstr,      MIPS32FN(ppMIPSInstr)),
+      HFN(ppReg,        MIPS32FN(ppHRegMIPS)),
+      HFN(iselSB,       MIPS32FN(iselSB_MIPS)),
+      HFN(emit,         MIPS32FN(emit_MIPSInstr))
+   },
+   [ARCH_IX(VexArchMIPS64)] = {
+      .mode64 = True, .wordTy = Ity_I64,
+      .endnesses = ENDNESS_LE | ENDNESS_BE,
+      .widestStoreTy = Ity_I64, .unalignedStoresOK = False,
+      .guardedMemTy = Ity_INVALID,
+      HFN(isMove,       MIPS64FN(isMove_MIPSInstr)),
+      HFN(getRegUsage,  MIPS64FN(getRegUsage_MIPSInstr)),
+      HFN(mapRegs,      MIPS64FN(mapRegs_MIPSInstr)),
+      HFN(genSpill,     MIPS64FN(genSpill_MIPS)),
+      HFN(genReload,    MIPS64FN(genReload_MIPS)),
+      HFN(ppInstr,      MIPS64FN(ppMIPSInstr)),
+      HFN(ppReg,        MIPS64FN(ppHRegMIPS)),
+      HFN(iselSB,       MIPS64FN(iselSB_MIPS)),
+      HFN(emit,         MIPS64FN(emit_MIPSInstr))
+   },
+   [ARCH_IX(VexArchTILEGX)] = {
+      .mode64 = True, .wordTy = Ity_I64, .endnesses = ENDNESS_LE,
+      .widestStoreTy = Ity_I64, .unalignedStoresOK = False,
+      .guardedMemTy = Ity_INVALID,
+      HFN(isMove,       TILEGXFN(isMove_TILEGXInstr)),
+      HFN(getRegUsage,  TILEGXFN(getRegUsage_TILEGXInstr)),
+      HFN(mapRegs,      TILEGXFN(mapRegs_TILEGXInstr)),
+      HFN(genSpill,     TILEGXFN(genSpill_TILEGX)),
+      HFN(genReload,    TILEGXFN(genReload_TILEGX)),
+      HFN(ppInstr,      TILEGXFN(ppTILEGXInstr)),
+      HFN(ppReg,        TILEGXFN(ppHRegTILEGX)),
+      HFN(iselSB,       TILEGXFN(iselSB_TILEGX)),
+      HFN(emit,         TILEGXFN(emit_TILEGXInstr))
+   }
+};
+
+#undef HFN
+
+/* Fill in the layout-derived fields of a guest descriptor. */
+#define GUEST_STATE_FIELDS(_state, _ip)                                  \
+   .sizeB                  = sizeof(_state),                            \
+   .offB_CMSTART           = offsetof(_state,guest_CMSTART),            \
+   .offB_CMLEN             = offsetof(_state,guest_CMLEN),              \
+   .offB_GUEST_IP          = offsetof(_state,_ip),                      \
+   .szB_GUEST_IP           = sizeof( ((_state*)0)->_ip ),               \
+   .offB_HOST_EvC_COUNTER  = offsetof(_state,host_EvC_COUNTER),         \
+   .offB_HOST_EvC_FAILADDR = offsetof(_state,host_EvC_FAILADDR)
+
+static const GuestArchDesc guest_arch_descs[N_VEX_ARCHS] = {
+   [ARCH_IX(VexArchX86)] = {
+      .wordTy = Ity_I32, .endnesses = ENDNESS_LE,
+      .preciseMemExnsFn = X86FN(guest_x86_state_requires_precise_mem_exns),
+      .disInstrFn       = X86FN(disInstr_X86),
+      .specHelper       = X86FN(guest_x86_spechelper),
+      .layout           = X86FN(&x86guest_layout),
+      GUEST_STATE_FIELDS(VexGuestX86State, guest_EIP)
+   },
+   [ARCH_IX(VexArchAMD64)] = {
+      .wordTy = Ity_I64, .endnesses = ENDNESS_LE,
+      .preciseMemExnsFn = AMD64FN(guest_amd64_state_requires_precise_mem_exns),
+      .disInstrFn       = AMD64FN(disInstr_AMD64),
+      .specHelper       = AMD64FN(guest_amd64_spechelper),
+      .layout           = AMD64FN(&amd64guest_layout),
+      GUEST_STATE_FIELDS(VexGuestAMD64State, guest_RIP)
+   },
+   [ARCH_IX(VexArchPPC32)] = {
+      .wordTy = Ity_I32, .endnesses = ENDNESS_BE,
+      .preciseMemExnsFn = PPC32FN(guest_ppc32_state_requires_precise_mem_exns),
+      .disInstrFn       = PPC32FN(disInstr_PPC),
+      .specHelper       = PPC32FN(guest_ppc32_spechelper),
+      .layout           = PPC32FN(&ppc32Guest_layout),
+      GUEST_STATE_FIELDS(VexGuestPPC32State, guest_CIA)
+   },
+   [ARCH_IX(VexArchPPC64)] = {
+      .wordTy = Ity_I64, .endnesses = ENDNESS_LE | ENDNESS_BE,
+      .preciseMemExnsFn = PPC64FN(guest_ppc64_state_requires_precise_mem_exns),
+      .disInstrFn       = PPC64FN(disInstr_PPC),
+      .specHelper       = PPC64FN(guest_ppc64_spechelper),
+      .layout           = PPC64FN(&ppc64Guest_layout),
+      GUEST_STATE_FIELDS(VexGuestPPC64State, guest_CIA)
+   },
+   [ARCH_IX(VexArchS390X)] = {
+      .wordTy = Ity_I64, .endnesses = ENDNESS_BE,
+      .preciseMemExnsFn = S390FN(guest_s390x_state_requires_precise_mem_exns),
+      .disInstrFn       = S390FN(disInstr_S390),
+      .specHelper       = S390FN(guest_s390x_spechelper),
+      .layout           = S390FN(&s390xGuest_layout),
+      GUEST_STATE_FIELDS(VexGuestS390XState, guest_IA)
+   },
+   [ARCH_IX(VexArchARM)] = {
+      .wordTy = Ity_I32, .endnesses = ENDNESS_LE,
+      .preciseMemExnsFn = ARMFN(guest_arm_state_requires_precise_mem_exns),
+      .disInstrFn       = ARMFN(disInstr_ARM),
+      .specHelper       = ARMFN(guest_arm_spechelper),
+      .layout           = ARMFN(&armGuest_layout),
+      GUEST_STATE_FIELDS(VexGuestARMState, guest_R15T)
+   },
+   [ARCH_IX(VexArchARM64)] = {
+      .wordTy = Ity_I64, .endnesses = ENDNESS_LE,
+      .preciseMemExnsFn = ARM64FN(guest_arm64_state_requires_precise_mem_exns),
+      .disInstrFn       = ARM64FN(disInstr_ARM64),
+      .specHelper       = ARM64FN(guest_arm64_spechelper),
+      .layout           = ARM64FN(&arm64Guest_layout),
+      GUEST_STATE_FIELDS(VexGuestARM64State, guest_PC)
+   },
+   [ARCH_IX(VexArchMIPS32)] = {
+      .wordTy = Ity_I32, .endnesses = ENDNESS_LE | ENDNESS_BE,
+      .preciseMemExnsFn = MIPS32FN(guest_mips32_state_requires_precise_mem_exns),
+      .disInstrFn       = MIPS32FN(disInstr_MIPS),
+      .specHelper       = MIPS32FN(guest_mips32_spechelper),
+      .layout           = MIPS32FN(&mips32Guest_layout),
+      GUEST_STATE_FIELDS(VexGuestMIPS32State, guest_PC)
+   },
+   [ARCH_IX(VexArchMIPS64)] = {
+      .wordTy = Ity_I64, .endnesses = ENDNESS_LE | ENDNESS_BE,
+      .preciseMemExnsFn = MIPS64FN(guest_mips64_state_requires_precise_mem_exns),
+      .disInstrFn       = MIPS64FN(disInstr_MIPS),
+      .specHelper       = MIPS64FN(guest_mips64_spechelper),
+      .layout           = MIPS64FN(&mips64Guest_layout),
+      GUEST_STATE_FIELDS(VexGuestMIPS64State, guest_PC)
+   },
+   [ARCH_IX(VexArchTILEGX)] = {
+      .wordTy = Ity_I64, .endnesses = ENDNESS_LE,
+      .preciseMemExnsFn = TILEGXFN(guest_tilegx_state_requires_precise_mem_exns),
+      .disInstrFn       = TILEGXFN(disInstr_TILEGX),
+      .specHelper       = TILEGXFN(guest_tilegx_spechelper),
+      .layout           = TILEGXFN(&tilegxGuest_layout),
+      GUEST_STATE_FIELDS(VexGuestTILEGXState, guest_pc)
+   }
+};
+
+#undef GUEST_STATE_FIELDS
+
+/* The sizes of the guest state fields VEX itself writes are
+   compile-time constants, and the same on every host.  The size of
+   the whole state is not: some guest states (ARM64 and MIPS among
+   them) are only a multiple of LibVEX_GUEST_STATE_ALIGN when 64-bit
+   fields are 8-aligned, so that is checked at translation time, and
+   only for the guest actually in use. */
+#define GUEST_STATE_CHECKS(_state, _wordSzB)                             \
+   STATIC_ASSERT(sizeof( ((_state*)0)->guest_CMSTART) == (_wordSzB));   \
+   STATIC_ASSERT(sizeof( ((_state*)0)->guest_CMLEN  ) == (_wordSzB));   \
+   STATIC_ASSERT(sizeof( ((_state*)0)->guest_NRADDR ) == (_wordSzB))
+
+GUEST_STATE_CHECKS(VexGuestX86State,    4);
+GUEST_STATE_CHECKS(VexGuestAMD64State,  8);
+GUEST_STATE_CHECKS(VexGuestPPC32State,  4);
+GUEST_STATE_CHECKS(VexGuestPPC64State,  8);
+STATIC_ASSERT(sizeof( ((VexGuestPPC64State*)0)->guest_NRADDR_GPR2) == 8);
+GUEST_STATE_CHECKS(VexGuestS390XState,  8);
+GUEST_STATE_CHECKS(VexGuestARMState,    4);
+GUEST_STATE_CHECKS(VexGuestARM64State,  8);
+GUEST_STATE_CHECKS(VexGuestMIPS32State, 4);
+GUEST_STATE_CHECKS(VexGuestMIPS64State, 8);
+GUEST_STATE_CHECKS(VexGuestTILEGXState, 8);
+
+#undef GUEST_STATE_CHECKS
+
+/* Find the descriptor for ARCH, or NULL if VEX has no such host (or
+   guest) support compiled in. */
+static const HostArchDesc* getHostArchDesc ( VexArch arch )
+{
+   const HostArchDesc* hd;
+   if (arch <= VexArch_INVALID || arch > VexArchTILEGX)
+      return NULL;
+   hd = &host_arch_descs[ARCH_IX(arch)];
+   return hd->iselSB == NULL ? NULL : hd;
+}
+
+static const GuestArchDesc* getGuestArchDesc ( VexArch arch )
+{
+   const GuestArchDesc* gd;
+   if (arch <= VexArch_INVALID || arch > VexArchTILEGX)
+      return NULL;
+   gd = &guest_arch_descs[ARCH_IX(arch)];
+   return gd->disInstrFn == NULL ? NULL : gd;
+}
+
+/* The real-register universe for a host.  It is only computed the
+   first time a translation for that host is made. */
+static const RRegUniverse* getHostRRegUniverse ( VexArch arch )
+{
+   static const RRegUniverse* univs[N_VEX_ARCHS];
+   const RRegUniverse** slot = &univs[ARCH_IX(arch)];
+
+   if (LIKELY(*slot != NULL))
+      return *slot;
+
+   switch (arch) {
+      case VexArchX86:
+         *slot = X86FN(getRRegUniverse_X86()); break;
+      case VexArchAMD64:
+         *slot = AMD64FN(getRRegUniverse_AMD64()); break;
+      case VexArchPPC32:
+         *slot = PPC32FN(getRRegUniverse_PPC(False/*!mode64*/)); break;
+      case VexArchPPC64:
+         *slot = PPC64FN(getRRegUniverse_PPC(True/*mode64*/)); break;
+      case VexArchS390X:
+         *slot = S390FN(getRRegUniverse_S390()); break;
+      case VexArchARM:
+         *slot = ARMFN(getRRegUniverse_ARM()); break;
+      case VexArchARM64:
+         *slot = ARM64FN(getRRegUniverse_ARM64()); break;
+      case VexArchMIPS32:
+         *slot = MIPS32FN(getRRegUniverse_MIPS(False/*!mode64*/)); break;
+      case VexArchMIPS64:
+         *slot = MIPS64FN(getRRegUniverse_MIPS(True/*mode64*/)); break;
+      case VexArchTILEGX:
+         *slot = TILEGXFN(getRRegUniverse_TILEGX()); break;
+      default:
+         vassert(0);
+   }
+   vassert(*slot != NULL);
+   return *slot;
+}
+
 /* --------- Make a translation. --------- */
 /* KLUDGE: S390 need to know the hwcaps of the host when generating
    code. But that info is not passed to emit_S390Instr. Only mode64 is
@@ -316,74 +771,272 @@ void LibVEX_Init (
 UInt s390_host_hwcaps;
 
 
+/* Classify a direct exit to |dst| from the guest insn at |insn|, of
+   |insn_len| bytes.  |insn| includes the IMark's delta, as jump
+   targets do, so for Thumb it is odd. */
+static VexExitKind exit_kind ( Addr insn, UInt insn_len, const IRConst* dst )
+{
+   Addr dstGA;
+   vassert(dst->tag == Ico_U64 || dst->tag == Ico_U32);
+   dstGA = (Addr)(dst->tag == Ico_U64 ? dst->Ico.U64 : dst->Ico.U32);
+   if (dstGA == insn + insn_len)
+      return VexExitFallThrough;
+   if (dstGA == insn)
+      return VexExitResteer;
+   return VexExitBranch;
+}
+
+
+/* The back half of LibVEX_Translate and LibVEX_CompileIR: turn a
+   flat, optimised, instrumented IRSB into host code.  |guest_sizeB|
+   is the size of the guest state, which determines where the spill
+   area is, and |first_ga| is the guest address to attribute exits to
+   that come before any IMark.  Sets res->status and
+   res->offs_profInc. */
+static void compile_IRSB ( /*MOD*/VexTranslateResult* res,
+                           const HostArchDesc* hd,
+                           const VexCompileIRArgs* ca,
+                           IRSB* irsb,
+                           VexRegisterUpdates pxControl,
+                           IRSB* (*finaltidy) ( IRSB* ),
+                           Int guest_sizeB,
+                           Addr first_ga )
+{
+   const RRegUniverse* rRegUniv = getHostRRegUniverse(ca->arch_host);
+   Bool (*preciseMemExnsFn)(Int,Int,VexRegisterUpdates)
+      = ca->preciseMemExnsFn;
+   HInstrArray* vcode;
+   HInstrSeq*   rcode;
+   Int          i, j, k, out_used;
+   UChar        insn_bytes[128];
+   Bool         mode64          = hd->mode64;
+   Bool         chainingAllowed = ca->disp_cp_chain_me_to_slowEP != NULL;
+   Addr         max_ga;
+   VexExitSite* exit_info       = NULL;
+   Int          n_ir_exits      = 0;
+   Int          n_hi_exits      = 0;
+
+   /* Give the host F128 and DFP support in software if it has none. */
+   if (hd->softF128) {
+      irsb = do_F128_lowering_BB( irsb, ca->archinfo_host.endness );
+      vex_pass_done("f128-lowering", irsb);
+   }
+   if (hd->softDFP) {
+      irsb = do_DFP_lowering_BB( irsb, ca->archinfo_host.endness );
+      vex_pass_done("dfp-lowering", irsb);
+   }
+
+   /* Turn it into virtual-registerised code.  Build trees -- this
+      also throws away any dead bindings. */
+   max_ga = ado_treebuild_BB( irsb, preciseMemExnsFn, pxControl );
+   vex_pass_done("treebuild", irsb);
+
+   if (finaltidy) {
+      irsb = finaltidy(irsb);
+   }
+
+   vexAllocSanityCheck();
+
+   if (vex_traceflags & VEX_TRACE_TREES) {
+      vex_printf("\n------------------------" 
+                   "  After tree-building "
+                   "------------------------\n\n");
+      ppIRSB ( irsb );
+      vex_printf("\n");
+   }
+
+   /* If the caller wants the direct exits recorded, note which guest
+      insn each exit of the block belongs to, and what its target is
+      relative to that insn.  The back end turns each IR exit, and
+      the final jump, into exactly one exit insn, in order, so they
+      can be matched up as the code is emitted. */
+   if (ca->exit_sites) {
+      *(ca->exit_sites_used) = 0;
+      if (hd->isExit) {
+         Addr  curr_insn     = first_ga;
+         UInt  curr_insn_len = 0;
+         UChar curr_delta    = 0;
+         exit_info = LibVEX_Alloc_inline((irsb->stmts_used + 1)
+                                         * sizeof(VexExitSite));
+         for (i = 0; i < irsb->stmts_used; i++) {
+            const IRStmt* st = irsb->stmts[i];
+            if (st->tag == Ist_IMark) {
+               curr_insn     = st->Ist.IMark.addr;
+               curr_insn_len = st->Ist.IMark.len;
+               curr_delta    = st->Ist.IMark.delta;
+            } else if (st->tag == Ist_Exit) {
+               exit_info[n_ir_exits].guest_insn     = curr_insn;
+               exit_info[n_ir_exits].guest_insn_len = curr_insn_len;
+               exit_info[n_ir_exits].kind
+                  = exit_kind(curr_insn + curr_delta, curr_insn_len,
+                              st->Ist.Exit.dst);
+               exit_info[n_ir_exits].self_checked   = False;
+               n_ir_exits++;
+            }
+         }
+         exit_info[n_ir_exits].guest_insn     = curr_insn;
+         exit_info[n_ir_exits].guest_insn_len = curr_insn_len;
+         exit_info[n_ir_exits].kind
+            = irsb->next->tag == Iex_Const
+                 ? exit_kind(curr_insn + curr_delta, curr_insn_len,
+                             irsb->next->Iex.Const.con)
+                 : VexExitKind_INVALID;
+         exit_info[n_ir_exits].self_checked   = False;
+         n_ir_exits++;
+      }
+   }
+
+   /* HACK */
+   if (0) {
+      *(ca->host_bytes_used) = 0;
+      res->status = VexTransOK; return;
+   }
+   /* end HACK */
+
+   if (vex_traceflags & VEX_TRACE_VCODE)
+      vex_printf("\n------------------------" 
+                   " Instruction selection "
+                   "------------------------\n");
+
+   vcode = hd->iselSB ( irsb, ca->arch_host,
+                        &ca->archinfo_host,
+                        &ca->abiinfo,
+                        ca->offB_HOST_EvC_COUNTER,
+                        ca->offB_HOST_EvC_FAILADDR,
+                        chainingAllowed,
+                        ca->addProfInc,
+                        max_ga );
+
+   vexAllocSanityCheck();
+   vex_pass_done("isel", NULL);
+
+   if (vex_traceflags & VEX_TRACE_VCODE)
+      vex_printf("\n");
+
+   if (vex_traceflags & VEX_TRACE_VCODE) {
+      for (i = 0; i < vcode->arr_used; i++) {
+         vex_printf("%3d   ", i);
+         hd->ppInstr(getHInstr(vcode, i), mode64);
+         vex_printf("\n");
+      }
+      vex_printf("\n");
+   }
+
+   /* Register allocate. */
+   rcode = doRegisterAllocation ( vcode, rRegUniv,
+                                  hd->isMove, hd->getRegUsage, hd->mapRegs,
+                                  hd->genSpill, hd->genReload,
+                                  hd->directReload,
+                                  guest_sizeB,
+                                  hd->ppInstr, hd->ppReg, mode64 );
+
+   vexAllocSanityCheck();
+   vex_pass_done("regalloc", NULL);
+
+   if (vex_traceflags & VEX_TRACE_RCODE) {
+      vex_printf("\n------------------------" 
+                   " Register-allocated code "
+                   "------------------------\n\n");
+      for (i = 0; i < rcode->order_used; i++) {
+         vex_printf("%3d   ", i);
+         hd->ppInstr(getHInstrInSeq(rcode, i), mode64);
+         vex_printf("\n");
+      }
+      vex_printf("\n");
+   }
+
+   /* HACK */
+   if (0) { 
+      *(ca->host_bytes_used) = 0;
+      res->status = VexTransOK; return;
+   }
+   /* end HACK */
+
+   /* Assemble */
+   if (vex_traceflags & VEX_TRACE_ASM) {
+      vex_printf("\n------------------------" 
+                   " Assembly "
+                   "------------------------\n\n");
+   }
+
+   out_used = 0; /* tracks along the host_bytes array */
+   for (i = 0; i < rcode->order_used; i++) {
+      HInstr* hi           = getHInstrInSeq(rcode, i);
+      Bool    hi_isProfInc = False;
+      if (UNLIKELY(vex_traceflags & VEX_TRACE_ASM)) {
+         hd->ppInstr(hi, mode64);
+         vex_printf("\n");
+      }
+      j = hd->emit( &hi_isProfInc,
+                    insn_bytes, sizeof insn_bytes, hi,
+                    mode64, ca->archinfo_host.endness,
+                    ca->disp_cp_chain_me_to_slowEP,
+                    ca->disp_cp_chain_me_to_fastEP,
+                    ca->disp_cp_xindir,
+                    ca->disp_cp_xassisted );
+      if (UNLIKELY(vex_traceflags & VEX_TRACE_ASM)) {
+         for (k = 0; k < j; k++)
+            vex_printf("%02x ", (UInt)insn_bytes[k]);
+         vex_printf("\n\n");
+      }
+      if (UNLIKELY(out_used + j > ca->host_bytes_size)) {
+         res->status = VexTransOutputFull;
+         return;
+      }
+      if (UNLIKELY(hi_isProfInc)) {
+         vassert(ca->addProfInc); /* else where did it come from? */
+         vassert(res->offs_profInc == -1); /* there can be only one (tm) */
+         vassert(out_used >= 0);
+         res->offs_profInc = out_used;
+      }
+      if (exit_info) {
+         Bool   direct, toFastEP;
+         Addr   dstGA;
+         if (hd->isExit(hi, &direct, &dstGA, &toFastEP)) {
+            vassert(n_hi_exits < n_ir_exits);
+            if (direct
+                && *(ca->exit_sites_used) < ca->exit_sites_size) {
+               VexExitSite* es
+                  = &ca->exit_sites[(*(ca->exit_sites_used))++];
+               *es = exit_info[n_hi_exits];
+               es->offs_host    = out_used;
+               es->guest_target = dstGA;
+               es->to_fast_ep   = toFastEP;
+               es->max_ga       = max_ga;
+            }
+            n_hi_exits++;
+         }
+      }
+      { UChar* dst = &ca->host_bytes[out_used];
+        for (k = 0; k < j; k++) {
+           dst[k] = insn_bytes[k];
+        }
+        out_used += j;
+      }
+   }
+   *(ca->host_bytes_used) = out_used;
+   vassert(n_hi_exits == n_ir_exits);
+   vex_pass_done("emit", NULL);
+
+   res->status = VexTransOK;
+}
+
+
 /* Exported to library client. */
 
 VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
 {
-   /* This the bundle of functions we need to do the back-end stuff
-      (insn selection, reg-alloc, assembly) whilst being insulated
-      from the target instruction set. */
-   Bool         (*isMove)       ( const HInstr*, HReg*, HReg* );
-   void         (*getRegUsage)  ( HRegUsage*, const HInstr*, Bool );
-   void         (*mapRegs)      ( HRegRemap*, HInstr*, Bool );
-   void         (*genSpill)     ( HInstr**, HInstr**, HReg, Int, Bool );
-   void         (*genReload)    ( HInstr**, HInstr**, HReg, Int, Bool );
-   HInstr*      (*directReload) ( HInstr*, HReg, Short );
-   void         (*ppInstr)      ( const HInstr*, Bool );
-   void         (*ppReg)        ( HReg );
-   HInstrArray* (*iselSB)       ( const IRSB*, VexArch, const VexArchInfo*,
-                                  const VexAbiInfo*, Int, Int, Bool, Bool,
-                                  Addr );
-   Int          (*emit)         ( /*MB_MOD*/Bool*,
-                                  UChar*, Int, const HInstr*, Bool, VexEndness,
-                                  const void*, const void*, const void*,
-                                  const void* );
-   IRExpr*      (*specHelper)   ( const HChar*, IRExpr**, IRStmt**, Int );
-   Bool         (*preciseMemExnsFn) ( Int, Int, VexRegisterUpdates );
-
-   const RRegUniverse* rRegUniv = NULL;
-
-   DisOneInstrFn disInstrFn;
-
-   VexGuestLayout* guest_layout;
+   const HostArchDesc*  hd;
+   const GuestArchDesc* gd;
+
    IRSB*           irsb;
-   HInstrArray*    vcode;
-   HInstrArray*    rcode;
-   Int             i, j, k, out_used, guest_sizeB;
-   Int             offB_CMSTART, offB_CMLEN, offB_GUEST_IP, szB_GUEST_IP;
-   Int             offB_HOST_EvC_COUNTER, offB_HOST_EvC_FAILADDR;
-   UChar           insn_bytes[128];
+   Int             i, j;
    IRType          guest_word_type;
    IRType          host_word_type;
-   Bool            mode64, chainingAllowed;
-   Addr            max_ga;
-
-   guest_layout           = NULL;
-   isMove                 = NULL;
-   getRegUsage            = NULL;
-   mapRegs                = NULL;
-   genSpill               = NULL;
-   genReload              = NULL;
-   directReload           = NULL;
-   ppInstr                = NULL;
-   ppReg                  = NULL;
-   iselSB                 = NULL;
-   emit                   = NULL;
-   specHelper             = NULL;
-   preciseMemExnsFn       = NULL;
-   disInstrFn             = NULL;
-   guest_word_type        = Ity_INVALID;
-   host_word_type         = Ity_INVALID;
-   offB_CMSTART           = 0;
-   offB_CMLEN             = 0;
-   offB_GUEST_IP          = 0;
-   szB_GUEST_IP           = 0;
-   offB_HOST_EvC_COUNTER  = 0;
-   offB_HOST_EvC_FAILADDR = 0;
-   mode64                 = False;
-   chainingAllowed        = False;
-
-   vex_traceflags = vta->traceflags;
+
+   vex_traceflags     = vta->traceflags;
+   vex_ir_pass_done   = vta->ir_pass_done;
+   vex_ir_pass_opaque = vta->callback_opaque;
 
    vassert(vex_initdone);
    vassert(vta->needs_self_check  != NULL);
@@ -392,7 +1045,6 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
    if (vta->disp_cp_chain_me_to_slowEP        != NULL) {
       vassert(vta->disp_cp_chain_me_to_fastEP != NULL);
       vassert(vta->disp_cp_xindir             != NULL);
-      chainingAllowed = True;
    } else {
       vassert(vta->disp_cp_chain_me_to_fastEP == NULL);
       vassert(vta->disp_cp_xindir             == NULL);
@@ -404,413 +1056,36 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
    /* First off, check that the guest and host insn sets
       are supported. */
 
-   switch (vta->arch_host) {
+   hd = getHostArchDesc(vta->arch_host);
+   if (hd == NULL)
+      vpanic("LibVEX_Translate: unsupported host insn set");
+   vassert(endness_bit(vta->archinfo_host.endness) & hd->endnesses);
 
-      case VexArchX86:
-         mode64       = False;
-         rRegUniv     = X86FN(getRRegUniverse_X86());
-         isMove       = (__typeof__(isMove)) X86FN(isMove_X86Instr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) X86FN(getRegUsage_X86Instr);
-         mapRegs      = (__typeof__(mapRegs)) X86FN(mapRegs_X86Instr);
-         genSpill     = (__typeof__(genSpill)) X86FN(genSpill_X86);
-         genReload    = (__typeof__(genReload)) X86FN(genReload_X86);
-         directReload = (__typeof__(directReload)) X86FN(directReload_X86);
-         ppInstr      = (__typeof__(ppInstr)) X86FN(ppX86Instr);
-         ppReg        = (__typeof__(ppReg)) X86FN(ppHRegX86);
-         iselSB       = X86FN(iselSB_X86);
-         emit         = (__typeof__(emit)) X86FN(emit_X86Instr);
-         host_word_type = Ity_I32;
-         vassert(vta->archinfo_host.endness == VexEndnessLE);
-         break;
-
-      case VexArchAMD64:
-         mode64       = True;
-         rRegUniv     = AMD64FN(getRRegUniverse_AMD64());
-         isMove       = (__typeof__(isMove)) AMD64FN(isMove_AMD64Instr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) AMD64FN(getRegUsage_AMD64Instr);
-         mapRegs      = (__typeof__(mapRegs)) AMD64FN(mapRegs_AMD64Instr);
-         genSpill     = (__typeof__(genSpill)) AMD64FN(genSpill_AMD64);
-         genReload    = (__typeof__(genReload)) AMD64FN(genReload_AMD64);
-         ppInstr      = (__typeof__(ppInstr)) AMD64FN(ppAMD64Instr);
-         ppReg        = (__typeof__(ppReg)) AMD64FN(ppHRegAMD64);
-         iselSB       = AMD64FN(iselSB_AMD64);
-         emit         = (__typeof__(emit)) AMD64FN(emit_AMD64Instr);
-         host_word_type = Ity_I64;
-         vassert(vta->archinfo_host.endness == VexEndnessLE);
-         break;
+   host_word_type = hd->wordTy;
 
-      case VexArchPPC32:
-         mode64       = False;
-         rRegUniv     = PPC32FN(getRRegUniverse_PPC(mode64));
-         isMove       = (__typeof__(isMove)) PPC32FN(isMove_PPCInstr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) PPC32FN(getRegUsage_PPCInstr);
-         mapRegs      = (__typeof__(mapRegs)) PPC32FN(mapRegs_PPCInstr);
-         genSpill     = (__typeof__(genSpill)) PPC32FN(genSpill_PPC);
-         genReload    = (__typeof__(genReload)) PPC32FN(genReload_PPC);
-         ppInstr      = (__typeof__(ppInstr)) PPC32FN(ppPPCInstr);
-         ppReg        = (__typeof__(ppReg)) PPC32FN(ppHRegPPC);
-         iselSB       = PPC32FN(iselSB_PPC);
-         emit         = (__typeof__(emit)) PPC32FN(emit_PPCInstr);
-         host_word_type = Ity_I32;
-         vassert(vta->archinfo_host.endness == VexEndnessBE);
-         break;
-
-      case VexArchPPC64:
-         mode64       = True;
-         rRegUniv     = PPC64FN(getRRegUniverse_PPC(mode64));
-         isMove       = (__typeof__(isMove)) PPC64FN(isMove_PPCInstr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) PPC64FN(getRegUsage_PPCInstr);
-         mapRegs      = (__typeof__(mapRegs)) PPC64FN(mapRegs_PPCInstr);
-         genSpill     = (__typeof__(genSpill)) PPC64FN(genSpill_PPC);
-         genReload    = (__typeof__(genReload)) PPC64FN(genReload_PPC);
-         ppInstr      = (__typeof__(ppInstr)) PPC64FN(ppPPCInstr);
-         ppReg        = (__typeof__(ppReg)) PPC64FN(ppHRegPPC);
-         iselSB       = PPC64FN(iselSB_PPC);
-         emit         = (__typeof__(emit)) PPC64FN(emit_PPCInstr);
-         host_word_type = Ity_I64;
-         vassert(vta->archinfo_host.endness == VexEndnessBE ||
-                 vta->archinfo_host.endness == VexEndnessLE );
-         break;
-
-      case VexArchS390X:
-         mode64       = True;
-         /* KLUDGE: export hwcaps. */
-         s390_host_hwcaps = vta->archinfo_host.hwcaps;
-         rRegUniv     = S390FN(getRRegUniverse_S390());
-         isMove       = (__typeof__(isMove)) S390FN(isMove_S390Instr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) S390FN(getRegUsage_S390Instr);
-         mapRegs      = (__typeof__(mapRegs)) S390FN(mapRegs_S390Instr);
-         genSpill     = (__typeof__(genSpill)) S390FN(genSpill_S390);
-         genReload    = (__typeof__(genReload)) S390FN(genReload_S390);
-         // fixs390: consider implementing directReload_S390
-         ppInstr      = (__typeof__(ppInstr)) S390FN(ppS390Instr);
-         ppReg        = (__typeof__(ppReg)) S390FN(ppHRegS390);
-         iselSB       = S390FN(iselSB_S390);
-         emit         = (__typeof__(emit)) S390FN(emit_S390Instr);
-         host_word_type = Ity_I64;
-         vassert(vta->archinfo_host.endness == VexEndnessBE);
-         break;
-
-      case VexArchARM:
-         mode64       = False;
-         rRegUniv     = ARMFN(getRRegUniverse_ARM());
-         isMove       = (__typeof__(isMove)) ARMFN(isMove_ARMInstr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) ARMFN(getRegUsage_ARMInstr);
-         mapRegs      = (__typeof__(mapRegs)) ARMFN(mapRegs_ARMInstr);
-         genSpill     = (__typeof__(genSpill)) ARMFN(genSpill_ARM);
-         genReload    = (__typeof__(genReload)) ARMFN(genReload_ARM);
-         ppInstr      = (__typeof__(ppInstr)) ARMFN(ppARMInstr);
-         ppReg        = (__typeof__(ppReg)) ARMFN(ppHRegARM);
-         iselSB       = ARMFN(iselSB_ARM);
-         emit         = (__typeof__(emit)) ARMFN(emit_ARMInstr);
-         host_word_type = Ity_I32;
-         vassert(vta->archinfo_host.endness == VexEndnessLE);
-         break;
-
-      case VexArchARM64:
-         mode64       = True;
-         rRegUniv     = ARM64FN(getRRegUniverse_ARM64());
-         isMove       = (__typeof__(isMove)) ARM64FN(isMove_ARM64Instr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) ARM64FN(getRegUsage_ARM64Instr);
-         mapRegs      = (__typeof__(mapRegs)) ARM64FN(mapRegs_ARM64Instr);
-         genSpill     = (__typeof__(genSpill)) ARM64FN(genSpill_ARM64);
-         genReload    = (__typeof__(genReload)) ARM64FN(genReload_ARM64);
-         ppInstr      = (__typeof__(ppInstr)) ARM64FN(ppARM64Instr);
-         ppReg        = (__typeof__(ppReg)) ARM64FN(ppHRegARM64);
-         iselSB       = ARM64FN(iselSB_ARM64);
-         emit         = (__typeof__(emit)) ARM64FN(emit_ARM64Instr);
-         host_word_type = Ity_I64;
-         vassert(vta->archinfo_host.endness == VexEndnessLE);
-         break;
-
-      case VexArchMIPS32:
-         mode64       = False;
-         rRegUniv     = MIPS32FN(getRRegUniverse_MIPS(mode64));
-         isMove       = (__typeof__(isMove)) MIPS32FN(isMove_MIPSInstr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) MIPS32FN(getRegUsage_MIPSInstr);
-         mapRegs      = (__typeof__(mapRegs)) MIPS32FN(mapRegs_MIPSInstr);
-         genSpill     = (__typeof__(genSpill)) MIPS32FN(genSpill_MIPS);
-         genReload    = (__typeof__(genReload)) MIPS32FN(genReload_MIPS);
-         ppInstr      = (__typeof__(ppInstr)) MIPS32FN(ppMIPSInstr);
-         ppReg        = (__typeof__(ppReg)) MIPS32FN(ppHRegMIPS);
-         iselSB       = MIPS32FN(iselSB_MIPS);
-         emit         = (__typeof__(emit)) MIPS32FN(emit_MIPSInstr);
-         host_word_type = Ity_I32;
-         vassert(vta->archinfo_host.endness == VexEndnessLE
-                 || vta->archinfo_host.endness == VexEndnessBE);
-         break;
-
-      case VexArchMIPS64:
-         mode64       = True;
-         rRegUniv     = MIPS64FN(getRRegUniverse_MIPS(mode64));
-         isMove       = (__typeof__(isMove)) MIPS64FN(isMove_MIPSInstr);
-         getRegUsage  
-            = (__typeof__(getRegUsage)) MIPS64FN(getRegUsage_MIPSInstr);
-         mapRegs      = (__typeof__(mapRegs)) MIPS64FN(mapRegs_MIPSInstr);
-         genSpill     = (__typeof__(genSpill)) MIPS64FN(genSpill_MIPS);
-         genReload    = (__typeof__(genReload)) MIPS64FN(genReload_MIPS);
-         ppInstr      = (__typeof__(ppInstr)) MIPS64FN(ppMIPSInstr);
-         ppReg        = (__typeof__(ppReg)) MIPS64FN(ppHRegMIPS);
-         iselSB       = MIPS64FN(iselSB_MIPS);
-         emit         = (__typeof__(emit)) MIPS64FN(emit_MIPSInstr);
-         host_word_type = Ity_I64;
-         vassert(vta->archinfo_host.endness == VexEndnessLE
-                 || vta->archinfo_host.endness == VexEndnessBE);
-         break;
-
-      case VexArchTILEGX:
-         mode64      = True;
-         rRegUniv    = TILEGXFN(getRRegUniverse_TILEGX());
-         isMove      = (__typeof__(isMove)) TILEGXFN(isMove_TILEGXInstr);
-         getRegUsage =
-            (__typeof__(getRegUsage)) TILEGXFN(getRegUsage_TILEGXInstr);
-         mapRegs     = (__typeof__(mapRegs)) TILEGXFN(mapRegs_TILEGXInstr);
-         genSpill    = (__typeof__(genSpill)) TILEGXFN(genSpill_TILEGX);
-         genReload   = (__typeof__(genReload)) TILEGXFN(genReload_TILEGX);
-         ppInstr     = (__typeof__(ppInstr)) TILEGXFN(ppTILEGXInstr);
-         ppReg       = (__typeof__(ppReg)) TILEGXFN(ppHRegTILEGX);
-         iselSB      = TILEGXFN(iselSB_TILEGX);
-         emit        = (__typeof__(emit)) TILEGXFN(emit_TILEGXInstr);
-         host_word_type    = Ity_I64;
-         vassert(vta->archinfo_host.endness == VexEndnessLE);
-         break;
-
-      default:
-         vpanic("LibVEX_Translate: unsupported host insn set");
+   if (vta->arch_host == VexArchS390X) {
+      /* KLUDGE: export hwcaps. */
+      s390_host_hwcaps = vta->archinfo_host.hwcaps;
+   }
+   else if (vta->arch_guest == VexArchS390X && hd->softDFP) {
+      /* The s390 front end only generates DFP IR if the host has the
+         facility; a host with it in software has it if the guest
+         does. */
+      s390_host_hwcaps
+         = vta->archinfo_guest.hwcaps & VEX_HWCAPS_S390X_DFP;
    }
 
    // Are the host's hardware capabilities feasible. The function will
    // not return if hwcaps are infeasible in some sense.
    check_hwcaps(vta->arch_host, vta->archinfo_host.hwcaps);
 
-   switch (vta->arch_guest) {
-
-      case VexArchX86:
-         preciseMemExnsFn       
-            = X86FN(guest_x86_state_requires_precise_mem_exns);
-         disInstrFn             = X86FN(disInstr_X86);
-         specHelper             = X86FN(guest_x86_spechelper);
-         guest_sizeB            = sizeof(VexGuestX86State);
-         guest_word_type        = Ity_I32;
-         guest_layout           = X86FN(&x86guest_layout);
-         offB_CMSTART           = offsetof(VexGuestX86State,guest_CMSTART);
-         offB_CMLEN             = offsetof(VexGuestX86State,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestX86State,guest_EIP);
-         szB_GUEST_IP           = sizeof( ((VexGuestX86State*)0)->guest_EIP );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestX86State,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestX86State,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessLE);
-         vassert(0 == sizeof(VexGuestX86State) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestX86State*)0)->guest_CMSTART) == 4);
-         vassert(sizeof( ((VexGuestX86State*)0)->guest_CMLEN  ) == 4);
-         vassert(sizeof( ((VexGuestX86State*)0)->guest_NRADDR ) == 4);
-         break;
-
-      case VexArchAMD64:
-         preciseMemExnsFn       
-            = AMD64FN(guest_amd64_state_requires_precise_mem_exns);
-         disInstrFn             = AMD64FN(disInstr_AMD64);
-         specHelper             = AMD64FN(guest_amd64_spechelper);
-         guest_sizeB            = sizeof(VexGuestAMD64State);
-         guest_word_type        = Ity_I64;
-         guest_layout           = AMD64FN(&amd64guest_layout);
-         offB_CMSTART           = offsetof(VexGuestAMD64State,guest_CMSTART);
-         offB_CMLEN             = offsetof(VexGuestAMD64State,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestAMD64State,guest_RIP);
-         szB_GUEST_IP           = sizeof( ((VexGuestAMD64State*)0)->guest_RIP );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestAMD64State,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestAMD64State,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessLE);
-         vassert(0 == sizeof(VexGuestAMD64State) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestAMD64State*)0)->guest_CMSTART ) == 8);
-         vassert(sizeof( ((VexGuestAMD64State*)0)->guest_CMLEN   ) == 8);
-         vassert(sizeof( ((VexGuestAMD64State*)0)->guest_NRADDR  ) == 8);
-         break;
-
-      case VexArchPPC32:
-         preciseMemExnsFn       
-            = PPC32FN(guest_ppc32_state_requires_precise_mem_exns);
-         disInstrFn             = PPC32FN(disInstr_PPC);
-         specHelper             = PPC32FN(guest_ppc32_spechelper);
-         guest_sizeB            = sizeof(VexGuestPPC32State);
-         guest_word_type        = Ity_I32;
-         guest_layout           = PPC32FN(&ppc32Guest_layout);
-         offB_CMSTART           = offsetof(VexGuestPPC32State,guest_CMSTART);
-         offB_CMLEN             = offsetof(VexGuestPPC32State,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestPPC32State,guest_CIA);
-         szB_GUEST_IP           = sizeof( ((VexGuestPPC32State*)0)->guest_CIA );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestPPC32State,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestPPC32State,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessBE);
-         vassert(0 == sizeof(VexGuestPPC32State) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestPPC32State*)0)->guest_CMSTART ) == 4);
-         vassert(sizeof( ((VexGuestPPC32State*)0)->guest_CMLEN   ) == 4);
-         vassert(sizeof( ((VexGuestPPC32State*)0)->guest_NRADDR  ) == 4);
-         break;
-
-      case VexArchPPC64:
-         preciseMemExnsFn       
-            = PPC64FN(guest_ppc64_state_requires_precise_mem_exns);
-         disInstrFn             = PPC64FN(disInstr_PPC);
-         specHelper             = PPC64FN(guest_ppc64_spechelper);
-         guest_sizeB            = sizeof(VexGuestPPC64State);
-         guest_word_type        = Ity_I64;
-         guest_layout           = PPC64FN(&ppc64Guest_layout);
-         offB_CMSTART           = offsetof(VexGuestPPC64State,guest_CMSTART);
-         offB_CMLEN             = offsetof(VexGuestPPC64State,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestPPC64State,guest_CIA);
-         szB_GUEST_IP           = sizeof( ((VexGuestPPC64State*)0)->guest_CIA );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestPPC64State,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestPPC64State,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessBE ||
-                 vta->archinfo_guest.endness == VexEndnessLE );
-         vassert(0 == sizeof(VexGuestPPC64State) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestPPC64State*)0)->guest_CMSTART    ) == 8);
-         vassert(sizeof( ((VexGuestPPC64State*)0)->guest_CMLEN      ) == 8);
-         vassert(sizeof( ((VexGuestPPC64State*)0)->guest_NRADDR     ) == 8);
-         vassert(sizeof( ((VexGuestPPC64State*)0)->guest_NRADDR_GPR2) == 8);
-         break;
-
-      case VexArchS390X:
-         preciseMemExnsFn 
-            = S390FN(guest_s390x_state_requires_precise_mem_exns);
-         disInstrFn       = S390FN(disInstr_S390);
-         specHelper       = S390FN(guest_s390x_spechelper);
-         guest_sizeB      = sizeof(VexGuestS390XState);
-         guest_word_type  = Ity_I64;
-         guest_layout     = S390FN(&s390xGuest_layout);
-         offB_CMSTART     = offsetof(VexGuestS390XState,guest_CMSTART);
-         offB_CMLEN       = offsetof(VexGuestS390XState,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestS390XState,guest_IA);
-         szB_GUEST_IP           = sizeof( ((VexGuestS390XState*)0)->guest_IA);
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestS390XState,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestS390XState,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessBE);
-         vassert(0 == sizeof(VexGuestS390XState) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestS390XState*)0)->guest_CMSTART    ) == 8);
-         vassert(sizeof( ((VexGuestS390XState*)0)->guest_CMLEN      ) == 8);
-         vassert(sizeof( ((VexGuestS390XState*)0)->guest_NRADDR     ) == 8);
-         break;
-
-      case VexArchARM:
-         preciseMemExnsFn       
-            = ARMFN(guest_arm_state_requires_precise_mem_exns);
-         disInstrFn             = ARMFN(disInstr_ARM);
-         specHelper             = ARMFN(guest_arm_spechelper);
-         guest_sizeB            = sizeof(VexGuestARMState);
-         guest_word_type        = Ity_I32;
-         guest_layout           = ARMFN(&armGuest_layout);
-         offB_CMSTART           = offsetof(VexGuestARMState,guest_CMSTART);
-         offB_CMLEN             = offsetof(VexGuestARMState,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestARMState,guest_R15T);
-         szB_GUEST_IP           = sizeof( ((VexGuestARMState*)0)->guest_R15T );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestARMState,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestARMState,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessLE);
-         vassert(0 == sizeof(VexGuestARMState) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestARMState*)0)->guest_CMSTART) == 4);
-         vassert(sizeof( ((VexGuestARMState*)0)->guest_CMLEN  ) == 4);
-         vassert(sizeof( ((VexGuestARMState*)0)->guest_NRADDR ) == 4);
-         break;
-
-      case VexArchARM64:
-         preciseMemExnsFn     
-            = ARM64FN(guest_arm64_state_requires_precise_mem_exns);
-         disInstrFn           = ARM64FN(disInstr_ARM64);
-         specHelper           = ARM64FN(guest_arm64_spechelper);
-         guest_sizeB          = sizeof(VexGuestARM64State);
-         guest_word_type      = Ity_I64;
-         guest_layout         = ARM64FN(&arm64Guest_layout);
-         offB_CMSTART         = offsetof(VexGuestARM64State,guest_CMSTART);
-         offB_CMLEN           = offsetof(VexGuestARM64State,guest_CMLEN);
-         offB_GUEST_IP        = offsetof(VexGuestARM64State,guest_PC);
-         szB_GUEST_IP         = sizeof( ((VexGuestARM64State*)0)->guest_PC );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestARM64State,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestARM64State,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessLE);
-         vassert(0 == sizeof(VexGuestARM64State) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestARM64State*)0)->guest_CMSTART) == 8);
-         vassert(sizeof( ((VexGuestARM64State*)0)->guest_CMLEN  ) == 8);
-         vassert(sizeof( ((VexGuestARM64State*)0)->guest_NRADDR ) == 8);
-         break;
-
-      case VexArchMIPS32:
-         preciseMemExnsFn       
-            = MIPS32FN(guest_mips32_state_requires_precise_mem_exns);
-         disInstrFn             = MIPS32FN(disInstr_MIPS);
-         specHelper             = MIPS32FN(guest_mips32_spechelper);
-         guest_sizeB            = sizeof(VexGuestMIPS32State);
-         guest_word_type        = Ity_I32;
-         guest_layout           = MIPS32FN(&mips32Guest_layout);
-         offB_CMSTART           = offsetof(VexGuestMIPS32State,guest_CMSTART);
-         offB_CMLEN             = offsetof(VexGuestMIPS32State,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestMIPS32State,guest_PC);
-         szB_GUEST_IP           = sizeof( ((VexGuestMIPS32State*)0)->guest_PC );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestMIPS32State,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestMIPS32State,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessLE
-                 || vta->archinfo_guest.endness == VexEndnessBE);
-         vassert(0 == sizeof(VexGuestMIPS32State) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestMIPS32State*)0)->guest_CMSTART) == 4);
-         vassert(sizeof( ((VexGuestMIPS32State*)0)->guest_CMLEN  ) == 4);
-         vassert(sizeof( ((VexGuestMIPS32State*)0)->guest_NRADDR ) == 4);
-         break;
-
-      case VexArchMIPS64:
-         preciseMemExnsFn       
-            = MIPS64FN(guest_mips64_state_requires_precise_mem_exns);
-         disInstrFn             = MIPS64FN(disInstr_MIPS);
-         specHelper             = MIPS64FN(guest_mips64_spechelper);
-         guest_sizeB            = sizeof(VexGuestMIPS64State);
-         guest_word_type        = Ity_I64;
-         guest_layout           = MIPS64FN(&mips64Guest_layout);
-         offB_CMSTART           = offsetof(VexGuestMIPS64State,guest_CMSTART);
-         offB_CMLEN             = offsetof(VexGuestMIPS64State,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestMIPS64State,guest_PC);
-         szB_GUEST_IP           = sizeof( ((VexGuestMIPS64State*)0)->guest_PC );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestMIPS64State,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestMIPS64State,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessLE
-                 || vta->archinfo_guest.endness == VexEndnessBE);
-         vassert(0 == sizeof(VexGuestMIPS64State) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestMIPS64State*)0)->guest_CMSTART) == 8);
-         vassert(sizeof( ((VexGuestMIPS64State*)0)->guest_CMLEN  ) == 8);
-         vassert(sizeof( ((VexGuestMIPS64State*)0)->guest_NRADDR ) == 8);
-         break;
-
-      case VexArchTILEGX:
-         preciseMemExnsFn =
-            TILEGXFN(guest_tilegx_state_requires_precise_mem_exns);
-         disInstrFn       = TILEGXFN(disInstr_TILEGX);
-         specHelper       = TILEGXFN(guest_tilegx_spechelper);
-         guest_sizeB      = sizeof(VexGuestTILEGXState);
-         guest_word_type  = Ity_I64;
-         guest_layout     = TILEGXFN(&tilegxGuest_layout);
-         offB_CMSTART     = offsetof(VexGuestTILEGXState,guest_CMSTART);
-         offB_CMLEN       = offsetof(VexGuestTILEGXState,guest_CMLEN);
-         offB_GUEST_IP          = offsetof(VexGuestTILEGXState,guest_pc);
-         szB_GUEST_IP           = sizeof( ((VexGuestTILEGXState*)0)->guest_pc );
-         offB_HOST_EvC_COUNTER  = offsetof(VexGuestTILEGXState,host_EvC_COUNTER);
-         offB_HOST_EvC_FAILADDR = offsetof(VexGuestTILEGXState,host_EvC_FAILADDR);
-         vassert(vta->archinfo_guest.endness == VexEndnessLE);
-         vassert(0 ==
-                 sizeof(VexGuestTILEGXState) % LibVEX_GUEST_STATE_ALIGN);
-         vassert(sizeof( ((VexGuestTILEGXState*)0)->guest_CMSTART    ) == 8);
-         vassert(sizeof( ((VexGuestTILEGXState*)0)->guest_CMLEN      ) == 8);
-         vassert(sizeof( ((VexGuestTILEGXState*)0)->guest_NRADDR     ) == 8);
-         break;
+   gd = getGuestArchDesc(vta->arch_guest);
+   if (gd == NULL)
+      vpanic("LibVEX_Translate: unsupported guest insn set");
+   vassert(endness_bit(vta->archinfo_guest.endness) & gd->endnesses);
+   vassert(0 == gd->sizeB % LibVEX_GUEST_STATE_ALIGN);
 
-      default:
-         vpanic("LibVEX_Translate: unsupported guest insn set");
-   }
+   guest_word_type = gd->wordTy;
 
    // Are the guest's hardware capabilities feasible. The function will
    // not return if hwcaps are infeasible in some sense.
@@ -850,10 +1125,11 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
                      &res.n_guest_instrs,
                      &pxControl,
                      vta->callback_opaque,
-                     disInstrFn,
+                     gd->disInstrFn,
                      vta->guest_bytes, 
                      vta->guest_bytes_addr,
                      vta->chase_into_ok,
+                     vta->guess_indirect_target,
                      vta->archinfo_host.endness,
                      vta->sigill_diag,
                      vta->arch_guest,
@@ -862,17 +1138,20 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
                      guest_word_type,
                      vta->needs_self_check,
                      vta->preamble_function,
-                     offB_CMSTART,
-                     offB_CMLEN,
-                     offB_GUEST_IP,
-                     szB_GUEST_IP );
+                     gd->offB_CMSTART,
+                     gd->offB_CMLEN,
+                     gd->offB_GUEST_IP,
+                     gd->szB_GUEST_IP,
+                     hd->guardedMemTy,
+                     hd->wordTy );
 
    vexAllocSanityCheck();
 
    if (irsb == NULL) {
       /* Access failure. */
       vexSetAllocModeTEMP_and_clear();
-      vex_traceflags = 0;
+      vex_traceflags   = 0;
+      vex_ir_pass_done = NULL;
       res.status = VexTransAccessFail; return res;
    }
 
@@ -909,13 +1188,25 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
    /* Sanity check the initial IR. */
    sanityCheckIRSB( irsb, "initial IR", 
                     False/*can be non-flat*/, guest_word_type );
+   vex_pass_done("frontend", irsb);
 
    vexAllocSanityCheck();
 
    /* Clean it up, hopefully a lot. */
-   irsb = do_iropt_BB ( irsb, specHelper, preciseMemExnsFn, pxControl,
+   irsb = do_iropt_BB ( irsb, gd->specHelper, gd->preciseMemExnsFn, pxControl,
                               vta->guest_bytes_addr,
                               vta->arch_guest );
+   if (vex_control.iropt_level > 1 && vex_control.iropt_slp_level > 0
+       && hd->nativeV128Op) {
+      irsb = do_slp_BB ( irsb, hd->nativeV128Op,
+                         vex_control.iropt_slp_level > 1 );
+      vex_pass_done("slp", irsb);
+   }
+   if (vex_control.iropt_level > 1) {
+      irsb = do_store_merging_BB ( irsb, hd->widestStoreTy,
+                                   hd->unalignedStoresOK );
+      vex_pass_done("store-merging", irsb);
+   }
    sanityCheckIRSB( irsb, "after initial iropt", 
                     True/*must be flat*/, guest_word_type );
 
@@ -932,7 +1223,7 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
    /* Get the thing instrumented. */
    if (vta->instrument1)
       irsb = vta->instrument1(vta->callback_opaque,
-                              irsb, guest_layout, 
+                              irsb, gd->layout,
                               vta->guest_extents,
                               &vta->archinfo_host,
                               guest_word_type, host_word_type);
@@ -940,7 +1231,7 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
 
    if (vta->instrument2)
       irsb = vta->instrument2(vta->callback_opaque,
-                              irsb, guest_layout,
+                              irsb, gd->layout,
                               vta->guest_extents,
                               &vta->archinfo_host,
                               guest_word_type, host_word_type);
@@ -953,17 +1244,25 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
       vex_printf("\n");
    }
 
-   if (vta->instrument1 || vta->instrument2)
+   if (vta->instrument1 || vta->instrument2) {
       sanityCheckIRSB( irsb, "after instrumentation",
                        True/*must be flat*/, guest_word_type );
+      vex_pass_done("instrumentation", irsb);
+   }
 
-   /* Do a post-instrumentation cleanup pass. */
+   /* Inline any helpers the instrumentation calls that the client has
+      given bodies for, lower any event buffer appends, then do a
+      post-instrumentation cleanup pass. */
    if (vta->instrument1 || vta->instrument2) {
+      if (vex_control.iropt_level > 0)
+         irsb = do_helper_inlining_BB( irsb, False/*!newBlock*/ );
+      irsb = do_evappend_lowering_BB( irsb, guest_word_type );
       do_deadcode_BB( irsb );
       irsb = cprop_BB( irsb );
       do_deadcode_BB( irsb );
       sanityCheckIRSB( irsb, "after post-instrumentation cleanup",
                        True/*must be flat*/, guest_word_type );
+      vex_pass_done("post-instrumentation", irsb);
    }
 
    vexAllocSanityCheck();
@@ -976,287 +1275,402 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* vta )
       vex_printf("\n");
    }
 
-   /* Turn it into virtual-registerised code.  Build trees -- this
-      also throws away any dead bindings. */
-   max_ga = ado_treebuild_BB( irsb, preciseMemExnsFn, pxControl );
-
-   if (vta->finaltidy) {
-      irsb = vta->finaltidy(irsb);
+   /* Do the rest. */
+   {
+      VexCompileIRArgs ca;
+      vex_bzero(&ca, sizeof(ca));
+      ca.arch_host                  = vta->arch_host;
+      ca.archinfo_host              = vta->archinfo_host;
+      ca.abiinfo                    = vta->abiinfo_both;
+      ca.irsb                       = irsb;
+      ca.layout                     = gd->layout;
+      ca.offB_HOST_EvC_COUNTER      = gd->offB_HOST_EvC_COUNTER;
+      ca.offB_HOST_EvC_FAILADDR     = gd->offB_HOST_EvC_FAILADDR;
+      ca.preciseMemExnsFn           = gd->preciseMemExnsFn;
+      ca.specHelper                 = gd->specHelper;
+      ca.host_bytes                 = vta->host_bytes;
+      ca.host_bytes_size            = vta->host_bytes_size;
+      ca.host_bytes_used            = vta->host_bytes_used;
+      ca.traceflags                 = vta->traceflags;
+      ca.addProfInc                 = vta->addProfInc;
+      ca.ir_pass_done               = vta->ir_pass_done;
+      ca.callback_opaque            = vta->callback_opaque;
+      ca.exit_sites                 = vta->exit_sites;
+      ca.exit_sites_size            = vta->exit_sites_size;
+      ca.exit_sites_used            = vta->exit_sites_used;
+      ca.disp_cp_chain_me_to_slowEP = vta->disp_cp_chain_me_to_slowEP;
+      ca.disp_cp_chain_me_to_fastEP = vta->disp_cp_chain_me_to_fastEP;
+      ca.disp_cp_xindir             = vta->disp_cp_xindir;
+      ca.disp_cp_xassisted          = vta->disp_cp_xassisted;
+
+      /* No guest has its IP field at offset zero.  If this fails it
+         means some transformation pass somewhere failed to
+         update/copy irsb->offsIP properly. */
+      vassert(irsb->offsIP >= 16);
+
+      compile_IRSB( &res, hd, &ca, irsb, pxControl, vta->finaltidy,
+                    gd->sizeB, vta->guest_bytes_addr );
+      if (res.status != VexTransOK) {
+         vexSetAllocModeTEMP_and_clear();
+         vex_traceflags   = 0;
+         vex_ir_pass_done = NULL;
+         return res;
+      }
+      if (vta->exit_sites && res.n_sc_extents > 0) {
+         for (i = 0; i < *(vta->exit_sites_used); i++)
+            vta->exit_sites[i].self_checked = True;
+      }
    }
 
    vexAllocSanityCheck();
 
-   if (vex_traceflags & VEX_TRACE_TREES) {
-      vex_printf("\n------------------------" 
-                   "  After tree-building "
-                   "------------------------\n\n");
-      ppIRSB ( irsb );
-      vex_printf("\n");
-   }
+   vexSetAllocModeTEMP_and_clear();
 
-   /* HACK */
-   if (0) {
-      *(vta->host_bytes_used) = 0;
-      res.status = VexTransOK; return res;
+   if (vex_traceflags) {
+      /* Print the expansion ratio for this SB. */
+      j = 0; /* total guest bytes */
+      for (i = 0; i < vta->guest_extents->n_used; i++) {
+         j += vta->guest_extents->len[i];
+      }
+      if (1) vex_printf("VexExpansionRatio %d %d   %d :10\n\n",
+                        j, *(vta->host_bytes_used),
+                        (10 * *(vta->host_bytes_used)) / (j == 0 ? 1 : j));
    }
-   /* end HACK */
 
-   if (vex_traceflags & VEX_TRACE_VCODE)
-      vex_printf("\n------------------------" 
-                   " Instruction selection "
-                   "------------------------\n");
+   vex_traceflags   = 0;
+   vex_ir_pass_done = NULL;
+   res.status = VexTransOK;
+   return res;
+}
+
+
+/* --------- Inlinable helpers. --------- */
+
+/* Exported to library client. */
+
+void LibVEX_RegisterInlineHelper ( void* addr, Int n_args,
+                                   const IRExpr* body, Int max_per_block )
+{
+   VexAllocMode saved;
+   IRExpr*      copy;
+
+   vassert(vex_initdone);
+   saved = vexGetAllocMode();
+   vexSetAllocMode(VexAllocModePERM);
+   copy = deepCopyIRExpr(body);
+   vexSetAllocMode(saved);
+   iropt_register_inline_helper(addr, n_args, copy, max_per_block);
+}
+
+
+/* --------- Compile client-built IR. --------- */
+
+/* Used when the caller doesn't say which parts of its state block
+   need to be up to date at memory accesses: all of it. */
+static Bool compileIR_all_precise ( Int minoff, Int maxoff,
+                                    VexRegisterUpdates pxControl )
+{
+   return True;
+}
+
+static IRExpr* compileIR_no_spechelper ( const HChar* function_name,
+                                         IRExpr** args,
+                                         IRStmt** precedingStmts,
+                                         Int n_precedingStmts )
+{
+   return NULL;
+}
+
+/* Exported to library client. */
+
+VexTranslateResult LibVEX_CompileIR ( VexCompileIRArgs* vca )
+{
+   const HostArchDesc* hd;
+   VexCompileIRArgs    ca;
+   IRSB*               irsb;
+   IRType              host_word_type;
+   Addr                first_ga = 0;
+   Int                 i;
 
-   /* No guest has its IP field at offset zero.  If this fails it
-      means some transformation pass somewhere failed to update/copy
-      irsb->offsIP properly. */
-   vassert(irsb->offsIP >= 16);
+   VexTranslateResult res;
+   res.status         = VexTransOK;
+   res.n_sc_extents   = 0;
+   res.offs_profInc   = -1;
+   res.n_guest_instrs = 0;
 
-   vcode = iselSB ( irsb, vta->arch_host,
-                    &vta->archinfo_host, 
-                    &vta->abiinfo_both,
-                    offB_HOST_EvC_COUNTER,
-                    offB_HOST_EvC_FAILADDR,
-                    chainingAllowed,
-                    vta->addProfInc,
-                    max_ga );
+   vex_traceflags     = vca->traceflags;
+   vex_ir_pass_done   = vca->ir_pass_done;
+   vex_ir_pass_opaque = vca->callback_opaque;
 
+   vassert(vex_initdone);
+   vassert(vca->irsb != NULL);
+   vassert(vca->layout != NULL);
+   vassert(vca->disp_cp_xassisted != NULL);
+   if (vca->disp_cp_chain_me_to_slowEP        != NULL) {
+      vassert(vca->disp_cp_chain_me_to_fastEP != NULL);
+      vassert(vca->disp_cp_xindir             != NULL);
+   } else {
+      vassert(vca->disp_cp_chain_me_to_fastEP == NULL);
+      vassert(vca->disp_cp_xindir             == NULL);
+   }
+
+   /* Unlike LibVEX_Translate, don't clear the temporary allocation
+      area here: the caller's IR lives in it. */
    vexAllocSanityCheck();
 
-   if (vex_traceflags & VEX_TRACE_VCODE)
-      vex_printf("\n");
+   hd = getHostArchDesc(vca->arch_host);
+   if (hd == NULL)
+      vpanic("LibVEX_CompileIR: unsupported host insn set");
+   vassert(endness_bit(vca->archinfo_host.endness) & hd->endnesses);
+   host_word_type = hd->wordTy;
 
-   if (vex_traceflags & VEX_TRACE_VCODE) {
-      for (i = 0; i < vcode->arr_used; i++) {
-         vex_printf("%3d   ", i);
-         ppInstr(vcode->arr[i], mode64);
-         vex_printf("\n");
+   if (vca->arch_host == VexArchS390X) {
+      /* KLUDGE: export hwcaps. */
+      s390_host_hwcaps = vca->archinfo_host.hwcaps;
+   }
+   check_hwcaps(vca->arch_host, vca->archinfo_host.hwcaps);
+
+   /* The state block, and the fields in it that the generated code
+      uses, must be as described in libvex.h. */
+   vassert(vca->layout->total_sizeB > 0
+           && (vca->layout->total_sizeB & 15) == 0);
+   vassert(vca->irsb->offsIP >= 0
+           && vca->irsb->offsIP < vca->layout->total_sizeB);
+   vassert(vca->offB_HOST_EvC_COUNTER >= 0
+           && vca->offB_HOST_EvC_COUNTER < vca->layout->total_sizeB);
+   vassert(vca->offB_HOST_EvC_FAILADDR >= 0
+           && vca->offB_HOST_EvC_FAILADDR < vca->layout->total_sizeB);
+
+   ca = *vca;
+   if (ca.preciseMemExnsFn == NULL)
+      ca.preciseMemExnsFn = compileIR_all_precise;
+   if (ca.specHelper == NULL)
+      ca.specHelper = compileIR_no_spechelper;
+
+   irsb = ca.irsb;
+   for (i = 0; i < irsb->stmts_used; i++) {
+      if (irsb->stmts[i]->tag == Ist_IMark) {
+         first_ga = irsb->stmts[i]->Ist.IMark.addr;
+         break;
       }
-      vex_printf("\n");
    }
 
-   /* Register allocate. */
-   rcode = doRegisterAllocation ( vcode, rRegUniv,
-                                  isMove, getRegUsage, mapRegs, 
-                                  genSpill, genReload, directReload, 
-                                  guest_sizeB,
-                                  ppInstr, ppReg, mode64 );
+   VexRegisterUpdates pxControl = vex_control.iropt_register_updates_default;
+   vassert(pxControl >= VexRegUpdSpAtMemAccess
+           && pxControl <= VexRegUpdAllregsAtEachInsn);
 
-   vexAllocSanityCheck();
+   sanityCheckIRSB( irsb, "client IR",
+                    False/*can be non-flat*/, host_word_type );
+   vex_pass_done("client", irsb);
 
-   if (vex_traceflags & VEX_TRACE_RCODE) {
-      vex_printf("\n------------------------" 
-                   " Register-allocated code "
+   if (vex_traceflags & VEX_TRACE_FE) {
+      vex_printf("\n------------------------"
+                   " Client IR "
                    "------------------------\n\n");
-      for (i = 0; i < rcode->arr_used; i++) {
-         vex_printf("%3d   ", i);
-         ppInstr(rcode->arr[i], mode64);
-         vex_printf("\n");
-      }
+      ppIRSB ( irsb );
       vex_printf("\n");
    }
 
-   /* HACK */
-   if (0) { 
-      *(vta->host_bytes_used) = 0;
-      res.status = VexTransOK; return res;
+   /* Client IR may append to event buffers, as instrumentation does;
+      the optimiser does not know about Ist_EvAppend, so lower those
+      first. */
+   irsb = do_evappend_lowering_BB( irsb, host_word_type );
+
+   irsb = do_iropt_BB ( irsb, ca.specHelper, ca.preciseMemExnsFn,
+                              pxControl, first_ga, VexArch_INVALID );
+   if (vex_control.iropt_level > 1 && vex_control.iropt_slp_level > 0
+       && hd->nativeV128Op) {
+      irsb = do_slp_BB ( irsb, hd->nativeV128Op,
+                         vex_control.iropt_slp_level > 1 );
+      vex_pass_done("slp", irsb);
    }
-   /* end HACK */
-
-   /* Assemble */
-   if (vex_traceflags & VEX_TRACE_ASM) {
-      vex_printf("\n------------------------" 
-                   " Assembly "
-                   "------------------------\n\n");
+   if (vex_control.iropt_level > 1) {
+      irsb = do_store_merging_BB ( irsb, hd->widestStoreTy,
+                                   hd->unalignedStoresOK );
+      vex_pass_done("store-merging", irsb);
    }
+   sanityCheckIRSB( irsb, "after iropt",
+                    True/*must be flat*/, host_word_type );
 
-   out_used = 0; /* tracks along the host_bytes array */
-   for (i = 0; i < rcode->arr_used; i++) {
-      HInstr* hi           = rcode->arr[i];
-      Bool    hi_isProfInc = False;
-      if (UNLIKELY(vex_traceflags & VEX_TRACE_ASM)) {
-         ppInstr(hi, mode64);
-         vex_printf("\n");
-      }
-      j = emit( &hi_isProfInc,
-                insn_bytes, sizeof insn_bytes, hi,
-                mode64, vta->archinfo_host.endness,
-                vta->disp_cp_chain_me_to_slowEP,
-                vta->disp_cp_chain_me_to_fastEP,
-                vta->disp_cp_xindir,
-                vta->disp_cp_xassisted );
-      if (UNLIKELY(vex_traceflags & VEX_TRACE_ASM)) {
-         for (k = 0; k < j; k++)
-            vex_printf("%02x ", (UInt)insn_bytes[k]);
-         vex_printf("\n\n");
-      }
-      if (UNLIKELY(out_used + j > vta->host_bytes_size)) {
-         vexSetAllocModeTEMP_and_clear();
-         vex_traceflags = 0;
-         res.status = VexTransOutputFull;
-         return res;
-      }
-      if (UNLIKELY(hi_isProfInc)) {
-         vassert(vta->addProfInc); /* else where did it come from? */
-         vassert(res.offs_profInc == -1); /* there can be only one (tm) */
-         vassert(out_used >= 0);
-         res.offs_profInc = out_used;
-      }
-      { UChar* dst = &vta->host_bytes[out_used];
-        for (k = 0; k < j; k++) {
-           dst[k] = insn_bytes[k];
-        }
-        out_used += j;
-      }
+   if (vex_traceflags & VEX_TRACE_OPT1) {
+      vex_printf("\n------------------------"
+                   " After IR optimisation "
+                   "------------------------\n\n");
+      ppIRSB ( irsb );
+      vex_printf("\n");
    }
-   *(vta->host_bytes_used) = out_used;
 
    vexAllocSanityCheck();
 
-   vexSetAllocModeTEMP_and_clear();
+   compile_IRSB( &res, hd, &ca, irsb, pxControl, NULL/*finaltidy*/,
+                 ca.layout->total_sizeB, first_ga );
 
-   if (vex_traceflags) {
-      /* Print the expansion ratio for this SB. */
-      j = 0; /* total guest bytes */
-      for (i = 0; i < vta->guest_extents->n_used; i++) {
-         j += vta->guest_extents->len[i];
-      }
-      if (1) vex_printf("VexExpansionRatio %d %d   %d :10\n\n",
-                        j, out_used, (10 * out_used) / (j == 0 ? 1 : j));
-   }
-
-   vex_traceflags = 0;
-   res.status = VexTransOK;
+   vexAllocSanityCheck();
+   vexSetAllocModeTEMP_and_clear();
+   vex_traceflags   = 0;
+   vex_ir_pass_done = NULL;
    return res;
 }
 
 
 /* --------- Chain/Unchain XDirects. --------- */
 
+/* The code is patched through its write alias, at place + wr_delta.
+   The x86, amd64, arm and s390 chained jumps can be pc-relative, so
+   depend on where the code runs; those back ends are told both
+   addresses.  The rest only ever write absolute addresses, so they
+   are handed the alias and the range they return is moved back. */
+
+static inline void* wr_alias ( void* place, HWord wr_delta )
+{
+   return (UChar*)place + wr_delta;
+}
+
 VexInvalRange LibVEX_Chain ( VexArch     arch_host,
                              VexEndness  endness_host,
                              void*       place_to_chain,
+                             HWord       wr_delta,
                              const void* disp_cp_chain_me_EXPECTED,
                              const void* place_to_jump_to )
 {
+   VexInvalRange vir;
    switch (arch_host) {
       case VexArchX86:
          X86ST(return chainXDirect_X86(endness_host,
-                                       place_to_chain,
+                                       place_to_chain, wr_delta,
                                        disp_cp_chain_me_EXPECTED,
                                        place_to_jump_to));
       case VexArchAMD64:
          AMD64ST(return chainXDirect_AMD64(endness_host,
-                                           place_to_chain,
+                                           place_to_chain, wr_delta,
                                            disp_cp_chain_me_EXPECTED,
                                            place_to_jump_to));
       case VexArchARM:
          ARMST(return chainXDirect_ARM(endness_host,
-                                       place_to_chain,
+                                       place_to_chain, wr_delta,
                                        disp_cp_chain_me_EXPECTED,
                                        place_to_jump_to));
       case VexArchARM64:
-         ARM64ST(return chainXDirect_ARM64(endness_host,
-                                           place_to_chain,
-                                           disp_cp_chain_me_EXPECTED,
-                                           place_to_jump_to));
+         ARM64ST(vir = chainXDirect_ARM64(endness_host,
+                                          wr_alias(place_to_chain, wr_delta),
+                                          disp_cp_chain_me_EXPECTED,
+                                          place_to_jump_to));
+         break;
       case VexArchS390X:
          S390ST(return chainXDirect_S390(endness_host,
-                                         place_to_chain,
+                                         place_to_chain, wr_delta,
                                          disp_cp_chain_me_EXPECTED,
                                          place_to_jump_to));
       case VexArchPPC32:
-         PPC32ST(return chainXDirect_PPC(endness_host,
-                                         place_to_chain,
-                                         disp_cp_chain_me_EXPECTED,
-                                         place_to_jump_to, False/*!mode64*/));
+         PPC32ST(vir = chainXDirect_PPC(endness_host,
+                                        wr_alias(place_to_chain, wr_delta),
+                                        disp_cp_chain_me_EXPECTED,
+                                        place_to_jump_to, False/*!mode64*/));
+         break;
       case VexArchPPC64:
-         PPC64ST(return chainXDirect_PPC(endness_host,
-                                         place_to_chain,
-                                         disp_cp_chain_me_EXPECTED,
-                                         place_to_jump_to, True/*mode64*/));
+         PPC64ST(vir = chainXDirect_PPC(endness_host,
+                                        wr_alias(place_to_chain, wr_delta),
+                                        disp_cp_chain_me_EXPECTED,
+                                        place_to_jump_to, True/*mode64*/));
+         break;
       case VexArchMIPS32:
-         MIPS32ST(return chainXDirect_MIPS(endness_host,
-                                           place_to_chain,
-                                           disp_cp_chain_me_EXPECTED,
-                                           place_to_jump_to, False/*!mode64*/));
+         MIPS32ST(vir = chainXDirect_MIPS(endness_host,
+                                          wr_alias(place_to_chain, wr_delta),
+                                          disp_cp_chain_me_EXPECTED,
+                                          place_to_jump_to, False/*!mode64*/));
+         break;
       case VexArchMIPS64:
-         MIPS64ST(return chainXDirect_MIPS(endness_host,
-                                           place_to_chain,
-                                           disp_cp_chain_me_EXPECTED,
-                                           place_to_jump_to, True/*!mode64*/));
+         MIPS64ST(vir = chainXDirect_MIPS(endness_host,
+                                          wr_alias(place_to_chain, wr_delta),
+                                          disp_cp_chain_me_EXPECTED,
+                                          place_to_jump_to, True/*!mode64*/));
+         break;
 
       case VexArchTILEGX:
-         TILEGXST(return chainXDirect_TILEGX(endness_host,
-                                             place_to_chain,
-                                             disp_cp_chain_me_EXPECTED,
-                                             place_to_jump_to, True/*!mode64*/));
+         TILEGXST(vir = chainXDirect_TILEGX(endness_host,
+                                            wr_alias(place_to_chain, wr_delta),
+                                            disp_cp_chain_me_EXPECTED,
+                                            place_to_jump_to, True/*!mode64*/));
+         break;
       default:
          vassert(0);
    }
+   vir.start -= wr_delta;
+   return vir;
 }
 
 VexInvalRange LibVEX_UnChain ( VexArch     arch_host,
                                VexEndness  endness_host,
                                void*       place_to_unchain,
+                               HWord       wr_delta,
                                const void* place_to_jump_to_EXPECTED,
                                const void* disp_cp_chain_me )
 {
+   VexInvalRange vir;
    switch (arch_host) {
       case VexArchX86:
          X86ST(return unchainXDirect_X86(endness_host,
-                                         place_to_unchain,
+                                         place_to_unchain, wr_delta,
                                          place_to_jump_to_EXPECTED,
                                          disp_cp_chain_me));
       case VexArchAMD64:
          AMD64ST(return unchainXDirect_AMD64(endness_host,
-                                             place_to_unchain,
+                                             place_to_unchain, wr_delta,
                                              place_to_jump_to_EXPECTED,
                                              disp_cp_chain_me));
       case VexArchARM:
          ARMST(return unchainXDirect_ARM(endness_host,
-                                         place_to_unchain,
+                                         place_to_unchain, wr_delta,
                                          place_to_jump_to_EXPECTED,
                                          disp_cp_chain_me));
       case VexArchARM64:
-         ARM64ST(return unchainXDirect_ARM64(endness_host,
-                                             place_to_unchain,
-                                             place_to_jump_to_EXPECTED,
-                                             disp_cp_chain_me));
+         ARM64ST(vir = unchainXDirect_ARM64(endness_host,
+                                            wr_alias(place_to_unchain, wr_delta),
+                                            place_to_jump_to_EXPECTED,
+                                            disp_cp_chain_me));
+         break;
       case VexArchS390X:
          S390ST(return unchainXDirect_S390(endness_host,
-                                           place_to_unchain,
+                                           place_to_unchain, wr_delta,
                                            place_to_jump_to_EXPECTED,
                                            disp_cp_chain_me));
       case VexArchPPC32:
-         PPC32ST(return unchainXDirect_PPC(endness_host,
-                                           place_to_unchain,
-                                           place_to_jump_to_EXPECTED,
-                                           disp_cp_chain_me, False/*!mode64*/));
+         PPC32ST(vir = unchainXDirect_PPC(endness_host,
+                                          wr_alias(place_to_unchain, wr_delta),
+                                          place_to_jump_to_EXPECTED,
+                                          disp_cp_chain_me, False/*!mode64*/));
+         break;
       case VexArchPPC64:
-         PPC64ST(return unchainXDirect_PPC(endness_host,
-                                           place_to_unchain,
-                                           place_to_jump_to_EXPECTED,
-                                           disp_cp_chain_me, True/*mode64*/));
+         PPC64ST(vir = unchainXDirect_PPC(endness_host,
+                                          wr_alias(place_to_unchain, wr_delta),
+                                          place_to_jump_to_EXPECTED,
+                                          disp_cp_chain_me, True/*mode64*/));
+         break;
       case VexArchMIPS32:
-         MIPS32ST(return unchainXDirect_MIPS(endness_host,
-                                             place_to_unchain,
-                                             place_to_jump_to_EXPECTED,
-                                             disp_cp_chain_me, False/*!mode64*/));
+         MIPS32ST(vir = unchainXDirect_MIPS(endness_host,
+                                            wr_alias(place_to_unchain, wr_delta),
+                                            place_to_jump_to_EXPECTED,
+                                            disp_cp_chain_me, False/*!mode64*/));
+         break;
       case VexArchMIPS64:
-         MIPS64ST(return unchainXDirect_MIPS(endness_host,
-                                             place_to_unchain,
-                                             place_to_jump_to_EXPECTED,
-                                             disp_cp_chain_me, True/*!mode64*/));
+         MIPS64ST(vir = unchainXDirect_MIPS(endness_host,
+                                            wr_alias(place_to_unchain, wr_delta),
+                                            place_to_jump_to_EXPECTED,
+                                            disp_cp_chain_me, True/*!mode64*/));
+         break;
 
       case VexArchTILEGX:
-         TILEGXST(return unchainXDirect_TILEGX(endness_host,
-                                      place_to_unchain,
-                                      place_to_jump_to_EXPECTED,
-                                               disp_cp_chain_me, True/*!mode64*/));
+         TILEGXST(vir = unchainXDirect_TILEGX(endness_host,
+                                              wr_alias(place_to_unchain, wr_delta),
+                                              place_to_jump_to_EXPECTED,
+                                              disp_cp_chain_me, True/*!mode64*/));
+         break;
 
       default:
          vassert(0);
    }
+   vir.start -= wr_delta;
+   return vir;
 }
 
 Int LibVEX_evCheckSzB ( VexArch    arch_host )
@@ -1294,43 +1708,101 @@ Int LibVEX_evCheckSzB ( VexArch    arch_host )
 VexInvalRange LibVEX_PatchProfInc ( VexArch    arch_host,
                                     VexEndness endness_host,
                                     void*      place_to_patch,
+                                    HWord      wr_delta,
                                     const ULong* location_of_counter )
 {
+   VexInvalRange vir;
    switch (arch_host) {
       case VexArchX86:
-         X86ST(return patchProfInc_X86(endness_host, place_to_patch,
-                                       location_of_counter));
+         X86ST(vir = patchProfInc_X86(endness_host,
+                                      wr_alias(place_to_patch, wr_delta),
+                                      location_of_counter));
+         break;
       case VexArchAMD64:
-         AMD64ST(return patchProfInc_AMD64(endness_host, place_to_patch,
-                                           location_of_counter));
+         AMD64ST(vir = patchProfInc_AMD64(endness_host,
+                                          wr_alias(place_to_patch, wr_delta),
+                                          location_of_counter));
+         break;
       case VexArchARM:
-         ARMST(return patchProfInc_ARM(endness_host, place_to_patch,
-                                       location_of_counter));
+         ARMST(vir = patchProfInc_ARM(endness_host,
+                                      wr_alias(place_to_patch, wr_delta),
+                                      location_of_counter));
+         break;
       case VexArchARM64:
-         ARM64ST(return patchProfInc_ARM64(endness_host, place_to_patch,
-                                           location_of_counter));
+         ARM64ST(vir = patchProfInc_ARM64(endness_host,
+                                          wr_alias(place_to_patch, wr_delta),
+                                          location_of_counter));
+         break;
       case VexArchS390X:
-         S390ST(return patchProfInc_S390(endness_host, place_to_patch,
-                                         location_of_counter));
+         S390ST(vir = patchProfInc_S390(endness_host,
+                                        wr_alias(place_to_patch, wr_delta),
+                                        location_of_counter));
+         break;
       case VexArchPPC32:
-         PPC32ST(return patchProfInc_PPC(endness_host, place_to_patch,
-                                         location_of_counter, False/*!mode64*/));
+         PPC32ST(vir = patchProfInc_PPC(endness_host,
+                                        wr_alias(place_to_patch, wr_delta),
+                                        location_of_counter, False/*!mode64*/));
+         break;
       case VexArchPPC64:
-         PPC64ST(return patchProfInc_PPC(endness_host, place_to_patch,
-                                         location_of_counter, True/*mode64*/));
+         PPC64ST(vir = patchProfInc_PPC(endness_host,
+                                        wr_alias(place_to_patch, wr_delta),
+                                        location_of_counter, True/*mode64*/));
+         break;
       case VexArchMIPS32:
-         MIPS32ST(return patchProfInc_MIPS(endness_host, place_to_patch,
-                                           location_of_counter, False/*!mode64*/));
+         MIPS32ST(vir = patchProfInc_MIPS(endness_host,
+                                          wr_alias(place_to_patch, wr_delta),
+                                          location_of_counter, False/*!mode64*/));
+         break;
       case VexArchMIPS64:
-         MIPS64ST(return patchProfInc_MIPS(endness_host, place_to_patch,
-                                           location_of_counter, True/*!mode64*/));
+         MIPS64ST(vir = patchProfInc_MIPS(endness_host,
+                                          wr_alias(place_to_patch, wr_delta),
+                                          location_of_counter, True/*!mode64*/));
+         break;
       case VexArchTILEGX:
-         TILEGXST(return patchProfInc_TILEGX(endness_host, place_to_patch,
-                                             location_of_counter,
-                                             True/*!mode64*/));
+         TILEGXST(vir = patchProfInc_TILEGX(endness_host,
+                                            wr_alias(place_to_patch, wr_delta),
+                                            location_of_counter,
+                                            True/*!mode64*/));
+         break;
       default:
          vassert(0);
    }
+   vir.start -= wr_delta;
+   return vir;
+}
+
+Bool LibVEX_PatchExitTarget ( VexArch    arch_host,
+                              VexEndness endness_host,
+                              void*      place_to_patch,
+                              HWord      wr_delta,
+                              /*MOD*/VexExitSite* site,
+                              Addr       new_target,
+                              /*OUT*/VexInvalRange* inval )
+{
+   Bool ok = False;
+   if (site->kind != VexExitBranch || site->self_checked)
+      return False;
+   /* The chain_me stub called, hence the entry point the exit gets
+      chained to, was picked for the old target and stays as it is. */
+   if ((new_target > site->max_ga) != site->to_fast_ep)
+      return False;
+   switch (arch_host) {
+      case VexArchAMD64:
+         AMD64ST(ok = patchXDirectTarget_AMD64(endness_host,
+                                               wr_alias(place_to_patch,
+                                                        wr_delta),
+                                               new_target, inval));
+         break;
+      default:
+         /* LibVEX_Translate doesn't record exit sites for other
+            hosts, so we can't get here. */
+         vpanic("LibVEX_PatchExitTarget: unsupported host");
+   }
+   if (ok) {
+      inval->start -= wr_delta;
+      site->guest_target = new_target;
+   }
+   return ok;
 }
 
 
@@ -122,7 +122,9 @@ extern void   private_LibVEX_alloc_OOM(void) __attribute__((noreturn));
    boundary. */
 #define REQ_ALIGN 8
 
-static inline void* LibVEX_Alloc_inline ( SizeT nbytes )
+/* The number of bytes LibVEX_Alloc_inline really takes for a request
+   of 'nbytes'. */
+static inline SizeT LibVEX_Alloc_size ( SizeT nbytes )
 {
    struct align {
       char c;
@@ -145,15 +147,19 @@ static inline void* LibVEX_Alloc_inline ( SizeT nbytes )
    /* Make sure the compiler does no surprise us */
    vassert(offsetof(struct align,x) <= REQ_ALIGN);
 
+   SizeT ALIGN = offsetof(struct align,x) - 1;
+   return (nbytes + ALIGN) & ~ALIGN;
+}
+
+static inline void* LibVEX_Alloc_inline ( SizeT nbytes )
+{
 #if 0
   /* Nasty debugging hack, do not use. */
   return malloc(nbytes);
 #else
    HChar* curr;
    HChar* next;
-   SizeT  ALIGN;
-   ALIGN  = offsetof(struct align,x) - 1;
-   nbytes = (nbytes + ALIGN) & ~ALIGN;
+   nbytes = LibVEX_Alloc_size(nbytes);
    curr   = private_LibVEX_alloc_curr;
    next   = curr + nbytes;
    if (next >= private_LibVEX_alloc_last)
@@ -163,6 +169,16 @@ static inline void* LibVEX_Alloc_inline ( SizeT nbytes )
 #endif
 }
 
+/* Give back the 'nbytes' at 'p' if they were the last thing allocated,
+   and otherwise do nothing.  This is for objects which are copied
+   somewhere else as soon as they are made, so that the original need
+   not take up space. */
+static inline void LibVEX_Unalloc_inline ( void* p, SizeT nbytes )
+{
+   if ((HChar*)p + LibVEX_Alloc_size(nbytes) == private_LibVEX_alloc_curr)
+      private_LibVEX_alloc_curr = (HChar*)p;
+}
+
 /* Misaligned memory access support. */
 
 extern UInt  read_misaligned_UInt_LE  ( void* addr );
@@ -471,6 +471,15 @@ typedef
          numbers make it more enthusiastic about loop unrolling.
          Default=120.  A setting of zero disables unrolling.  */
       Int iropt_unroll_thresh;
+      /* Should iropt try to combine groups of identical scalar
+         integer operations on adjacent data into single 128-bit
+         vector operations?  Only done for hosts with suitable vector
+         instructions.  0 (default) = no.  1 = only within a single
+         guest instruction.  2 = also across guest instructions; this
+         moves memory accesses past instruction boundaries, so a
+         fault may be reported with guest state from a neighbouring
+         instruction. */
+      Int iropt_slp_level;
       /* What's the maximum basic block length the front end(s) allow?
          BBs longer than this are split up.  Default=50 (guest
          insns). */
@@ -482,7 +491,9 @@ typedef
          successor. A setting of zero disables chasing.  */
       Int guest_chase_thresh;
       /* EXPERIMENTAL: chase across conditional branches?  Not all
-         front ends honour this.  Default: NO. */
+         front ends honour this.  This also lets bb_to_IR absorb a
+         forward branch around one or two insns into the block, by
+         making those insns conditional.  Default: NO. */
       Bool guest_chase_cond;
    }
    VexControl;
@@ -593,6 +604,12 @@ extern void LibVEX_Init (
    const VexControl* vcon
 );
 
+/* Replace the settings given to LibVEX_Init.  Only for use between
+   translations, by clients that want to compare the output of
+   different optimisation settings. */
+
+extern void LibVEX_Update_Control ( const VexControl* vcon );
+
 
 /*-------------------------------------------------------*/
 /*--- Make a translation                              ---*/
@@ -634,6 +651,58 @@ typedef
    VexGuestExtents;
 
 
+/* Where the guest target of a direct exit comes from. */
+typedef
+   enum {
+      VexExitKind_INVALID=0x900,
+      /* The insn's branch displacement: a taken branch or call. */
+      VexExitBranch,
+      /* The address of the next insn: the not-taken side of a
+         conditional branch, or the end of the block. */
+      VexExitFallThrough,
+      /* The address of the insn itself, to re-execute it: a
+         mispredicted indirect target, or a repeated string insn. */
+      VexExitResteer
+   }
+   VexExitKind;
+
+/* Describes a direct exit from a translation: which guest insn it
+   came from, and where in the host code its guest target is loaded.
+   When a guest rewrites only the target of a direct branch (a
+   hot-patched trampoline, an inline cache), the client can use
+   LibVEX_PatchExitTarget to update the translation in place rather
+   than discarding it. */
+typedef
+   struct {
+      /* Offset in the generated code of the exit. */
+      UInt   offs_host;
+      /* The guest insn, of guest_insn_len bytes, that the exit
+         belongs to, ie the innermost IMark before it.  This is the
+         insn's real address, without the Thumb bit, as IMark.addr
+         gives it. */
+      UInt   guest_insn_len;
+      Addr   guest_insn;
+      /* The guest address the exit currently goes to. */
+      Addr   guest_target;
+      /* Whether the exit, once chained, goes to the target's fast
+         entry point, skipping its event check.  That is done for
+         targets above max_ga, the highest guest address in the
+         block, that is, for forward edges.  A new target has to be
+         on the same side of max_ga. */
+      Bool   to_fast_ep;
+      Addr   max_ga;
+      /* Where guest_target came from.  Only a VexExitBranch target
+         follows from the insn's bytes, so only those exits can be
+         patched. */
+      VexExitKind kind;
+      /* Whether the translation checks its guest bytes.  Such a
+         translation fails its check once the bytes change, so its
+         exits are never patched. */
+      Bool   self_checked;
+   }
+   VexExitSite;
+
+
 /* A structure to carry arguments for LibVEX_Translate.  There are so
    many of them, it seems better to have a structure. */
 typedef
@@ -664,10 +733,23 @@ typedef
 	 NULL. */
       Bool    (*chase_into_ok) ( /*callback_opaque*/void*, Addr );
 
+      /* IN: optionally, a callback which predicts the target of the
+         indirect jump or call at the given guest address, for example
+         from profiling.  If it returns True, and chase_into_ok allows
+         it, the front end guards on the computed target and chases
+         into the predicted one; a misprediction exits back to the
+         jump or call and re-executes it in a new translation.  May
+         be NULL. */
+      Bool    (*guess_indirect_target) ( /*callback_opaque*/void*,
+                                         Addr site, /*OUT*/Addr* target );
+
       /* OUT: which bits of guest code actually got translated */
       VexGuestExtents* guest_extents;
 
-      /* IN: a place to put the resulting code, and its size */
+      /* IN: a place to put the resulting code, and its size.  The
+         code does not depend on where it is put, so this may be a
+         writable alias of an executable code cache, or a buffer the
+         code is later copied from. */
       UChar*  host_bytes;
       Int     host_bytes_size;
       /* OUT: how much of the output area is used. */
@@ -690,6 +772,19 @@ typedef
 
       IRSB* (*finaltidy) ( IRSB* );
 
+      /* IN: debug: optionally, a callback made as each stage of the
+         translation finishes -- the front end, each IR optimisation
+         pass, instrumentation, lowering and tree building, then
+         "isel", "regalloc" and "emit" -- with |pass| naming it, the
+         IR after it, or NULL for the last three, and the number of
+         bytes of LibVEX's temporary storage then in use.  The IRSB
+         must not be modified or held on to.  This is for checking
+         the passes, as useful/irvalidate.c does, and for measuring
+         what they cost, as useful/irgen.c does.  May be NULL. */
+      void    (*ir_pass_done) ( /*callback_opaque*/void*,
+                                const HChar* pass, const IRSB*,
+                                SizeT temp_bytes_used );
+
       /* IN: a callback used to ask the caller which of the extents,
          if any, a self check is required for.  Must not be NULL.
          The returned value is a bitmask with a 1 in position i indicating
@@ -730,6 +825,16 @@ typedef
          translation? */
       Bool    addProfInc;
 
+      /* IN: optionally, a place to record the direct exits of the
+         translation, so that their targets can be patched later.  If
+         exit_sites is NULL, nothing is recorded; otherwise
+         exit_sites_used is set to the number of entries, which may
+         be zero if the host doesn't support this.  If there are more
+         than exit_sites_size, the rest are not recorded. */
+      VexExitSite* exit_sites;
+      Int          exit_sites_size;
+      Int*         exit_sites_used;
+
       /* IN: address of the dispatcher entry points.  Describes the
          places where generated code should jump to at the end of each
          bb.
@@ -791,12 +896,138 @@ VexTranslateResult LibVEX_Translate ( VexTranslateArgs* );
    FIXME: is this still up to date? */
 
 
+/*-------------------------------------------------------*/
+/*--- Inlinable helpers                               ---*/
+/*-------------------------------------------------------*/
+
+/* Give an IR body for the clean helper function at |addr|, taking
+   |n_args| arguments.  Calls to it (Iex_CCall, whether made by a
+   front end or by instrumentation) are then replaced by the body
+   before the optimiser gets to them, which avoids the cost of the
+   call and lets the body be folded and CSEd with the surrounding
+   code.  This is for tiny helpers: counters, shadow-bit combiners
+   and the like.
+
+   In |body|, IRExpr_Binder(i) stands for the i'th argument.  Apart
+   from those it may only contain constants, operators, ITEs and
+   calls to other clean helpers, which are not themselves inlined;
+   so it cannot read the guest state or memory.  Its type must be the
+   return type of the call.
+
+   No more than |max_per_block| calls to the helper are inlined in any
+   one block; the rest are left as calls.  The body is copied, so it
+   can be built in the usual way; registering a helper again replaces
+   its body.  Must be called after LibVEX_Init, and not from within a
+   callback from LibVEX_Translate.  Has no effect if iropt_level is
+   zero. */
+extern
+void LibVEX_RegisterInlineHelper ( void* addr, Int n_args,
+                                   const IRExpr* body, Int max_per_block );
+
+
+/*-------------------------------------------------------*/
+/*--- Compile client-built IR                         ---*/
+/*-------------------------------------------------------*/
+
+/* Arguments for LibVEX_CompileIR, which runs the back half of
+   LibVEX_Translate -- IR optimisation, tree building, instruction
+   selection, register allocation and assembly -- on an IRSB built by
+   the caller, rather than one made by a guest front end.  This makes
+   it possible to use VEX as a JIT back end for code that is not
+   machine code for any of the guest architectures, for example an
+   interpreter's bytecode.
+
+   The "guest state" is then a block defined by the caller and
+   described by |layout|.  The generated code is entered and left in
+   exactly the same way as a translation: the baseblock pointer
+   register points at the state block, which must be followed by the
+   two shadow areas and the spill area (see the note on guest state
+   layout above), and control returns to the dispatcher via the
+   disp_cp_* entry points.  The block must also provide the two event
+   check fields at offB_HOST_EvC_COUNTER and offB_HOST_EvC_FAILADDR,
+   and irsb->offsIP must be the offset of the field that holds the
+   next "guest" address.  Exits and the block end may be chained and
+   unchained with LibVEX_Chain and LibVEX_UnChain as usual.
+
+   Addresses in loads, stores and exits have the host word type.  The
+   block may use Ist_EvAppend; its cursor and limit fields then have
+   the host word type too. */
+typedef
+   struct {
+      /* IN: The instruction set we are compiling to, and misc info. */
+      VexArch      arch_host;
+      VexArchInfo  archinfo_host;
+      VexAbiInfo   abiinfo;
+
+      /* IN: The block to compile.  It must have been built with the
+         libvex_ir.h constructors since the last call to
+         LibVEX_Translate or LibVEX_CompileIR, as those release all
+         IR when they finish.  It need not be flat. */
+      IRSB*        irsb;
+
+      /* IN: The caller's state block. */
+      const VexGuestLayout* layout;
+      Int          offB_HOST_EvC_COUNTER;
+      Int          offB_HOST_EvC_FAILADDR;
+
+      /* IN: optionally, which parts of the state block must be up to
+         date at memory accesses, in the same way as a guest's
+         guest_<arch>_state_requires_precise_mem_exns.  If NULL, all
+         of it must be. */
+      Bool         (*preciseMemExnsFn) ( Int, Int, VexRegisterUpdates );
+
+      /* IN: optionally, a specialiser for calls to clean helpers, in
+         the same way as guest_<arch>_spechelper.  May be NULL. */
+      IRExpr*      (*specHelper) ( const HChar*, IRExpr**, IRStmt**, Int );
+
+      /* IN/OUT: as for LibVEX_Translate. */
+      UChar*       host_bytes;
+      Int          host_bytes_size;
+      Int*         host_bytes_used;
+
+      Int          traceflags;
+      Bool         addProfInc;
+
+      /* IN: debug: optionally, as for LibVEX_Translate, except that
+         the first call is for "client", the caller's IR once it has
+         been checked; the storage in use then is mostly that IR.
+         May be NULL. */
+      void         (*ir_pass_done) ( /*callback_opaque*/void*,
+                                     const HChar* pass, const IRSB*,
+                                     SizeT temp_bytes_used );
+      void*        callback_opaque;
+
+      VexExitSite* exit_sites;
+      Int          exit_sites_size;
+      Int*         exit_sites_used;
+
+      const void*  disp_cp_chain_me_to_slowEP;
+      const void*  disp_cp_chain_me_to_fastEP;
+      const void*  disp_cp_xindir;
+      const void*  disp_cp_xassisted;
+   }
+   VexCompileIRArgs;
+
+/* Returns VexTransOK or VexTransOutputFull.  n_sc_extents and
+   n_guest_instrs in the result are zero. */
+extern
+VexTranslateResult LibVEX_CompileIR ( VexCompileIRArgs* );
+
+
 /*-------------------------------------------------------*/
 /*--- Patch existing translations                     ---*/
 /*-------------------------------------------------------*/
 
 /* A host address range that was modified by the functions below. 
-   Callers must request I-cache syncing after the call as appropriate. */
+   Callers must request I-cache syncing after the call as appropriate.
+
+   All the places passed to these functions are executable addresses,
+   and the returned ranges are executable addresses too.  The code is
+   written at place + wr_delta, so a client whose code cache is
+   mapped twice -- once executable, once writable -- can patch it
+   without changing page permissions by passing the distance from the
+   executable mapping to the writable one.  Pass zero if the code is
+   writable where it runs. */
 typedef
    struct {
       HWord start;
@@ -812,6 +1043,7 @@ extern
 VexInvalRange LibVEX_Chain ( VexArch     arch_host,
                              VexEndness  endhess_host,
                              void*       place_to_chain,
+                             HWord       wr_delta,
                              const void* disp_cp_chain_me_EXPECTED,
                              const void* place_to_jump_to );
 
@@ -823,6 +1055,7 @@ extern
 VexInvalRange LibVEX_UnChain ( VexArch     arch_host,
                                VexEndness  endness_host,
                                void*       place_to_unchain,
+                               HWord       wr_delta,
                                const void* place_to_jump_to_EXPECTED,
                                const void* disp_cp_chain_me );
 
@@ -840,8 +1073,26 @@ extern
 VexInvalRange LibVEX_PatchProfInc ( VexArch      arch_host,
                                     VexEndness   endness_host,
                                     void*        place_to_patch,
+                                    HWord        wr_delta,
                                     const ULong* location_of_counter );
 
+/* Change the guest target of a direct exit, at host address
+   place_to_patch, as described by a VexExitSite.  The exit must not
+   currently be chained.  Returns False, changing nothing, if the exit
+   is not a VexExitBranch one, if the translation is self-checked, if
+   the new target can't be encoded in the space used by the old one,
+   or if it would need the other entry point (see
+   VexExitSite.to_fast_ep); the translation has to be discarded then.
+   Otherwise site->guest_target is updated. */
+extern
+Bool LibVEX_PatchExitTarget ( VexArch      arch_host,
+                              VexEndness   endness_host,
+                              void*        place_to_patch,
+                              HWord        wr_delta,
+                              /*MOD*/VexExitSite* site,
+                              Addr         new_target,
+                              /*OUT*/VexInvalRange* inval );
+
 
 /*-------------------------------------------------------*/
 /*--- Show accumulated statistics                     ---*/
@@ -52,6 +52,45 @@
 
 typedef
    struct {
+#if defined(VEX_GUEST_AMD64_HOT_LAYOUT)
+      /* Alternative ordering of the first 192 bytes, for clients
+         which allocate the guest state on a 64-byte boundary.  Most
+         blocks touch only RIP, the flags thunk and RSP, plus a few
+         GPRs, so those are packed into the first cache line, with
+         the remaining GPRs filling the next two.  The fields from
+         guest_ACFLAG onwards are at the same offsets as in the
+         default layout.  Nothing in VEX depends on which ordering
+         is in use -- everything goes via offsetof and the generated
+         pub/libvex_guest_offsets.h -- but VEX and its client must of
+         course be built with the same setting. */
+      /*   0 */ ULong  host_EvC_FAILADDR;
+      /*   8 */ UInt   host_EvC_COUNTER;
+      /*  12 */ UInt   pad0;
+      /*  16 */ ULong  guest_RIP;
+      /* 4-word thunk used to calculate O S Z A C P flags. */
+      /*  24 */ ULong  guest_CC_OP;
+      /*  32 */ ULong  guest_CC_DEP1;
+      /*  40 */ ULong  guest_CC_DEP2;
+      /*  48 */ ULong  guest_CC_NDEP;
+      /*  56 */ ULong  guest_RSP;
+      /*  64 */ ULong  guest_RAX;
+      /*  72 */ ULong  guest_RCX;
+      /*  80 */ ULong  guest_RDX;
+      /*  88 */ ULong  guest_RBX;
+      /*  96 */ ULong  guest_RBP;
+      /* 104 */ ULong  guest_RSI;
+      /* 112 */ ULong  guest_RDI;
+      /* 120 */ ULong  guest_R8;
+      /* 128 */ ULong  guest_R9;
+      /* 136 */ ULong  guest_R10;
+      /* 144 */ ULong  guest_R11;
+      /* 152 */ ULong  guest_R12;
+      /* 160 */ ULong  guest_R13;
+      /* 168 */ ULong  guest_R14;
+      /* 176 */ ULong  guest_R15;
+      /* The D flag is stored here, encoded as either -1 or +1 */
+      /* 184 */ ULong  guest_DFLAG;
+#else
       /* Event check fail addr, counter, and padding to make RAX 16
          aligned. */
       /*   0 */ ULong  host_EvC_FAILADDR;
@@ -81,10 +120,11 @@ typedef
       /* The D flag is stored here, encoded as either -1 or +1 */
       /* 176 */ ULong  guest_DFLAG;
       /* 184 */ ULong  guest_RIP;
+#endif
       /* Bit 18 (AC) of eflags stored here, as either 0 or 1. */
-      /* ... */ ULong  guest_ACFLAG;
+      /* 192 */ ULong  guest_ACFLAG;
       /* Bit 21 (ID) of eflags stored here, as either 0 or 1. */
-      /* 192 */ ULong guest_IDFLAG;
+      /* 200 */ ULong guest_IDFLAG;
       /* Probably a lot more stuff too. 
          D,ID flags
          16  128-bit SSE registers
@@ -95,14 +135,14 @@ typedef
          to hold a constant value (zero on linux main thread, 0x63 in other
          threads), and so guest_FS_CONST holds
          the 64-bit offset associated with this constant %fs value. */
-      /* 200 */ ULong guest_FS_CONST;
+      /* 208 */ ULong guest_FS_CONST;
 
       /* YMM registers.  Note that these must be allocated
          consecutively in order that the SSE4.2 PCMP{E,I}STR{I,M}
          helpers can treat them as an array.  YMM16 is a fake reg used
          as an intermediary in handling aforementioned insns. */
-      /* 208 */ULong guest_SSEROUND;
-      /* 216 */U256  guest_YMM0;
+      /* 216 */ULong guest_SSEROUND;
+      /* 224 */U256  guest_YMM0;
       U256  guest_YMM1;
       U256  guest_YMM2;
       U256  guest_YMM3;
@@ -2634,6 +2634,58 @@ extern IRLoadG* mkIRLoadG ( IREndness end, IRLoadGOp cvt,
                             IRExpr* guard );
 
 
+/* --------------- Event buffer appends --------------- */
+
+/* Append a fixed-size record to an in-memory event buffer.  This is
+   intended for tracing tools (memory-access tracers, branch loggers,
+   cache simulators and so on) which would otherwise have to make a
+   dirty helper call for every event they observe.
+
+   The buffer is described by two guest-word-sized fields in the
+   guest state: 'offCursor' is the offset of the address at which the
+   next record will be written, and 'offLimit' is the offset of the
+   address one past the end of the buffer.  Normally these live in a
+   part of the guest state (or its shadows) that the tool reserves for
+   itself.  'data' is a NULL-terminated vector of values which are
+   stored back to back, starting at the cursor, with endianness 'end'.
+   The cursor is then advanced by the total size of the record.
+
+   If the buffer does not have enough space, 'flush' is called first.
+   It is passed the baseblock pointer as its only argument, may read
+   both fields and must consume the buffer contents and move the
+   cursor back to the start of the buffer.
+
+   EvAppends may only be added by instrumentation functions (see
+   VexTranslateArgs.instrument1/2), or be in IR handed to
+   LibVEX_CompileIR.  LibVEX_Translate lowers them into plain IR
+   immediately after instrumentation, and LibVEX_CompileIR before it
+   optimises the block, so iropt and the back ends never see them.  The lowering checks for space only
+   once per superblock, at the start, for the total size of all the
+   records the superblock appends to that buffer; the appends
+   themselves become plain stores and a cursor update.  Consequently
+   the buffer must always be able to hold the records appended by
+   any one superblock, and nothing else in the block may write the
+   cursor field.
+*/
+typedef
+   struct {
+      IREndness end;       /* Endianness of the stored record */
+      Int       offCursor; /* Guest state offset of the write cursor */
+      Int       offLimit;  /* Guest state offset of the buffer limit */
+      IRCallee* flush;     /* Called, with the BBPTR, when full */
+      IRExpr**  data;      /* Values to append, NULL terminated */
+   }
+   IREvAppend;
+
+extern void ppIREvAppend ( const IREvAppend* ea );
+
+extern IREvAppend* mkIREvAppend ( IREndness end,
+                                  Int offCursor, Int offLimit,
+                                  IRCallee* flush, IRExpr** data );
+
+extern IREvAppend* deepCopyIREvAppend ( const IREvAppend* );
+
+
 /* ------------------ Statements ------------------ */
 
 /* The different kinds of statements.  Their meaning is explained
@@ -2661,7 +2713,8 @@ typedef
       Ist_LLSC,
       Ist_Dirty,
       Ist_MBE,
-      Ist_Exit
+      Ist_Exit,
+      Ist_EvAppend
    } 
    IRStmtTag;
 
@@ -2902,6 +2955,22 @@ typedef
             IRJumpKind jk;       /* Jump kind */
             Int        offsIP;   /* Guest state offset for IP */
          } Exit;
+
+         /* Append a record to an event buffer.  See the comments
+            above the IREvAppend type declaration.  Only allowed in
+            the output of instrumentation functions and in IR given
+            to LibVEX_CompileIR.
+
+            ppIRStmt output:
+               EvAppend<end>[<offCursor>,<offLimit>](<data>)
+                  ::: <flush>
+            eg.
+               EvAppendle[1272,1280](t3,0x4000AAA:I64)
+                  ::: flush_events{0x380035f4}
+         */
+         struct {
+            IREvAppend* details;
+         } EvAppend;
       } Ist;
    }
    IRStmt;
@@ -2925,6 +2994,7 @@ extern IRStmt* IRStmt_Dirty   ( IRDirty* details );
 extern IRStmt* IRStmt_MBE     ( IRMBusEvent event );
 extern IRStmt* IRStmt_Exit    ( IRExpr* guard, IRJumpKind jk, IRConst* dst,
                                 Int offsIP );
+extern IRStmt* IRStmt_EvAppend ( IREvAppend* details );
 
 /* Deep-copy an IRStmt. */
 extern IRStmt* deepCopyIRStmt ( const IRStmt* );
@@ -41,6 +41,7 @@ ARM64:
 #include "../pub/libvex.h"
 #include "../pub/libvex_trc_values.h"
 #include "linker.h"
+#include "../useful/vex_corpus.h"
 
 static ULong n_bbs_done = 0;
 static Int   n_translations_made = 0;
@@ -102,10 +103,31 @@ HWord sb_helper3 = 0;
 ULong trans_cache[N_TRANS_CACHE];
 VexGuestExtents trans_table [N_TRANS_TABLE];
 ULong*          trans_tableP[N_TRANS_TABLE];
+ULong*          trans_tableC[N_TRANS_TABLE];  /* exec counters, if recording */
 
 Int trans_cache_used = 0;
 Int trans_table_used = 0;
 
+/* Recording mode.  Each translation gets a profInc counter; when the
+   translation table is flushed, and at exit, the counts are folded
+   into rec_table, keyed by guest extent.  At exit rec_table is written
+   out as a corpus (see useful/vex_corpus.h) with the counts as block
+   weights. */
+#define N_REC_TABLE 100000
+
+typedef
+   struct {
+      Addr64 addr;
+      UShort len;
+      ULong  count;
+   }
+   RecEntry;
+
+static const HChar* record_file = NULL;
+static ULong    trans_counts[N_TRANS_TABLE];
+static RecEntry rec_table[N_REC_TABLE];
+static Int      rec_table_used = 0;
+
 static Bool chase_into_ok ( void* opaque, Addr64 dst ) {
    return False;
 }
@@ -115,6 +137,56 @@ static UInt needs_self_check ( void* opaque, const VexGuestExtents* vge ) {
 }
 
 
+static void fold_counts ( void )
+{
+   Int i, j;
+   for (i = 0; i < trans_table_used; i++) {
+      const VexGuestExtents* vge = &trans_table[i];
+      ULong count = *trans_tableC[i];
+      if (count == 0)
+         continue;
+      /* Chasing is disabled, so each block is a single extent. */
+      assert(vge->n_used == 1);
+      for (j = 0; j < rec_table_used; j++)
+         if (rec_table[j].addr == vge->base[0]
+             && rec_table[j].len == vge->len[0])
+            break;
+      if (j == rec_table_used) {
+         assert(rec_table_used < N_REC_TABLE);
+         rec_table[j].addr  = vge->base[0];
+         rec_table[j].len   = vge->len[0];
+         rec_table[j].count = 0;
+         rec_table_used++;
+      }
+      rec_table[j].count += count;
+   }
+}
+
+static void write_recording ( void )
+{
+   VexCorpusWriter w;
+   Int i;
+
+   if (!record_file)
+      return;
+   fold_counts();
+   trans_table_used = 0;
+   if (!vex_corpus_create(&w, record_file, VexArch, 0, VexEndnessLE))
+      return;
+   /* The guest code is part of this process, so its bytes can be
+      read directly. */
+   for (i = 0; i < rec_table_used; i++) {
+      ULong count = rec_table[i].count;
+      vex_corpus_add(&w, rec_table[i].addr,
+                     (const UChar*)(HWord)rec_table[i].addr,
+                     rec_table[i].len,
+                     count > 0xFFFFFFFFULL ? 0xFFFFFFFF : (UInt)count);
+   }
+   if (vex_corpus_finish(&w))
+      printf("%d blocks recorded in %s\n", rec_table_used, record_file);
+}
+
+
 /* For providing services. */
 static HWord serviceFn ( HWord arg1, HWord arg2 )
 {
@@ -125,6 +197,7 @@ static HWord serviceFn ( HWord arg1, HWord arg2 )
 	 printf("%llu bbs simulated\n", n_bbs_done);
 	 printf("%d translations made, %d tt bytes\n", 
                 n_translations_made, 8*trans_cache_used);
+         write_recording();
          exit(0);
       case 1: /* PUTC */
          putchar(arg2);
@@ -538,10 +611,13 @@ HWord find_translation ( Addr guest_addr )
    if (i > 2) {
       VexGuestExtents tmpE = trans_table[i-1];
       ULong*          tmpP = trans_tableP[i-1];
+      ULong*          tmpC = trans_tableC[i-1];
       trans_table[i-1]  = trans_table[i];
       trans_tableP[i-1] = trans_tableP[i];
+      trans_tableC[i-1] = trans_tableC[i];
       trans_table[i] = tmpE;
       trans_tableP[i] = tmpP;
+      trans_tableC[i] = tmpC;
       i--;
    }
 
@@ -567,6 +643,8 @@ void make_translation ( Addr guest_addr, Bool verbose )
        || trans_cache_used >= N_TRANS_CACHE-1000) {
       /* If things are looking to full, just dump
          all the translations. */
+      if (record_file)
+         fold_counts();
       trans_cache_used = 0;
       trans_table_used = 0;
    }
@@ -602,12 +680,12 @@ void make_translation ( Addr guest_addr, Bool verbose )
    vta.disp_cp_xindir             = NULL; //disp_chain_indir;
    vta.disp_cp_xassisted          = disp_chain_assisted;
 
-   vta.addProfInc       = False;
+   vta.addProfInc       = record_file != NULL;
 
    tres = LibVEX_Translate ( &vta );
 
    assert(tres.status == VexTransOK);
-   assert(tres.offs_profInc == -1);
+   assert(record_file ? tres.offs_profInc >= 0 : tres.offs_profInc == -1);
 
    ws_needed = (trans_used+7) / 8;
    assert(ws_needed > 0);
@@ -620,6 +698,20 @@ void make_translation ( Addr guest_addr, Bool verbose )
       *dst = *src;
    }
 
+   if (record_file) {
+      /* Counters stay with their translation-table slot, but the
+         table gets reordered by find_translation, so keep a pointer
+         alongside. */
+      ULong* counter = &trans_counts[trans_table_used];
+      *counter = 0;
+      LibVEX_PatchProfInc(VexArch, VexEndnessLE,
+                          ((HChar*)&trans_cache[trans_cache_used])
+                             + tres.offs_profInc,
+                          0/*code is writable in place*/,
+                          counter);
+      trans_tableC[trans_table_used] = counter;
+   }
+
 #if defined(__aarch64__)
    invalidate_icache( &trans_cache[trans_cache_used], trans_used );
 #endif
@@ -724,6 +816,7 @@ static void run_simulator ( void )
          }
 #endif
          printf("---  end SWITCHBACK at bb:%llu ---\n", n_bbs_done);
+         write_recording();
          switchback();
          assert(0); /*NOTREACHED*/
       }
@@ -741,15 +834,22 @@ static void run_simulator ( void )
 
 static void usage ( void )
 {
-   printf("usage: switchback #bbs\n");
+   printf("usage: switchback [--record=file.corpus] #bbs\n");
    printf("   - begins switchback for basic block #bbs\n");
-   printf("   - use -1 for largest possible run without switchback\n\n");
+   printf("   - use -1 for largest possible run without switchback\n");
+   printf("   - --record= writes every block run, weighted by its\n");
+   printf("     execution count, to a corpus for replay by useful/vex\n\n");
    exit(1);
 }
 
 
 int main ( Int argc, HChar** argv )
 {
+   if (argc == 3 && 0 == strncmp(argv[1], "--record=", 9)) {
+      record_file = argv[1] + 9;
+      argc--;
+      argv++;
+   }
    if (argc != 2)
       usage();
 
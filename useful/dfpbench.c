@@ -0,0 +1,249 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                        dfpbench.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Measures what a DFP op costs on hosts that do DFP in software:
+   the time per result of h_generic_calc_DFP, which is what each DFP
+   primop turns into after do_DFP_lowering_BB.  A D128 result takes
+   two calls, one per half, and is timed as such.
+
+      --iters=N      results computed per op (default 200000)
+      --digits=N     significant digits in the operands, at most 16
+                     (default 16)
+      --seed=N       random seed
+
+   The operands have exponents close together, so additions are not
+   dominated by the cheap case of one operand swamping the other.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libvex_basictypes.h"
+#include "libvex_ir.h"
+#include "libvex.h"
+
+#include "host_generic_dfp.h"
+
+#define N_OPERANDS 1024
+
+static Int  opt_iters  = 200000;
+static Int  opt_digits = 16;
+static UInt opt_seed   = 1;
+
+/* Operands: D64 bit patterns, and D128s as (hi,lo) pairs. */
+static ULong d64[N_OPERANDS];
+static ULong d128hi[N_OPERANDS], d128lo[N_OPERANDS];
+static ULong ints[N_OPERANDS];
+
+static volatile ULong sink;
+
+__attribute__ ((noreturn))
+static void usage ( void )
+{
+   fprintf(stderr, "usage: dfpbench [--iters=N] [--digits=N] [--seed=N]\n");
+   exit(1);
+}
+
+static Bool int_opt ( const HChar* arg, const HChar* name, Int* val )
+{
+   SizeT len = strlen(name);
+   if (0 != strncmp(arg, name, len) || arg[len] != '=')
+      return False;
+   *val = atoi(arg + len + 1);
+   return True;
+}
+
+/* A small LCG, so that a seed always gives the same operands. */
+static ULong rng_state;
+
+static UInt rng ( void )
+{
+   rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+   return (UInt)(rng_state >> 33);
+}
+
+static ULong calc ( IROp op, Bool hiHalf, ULong aHi, ULong aLo,
+                    ULong bHi, ULong bLo )
+{
+   return h_generic_calc_DFP(((ULong)op << 1) | (hiHalf ? 1 : 0),
+                             Irrm_NEAREST, aHi, aLo, bHi, bLo);
+}
+
+/* A random integer of exactly |digits| digits, possibly negative. */
+static ULong random_int ( Int digits )
+{
+   ULong v = 1 + rng() % 9;
+   Int   i;
+   for (i = 1; i < digits; i++)
+      v = v * 10 + rng() % 10;
+   return (rng() & 1) ? -v : v;
+}
+
+static void make_operands ( void )
+{
+   Int i;
+   rng_state = opt_seed;
+   for (i = 0; i < N_OPERANDS; i++) {
+      /* Biased exponents a little below 1.0's, 398. */
+      ULong be = 398 - 8 + rng() % 8;
+      ULong x  = calc(Iop_I64StoD64, False, 0, 0, 0, random_int(opt_digits));
+      ULong hi, lo, mHi, mLo;
+      d64[i]  = calc(Iop_InsertExpD64, False, 0, x, 0, be);
+      ints[i] = random_int(opt_digits);
+      /* Widen, then fill out the coefficient to 32 or so digits. */
+      hi  = calc(Iop_D64toD128, True,  0, d64[i], 0, 0);
+      lo  = calc(Iop_D64toD128, False, 0, d64[i], 0, 0);
+      mHi = calc(Iop_I64StoD128, True,  0, 0, 0, ints[i]);
+      mLo = calc(Iop_I64StoD128, False, 0, 0, 0, ints[i]);
+      d128hi[i] = calc(Iop_MulD128, True,  hi, lo, mHi, mLo);
+      d128lo[i] = calc(Iop_MulD128, False, hi, lo, mHi, mLo);
+   }
+}
+
+static ULong now_ns ( void )
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (ULong)ts.tv_sec * 1000000000ULL + (ULong)ts.tv_nsec;
+}
+
+typedef
+   enum { K_D64_D64, K_D64, K_INT, K_D128_D128, K_D128, K_BCD }
+   OpKind;
+
+typedef
+   struct {
+      const HChar* name;
+      IROp         op;
+      OpKind       kind;
+   }
+   BenchOp;
+
+static const BenchOp bench_ops[] = {
+   { "AddD64",       Iop_AddD64,       K_D64_D64   },
+   { "SubD64",       Iop_SubD64,       K_D64_D64   },
+   { "MulD64",       Iop_MulD64,       K_D64_D64   },
+   { "DivD64",       Iop_DivD64,       K_D64_D64   },
+   { "QuantizeD64",  Iop_QuantizeD64,  K_D64_D64   },
+   { "CmpD64",       Iop_CmpD64,       K_D64_D64   },
+   { "RoundD64toInt", Iop_RoundD64toInt, K_D64     },
+   { "D64toI64S",    Iop_D64toI64S,    K_D64       },
+   { "D64toD32",     Iop_D64toD32,     K_D64       },
+   { "I64StoD64",    Iop_I64StoD64,    K_INT       },
+   { "AddD128",      Iop_AddD128,      K_D128_D128 },
+   { "MulD128",      Iop_MulD128,      K_D128_D128 },
+   { "DivD128",      Iop_DivD128,      K_D128_D128 },
+   { "CmpD128",      Iop_CmpD128,      K_D128_D128 },
+   { "D128toD64",    Iop_D128toD64,    K_D128      },
+   { "DPBtoBCD",     Iop_DPBtoBCD,     K_BCD       },
+};
+
+/* Nanoseconds per result of |b|. */
+static double time_op ( const BenchOp* b )
+{
+   ULong t0, acc = 0;
+   Int   i, j, k;
+
+   t0 = now_ns();
+   for (i = 0; i < opt_iters; i++) {
+      j = i & (N_OPERANDS - 1);
+      k = (i * 7 + 1) & (N_OPERANDS - 1);
+      switch (b->kind) {
+         case K_D64_D64:
+            acc += calc(b->op, False, 0, d64[j], 0, d64[k]);
+            break;
+         case K_D64:
+            acc += calc(b->op, False, 0, d64[j], 0, 0);
+            break;
+         case K_INT:
+            acc += calc(b->op, False, 0, 0, 0, ints[j]);
+            break;
+         case K_D128_D128:
+            acc += calc(b->op, True,  d128hi[j], d128lo[j],
+                                      d128hi[k], d128lo[k]);
+            if (b->op != Iop_CmpD128)
+               acc += calc(b->op, False, d128hi[j], d128lo[j],
+                                         d128hi[k], d128lo[k]);
+            break;
+         case K_D128:
+            acc += calc(b->op, False, d128hi[j], d128lo[j], 0, 0);
+            break;
+         case K_BCD:
+            acc += calc(b->op, False, 0, d64[j] & 0x3FFFFFFFFFFFFULL, 0, 0);
+            break;
+      }
+   }
+   sink = acc;
+   return (double)(now_ns() - t0) / opt_iters;
+}
+
+__attribute__ ((noreturn))
+static void failure_exit ( void )
+{
+   fprintf(stderr, "dfpbench: LibVEX failed\n");
+   exit(1);
+}
+
+static void log_bytes ( const HChar* bytes, SizeT nbytes )
+{
+   fwrite(bytes, 1, nbytes, stdout);
+}
+
+int main ( int argc, char** argv )
+{
+   VexControl vcon;
+   UInt       i;
+
+   for (i = 1; i < (UInt)argc; i++) {
+      Int v;
+      if (int_opt(argv[i], "--iters", &opt_iters)) continue;
+      if (int_opt(argv[i], "--digits", &opt_digits)) continue;
+      if (int_opt(argv[i], "--seed", &v)) { opt_seed = v; continue; }
+      usage();
+   }
+   if (opt_iters < 1 || opt_digits < 1 || opt_digits > 16)
+      usage();
+
+   LibVEX_default_VexControl(&vcon);
+   LibVEX_Init(failure_exit, log_bytes, 0, &vcon);
+   make_operands();
+
+   printf("%d results per op, %d-digit operands\n", opt_iters, opt_digits);
+   printf("%-14s %10s\n", "op", "ns/result");
+   for (i = 0; i < sizeof(bench_ops) / sizeof(bench_ops[0]); i++)
+      printf("%-14s %10.1f\n", bench_ops[i].name, time_op(&bench_ops[i]));
+   return 0;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                          dfpbench.c ---*/
+/*---------------------------------------------------------------*/
@@ -0,0 +1,658 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                           irgen.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Builds synthetic flat IR blocks and compiles them with
+   LibVEX_CompileIR, reporting the time and temporary storage used by
+   each IR pass and back end stage.  The guest corpora have few of the
+   blocks that make iropt and the register allocator slow -- very
+   long ones, ones with many values live at once, ones full of helper
+   calls or GetI/PutI, heavily instrumented ones -- so this makes
+   them to order:
+
+      --stmts=N      statements per block (default 1000)
+      --live=N       operands are picked from the last N values of
+                     their type, so about N values are live at once
+                     (default 8)
+      --insn=N       statements per IMark (default 4)
+      --helpers=P    percent of statements that call a clean helper
+      --dirty=P      percent of statements that call a dirty helper
+      --mem=P        percent of statements that load or store
+      --vec=P        percent of statements that do V128 arithmetic
+      --fp=P         percent of statements that do F64 arithmetic
+      --geti=P       percent of statements that do a GetI or PutI;
+                     amd64 only, on an 8-entry array as for x87
+      --exits=P      percent of statements that are side exits
+      --instrument   put a dirty call before every load and store
+      --host=ARCH    amd64 (default) or arm64
+      --iropt=N      iropt level (default 2)
+      --blocks=N     how many blocks (default 100)
+      --seed=N       random seed
+      --show         print the first block
+
+   Statements not accounted for by the percentages are integer
+   arithmetic, Gets and Puts.  The blocks are only compiled, never
+   run.  Very large blocks can exhaust LibVEX's temporary storage;
+   N_TEMPORARY_BYTES in priv/main_util.c sets its size.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "libvex_basictypes.h"
+#include "libvex.h"
+
+/* The layout of the made-up guest state. */
+#define OFFB_EVC_FAILADDR  0
+#define OFFB_EVC_COUNTER   8
+#define OFFB_IP            16
+#define OFFB_IREGS         32    /* 16 x I64 */
+#define N_IREGS            16
+#define OFFB_VREGS         160   /* 16 x V128 */
+#define N_VREGS            16
+#define OFFB_FREGS         416   /* 8 x F64 */
+#define N_FREGS            8
+#define OFFB_ARRAY         480   /* 8 x I64, for GetI/PutI */
+#define N_ARRAY            8
+#define STATE_SZB          544
+
+#define N_HOST_BYTES       (4 * 1024 * 1024)
+static UChar host_bytes[N_HOST_BYTES];
+
+
+/*---------------------------------------------------------------*/
+/*--- Options                                                 ---*/
+/*---------------------------------------------------------------*/
+
+static Int   opt_stmts      = 1000;
+static Int   opt_live       = 8;
+static Int   opt_insn       = 4;
+static Int   opt_helpers    = 0;
+static Int   opt_dirty      = 0;
+static Int   opt_mem        = 0;
+static Int   opt_vec        = 0;
+static Int   opt_fp         = 0;
+static Int   opt_geti       = 0;
+static Int   opt_exits      = 0;
+static Bool  opt_instrument = False;
+static Int   opt_iropt      = 2;
+static Int   opt_blocks     = 100;
+static UInt  opt_seed       = 1;
+static Bool  opt_show       = False;
+static VexArch opt_host     = VexArchAMD64;
+
+__attribute__ ((noreturn))
+static void usage ( void )
+{
+   fprintf(stderr,
+           "usage: irgen [--stmts=N] [--live=N] [--insn=N] [--helpers=P]\n"
+           "             [--dirty=P] [--mem=P] [--vec=P] [--fp=P]\n"
+           "             [--geti=P] [--exits=P] [--instrument]\n"
+           "             [--host=amd64|arm64] [--iropt=N] [--blocks=N]\n"
+           "             [--seed=N] [--show]\n");
+   exit(1);
+}
+
+static Bool int_opt ( const HChar* arg, const HChar* name, Int* val )
+{
+   SizeT len = strlen(name);
+   if (0 != strncmp(arg, name, len) || arg[len] != '=')
+      return False;
+   *val = atoi(arg + len + 1);
+   return True;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Generating blocks                                       ---*/
+/*---------------------------------------------------------------*/
+
+/* A small LCG, so that a seed always gives the same blocks. */
+static ULong rng_state;
+
+static UInt rnd ( UInt n )
+{
+   rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+   return n == 0 ? 0 : (UInt)(rng_state >> 33) % n;
+}
+
+/* The most recent values of each type, operands being picked from
+   the last opt_live of them. */
+#define N_POOL 1024
+
+typedef
+   struct {
+      IRType ty;
+      IRTemp tmps[N_POOL];
+      Int    n;
+   }
+   Pool;
+
+static Pool pool_I64, pool_I1, pool_F64, pool_V128;
+
+static IRSB* sb;
+static Int   n_in_insn;
+static Addr  insn_addr;
+
+static void pool_reset ( Pool* p, IRType ty )
+{
+   p->ty = ty;
+   p->n  = 0;
+}
+
+static void pool_add ( Pool* p, IRTemp t )
+{
+   if (p->n == N_POOL) {
+      memmove(&p->tmps[0], &p->tmps[N_POOL/2],
+              (N_POOL/2) * sizeof(IRTemp));
+      p->n = N_POOL/2;
+   }
+   p->tmps[p->n++] = t;
+}
+
+static void stmt ( IRStmt* st )
+{
+   if (n_in_insn == 0) {
+      addStmtToIRSB(sb, IRStmt_IMark(insn_addr, 4, 0));
+      insn_addr += 4;
+   }
+   if (++n_in_insn == opt_insn)
+      n_in_insn = 0;
+   addStmtToIRSB(sb, st);
+}
+
+static IRTemp assign ( Pool* p, IRExpr* e )
+{
+   IRTemp t = newIRTemp(sb->tyenv, typeOfIRExpr(sb->tyenv, e));
+   stmt(IRStmt_WrTmp(t, e));
+   if (p)
+      pool_add(p, t);
+   return t;
+}
+
+static IRExpr* mkU64 ( ULong n ) { return IRExpr_Const(IRConst_U64(n)); }
+static IRExpr* mkU32 ( UInt n )  { return IRExpr_Const(IRConst_U32(n)); }
+static IRExpr* mkU8  ( UInt n )  { return IRExpr_Const(IRConst_U8(n)); }
+
+static IRExpr* pick ( Pool* p );
+
+/* Make a new value of p's type out of nothing much. */
+static IRTemp fresh ( Pool* p )
+{
+   switch (p->ty) {
+      case Ity_I64:
+         return assign(p, IRExpr_Get(OFFB_IREGS + 8 * rnd(N_IREGS),
+                                     Ity_I64));
+      case Ity_F64:
+         return assign(p, IRExpr_Get(OFFB_FREGS + 8 * rnd(N_FREGS),
+                                     Ity_F64));
+      case Ity_V128:
+         return assign(p, IRExpr_Get(OFFB_VREGS + 16 * rnd(N_VREGS),
+                                     Ity_V128));
+      case Ity_I1:
+         return assign(p, IRExpr_Binop(rnd(2) ? Iop_CmpEQ64 : Iop_CmpLT64U,
+                                       pick(&pool_I64), pick(&pool_I64)));
+      default:
+         assert(0);
+   }
+}
+
+/* An operand of p's type, from among the last opt_live values. */
+static IRExpr* pick ( Pool* p )
+{
+   Int window = p->n < opt_live ? p->n : opt_live;
+   if (window == 0 || rnd(4 * opt_live) == 0)
+      return IRExpr_RdTmp(fresh(p));
+   return IRExpr_RdTmp(p->tmps[p->n - 1 - rnd(window)]);
+}
+
+static ULong helper_I64_2 ( ULong a, ULong b ) { return a * 31 + b; }
+static ULong helper_I64_4 ( ULong a, ULong b, ULong c, ULong d )
+{
+   return a ^ b ^ c ^ d;
+}
+static void  dirty_0 ( ULong a ) { (void)a; }
+static ULong dirty_1 ( ULong a, ULong b ) { return a + b; }
+
+static void gen_int ( void )
+{
+   static const IROp ops[]
+      = { Iop_Add64, Iop_Sub64, Iop_And64, Iop_Or64, Iop_Xor64,
+          Iop_Mul64 };
+   switch (rnd(8)) {
+      case 0:
+         fresh(&pool_I64);
+         break;
+      case 1:
+         stmt(IRStmt_Put(OFFB_IREGS + 8 * rnd(N_IREGS), pick(&pool_I64)));
+         break;
+      case 2:
+         assign(&pool_I64, IRExpr_Binop(rnd(2) ? Iop_Shl64 : Iop_Shr64,
+                                        pick(&pool_I64), mkU8(1 + rnd(63))));
+         break;
+      case 3:
+         assign(&pool_I64, IRExpr_ITE(pick(&pool_I1), pick(&pool_I64),
+                                      pick(&pool_I64)));
+         break;
+      case 4:
+         assign(&pool_I64,
+                IRExpr_Unop(Iop_32Uto64,
+                            IRExpr_RdTmp(
+                               assign(NULL, IRExpr_Unop(Iop_64to32,
+                                                        pick(&pool_I64))))));
+         break;
+      default:
+         assign(&pool_I64, IRExpr_Binop(ops[rnd(sizeof(ops)/sizeof(ops[0]))],
+                                        pick(&pool_I64), pick(&pool_I64)));
+         break;
+   }
+}
+
+static void gen_helper ( void )
+{
+   IRExpr* e;
+   if (rnd(2))
+      e = mkIRExprCCall(Ity_I64, 0, "helper_I64_2", helper_I64_2,
+                        mkIRExprVec_2(pick(&pool_I64), pick(&pool_I64)));
+   else
+      e = mkIRExprCCall(Ity_I64, 0, "helper_I64_4", helper_I64_4,
+                        mkIRExprVec_4(pick(&pool_I64), pick(&pool_I64),
+                                      pick(&pool_I64), pick(&pool_I64)));
+   assign(&pool_I64, e);
+}
+
+static void gen_dirty ( IRExpr* arg )
+{
+   IRDirty* d;
+   if (arg || rnd(2)) {
+      d = unsafeIRDirty_0_N(0, "dirty_0", dirty_0,
+                            mkIRExprVec_1(arg ? arg : pick(&pool_I64)));
+   } else {
+      IRTemp t = newIRTemp(sb->tyenv, Ity_I64);
+      d = unsafeIRDirty_1_N(t, 0, "dirty_1", dirty_1,
+                            mkIRExprVec_2(pick(&pool_I64), pick(&pool_I64)));
+      stmt(IRStmt_Dirty(d));
+      pool_add(&pool_I64, t);
+      return;
+   }
+   stmt(IRStmt_Dirty(d));
+}
+
+static void gen_mem ( void )
+{
+   static const IRType tys[] = { Ity_I8, Ity_I16, Ity_I32, Ity_I64 };
+   IRType  ty   = tys[rnd(4)];
+   IRTemp  addr = assign(NULL, IRExpr_Binop(Iop_Add64, pick(&pool_I64),
+                                            mkU64(8 * rnd(64))));
+   if (opt_instrument)
+      gen_dirty(IRExpr_RdTmp(addr));
+   if (rnd(2)) {
+      IRTemp v = assign(NULL, IRExpr_Load(Iend_LE, ty, IRExpr_RdTmp(addr)));
+      switch (ty) {
+         case Ity_I8:
+            assign(&pool_I64, IRExpr_Unop(Iop_8Uto64, IRExpr_RdTmp(v)));
+            break;
+         case Ity_I16:
+            assign(&pool_I64, IRExpr_Unop(Iop_16Uto64, IRExpr_RdTmp(v)));
+            break;
+         case Ity_I32:
+            assign(&pool_I64, IRExpr_Unop(Iop_32Sto64, IRExpr_RdTmp(v)));
+            break;
+         default:
+            pool_add(&pool_I64, v);
+            break;
+      }
+   } else {
+      IRExpr* data = pick(&pool_I64);
+      switch (ty) {
+         case Ity_I8:
+            data = IRExpr_RdTmp(assign(NULL, IRExpr_Unop(Iop_64to8, data)));
+            break;
+         case Ity_I16:
+            data = IRExpr_RdTmp(assign(NULL, IRExpr_Unop(Iop_64to16, data)));
+            break;
+         case Ity_I32:
+            data = IRExpr_RdTmp(assign(NULL, IRExpr_Unop(Iop_64to32, data)));
+            break;
+         default:
+            break;
+      }
+      stmt(IRStmt_Store(Iend_LE, IRExpr_RdTmp(addr), data));
+   }
+}
+
+static void gen_vec ( void )
+{
+   static const IROp ops[]
+      = { Iop_Add32x4, Iop_Sub64x2, Iop_AndV128, Iop_OrV128, Iop_XorV128,
+          Iop_Add8x16, Iop_Sub16x8, Iop_CmpEQ32x4 };
+   switch (rnd(6)) {
+      case 0:
+         stmt(IRStmt_Put(OFFB_VREGS + 16 * rnd(N_VREGS), pick(&pool_V128)));
+         break;
+      case 1:
+         assign(&pool_V128, IRExpr_Binop(Iop_64HLtoV128, pick(&pool_I64),
+                                         pick(&pool_I64)));
+         break;
+      case 2:
+         assign(&pool_I64, IRExpr_Unop(rnd(2) ? Iop_V128to64
+                                              : Iop_V128HIto64,
+                                       pick(&pool_V128)));
+         break;
+      default:
+         assign(&pool_V128, IRExpr_Binop(ops[rnd(sizeof(ops)/sizeof(ops[0]))],
+                                         pick(&pool_V128), pick(&pool_V128)));
+         break;
+   }
+}
+
+static void gen_fp ( void )
+{
+   static const IROp ops[]
+      = { Iop_AddF64, Iop_SubF64, Iop_MulF64, Iop_DivF64 };
+   switch (rnd(5)) {
+      case 0:
+         stmt(IRStmt_Put(OFFB_FREGS + 8 * rnd(N_FREGS), pick(&pool_F64)));
+         break;
+      case 1:
+         assign(&pool_F64, IRExpr_Binop(Iop_I64StoF64, mkU32(Irrm_NEAREST),
+                                        pick(&pool_I64)));
+         break;
+      case 2:
+         assign(&pool_I64, IRExpr_Unop(Iop_ReinterpF64asI64,
+                                       pick(&pool_F64)));
+         break;
+      default:
+         assign(&pool_F64, IRExpr_Triop(ops[rnd(4)], mkU32(Irrm_NEAREST),
+                                        pick(&pool_F64), pick(&pool_F64)));
+         break;
+   }
+}
+
+static void gen_geti ( void )
+{
+   IRRegArray* descr = mkIRRegArray(OFFB_ARRAY, Ity_I64, N_ARRAY);
+   IRTemp      ix    = assign(NULL, IRExpr_Unop(Iop_64to32, pick(&pool_I64)));
+   if (rnd(2))
+      assign(&pool_I64, IRExpr_GetI(descr, IRExpr_RdTmp(ix), rnd(N_ARRAY)));
+   else
+      stmt(IRStmt_PutI(mkIRPutI(descr, IRExpr_RdTmp(ix), rnd(N_ARRAY),
+                                pick(&pool_I64))));
+}
+
+static void gen_exit ( void )
+{
+   stmt(IRStmt_Exit(pick(&pool_I1), Ijk_Boring,
+                    IRConst_U64(0x100000 + 4 * rnd(4096)), OFFB_IP));
+}
+
+static IRSB* gen_block ( void )
+{
+   Int i;
+
+   sb        = emptyIRSB();
+   n_in_insn = 0;
+   insn_addr = 0x400000;
+   pool_reset(&pool_I64,  Ity_I64);
+   pool_reset(&pool_I1,   Ity_I1);
+   pool_reset(&pool_F64,  Ity_F64);
+   pool_reset(&pool_V128, Ity_V128);
+
+   for (i = 0; i < opt_stmts; i++) {
+      Int r = rnd(100);
+      if ((r -= opt_helpers) < 0)
+         gen_helper();
+      else if ((r -= opt_dirty) < 0)
+         gen_dirty(NULL);
+      else if ((r -= opt_mem) < 0)
+         gen_mem();
+      else if ((r -= opt_vec) < 0)
+         gen_vec();
+      else if ((r -= opt_fp) < 0)
+         gen_fp();
+      else if ((r -= opt_geti) < 0)
+         gen_geti();
+      else if ((r -= opt_exits) < 0)
+         gen_exit();
+      else
+         gen_int();
+   }
+
+   sb->next     = mkU64(insn_addr);
+   sb->jumpkind = Ijk_Boring;
+   sb->offsIP   = OFFB_IP;
+   return sb;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Compiling blocks and measuring the stages               ---*/
+/*---------------------------------------------------------------*/
+
+#define N_STAGES 40
+
+typedef
+   struct {
+      const HChar* name;
+      ULong        ns_tot, ns_max;
+      ULong        bytes_tot, bytes_max;
+   }
+   Stage;
+
+static Stage  stages[N_STAGES];
+static Int    n_stages;
+static ULong  last_ns;
+static SizeT  last_bytes;
+
+static ULong now_ns ( void )
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (ULong)ts.tv_sec * 1000000000ULL + (ULong)ts.tv_nsec;
+}
+
+static Stage* find_stage ( const HChar* name )
+{
+   Int i;
+   for (i = 0; i < n_stages; i++)
+      if (0 == strcmp(stages[i].name, name))
+         return &stages[i];
+   assert(n_stages < N_STAGES);
+   stages[n_stages].name = name;
+   return &stages[n_stages++];
+}
+
+static void note_stage ( Stage* s, ULong ns, ULong bytes )
+{
+   s->ns_tot    += ns;
+   s->bytes_tot += bytes;
+   if (ns > s->ns_max)
+      s->ns_max = ns;
+   if (bytes > s->bytes_max)
+      s->bytes_max = bytes;
+}
+
+/* Called by LibVEX_CompileIR as each pass or back end stage
+   finishes.  Storage is only released at the end, so a stage's use is
+   the growth since the previous one.  The averages add up passes that
+   run more than once per block, such as cprop. */
+static void stage_done ( void* opaque, const HChar* stage,
+                         const IRSB* bb, SizeT temp_bytes_used )
+{
+   ULong t = now_ns();
+   (void)opaque;
+   (void)bb;
+   note_stage(find_stage(stage), t - last_ns,
+              temp_bytes_used - last_bytes);
+   last_ns    = t;
+   last_bytes = temp_bytes_used;
+}
+
+/* Only the IP need be up to date at memory accesses. */
+static Bool precise_ip_only ( Int minoff, Int maxoff,
+                              VexRegisterUpdates pxControl )
+{
+   if (pxControl == VexRegUpdAllregsAtMemAccess
+       || pxControl == VexRegUpdAllregsAtEachInsn)
+      return True;
+   return maxoff >= OFFB_IP && minoff < OFFB_IP + 8;
+}
+
+__attribute__ ((noreturn))
+static void failure_exit ( void )
+{
+   fprintf(stderr, "irgen: LibVEX failed\n");
+   exit(1);
+}
+
+static void log_bytes ( const HChar* bytes, SizeT nbytes )
+{
+   fwrite(bytes, 1, nbytes, stdout);
+}
+
+/* Never called: the blocks are not run. */
+static void dispatcher ( void ) { }
+
+
+int main ( int argc, char** argv )
+{
+   VexControl         vcon;
+   VexGuestLayout     layout;
+   VexCompileIRArgs   ca;
+   VexTranslateResult res;
+   Int                i, used;
+   ULong              code_tot = 0, gen_ns = 0, t0;
+   Int                v;
+
+   for (i = 1; i < argc; i++) {
+      const HChar* a = argv[i];
+      if (int_opt(a, "--stmts", &opt_stmts)) continue;
+      if (int_opt(a, "--live", &opt_live)) continue;
+      if (int_opt(a, "--insn", &opt_insn)) continue;
+      if (int_opt(a, "--helpers", &opt_helpers)) continue;
+      if (int_opt(a, "--dirty", &opt_dirty)) continue;
+      if (int_opt(a, "--mem", &opt_mem)) continue;
+      if (int_opt(a, "--vec", &opt_vec)) continue;
+      if (int_opt(a, "--fp", &opt_fp)) continue;
+      if (int_opt(a, "--geti", &opt_geti)) continue;
+      if (int_opt(a, "--exits", &opt_exits)) continue;
+      if (int_opt(a, "--iropt", &opt_iropt)) continue;
+      if (int_opt(a, "--blocks", &opt_blocks)) continue;
+      if (int_opt(a, "--seed", &v)) { opt_seed = (UInt)v; continue; }
+      if (0 == strcmp(a, "--instrument")) { opt_instrument = True; continue; }
+      if (0 == strcmp(a, "--show")) { opt_show = True; continue; }
+      if (0 == strcmp(a, "--host=amd64")) { opt_host = VexArchAMD64; continue; }
+      if (0 == strcmp(a, "--host=arm64")) { opt_host = VexArchARM64; continue; }
+      usage();
+   }
+   if (opt_stmts < 1 || opt_live < 1 || opt_insn < 1 || opt_blocks < 1
+       || opt_helpers + opt_dirty + opt_mem + opt_vec + opt_fp
+          + opt_geti + opt_exits > 100)
+      usage();
+   if (opt_geti > 0 && opt_host != VexArchAMD64) {
+      fprintf(stderr, "irgen: --geti needs --host=amd64\n");
+      exit(1);
+   }
+   rng_state = opt_seed;
+
+   LibVEX_default_VexControl(&vcon);
+   vcon.iropt_level = opt_iropt;
+   LibVEX_Init(failure_exit, log_bytes, 0, &vcon);
+
+   memset(&layout, 0, sizeof(layout));
+   layout.total_sizeB = STATE_SZB;
+   layout.offset_SP   = OFFB_IREGS;
+   layout.sizeof_SP   = 8;
+   layout.offset_FP   = OFFB_IREGS + 8;
+   layout.sizeof_FP   = 8;
+   layout.offset_IP   = OFFB_IP;
+   layout.sizeof_IP   = 8;
+
+   memset(&ca, 0, sizeof(ca));
+   ca.arch_host = opt_host;
+   LibVEX_default_VexArchInfo(&ca.archinfo_host);
+   ca.archinfo_host.endness = VexEndnessLE;
+   if (opt_host == VexArchARM64)
+      ca.archinfo_host.arm64_dMinLine_lg2_szB
+         = ca.archinfo_host.arm64_iMinLine_lg2_szB = 6;
+   LibVEX_default_VexAbiInfo(&ca.abiinfo);
+   ca.layout                     = &layout;
+   ca.offB_HOST_EvC_COUNTER      = OFFB_EVC_COUNTER;
+   ca.offB_HOST_EvC_FAILADDR     = OFFB_EVC_FAILADDR;
+   ca.preciseMemExnsFn           = precise_ip_only;
+   ca.host_bytes                 = host_bytes;
+   ca.host_bytes_size            = N_HOST_BYTES;
+   ca.host_bytes_used            = &used;
+   ca.ir_pass_done               = stage_done;
+   ca.disp_cp_chain_me_to_slowEP = (void*)dispatcher;
+   ca.disp_cp_chain_me_to_fastEP = (void*)dispatcher;
+   ca.disp_cp_xindir             = (void*)dispatcher;
+   ca.disp_cp_xassisted          = (void*)dispatcher;
+
+   for (i = 0; i < opt_blocks; i++) {
+      t0     = now_ns();
+      ca.irsb = gen_block();
+      if (opt_show && i == 0)
+         ppIRSB(ca.irsb);
+      last_ns    = now_ns();
+      last_bytes = 0;
+      gen_ns    += last_ns - t0;
+      ca.traceflags = 0;
+      res = LibVEX_CompileIR(&ca);
+      if (res.status != VexTransOK) {
+         fprintf(stderr, "irgen: block %d: code buffer too small\n", i);
+         exit(1);
+      }
+      code_tot += used;
+   }
+
+   printf("%d blocks of %d stmts, live=%d, %s host, iropt level %d\n",
+          opt_blocks, opt_stmts, opt_live,
+          opt_host == VexArchAMD64 ? "amd64" : "arm64", opt_iropt);
+   printf("%-16s %12s %12s %12s %12s\n",
+          "stage", "avg usec", "max usec", "avg KB", "max KB");
+   printf("%-16s %12.1f\n", "generate", (double)gen_ns / opt_blocks / 1000.0);
+   for (i = 0; i < n_stages; i++)
+      printf("%-16s %12.1f %12.1f %12.1f %12.1f\n",
+             stages[i].name,
+             (double)stages[i].ns_tot / opt_blocks / 1000.0,
+             (double)stages[i].ns_max / 1000.0,
+             (double)stages[i].bytes_tot / opt_blocks / 1024.0,
+             (double)stages[i].bytes_max / 1024.0);
+   printf("%-16s %12.1f bytes of code per block\n", "output",
+          (double)code_tot / opt_blocks);
+   return 0;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                             irgen.c ---*/
+/*---------------------------------------------------------------*/
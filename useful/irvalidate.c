@@ -0,0 +1,1605 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                      irvalidate.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Randomised translation validation of the IR optimiser.  Each guest
+   block is translated at several optimisation settings, and the IR
+   after every pass (as reported through VexTranslateArgs.ir_pass_done)
+   is run by a small IR interpreter over a number of random guest
+   states and memories.  The outcome of each run -- the final guest
+   state, the bytes of memory written and the jump kind -- must match
+   that of the front end's IR for the same state.  The first pass
+   whose IR does not is reported.
+
+      irvalidate [options] file.orig|file.corpus
+      irvalidate [options] --raw=FILE
+
+      --raw=FILE     take blocks from a flat binary, for example the
+                     .text of a compiled test/test-amd64.c got with
+                     "objcopy -O binary -j .text", by a linear sweep:
+                     each block starts where the previous one ended
+      --base=ADDR    guest address of the start of the --raw file
+      --guest=ARCH   amd64 (default) or x86; the host is always
+                     amd64.  A .corpus file's own arch takes precedence
+      --states=N     random states per block (default 8)
+      --blocks=N     stop after N blocks
+      --seed=N       random seed
+      --show         print the IR before and after a diverging pass
+
+   Integer, bitwise and the simpler vector primops, which the
+   optimiser folds and rewrites, are given their real semantics; all
+   others, the FP ones among them, are treated as uninterpreted
+   functions of their operands, which is all that is needed as long
+   as no pass rewrites them.  Clean helpers are called for real, so
+   this must run on the host the library was built for, which must be
+   a 64-bit one.  A state for which a helper panics or faults is
+   dropped.  Dirty helpers are modelled as uninterpreted functions of
+   their arguments and of the guest state and memory they declare
+   they read, writing values derived from those to whatever they
+   declare they write.
+
+   Blocks using F128 or DFP values, or containing event buffer
+   appends, are skipped.  Failures in the back end, which come after
+   all the passes have been checked, are counted and otherwise
+   ignored; the amd64 back end can't yet take all x86 guest code.  A
+   pass that unrolls a loop is compared against the front end's IR
+   run repeatedly.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stddef.h>
+
+#include "libvex_basictypes.h"
+#include "libvex_ir.h"
+#include "libvex.h"
+#include "libvex_guest_amd64.h"
+#include "libvex_guest_x86.h"
+
+#include "guest_amd64_defs.h"
+#include "guest_x86_defs.h"
+
+#include "vex_corpus.h"
+
+#define N_LINEBUF   10000
+#define N_ORIGBUF   10000
+#define N_TRANSBUF  60000
+
+/* The unroller's largest factor. */
+#define MAX_UNROLL  8
+
+static const HChar* opt_raw    = NULL;
+static ULong        opt_base   = 0;
+static VexArch      opt_guest  = VexArchAMD64;
+static Int          opt_states = 8;
+static Int          opt_blocks = 1000000;
+static UInt         opt_seed   = 1;
+static Bool         opt_show   = False;
+
+static HChar linebuf[N_LINEBUF];
+static UChar origbuf[N_ORIGBUF + 64];
+static UChar transbuf[N_TRANSBUF];
+
+/* The optimisation settings each block is translated with. */
+typedef
+   struct {
+      const HChar* name;
+      Int          iropt_level;
+      Int          unroll_thresh;
+      Int          slp_level;
+      Bool         chase_cond;
+   }
+   Config;
+
+static const Config configs[] = {
+   { "O0",        0, 120, 0, False },
+   { "O1",        1, 120, 0, False },
+   { "O2",        2, 120, 0, False },
+   { "O2-unroll", 2, 400, 0, False },
+   { "O2-slp",    2, 120, 2, False },
+   { "O2-chase",  2, 120, 0, True  },
+};
+
+#define N_CONFIGS  (sizeof(configs) / sizeof(configs[0]))
+
+
+/*---------------------------------------------------------------*/
+/*--- Hashing                                                 ---*/
+/*---------------------------------------------------------------*/
+
+static ULong mix64 ( ULong x )
+{
+   x += 0x9E3779B97F4A7C15ULL;
+   x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+   return x ^ (x >> 31);
+}
+
+static ULong hash_str ( ULong h, const HChar* s )
+{
+   for (; *s; s++)
+      h = mix64(h ^ (UChar)*s);
+   return h;
+}
+
+static ULong rng_state;
+
+static ULong rng ( void )
+{
+   rng_state = mix64(rng_state);
+   return rng_state;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Values                                                  ---*/
+/*---------------------------------------------------------------*/
+
+/* A value of any type, least significant word first.  Bits above the
+   type's size are always zero; an Ity_I1 is 0 or 1. */
+typedef
+   struct { ULong w[4]; }
+   Val;
+
+static Int bits_of ( IRType ty )
+{
+   switch (ty) {
+      case Ity_I1:   return 1;
+      case Ity_I8:   return 8;
+      case Ity_I16:  case Ity_F16: return 16;
+      case Ity_I32:  case Ity_F32: return 32;
+      case Ity_I64:  case Ity_F64: return 64;
+      case Ity_I128: case Ity_V128: return 128;
+      case Ity_V256: return 256;
+      default: ppIRType(ty); fprintf(stderr, "\n"); assert(0);
+   }
+}
+
+static ULong mask64 ( Int bits )
+{
+   return bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+}
+
+static Long sext ( ULong x, Int bits )
+{
+   return bits >= 64 ? (Long)x : ((Long)(x << (64 - bits))) >> (64 - bits);
+}
+
+static void mask_val ( Val* v, IRType ty )
+{
+   Int bits = bits_of(ty), i;
+   for (i = 0; i < 4; i++) {
+      Int lo = 64 * i;
+      if (bits <= lo)
+         v->w[i] = 0;
+      else if (bits < lo + 64)
+         v->w[i] &= mask64(bits - lo);
+   }
+}
+
+static Val mk_val ( ULong x )
+{
+   Val v;
+   memset(&v, 0, sizeof(v));
+   v.w[0] = x;
+   return v;
+}
+
+static ULong get_lane ( const Val* v, Int laneBits, Int i )
+{
+   Int bit = laneBits * i;
+   return (v->w[bit / 64] >> (bit % 64)) & mask64(laneBits);
+}
+
+static void set_lane ( Val* v, Int laneBits, Int i, ULong x )
+{
+   Int bit = laneBits * i;
+   ULong m = mask64(laneBits) << (bit % 64);
+   v->w[bit / 64] = (v->w[bit / 64] & ~m) | ((x << (bit % 64)) & m);
+}
+
+/* The value of an uninterpreted function |tag| of |args|. */
+static Val hash_val ( ULong tag, const Val* args, Int nArgs, IRType ty )
+{
+   Val   r;
+   ULong h = mix64(tag);
+   Int   i, j;
+   for (i = 0; i < nArgs; i++)
+      for (j = 0; j < 4; j++)
+         h = mix64(h ^ args[i].w[j]);
+   for (j = 0; j < 4; j++)
+      r.w[j] = mix64(h + j);
+   mask_val(&r, ty);
+   return r;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- The machine                                             ---*/
+/*---------------------------------------------------------------*/
+
+/* The guest state, and a memory which holds a pseudo-random
+   background value at every address, overlaid with whatever has
+   been stored. */
+
+static UChar* gst;
+static Int    gst_szB;
+static ULong  mem_seed;
+
+#define N_MEM_SLOTS  (1 << 16)
+
+static ULong mem_addr[N_MEM_SLOTS];
+static UChar mem_byte[N_MEM_SLOTS];
+static Bool  mem_inuse[N_MEM_SLOTS];
+static Int   mem_used[N_MEM_SLOTS];
+static Int   n_mem_used;
+
+/* Where a run of a block stops when its state turns out not to be
+   usable, and whether a clean helper is running. */
+static sigjmp_buf eval_jmp;
+static volatile Bool in_helper = False;
+
+/* Where a translation goes when the back end fails, and whether it
+   is running. */
+static sigjmp_buf backend_jmp;
+static volatile Bool in_backend = False;
+
+__attribute__ ((noreturn))
+static void drop_state ( void )
+{
+   siglongjmp(eval_jmp, 1);
+}
+
+static UChar mem_bg ( ULong a )
+{
+   return (UChar)mix64(mem_seed ^ mix64(a));
+}
+
+static Int mem_slot ( ULong a )
+{
+   Int i = (Int)(mix64(a) & (N_MEM_SLOTS - 1));
+   while (mem_inuse[i] && mem_addr[i] != a)
+      i = (i + 1) & (N_MEM_SLOTS - 1);
+   return i;
+}
+
+static UChar mem_read8 ( ULong a )
+{
+   Int i = mem_slot(a);
+   return mem_inuse[i] ? mem_byte[i] : mem_bg(a);
+}
+
+static void mem_write8 ( ULong a, UChar b )
+{
+   Int i = mem_slot(a);
+   if (!mem_inuse[i]) {
+      if (n_mem_used >= N_MEM_SLOTS / 2)
+         drop_state();
+      mem_inuse[i] = True;
+      mem_addr[i]  = a;
+      mem_used[n_mem_used++] = i;
+   }
+   mem_byte[i] = b;
+}
+
+static void mem_reset ( void )
+{
+   Int i;
+   for (i = 0; i < n_mem_used; i++)
+      mem_inuse[mem_used[i]] = False;
+   n_mem_used = 0;
+}
+
+static IRType guest_word_ty;
+
+static ULong addr_of ( const Val* v )
+{
+   return guest_word_ty == Ity_I32 ? (UInt)v->w[0] : v->w[0];
+}
+
+static Val mem_load ( IREndness end, IRType ty, ULong a )
+{
+   Val v;
+   Int n = sizeofIRType(ty), i;
+   memset(&v, 0, sizeof(v));
+   for (i = 0; i < n; i++) {
+      Int j = end == Iend_LE ? i : n - 1 - i;
+      v.w[j / 8] |= (ULong)mem_read8(a + i) << (8 * (j % 8));
+   }
+   return v;
+}
+
+static void mem_store ( IREndness end, IRType ty, ULong a, const Val* v )
+{
+   Int n = sizeofIRType(ty), i;
+   for (i = 0; i < n; i++) {
+      Int j = end == Iend_LE ? i : n - 1 - i;
+      mem_write8(a + i, (UChar)(v->w[j / 8] >> (8 * (j % 8))));
+   }
+}
+
+static Val get_guest ( Int off, IRType ty )
+{
+   Val v;
+   Int n = sizeofIRType(ty), i;
+   if (off < 0 || off + n > gst_szB)
+      drop_state();
+   memset(&v, 0, sizeof(v));
+   for (i = 0; i < n; i++)
+      v.w[i / 8] |= (ULong)gst[off + i] << (8 * (i % 8));
+   return v;
+}
+
+static void put_guest ( Int off, IRType ty, const Val* v )
+{
+   Int n = sizeofIRType(ty), i;
+   if (off < 0 || off + n > gst_szB)
+      drop_state();
+   for (i = 0; i < n; i++)
+      gst[off + i] = (UChar)(v->w[i / 8] >> (8 * (i % 8)));
+}
+
+static Int guest_array_offset ( const IRRegArray* descr, const Val* ix,
+                                Int bias )
+{
+   Int i = ((Int)(UInt)ix->w[0] + bias) % descr->nElems;
+   if (i < 0)
+      i += descr->nElems;
+   return descr->base + i * sizeofIRType(descr->elemTy);
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Primops                                                 ---*/
+/*---------------------------------------------------------------*/
+
+static Val eval_unop ( IROp op, const Val* a, IRType tyA, IRType tyR )
+{
+   Int   bitsA = bits_of(tyA);
+   ULong x     = a->w[0];
+   Val   r     = mk_val(0);
+   Int   i;
+
+   switch (op) {
+      case Iop_Not8: case Iop_Not16: case Iop_Not32: case Iop_Not64:
+      case Iop_Not1: case Iop_NotV128: case Iop_NotV256:
+         for (i = 0; i < 4; i++)
+            r.w[i] = ~a->w[i];
+         break;
+
+      case Iop_8Uto16: case Iop_8Uto32: case Iop_8Uto64:
+      case Iop_16Uto32: case Iop_16Uto64: case Iop_32Uto64:
+      case Iop_1Uto8: case Iop_1Uto32: case Iop_1Uto64:
+      case Iop_64to32: case Iop_64to16: case Iop_64to8:
+      case Iop_32to16: case Iop_32to8: case Iop_16to8:
+      case Iop_32to1: case Iop_64to1:
+      case Iop_128to64: case Iop_V128to64: case Iop_V128to32:
+      case Iop_V256to64_0:
+      case Iop_32UtoV128: case Iop_64UtoV128:
+      case Iop_ReinterpF64asI64: case Iop_ReinterpI64asF64:
+      case Iop_ReinterpF32asI32: case Iop_ReinterpI32asF32:
+         r.w[0] = x;
+         break;
+
+      case Iop_8Sto16: case Iop_8Sto32: case Iop_8Sto64:
+      case Iop_16Sto32: case Iop_16Sto64: case Iop_32Sto64:
+      case Iop_1Sto8: case Iop_1Sto16: case Iop_1Sto32: case Iop_1Sto64:
+         r.w[0] = (ULong)sext(x, bitsA);
+         break;
+
+      case Iop_16HIto8:  r.w[0] = x >> 8;  break;
+      case Iop_32HIto16: r.w[0] = x >> 16; break;
+      case Iop_64HIto32: r.w[0] = x >> 32; break;
+      case Iop_128HIto64: case Iop_V128HIto64: case Iop_V256to64_1:
+         r.w[0] = a->w[1];
+         break;
+      case Iop_V256to64_2: r.w[0] = a->w[2]; break;
+      case Iop_V256to64_3: r.w[0] = a->w[3]; break;
+      case Iop_V256toV128_0: r.w[0] = a->w[0]; r.w[1] = a->w[1]; break;
+      case Iop_V256toV128_1: r.w[0] = a->w[2]; r.w[1] = a->w[3]; break;
+
+      case Iop_ZeroHI64ofV128:  r.w[0] = x; break;
+      case Iop_ZeroHI96ofV128:  r.w[0] = x & 0xFFFFFFFFULL; break;
+      case Iop_ZeroHI112ofV128: r.w[0] = x & 0xFFFFULL; break;
+      case Iop_ZeroHI120ofV128: r.w[0] = x & 0xFFULL; break;
+
+      case Iop_CmpNEZ8: case Iop_CmpNEZ16:
+      case Iop_CmpNEZ32: case Iop_CmpNEZ64:
+         r.w[0] = x != 0;
+         break;
+      case Iop_CmpwNEZ32: case Iop_CmpwNEZ64:
+         r.w[0] = x != 0 ? ~0ULL : 0;
+         break;
+      case Iop_Left8: case Iop_Left16: case Iop_Left32: case Iop_Left64:
+         r.w[0] = x | (0 - x);
+         break;
+
+      case Iop_Clz32: case Iop_Clz64:
+         if (x == 0)
+            return hash_val(op, a, 1, tyR);
+         r.w[0] = bitsA == 32 ? __builtin_clz((UInt)x) : __builtin_clzll(x);
+         break;
+      case Iop_Ctz32: case Iop_Ctz64:
+         if (x == 0)
+            return hash_val(op, a, 1, tyR);
+         r.w[0] = __builtin_ctzll(x);
+         break;
+
+      default:
+         return hash_val(op, a, 1, tyR);
+   }
+   mask_val(&r, tyR);
+   return r;
+}
+
+static Bool lane_op ( IROp op, /*OUT*/Int* laneBits, /*OUT*/Int* kind )
+{
+   switch (op) {
+      case Iop_Add8x8:   case Iop_Add8x16:  *laneBits = 8;  *kind = 0; break;
+      case Iop_Add16x4:  case Iop_Add16x8:  *laneBits = 16; *kind = 0; break;
+      case Iop_Add32x2:  case Iop_Add32x4:  *laneBits = 32; *kind = 0; break;
+      case Iop_Add64x2:                     *laneBits = 64; *kind = 0; break;
+      case Iop_Sub8x8:   case Iop_Sub8x16:  *laneBits = 8;  *kind = 1; break;
+      case Iop_Sub16x4:  case Iop_Sub16x8:  *laneBits = 16; *kind = 1; break;
+      case Iop_Sub32x2:  case Iop_Sub32x4:  *laneBits = 32; *kind = 1; break;
+      case Iop_Sub64x2:                     *laneBits = 64; *kind = 1; break;
+      case Iop_Mul8x8:   case Iop_Mul8x16:  *laneBits = 8;  *kind = 2; break;
+      case Iop_Mul16x4:  case Iop_Mul16x8:  *laneBits = 16; *kind = 2; break;
+      case Iop_Mul32x2:  case Iop_Mul32x4:  *laneBits = 32; *kind = 2; break;
+      case Iop_CmpEQ8x8: case Iop_CmpEQ8x16: *laneBits = 8;  *kind = 3; break;
+      case Iop_CmpEQ16x4: case Iop_CmpEQ16x8: *laneBits = 16; *kind = 3; break;
+      case Iop_CmpEQ32x2: case Iop_CmpEQ32x4: *laneBits = 32; *kind = 3; break;
+      case Iop_CmpEQ64x2:                   *laneBits = 64; *kind = 3; break;
+      default: return False;
+   }
+   return True;
+}
+
+static Val eval_binop ( IROp op, const Val* a, const Val* b,
+                        IRType tyA, IRType tyR )
+{
+   Int   bitsA = bits_of(tyA);
+   ULong x     = a->w[0], y = b->w[0];
+   Val   r     = mk_val(0);
+   Val   args[2];
+   Int   laneBits, kind, i;
+
+   if (lane_op(op, &laneBits, &kind)) {
+      for (i = 0; i < bits_of(tyR) / laneBits; i++) {
+         ULong p = get_lane(a, laneBits, i), q = get_lane(b, laneBits, i);
+         ULong v = kind == 0 ? p + q : kind == 1 ? p - q
+                   : kind == 2 ? p * q : (p == q ? ~0ULL : 0);
+         set_lane(&r, laneBits, i, v);
+      }
+      return r;
+   }
+
+   switch (op) {
+      case Iop_Add8: case Iop_Add16: case Iop_Add32: case Iop_Add64:
+         r.w[0] = x + y; break;
+      case Iop_Sub8: case Iop_Sub16: case Iop_Sub32: case Iop_Sub64:
+         r.w[0] = x - y; break;
+      case Iop_Mul8: case Iop_Mul16: case Iop_Mul32: case Iop_Mul64:
+         r.w[0] = x * y; break;
+      case Iop_And8: case Iop_And16: case Iop_And32: case Iop_And64:
+      case Iop_AndV128: case Iop_AndV256:
+         for (i = 0; i < 4; i++) r.w[i] = a->w[i] & b->w[i];
+         break;
+      case Iop_Or8: case Iop_Or16: case Iop_Or32: case Iop_Or64:
+      case Iop_OrV128: case Iop_OrV256:
+         for (i = 0; i < 4; i++) r.w[i] = a->w[i] | b->w[i];
+         break;
+      case Iop_Xor8: case Iop_Xor16: case Iop_Xor32: case Iop_Xor64:
+      case Iop_XorV128: case Iop_XorV256:
+         for (i = 0; i < 4; i++) r.w[i] = a->w[i] ^ b->w[i];
+         break;
+
+      case Iop_Shl8: case Iop_Shl16: case Iop_Shl32: case Iop_Shl64:
+         r.w[0] = y >= (ULong)bitsA ? 0 : x << y; break;
+      case Iop_Shr8: case Iop_Shr16: case Iop_Shr32: case Iop_Shr64:
+         r.w[0] = y >= (ULong)bitsA ? 0 : x >> y; break;
+      case Iop_Sar8: case Iop_Sar16: case Iop_Sar32: case Iop_Sar64:
+         r.w[0] = (ULong)(sext(x, bitsA)
+                          >> (y >= (ULong)bitsA ? bitsA - 1 : (Int)y));
+         break;
+
+      case Iop_CmpEQ8: case Iop_CmpEQ16: case Iop_CmpEQ32: case Iop_CmpEQ64:
+      case Iop_CasCmpEQ8: case Iop_CasCmpEQ16:
+      case Iop_CasCmpEQ32: case Iop_CasCmpEQ64:
+         r.w[0] = x == y; break;
+      case Iop_CmpNE8: case Iop_CmpNE16: case Iop_CmpNE32: case Iop_CmpNE64:
+      case Iop_CasCmpNE8: case Iop_CasCmpNE16:
+      case Iop_CasCmpNE32: case Iop_CasCmpNE64:
+      case Iop_ExpCmpNE8: case Iop_ExpCmpNE16:
+      case Iop_ExpCmpNE32: case Iop_ExpCmpNE64:
+         r.w[0] = x != y; break;
+      case Iop_CmpLT32S: case Iop_CmpLT64S:
+         r.w[0] = sext(x, bitsA) < sext(y, bitsA); break;
+      case Iop_CmpLE32S: case Iop_CmpLE64S:
+         r.w[0] = sext(x, bitsA) <= sext(y, bitsA); break;
+      case Iop_CmpLT32U: case Iop_CmpLT64U:
+         r.w[0] = x < y; break;
+      case Iop_CmpLE32U: case Iop_CmpLE64U:
+         r.w[0] = x <= y; break;
+      case Iop_CmpORD32S: case Iop_CmpORD64S:
+         r.w[0] = sext(x, bitsA) < sext(y, bitsA) ? 8
+                  : sext(x, bitsA) > sext(y, bitsA) ? 4 : 2;
+         break;
+      case Iop_CmpORD32U: case Iop_CmpORD64U:
+         r.w[0] = x < y ? 8 : x > y ? 4 : 2;
+         break;
+      case Iop_Max32U:
+         r.w[0] = x > y ? x : y; break;
+
+      case Iop_MullU8: case Iop_MullU16: case Iop_MullU32: case Iop_MullU64: {
+         unsigned __int128 p = (unsigned __int128)x * y;
+         r.w[0] = (ULong)p; r.w[1] = (ULong)(p >> 64);
+         break;
+      }
+      case Iop_MullS8: case Iop_MullS16: case Iop_MullS32: case Iop_MullS64: {
+         __int128 p = (__int128)sext(x, bitsA) * sext(y, bitsA);
+         r.w[0] = (ULong)p; r.w[1] = (ULong)((unsigned __int128)p >> 64);
+         break;
+      }
+
+      case Iop_8HLto16: case Iop_16HLto32: case Iop_32HLto64:
+         r.w[0] = (x << bitsA) | y; break;
+      case Iop_64HLto128: case Iop_64HLtoV128:
+         r.w[0] = y; r.w[1] = x; break;
+      case Iop_V128HLtoV256:
+         r.w[0] = b->w[0]; r.w[1] = b->w[1];
+         r.w[2] = a->w[0]; r.w[3] = a->w[1];
+         break;
+      case Iop_SetV128lo64:
+         r.w[0] = y; r.w[1] = a->w[1]; break;
+      case Iop_SetV128lo32:
+         r.w[0] = (x & ~0xFFFFFFFFULL) | y; r.w[1] = a->w[1]; break;
+      case Iop_InterleaveLO8x16:
+         for (i = 0; i < 8; i++) {
+            set_lane(&r, 8, 2 * i,     get_lane(b, 8, i));
+            set_lane(&r, 8, 2 * i + 1, get_lane(a, 8, i));
+         }
+         break;
+
+      default:
+         args[0] = *a;
+         args[1] = *b;
+         return hash_val(op, args, 2, tyR);
+   }
+   mask_val(&r, tyR);
+   return r;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Expressions and statements                              ---*/
+/*---------------------------------------------------------------*/
+
+static const IRTypeEnv* tyenv;
+static Val*             temps;
+static Int              temps_size;
+
+static Val eval_const ( const IRConst* con )
+{
+   Val v = mk_val(0);
+   Int i;
+   switch (con->tag) {
+      case Ico_U1:   v.w[0] = con->Ico.U1; break;
+      case Ico_U8:   v.w[0] = con->Ico.U8; break;
+      case Ico_U16:  v.w[0] = con->Ico.U16; break;
+      case Ico_U32:  v.w[0] = con->Ico.U32; break;
+      case Ico_U64:  v.w[0] = con->Ico.U64; break;
+      case Ico_F32i: v.w[0] = con->Ico.F32i; break;
+      case Ico_F64i: v.w[0] = con->Ico.F64i; break;
+      case Ico_F32: {
+         Float f = con->Ico.F32;
+         UInt  u;
+         memcpy(&u, &f, 4);
+         v.w[0] = u;
+         break;
+      }
+      case Ico_F64:
+         memcpy(&v.w[0], &con->Ico.F64, 8);
+         break;
+      case Ico_V128:
+         for (i = 0; i < 16; i++)
+            if (con->Ico.V128 & (1 << i))
+               set_lane(&v, 8, i, 0xFF);
+         break;
+      case Ico_V256:
+         for (i = 0; i < 32; i++)
+            if (con->Ico.V256 & (1U << i))
+               set_lane(&v, 8, i, 0xFF);
+         break;
+      default:
+         ppIRConst(con); assert(0);
+   }
+   return v;
+}
+
+static Val eval_expr ( const IRExpr* e );
+
+static Val call_helper ( const IRCallee* cee, const Val* args, Int nArgs )
+{
+   typedef ULong (*Helper)(ULong, ULong, ULong, ULong, ULong, ULong);
+   ULong a[6];
+   Int   i;
+   Val   r;
+   assert(nArgs <= 6);
+   for (i = 0; i < 6; i++)
+      a[i] = i < nArgs ? args[i].w[0] : 0;
+   in_helper = True;
+   r = mk_val(((Helper)cee->addr)(a[0], a[1], a[2], a[3], a[4], a[5]));
+   in_helper = False;
+   return r;
+}
+
+static Val eval_expr ( const IRExpr* e )
+{
+   Val    a[4], r;
+   IRType tyR, ty1, ty2, ty3, ty4;
+   Int    i;
+
+   switch (e->tag) {
+      case Iex_Get:
+         return get_guest(e->Iex.Get.offset, e->Iex.Get.ty);
+      case Iex_GetI: {
+         const IRRegArray* descr = e->Iex.GetI.descr;
+         a[0] = eval_expr(e->Iex.GetI.ix);
+         return get_guest(guest_array_offset(descr, &a[0], e->Iex.GetI.bias),
+                          descr->elemTy);
+      }
+      case Iex_RdTmp:
+         return temps[e->Iex.RdTmp.tmp];
+      case Iex_Const:
+         return eval_const(e->Iex.Const.con);
+      case Iex_Load:
+         a[0] = eval_expr(e->Iex.Load.addr);
+         return mem_load(e->Iex.Load.end, e->Iex.Load.ty, addr_of(&a[0]));
+      case Iex_ITE:
+         a[0] = eval_expr(e->Iex.ITE.cond);
+         return eval_expr(a[0].w[0] ? e->Iex.ITE.iftrue : e->Iex.ITE.iffalse);
+      case Iex_Unop:
+         typeOfPrimop(e->Iex.Unop.op, &tyR, &ty1, &ty2, &ty3, &ty4);
+         a[0] = eval_expr(e->Iex.Unop.arg);
+         return eval_unop(e->Iex.Unop.op, &a[0], ty1, tyR);
+      case Iex_Binop:
+         typeOfPrimop(e->Iex.Binop.op, &tyR, &ty1, &ty2, &ty3, &ty4);
+         a[0] = eval_expr(e->Iex.Binop.arg1);
+         a[1] = eval_expr(e->Iex.Binop.arg2);
+         return eval_binop(e->Iex.Binop.op, &a[0], &a[1], ty1, tyR);
+      case Iex_Triop: {
+         const IRTriop* t = e->Iex.Triop.details;
+         typeOfPrimop(t->op, &tyR, &ty1, &ty2, &ty3, &ty4);
+         a[0] = eval_expr(t->arg1);
+         a[1] = eval_expr(t->arg2);
+         a[2] = eval_expr(t->arg3);
+         return hash_val(t->op, a, 3, tyR);
+      }
+      case Iex_Qop: {
+         const IRQop* q = e->Iex.Qop.details;
+         typeOfPrimop(q->op, &tyR, &ty1, &ty2, &ty3, &ty4);
+         a[0] = eval_expr(q->arg1);
+         a[1] = eval_expr(q->arg2);
+         a[2] = eval_expr(q->arg3);
+         a[3] = eval_expr(q->arg4);
+         return hash_val(q->op, a, 4, tyR);
+      }
+      case Iex_CCall: {
+         Val args[6];
+         for (i = 0; e->Iex.CCall.args[i]; i++) {
+            assert(i < 6);
+            args[i] = eval_expr(e->Iex.CCall.args[i]);
+         }
+         r = call_helper(e->Iex.CCall.cee, args, i);
+         mask_val(&r, e->Iex.CCall.retty);
+         return r;
+      }
+      default:
+         ppIRExpr(e); assert(0);
+   }
+}
+
+/* Run dirty call |d| as an uninterpreted function of what it reads,
+   as described at the top of this file. */
+static void eval_dirty ( const IRDirty* d )
+{
+   ULong h = hash_str(0xD1D1D1D1ULL, d->cee->name);
+   ULong maddr = 0;
+   Val   guard, v;
+   Int   i, j, k;
+
+   for (i = 0; d->args[i]; i++) {
+      if (is_IRExpr_VECRET_or_BBPTR(d->args[i]))
+         continue;
+      v = eval_expr(d->args[i]);
+      for (j = 0; j < 4; j++)
+         h = mix64(h ^ v.w[j]);
+   }
+   if (d->mFx != Ifx_None) {
+      v = eval_expr(d->mAddr);
+      maddr = addr_of(&v);
+   }
+   guard = eval_expr(d->guard);
+   if (!guard.w[0]) {
+      if (d->tmp != IRTemp_INVALID) {
+         v.w[0] = v.w[1] = v.w[2] = v.w[3] = 0x5555555555555555ULL;
+         mask_val(&v, tyenv->types[d->tmp]);
+         temps[d->tmp] = v;
+      }
+      return;
+   }
+
+   for (i = 0; i < d->nFxState; i++) {
+      if (d->fxState[i].fx == Ifx_Write)
+         continue;
+      for (k = 0; k <= d->fxState[i].nRepeats; k++) {
+         Int off = d->fxState[i].offset + k * d->fxState[i].repeatLen;
+         if (off < 0 || off + d->fxState[i].size > gst_szB)
+            drop_state();
+         for (j = 0; j < d->fxState[i].size; j++)
+            h = mix64(h ^ gst[off + j]);
+      }
+   }
+   if (d->mFx == Ifx_Read || d->mFx == Ifx_Modify)
+      for (j = 0; j < d->mSize; j++)
+         h = mix64(h ^ mem_read8(maddr + j));
+
+   for (i = 0; i < d->nFxState; i++) {
+      if (d->fxState[i].fx == Ifx_Read)
+         continue;
+      for (k = 0; k <= d->fxState[i].nRepeats; k++) {
+         Int off = d->fxState[i].offset + k * d->fxState[i].repeatLen;
+         for (j = 0; j < d->fxState[i].size; j++)
+            gst[off + j] = (UChar)mix64(h ^ mix64(off + j));
+      }
+   }
+   if (d->mFx == Ifx_Write || d->mFx == Ifx_Modify)
+      for (j = 0; j < d->mSize; j++)
+         mem_write8(maddr + j, (UChar)mix64(h ^ mix64(maddr + j)));
+
+   if (d->tmp != IRTemp_INVALID) {
+      for (j = 0; j < 4; j++)
+         v.w[j] = mix64(h + 0x100 + j);
+      mask_val(&v, tyenv->types[d->tmp]);
+      temps[d->tmp] = v;
+   }
+}
+
+static void put_IP ( Int offsIP, const Val* v )
+{
+   put_guest(offsIP, guest_word_ty, v);
+}
+
+/* Run |bb| on the machine.  Returns False if the state had to be
+   dropped, and otherwise the jump kind the block left by. */
+static Bool run_block ( const IRSB* bb, /*OUT*/IRJumpKind* jk )
+{
+   Val next;
+   Int i;
+
+   if (bb->tyenv->types_used > temps_size) {
+      temps_size = 2 * bb->tyenv->types_used;
+      temps = realloc(temps, temps_size * sizeof(Val));
+      assert(temps);
+   }
+   tyenv = bb->tyenv;
+
+   if (sigsetjmp(eval_jmp, 1)) {
+      in_helper = False;
+      return False;
+   }
+
+   for (i = 0; i < bb->stmts_used; i++) {
+      const IRStmt* st = bb->stmts[i];
+      Val a, b, c;
+      if (!st)
+         continue;
+      switch (st->tag) {
+         case Ist_NoOp: case Ist_IMark: case Ist_AbiHint: case Ist_MBE:
+            break;
+         case Ist_Put:
+            a = eval_expr(st->Ist.Put.data);
+            put_guest(st->Ist.Put.offset,
+                      typeOfIRExpr(tyenv, st->Ist.Put.data), &a);
+            break;
+         case Ist_PutI: {
+            const IRPutI* p = st->Ist.PutI.details;
+            a = eval_expr(p->ix);
+            b = eval_expr(p->data);
+            put_guest(guest_array_offset(p->descr, &a, p->bias),
+                      p->descr->elemTy, &b);
+            break;
+         }
+         case Ist_WrTmp:
+            temps[st->Ist.WrTmp.tmp] = eval_expr(st->Ist.WrTmp.data);
+            break;
+         case Ist_Store:
+            a = eval_expr(st->Ist.Store.addr);
+            b = eval_expr(st->Ist.Store.data);
+            mem_store(st->Ist.Store.end,
+                      typeOfIRExpr(tyenv, st->Ist.Store.data),
+                      addr_of(&a), &b);
+            break;
+         case Ist_StoreG: {
+            const IRStoreG* sg = st->Ist.StoreG.details;
+            a = eval_expr(sg->addr);
+            b = eval_expr(sg->data);
+            c = eval_expr(sg->guard);
+            if (c.w[0])
+               mem_store(sg->end, typeOfIRExpr(tyenv, sg->data),
+                         addr_of(&a), &b);
+            break;
+         }
+         case Ist_LoadG: {
+            const IRLoadG* lg = st->Ist.LoadG.details;
+            IRType tyRes, tyArg;
+            typeOfIRLoadGOp(lg->cvt, &tyRes, &tyArg);
+            a = eval_expr(lg->addr);
+            b = eval_expr(lg->alt);
+            c = eval_expr(lg->guard);
+            if (c.w[0]) {
+               b = mem_load(lg->end, tyArg, addr_of(&a));
+               switch (lg->cvt) {
+                  case ILGop_16Sto32: b.w[0] = (UInt)sext(b.w[0], 16); break;
+                  case ILGop_8Sto32:  b.w[0] = (UInt)sext(b.w[0], 8);  break;
+                  default: break;
+               }
+            }
+            temps[lg->dst] = b;
+            break;
+         }
+         case Ist_CAS: {
+            const IRCAS* cas = st->Ist.CAS.details;
+            IRType ty  = tyenv->types[cas->oldLo];
+            Int    szB = sizeofIRType(ty);
+            ULong  ea;
+            Val    oldLo, oldHi = mk_val(0), expdHi = mk_val(0), dataHi;
+            a  = eval_expr(cas->addr);
+            ea = addr_of(&a);
+            b  = eval_expr(cas->expdLo);
+            c  = eval_expr(cas->dataLo);
+            if (cas->oldHi == IRTemp_INVALID) {
+               oldLo = mem_load(cas->end, ty, ea);
+               if (oldLo.w[0] == b.w[0])
+                  mem_store(cas->end, ty, ea, &c);
+            } else {
+               ULong eaLo = cas->end == Iend_LE ? ea : ea + szB;
+               ULong eaHi = cas->end == Iend_LE ? ea + szB : ea;
+               expdHi = eval_expr(cas->expdHi);
+               dataHi = eval_expr(cas->dataHi);
+               oldLo  = mem_load(cas->end, ty, eaLo);
+               oldHi  = mem_load(cas->end, ty, eaHi);
+               if (oldLo.w[0] == b.w[0] && oldHi.w[0] == expdHi.w[0]) {
+                  mem_store(cas->end, ty, eaLo, &c);
+                  mem_store(cas->end, ty, eaHi, &dataHi);
+               }
+               temps[cas->oldHi] = oldHi;
+            }
+            temps[cas->oldLo] = oldLo;
+            break;
+         }
+         case Ist_LLSC: {
+            IRType ty = tyenv->types[st->Ist.LLSC.result];
+            a = eval_expr(st->Ist.LLSC.addr);
+            if (st->Ist.LLSC.storedata == NULL) {
+               temps[st->Ist.LLSC.result]
+                  = mem_load(st->Ist.LLSC.end, ty, addr_of(&a));
+            } else {
+               b = eval_expr(st->Ist.LLSC.storedata);
+               mem_store(st->Ist.LLSC.end,
+                         typeOfIRExpr(tyenv, st->Ist.LLSC.storedata),
+                         addr_of(&a), &b);
+               temps[st->Ist.LLSC.result] = mk_val(1);
+            }
+            break;
+         }
+         case Ist_Dirty:
+            eval_dirty(st->Ist.Dirty.details);
+            break;
+         case Ist_Exit:
+            a = eval_expr(st->Ist.Exit.guard);
+            if (a.w[0]) {
+               b = eval_const(st->Ist.Exit.dst);
+               put_IP(st->Ist.Exit.offsIP, &b);
+               *jk = st->Ist.Exit.jk;
+               return True;
+            }
+            break;
+         default:
+            ppIRStmt(st); assert(0);
+      }
+   }
+
+   next = eval_expr(bb->next);
+   put_IP(bb->offsIP, &next);
+   *jk = bb->jumpkind;
+   return True;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Outcomes                                                ---*/
+/*---------------------------------------------------------------*/
+
+typedef
+   struct {
+      Bool       valid;
+      IRJumpKind jk;
+      UChar*     gst;
+      Int        n_mem;
+      ULong*     mem_addr;  /* ascending */
+      UChar*     mem_byte;
+   }
+   Outcome;
+
+static void free_outcome ( Outcome* o )
+{
+   free(o->gst);
+   free(o->mem_addr);
+   free(o->mem_byte);
+   memset(o, 0, sizeof(*o));
+}
+
+static Int cmp_addr ( const void* a, const void* b )
+{
+   ULong x = mem_addr[*(const Int*)a], y = mem_addr[*(const Int*)b];
+   return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/* Record the state of the machine.  Memory whose contents equal the
+   background is not recorded, so a store of the value that was there
+   anyway is not an effect. */
+static void capture_outcome ( /*OUT*/Outcome* o, Bool valid, IRJumpKind jk )
+{
+   Int i, n = 0;
+   free_outcome(o);
+   o->valid = valid;
+   if (!valid)
+      return;
+   o->jk  = jk;
+   o->gst = malloc(gst_szB);
+   memcpy(o->gst, gst, gst_szB);
+   qsort(mem_used, n_mem_used, sizeof(Int), cmp_addr);
+   o->mem_addr = malloc((n_mem_used + 1) * sizeof(ULong));
+   o->mem_byte = malloc(n_mem_used + 1);
+   for (i = 0; i < n_mem_used; i++) {
+      Int s = mem_used[i];
+      if (mem_byte[s] == mem_bg(mem_addr[s]))
+         continue;
+      o->mem_addr[n] = mem_addr[s];
+      o->mem_byte[n] = mem_byte[s];
+      n++;
+   }
+   o->n_mem = n;
+}
+
+static Bool same_outcome ( const Outcome* a, const Outcome* b )
+{
+   return a->jk == b->jk
+          && 0 == memcmp(a->gst, b->gst, gst_szB)
+          && a->n_mem == b->n_mem
+          && 0 == memcmp(a->mem_addr, b->mem_addr, a->n_mem * sizeof(ULong))
+          && 0 == memcmp(a->mem_byte, b->mem_byte, a->n_mem);
+}
+
+#define N_DIFFS_SHOWN  8
+
+static void show_diffs ( const Outcome* ref, const Outcome* got )
+{
+   Int i, j, shown = 0;
+
+   if (ref->jk != got->jk) {
+      printf("   jump kind: ");
+      ppIRJumpKind(got->jk);
+      printf(", expected ");
+      ppIRJumpKind(ref->jk);
+      printf("\n");
+   }
+   for (i = 0; i < gst_szB && shown < N_DIFFS_SHOWN; i += 8) {
+      ULong x = 0, y = 0;
+      Int   n = gst_szB - i < 8 ? gst_szB - i : 8;
+      if (0 == memcmp(&ref->gst[i], &got->gst[i], n))
+         continue;
+      memcpy(&x, &got->gst[i], n);
+      memcpy(&y, &ref->gst[i], n);
+      printf("   guest +%-4d %016llx, expected %016llx\n", i, x, y);
+      shown++;
+   }
+   /* Both lists are ascending; walk them together. */
+   for (i = j = 0; (i < got->n_mem || j < ref->n_mem)
+                   && shown < N_DIFFS_SHOWN; ) {
+      ULong a;
+      Int   x = -1, y = -1;
+      if (j >= ref->n_mem
+          || (i < got->n_mem && got->mem_addr[i] < ref->mem_addr[j])) {
+         a = got->mem_addr[i]; x = got->mem_byte[i]; i++;
+      } else if (i >= got->n_mem || ref->mem_addr[j] < got->mem_addr[i]) {
+         a = ref->mem_addr[j]; y = ref->mem_byte[j]; j++;
+      } else {
+         a = got->mem_addr[i]; x = got->mem_byte[i]; y = ref->mem_byte[j];
+         i++; j++;
+      }
+      if (x == y)
+         continue;
+      printf("   memory 0x%llx: ", a);
+      if (x < 0) printf("unwritten"); else printf("%02x", x);
+      printf(", expected ");
+      if (y < 0) printf("unwritten\n"); else printf("%02x\n", y);
+      shown++;
+   }
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Random states                                           ---*/
+/*---------------------------------------------------------------*/
+
+/* Values likely to be used as addresses all point into one small
+   area, so that loads and stores through different registers
+   sometimes alias. */
+#define POOL_BASE  0x10000ULL
+
+static Int   block_no;
+static Addr  block_addr;
+
+static void init_state ( Int state_no )
+{
+   Int i;
+   rng_state = mix64(((ULong)opt_seed << 40) ^ ((ULong)block_no << 16)
+                     ^ state_no);
+   for (i = 0; i < gst_szB; i += 8) {
+      ULong r = rng(), v;
+      switch (r & 3) {
+         case 0:  v = (r >> 8) % 16;  break;
+         case 1:  v = POOL_BASE + ((r >> 8) % 64) * 8; break;
+         default: v = rng(); break;
+      }
+      memcpy(&gst[i], &v, gst_szB - i < 8 ? gst_szB - i : 8);
+   }
+   if (opt_guest == VexArchAMD64) {
+      VexGuestAMD64State* s = (VexGuestAMD64State*)gst;
+      s->guest_CC_OP = rng() % AMD64G_CC_OP_NUMBER;
+      s->guest_DFLAG = (rng() & 1) ? 1 : -1ULL;
+   } else {
+      VexGuestX86State* s = (VexGuestX86State*)gst;
+      s->guest_CC_OP = rng() % X86G_CC_OP_NUMBER;
+      s->guest_DFLAG = (rng() & 1) ? 1 : -1U;
+      /* Helpers dereference these if nonzero. */
+      s->guest_LDT = 0;
+      s->guest_GDT = 0;
+   }
+   mem_seed = rng();
+   mem_reset();
+}
+
+/* Run |bb| from state |state_no|, |iters| times over if the block
+   keeps branching back to its own start. */
+static void run_from ( const IRSB* bb, Int state_no, Int iters,
+                       /*OUT*/Outcome* o )
+{
+   IRJumpKind jk = Ijk_Boring;
+   Bool       ok = True;
+   Int        i;
+   init_state(state_no);
+   for (i = 0; i < iters && ok; i++) {
+      Val ip;
+      ok = run_block(bb, &jk);
+      if (!ok || jk != Ijk_Boring)
+         break;
+      ip = get_guest(bb->offsIP, guest_word_ty);
+      if (addr_of(&ip) != block_addr)
+         break;
+   }
+   capture_outcome(o, ok, jk);
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Watching the passes                                     ---*/
+/*---------------------------------------------------------------*/
+
+static Outcome* ref_out;       /* first config's front end output */
+static Outcome* own_out;       /* this config's front end output */
+static Outcome* own_iter;      /* the same, run again and again */
+static Outcome  cur_out;
+static UShort   ref_len;
+static Bool     have_ref;
+
+static VexGuestExtents vge;
+static const Config*   cur_config;
+static Bool            cur_skip;      /* block can't be evaluated */
+static Bool            cur_diverged;  /* already reported */
+static Bool            cur_unrolled;
+static IRSB*           cur_frontend;
+static IRSB*           prev_ir;
+static const HChar*    prev_pass;
+
+static UInt n_blocks, n_skipped, n_failed, n_backend_failed;
+static UInt n_runs, n_dropped, n_diverged;
+
+static Bool is_supported ( const IRSB* bb )
+{
+   Int i;
+   for (i = 0; i < bb->tyenv->types_used; i++)
+      switch (bb->tyenv->types[i]) {
+         case Ity_F128: case Ity_D32: case Ity_D64: case Ity_D128:
+            return False;
+         default:
+            break;
+      }
+   for (i = 0; i < bb->stmts_used; i++) {
+      const IRStmt* st = bb->stmts[i];
+      if (st && st->tag == Ist_EvAppend)
+         return False;
+      if (st && st->tag == Ist_Dirty) {
+         const IRDirty* d = st->Ist.Dirty.details;
+         if (d->tmp != IRTemp_INVALID)
+            switch (bb->tyenv->types[d->tmp]) {
+               case Ity_F128: case Ity_D32: case Ity_D64: case Ity_D128:
+                  return False;
+               default:
+                  break;
+            }
+      }
+   }
+   return True;
+}
+
+static void report ( const HChar* pass, const IRSB* bb, Int state_no,
+                     const Outcome* ref, const Outcome* got,
+                     const HChar* against )
+{
+   printf("block %d at 0x%llx (%u bytes), %s: pass \"%s\" diverges from "
+          "%s in state %d\n",
+          block_no, (ULong)block_addr, (UInt)vge.len[0], cur_config->name,
+          pass, against, state_no);
+   show_diffs(ref, got);
+   if (opt_show) {
+      printf("---- IR after \"%s\" ----\n", prev_pass);
+      ppIRSB(prev_ir);
+      printf("---- IR after \"%s\" ----\n", pass);
+      ppIRSB(bb);
+   }
+   cur_diverged = True;
+   n_diverged++;
+}
+
+/* Does the outcome of |bb| in state |s| match that of the front
+   end's IR, run as many times as it takes if |bb| has been
+   unrolled? */
+static Bool matches ( const IRSB* bb, Int s )
+{
+   Int k;
+   run_from(bb, s, 1, &cur_out);
+   n_runs++;
+   if (!cur_out.valid || !own_out[s].valid) {
+      n_dropped++;
+      return True;
+   }
+   if (!cur_unrolled)
+      return same_outcome(&own_out[s], &cur_out);
+   for (k = 1; k <= MAX_UNROLL; k++) {
+      run_from(cur_frontend, s, k, &own_iter[s]);
+      if (own_iter[s].valid && same_outcome(&own_iter[s], &cur_out))
+         return True;
+   }
+   return False;
+}
+
+static void frontend_done ( const IRSB* bb )
+{
+   Int s;
+
+   cur_skip = !is_supported(bb);
+   if (cur_skip)
+      return;
+   cur_frontend = deepCopyIRSB(bb);
+
+   for (s = 0; s < opt_states; s++) {
+      run_from(bb, s, 1, &own_out[s]);
+      n_runs++;
+   }
+   if (!have_ref) {
+      for (s = 0; s < opt_states; s++) {
+         run_from(bb, s, 1, &ref_out[s]);
+      }
+      ref_len  = vge.len[0];
+      have_ref = True;
+      return;
+   }
+   /* The front end's output depends on the settings too, via
+      guest_chase_cond, so check it against the first settings' when
+      it covers the same guest code. */
+   if (vge.n_used != 1 || vge.len[0] != ref_len)
+      return;
+   for (s = 0; s < opt_states && !cur_diverged; s++) {
+      if (!ref_out[s].valid || !own_out[s].valid)
+         continue;
+      if (!same_outcome(&ref_out[s], &own_out[s]))
+         report("frontend", bb, s, &ref_out[s], &own_out[s],
+                configs[0].name);
+   }
+}
+
+static void pass_done ( void* opaque, const HChar* pass, const IRSB* bb,
+                        SizeT temp_bytes_used )
+{
+   Int s;
+
+   if (bb == NULL)
+      return;   /* a back end stage */
+   if (0 == strcmp(pass, "frontend")) {
+      cur_skip = cur_diverged = cur_unrolled = False;
+      frontend_done(bb);
+   } else if (!cur_skip && !cur_diverged) {
+      if (0 == strcmp(pass, "loop-unroll"))
+         cur_unrolled = True;
+      for (s = 0; s < opt_states; s++)
+         if (!matches(bb, s)) {
+            report(pass, bb, s, &own_out[s], &cur_out, "\"frontend\"");
+            break;
+         }
+   }
+   if (!cur_skip && opt_show) {
+      prev_ir   = deepCopyIRSB(bb);
+      prev_pass = pass;
+   }
+   if (0 == strcmp(pass, "treebuild"))
+      in_backend = True;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Driver                                                  ---*/
+/*---------------------------------------------------------------*/
+
+__attribute__ ((noreturn))
+static void failure_exit ( void )
+{
+   if (in_helper)
+      drop_state();
+   if (in_backend)
+      siglongjmp(backend_jmp, 1);
+   fprintf(stdout, "irvalidate: LibVEX failed\n");
+   exit(1);
+}
+
+static void log_bytes ( const HChar* bytes, SizeT nbytes )
+{
+   if (!in_helper && !in_backend)
+      fwrite(bytes, 1, nbytes, stdout);
+}
+
+static void fault_handler ( Int sig )
+{
+   if (in_helper)
+      drop_state();
+   signal(sig, SIG_DFL);
+   raise(sig);
+}
+
+static Bool chase_into_not_ok ( void* opaque, Addr dst )
+{
+   return False;
+}
+
+static UInt needs_self_check ( void* opaque, VexRegisterUpdates* pxControl,
+                               const VexGuestExtents* vge )
+{
+   return 0;
+}
+
+__attribute__ ((noreturn))
+static void usage ( void )
+{
+   fprintf(stderr,
+           "usage: irvalidate [--guest=amd64|x86] [--states=N] "
+           "[--blocks=N] [--seed=N]\n"
+           "                  [--show] file.orig|file.corpus\n"
+           "       irvalidate [options] --raw=FILE [--base=ADDR]\n");
+   exit(1);
+}
+
+/* Fetch the next block from a .orig or .corpus file, as test_main.c
+   does. */
+static Bool next_block ( FILE* f, VexCorpus* corpus,
+                         /*OUT*/Addr* addr, /*OUT*/Int* nbytes )
+{
+   Int  i, bb;
+   UInt u, a32;
+
+   memset(origbuf, 0, sizeof(origbuf));
+   if (corpus) {
+      VexCorpusBlock b;
+      if (!vex_corpus_next(corpus, &b))
+         return False;
+      if (b.n_bytes > N_ORIGBUF) {
+         fprintf(stderr, "block at 0x%llx is too big (%u bytes)\n",
+                 b.addr, b.n_bytes);
+         exit(1);
+      }
+      memcpy(origbuf, b.bytes, b.n_bytes);
+      *addr   = (Addr)b.addr;
+      *nbytes = b.n_bytes;
+      return True;
+   }
+   while (!feof(f)) {
+      linebuf[0] = 0;
+      if (!fgets(linebuf, N_LINEBUF, f) || linebuf[0] != '.')
+         continue;
+      assert(3 == sscanf(&linebuf[1], " %d %x %d\n", &bb, &a32, nbytes));
+      assert(*nbytes >= 1 && *nbytes <= N_ORIGBUF);
+      assert(fgets(linebuf, N_LINEBUF, f) && linebuf[0] == '.');
+      for (i = 0; i < *nbytes; i++) {
+         assert(1 == sscanf(&linebuf[2 + 3*i], "%x", &u));
+         origbuf[i] = (UChar)u;
+      }
+      *addr = a32;
+      return True;
+   }
+   return False;
+}
+
+static void setup_translation ( /*OUT*/VexTranslateArgs* vta )
+{
+   VexArchInfo vai_amd64, vai_x86;
+   VexAbiInfo  vbi;
+
+   LibVEX_default_VexArchInfo(&vai_amd64);
+   vai_amd64.endness = VexEndnessLE;
+   vai_amd64.hwcaps  = VEX_HWCAPS_AMD64_SSE3 | VEX_HWCAPS_AMD64_CX16
+                       | VEX_HWCAPS_AMD64_LZCNT | VEX_HWCAPS_AMD64_AVX
+                       | VEX_HWCAPS_AMD64_RDTSCP | VEX_HWCAPS_AMD64_BMI
+                       | VEX_HWCAPS_AMD64_AVX2;
+   LibVEX_default_VexArchInfo(&vai_x86);
+   vai_x86.endness = VexEndnessLE;
+   vai_x86.hwcaps  = VEX_HWCAPS_X86_MMXEXT | VEX_HWCAPS_X86_SSE1
+                     | VEX_HWCAPS_X86_SSE2 | VEX_HWCAPS_X86_SSE3
+                     | VEX_HWCAPS_X86_LZCNT;
+   LibVEX_default_VexAbiInfo(&vbi);
+   vbi.guest_stack_redzone_size = opt_guest == VexArchAMD64 ? 128 : 0;
+
+   memset(vta, 0, sizeof(*vta));
+   vta->arch_guest       = opt_guest;
+   vta->archinfo_guest   = opt_guest == VexArchAMD64 ? vai_amd64 : vai_x86;
+   /* The x86 back end only works on a 32-bit host, and the helpers
+      have to be callable from here anyway. */
+   vta->arch_host        = VexArchAMD64;
+   vta->archinfo_host    = vai_amd64;
+   vta->abiinfo_both     = vbi;
+   vta->guest_bytes      = origbuf;
+   vta->guest_extents    = &vge;
+   vta->host_bytes       = transbuf;
+   vta->host_bytes_size  = N_TRANSBUF;
+   vta->chase_into_ok    = chase_into_not_ok;
+   vta->needs_self_check = needs_self_check;
+   vta->sigill_diag      = False;
+   vta->ir_pass_done     = pass_done;
+   vta->disp_cp_chain_me_to_slowEP = (void*)0x12345678;
+   vta->disp_cp_chain_me_to_fastEP = (void*)0x12345679;
+   vta->disp_cp_xindir             = (void*)0x1234567A;
+   vta->disp_cp_xassisted          = (void*)0x1234567B;
+}
+
+/* Translate, putting up with failures in the back end, which come
+   after all the IR has been checked. */
+static Bool translate ( VexTranslateArgs* vta )
+{
+   in_backend = False;
+   if (sigsetjmp(backend_jmp, 1)) {
+      in_backend = False;
+      n_backend_failed++;
+      return True;
+   }
+   return LibVEX_Translate(vta).status == VexTransOK;
+}
+
+/* Translate the block in origbuf at every setting.  Returns the
+   number of guest bytes it covers at the first one, or 0 if that
+   failed. */
+static Int validate_block ( VexTranslateArgs* vta, Addr addr )
+{
+   VexControl vcon;
+   UInt       c;
+   Int        used, len = 0, s;
+
+   block_addr = addr;
+   have_ref   = False;
+   vta->guest_bytes_addr = addr;
+   vta->host_bytes_used  = &used;
+
+   for (c = 0; c < N_CONFIGS; c++) {
+      LibVEX_default_VexControl(&vcon);
+      vcon.iropt_level         = configs[c].iropt_level;
+      vcon.iropt_unroll_thresh = configs[c].unroll_thresh;
+      vcon.iropt_slp_level     = configs[c].slp_level;
+      vcon.guest_chase_cond    = configs[c].chase_cond;
+      LibVEX_Update_Control(&vcon);
+
+      cur_config = &configs[c];
+      if (!translate(vta)) {
+         n_failed++;
+         break;
+      }
+      if (c == 0) {
+         len = vge.len[0];
+         if (cur_skip) {
+            n_skipped++;
+            break;
+         }
+      }
+   }
+   for (s = 0; s < opt_states; s++) {
+      free_outcome(&ref_out[s]);
+      free_outcome(&own_out[s]);
+      free_outcome(&own_iter[s]);
+   }
+   n_blocks++;
+   return len;
+}
+
+static Bool parse_opt ( const HChar* arg, const HChar* name,
+                        /*OUT*/const HChar** val )
+{
+   SizeT len = strlen(name);
+   if (0 != strncmp(arg, name, len) || arg[len] != '=')
+      return False;
+   *val = arg + len + 1;
+   return True;
+}
+
+int main ( int argc, char** argv )
+{
+   const HChar* input = NULL;
+   const HChar* v;
+   VexControl   vcon;
+   VexTranslateArgs vta;
+   Int          i;
+
+   for (i = 1; i < argc; i++) {
+      if (parse_opt(argv[i], "--raw", &v)) { opt_raw = v; continue; }
+      if (parse_opt(argv[i], "--base", &v)) {
+         opt_base = strtoull(v, NULL, 0); continue;
+      }
+      if (parse_opt(argv[i], "--guest", &v)) {
+         if (0 == strcmp(v, "amd64"))    opt_guest = VexArchAMD64;
+         else if (0 == strcmp(v, "x86")) opt_guest = VexArchX86;
+         else usage();
+         continue;
+      }
+      if (parse_opt(argv[i], "--states", &v)) {
+         opt_states = atoi(v); continue;
+      }
+      if (parse_opt(argv[i], "--blocks", &v)) {
+         opt_blocks = atoi(v); continue;
+      }
+      if (parse_opt(argv[i], "--seed", &v)) {
+         opt_seed = atoi(v); continue;
+      }
+      if (0 == strcmp(argv[i], "--show")) { opt_show = True; continue; }
+      if (argv[i][0] == '-' || input)
+         usage();
+      input = argv[i];
+   }
+   if ((input == NULL) == (opt_raw == NULL) || opt_states < 1)
+      usage();
+   if (sizeof(void*) != 8) {
+      fprintf(stderr, "irvalidate: needs a 64-bit host\n");
+      exit(1);
+   }
+
+   signal(SIGSEGV, fault_handler);
+   signal(SIGBUS,  fault_handler);
+   signal(SIGFPE,  fault_handler);
+
+   ref_out  = calloc(opt_states, sizeof(Outcome));
+   own_out  = calloc(opt_states, sizeof(Outcome));
+   own_iter = calloc(opt_states, sizeof(Outcome));
+   assert(ref_out && own_out && own_iter);
+
+   LibVEX_default_VexControl(&vcon);
+   LibVEX_Init(failure_exit, log_bytes, 0, &vcon);
+
+   if (opt_raw) {
+      FILE* f = fopen(opt_raw, "rb");
+      UChar* raw;
+      long   size, off = 0;
+      if (!f) {
+         fprintf(stderr, "can't open `%s'\n", opt_raw);
+         exit(1);
+      }
+      fseek(f, 0, SEEK_END);
+      size = ftell(f);
+      fseek(f, 0, SEEK_SET);
+      raw = calloc(size + N_ORIGBUF, 1);
+      assert(raw && size == (long)fread(raw, 1, size, f));
+      fclose(f);
+      guest_word_ty = opt_guest == VexArchAMD64 ? Ity_I64 : Ity_I32;
+      gst_szB = opt_guest == VexArchAMD64 ? sizeof(VexGuestAMD64State)
+                                          : sizeof(VexGuestX86State);
+      gst = malloc(gst_szB);
+      setup_translation(&vta);
+      for (block_no = 0; off < size && block_no < opt_blocks; block_no++) {
+         Int len;
+         memcpy(origbuf, raw + off, N_ORIGBUF);
+         len = validate_block(&vta, (Addr)(opt_base + off));
+         off += len > 0 ? len : 1;
+      }
+      free(raw);
+   } else {
+      FILE*     f = NULL;
+      VexCorpus corpus;
+      Bool      use_corpus = vex_corpus_is_corpus(input);
+      Addr      addr;
+      Int       nbytes;
+      if (use_corpus) {
+         if (!vex_corpus_open(&corpus, input))
+            exit(1);
+         if (corpus.info.arch == VexArchAMD64
+             || corpus.info.arch == VexArchX86)
+            opt_guest = corpus.info.arch;
+      } else if (!(f = fopen(input, "r"))) {
+         fprintf(stderr, "can't open `%s'\n", input);
+         exit(1);
+      }
+      guest_word_ty = opt_guest == VexArchAMD64 ? Ity_I64 : Ity_I32;
+      gst_szB = opt_guest == VexArchAMD64 ? sizeof(VexGuestAMD64State)
+                                          : sizeof(VexGuestX86State);
+      gst = malloc(gst_szB);
+      setup_translation(&vta);
+      for (block_no = 0;
+           block_no < opt_blocks
+           && next_block(f, use_corpus ? &corpus : NULL, &addr, &nbytes);
+           block_no++)
+         validate_block(&vta, addr);
+      if (use_corpus) {
+         Bool bad = corpus.bad;
+         vex_corpus_close(&corpus);
+         if (bad)
+            exit(1);
+      } else {
+         fclose(f);
+      }
+   }
+
+   printf("%u blocks, %u skipped, %u failed to translate, %u in the back "
+          "end; %u runs, %u dropped; %u divergences\n",
+          n_blocks, n_skipped, n_failed, n_backend_failed,
+          n_runs, n_dropped, n_diverged);
+   return n_diverged > 0 ? 1 : 0;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                        irvalidate.c ---*/
+/*---------------------------------------------------------------*/
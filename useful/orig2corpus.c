@@ -0,0 +1,288 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                     orig2corpus.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Converts a text corpus of guest blocks into the binary format
+   described in vex_corpus.h.  Three inputs are understood:
+
+   .orig    pairs of lines
+               . bb-number bb-addr n-bytes [weight]
+               . byte byte byte ...
+            as read by test_main.c.  The optional weight is an
+            execution count; it defaults to 1.
+
+   .sorted  one instruction per line, "HEXBYTES disassembly", as in
+            orig_amd64/.  Each becomes a block at 0x12345678 with a
+            trailing ret, exactly as SortedToOrig.hs does.
+
+   smchash  "GuestBytes addr n-bytes byte byte ... checksum" lines, as
+            read by smchash.c.
+
+   The format is worked out from the first line that starts with '.'
+   or "GuestBytes"; if there is none, the input is taken to be a
+   .sorted file.  The guest arch is taken from --arch=, or else
+   guessed from an "orig_<arch>" component of the input path.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "libvex_basictypes.h"
+#include "libvex.h"
+
+#include "vex_corpus.h"
+
+#define N_LINEBUF 100000
+static HChar linebuf[N_LINEBUF];
+
+#define N_BLOCKBUF 10000
+static UChar blockbuf[N_BLOCKBUF];
+
+static const struct {
+   const HChar* name;
+   VexArch      arch;
+   VexEndness   endness;
+}
+archs[] = {
+   { "x86",    VexArchX86,    VexEndnessLE },
+   { "amd64",  VexArchAMD64,  VexEndnessLE },
+   { "arm",    VexArchARM,    VexEndnessLE },
+   { "arm64",  VexArchARM64,  VexEndnessLE },
+   { "ppc32",  VexArchPPC32,  VexEndnessBE },
+   { "ppc64",  VexArchPPC64,  VexEndnessBE },
+   { "s390x",  VexArchS390X,  VexEndnessBE },
+   { "mips32", VexArchMIPS32, VexEndnessLE },
+   { "mips64", VexArchMIPS64, VexEndnessLE },
+};
+#define N_ARCHS (sizeof(archs) / sizeof(archs[0]))
+
+__attribute__ ((noreturn))
+static void usage ( void )
+{
+   fprintf(stderr,
+           "usage: orig2corpus [--arch=NAME] [--hwcaps=N] "
+           "input output.corpus\n");
+   exit(1);
+}
+
+static Int find_arch ( const HChar* name, SizeT len )
+{
+   Int i;
+   for (i = 0; i < N_ARCHS; i++)
+      if (strlen(archs[i].name) == len
+          && 0 == strncmp(archs[i].name, name, len))
+         return i;
+   return -1;
+}
+
+/* Look for "orig_<arch>" in 'path'. */
+static Int guess_arch ( const HChar* path )
+{
+   const HChar* p = strstr(path, "orig_");
+   SizeT len;
+   if (!p)
+      return -1;
+   p += 5;
+   len = 0;
+   while (isalnum((UChar)p[len]))
+      len++;
+   return find_arch(p, len);
+}
+
+static Int hexval ( HChar c )
+{
+   if (c >= '0' && c <= '9') return c - '0';
+   if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+   if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+   return -1;
+}
+
+static Bool is_blank ( const HChar* s )
+{
+   while (isspace((UChar)*s))
+      s++;
+   return *s == 0;
+}
+
+
+/* ". bb-number bb-addr n-bytes [weight]" / ". byte byte ..." */
+static void convert_orig ( FILE* f, VexCorpusWriter* w )
+{
+   Int   i, bb_number, nbytes, n;
+   UInt  u, weight;
+   ULong addr;
+
+   while (fgets(linebuf, N_LINEBUF, f)) {
+      if (linebuf[0] != '.')
+         continue;
+      weight = 1;
+      n = sscanf(&linebuf[1], " %d %llx %d %u",
+                 &bb_number, &addr, &nbytes, &weight);
+      assert(n == 3 || n == 4);
+      assert(nbytes >= 1 && nbytes <= N_BLOCKBUF);
+      if (!fgets(linebuf, N_LINEBUF, f) || linebuf[0] != '.') {
+         fprintf(stderr, "orig2corpus: block %d has no bytes line\n",
+                 bb_number);
+         exit(1);
+      }
+      for (i = 0; i < nbytes; i++) {
+         n = sscanf(&linebuf[2 + 3*i], "%x", &u);
+         assert(n == 1);
+         blockbuf[i] = (UChar)u;
+      }
+      vex_corpus_add(w, addr, blockbuf, nbytes, weight);
+   }
+}
+
+/* "HEXBYTES disassembly" */
+static void convert_sorted ( FILE* f, VexCorpusWriter* w )
+{
+   Int nbytes;
+   const HChar* p;
+
+   while (fgets(linebuf, N_LINEBUF, f)) {
+      if (is_blank(linebuf))
+         continue;
+      nbytes = 0;
+      for (p = linebuf; hexval(p[0]) >= 0 && hexval(p[1]) >= 0; p += 2) {
+         assert(nbytes < N_BLOCKBUF - 1);
+         blockbuf[nbytes++] = (UChar)(16 * hexval(p[0]) + hexval(p[1]));
+      }
+      assert(nbytes > 0);
+      blockbuf[nbytes++] = 0xC3;   /* ret */
+      vex_corpus_add(w, 0x12345678ULL, blockbuf, nbytes, 1);
+   }
+}
+
+/* "GuestBytes addr n-bytes byte byte ... checksum" */
+static void convert_guestbytes ( FILE* f, VexCorpusWriter* w )
+{
+   Int   i, nbytes, n;
+   UInt  b, csum, esum;
+   ULong addr;
+
+   while (2 == fscanf(f, " GuestBytes %llx %d", &addr, &nbytes)) {
+      assert(nbytes > 0 && nbytes <= N_BLOCKBUF);
+      csum = 0;
+      for (i = 0; i < nbytes; i++) {
+         n = fscanf(f, "%x", &b);
+         assert(n == 1);
+         blockbuf[i] = (UChar)b;
+         csum = (csum << 1) ^ b;
+      }
+      n = fscanf(f, "%x", &esum);
+      assert(n == 1);
+      if (esum != csum) {
+         fprintf(stderr, "orig2corpus: bad checksum for block at 0x%llx\n",
+                 addr);
+         exit(1);
+      }
+      vex_corpus_add(w, addr, blockbuf, nbytes, 1);
+   }
+}
+
+
+int main ( int argc, char** argv )
+{
+   FILE*           f;
+   VexCorpusWriter w;
+   Int             i, a = -1;
+   HChar           fmt;
+   UInt            hwcaps = 0;
+   const HChar*    in  = NULL;
+   const HChar*    out = NULL;
+
+   for (i = 1; i < argc; i++) {
+      if (0 == strncmp(argv[i], "--arch=", 7)) {
+         a = find_arch(argv[i] + 7, strlen(argv[i] + 7));
+         if (a < 0) {
+            fprintf(stderr, "orig2corpus: unknown arch `%s'\n", argv[i] + 7);
+            exit(1);
+         }
+      }
+      else if (0 == strncmp(argv[i], "--hwcaps=", 9))
+         hwcaps = (UInt)strtoul(argv[i] + 9, NULL, 0);
+      else if (!in)
+         in = argv[i];
+      else if (!out)
+         out = argv[i];
+      else
+         usage();
+   }
+   if (!in || !out)
+      usage();
+   if (a < 0)
+      a = guess_arch(in);
+
+   f = fopen(in, "r");
+   if (!f) {
+      fprintf(stderr, "orig2corpus: can't open `%s'\n", in);
+      exit(1);
+   }
+   if (!vex_corpus_create(&w, out, a < 0 ? 0 : archs[a].arch, hwcaps,
+                          a < 0 ? 0 : archs[a].endness))
+      exit(1);
+
+   /* .orig files are interleaved with disassembly and IR dumps, so
+      decide on the format from the first line that starts with '.'
+      or "GuestBytes".  If there is none, it's a .sorted file. */
+   fmt = 's';
+   while (fgets(linebuf, N_LINEBUF, f)) {
+      if (linebuf[0] == '.') {
+         fmt = 'o';
+         break;
+      }
+      if (0 == strncmp(linebuf, "GuestBytes", 10)) {
+         fmt = 'g';
+         break;
+      }
+   }
+   rewind(f);
+   switch (fmt) {
+      case 'o': convert_orig(f, &w); break;
+      case 'g': convert_guestbytes(f, &w); break;
+      default:  convert_sorted(f, &w); break;
+   }
+   fclose(f);
+
+   if (!vex_corpus_finish(&w)) {
+      fprintf(stderr, "orig2corpus: error writing `%s'\n", out);
+      exit(1);
+   }
+   printf("%s: %u blocks%s%s\n", out, w.info.n_blocks,
+          a < 0 ? "" : ", ", a < 0 ? "" : archs[a].name);
+   return 0;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                       orig2corpus.c ---*/
+/*---------------------------------------------------------------*/
@@ -0,0 +1,212 @@
+/*---------------------------------------------------------------*/
+/*--- begin                                       ppcstring.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Translates the ppc string instructions -- lswi, stswi, lswx and
+   stswx -- for a ppc32 guest on a ppc32 host, one per block, and
+   reports any that fail.  The immediate forms are done for byte
+   counts 1 to 7 and 31, which between them take every path through
+   generate_lsw_imm and generate_stsw_imm, and the indexed forms,
+   whose count is only known at run time, once each; all of them
+   starting at r3, at r30 so that the registers wrap round to r0, and
+   at r31.  The code is only generated, never run, so this works on
+   any host.
+
+      ppcstring [--iropt=N] [--show]
+
+      --iropt=N      iropt level (default 2)
+      --show         trace the IR and the host code for each block
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libvex_basictypes.h"
+#include "libvex.h"
+
+#define N_TRANSBUF  20000
+
+static Int  opt_iropt = 2;
+static Bool opt_show  = False;
+
+static UChar        guestbuf[8];
+static UChar        transbuf[N_TRANSBUF];
+static const HChar* cur_name;
+static Int          cur_count;
+static Int          cur_reg;
+
+__attribute__ ((noreturn))
+static void failure_exit ( void )
+{
+   fprintf(stderr, "ppcstring: LibVEX failed on %s r%d, count %d\n",
+           cur_name, cur_reg, cur_count);
+   exit(1);
+}
+
+static void log_bytes ( const HChar* bytes, SizeT nbytes )
+{
+   fwrite(bytes, 1, nbytes, stdout);
+}
+
+static Bool chase_into_ok ( void* opaque, Addr addr )
+{
+   return False;
+}
+
+static UInt needs_self_check ( void* opaque, VexRegisterUpdates* pxControl,
+                               const VexGuestExtents* vge )
+{
+   return 0;
+}
+
+/* Never called: the blocks are not run. */
+static void dispatcher ( void ) { }
+
+static void put_be32 ( UChar* p, UInt w )
+{
+   p[0] = (UChar)(w >> 24);
+   p[1] = (UChar)(w >> 16);
+   p[2] = (UChar)(w >> 8);
+   p[3] = (UChar)w;
+}
+
+/* The X-form instruction with primary opcode 31, extended opcode
+   |xo|, and fields |rt|, |ra| and |rb|. */
+static UInt x_form ( UInt xo, UInt rt, UInt ra, UInt rb )
+{
+   return (31U << 26) | (rt << 21) | (ra << 16) | (rb << 11) | (xo << 1);
+}
+
+/* Translates |insn|, followed by a blr, as a block at 0x10000.
+   Returns True if it was translated. */
+static Bool translate_one ( VexTranslateArgs* vta, UInt insn )
+{
+   VexTranslateResult res;
+
+   put_be32(&guestbuf[0], insn);
+   put_be32(&guestbuf[4], 0x4E800020);   /* blr */
+   res = LibVEX_Translate(vta);
+   return res.status == VexTransOK;
+}
+
+int main ( int argc, char** argv )
+{
+   static const Int counts[] = { 1, 2, 3, 4, 5, 6, 7, 31 };
+   static const Int regs[]   = { 3, 30, 31 };
+   static const struct {
+      const HChar* name;
+      UInt         xo;
+      Bool         indexed;
+   } insns[] = {
+      { "lswi",  0x255, False },
+      { "stswi", 0x2D5, False },
+      { "lswx",  0x215, True  },
+      { "stswx", 0x295, True  },
+   };
+
+   VexControl       vcon;
+   VexArchInfo      vai;
+   VexAbiInfo       vbi;
+   VexGuestExtents  vge;
+   VexTranslateArgs vta;
+   Int              i, j, k, used, n_ok = 0, n_failed = 0;
+
+   for (i = 1; i < argc; i++) {
+      if (0 == strncmp(argv[i], "--iropt=", 8)) {
+         opt_iropt = atoi(argv[i] + 8);
+      } else if (0 == strcmp(argv[i], "--show")) {
+         opt_show = True;
+      } else {
+         fprintf(stderr, "usage: ppcstring [--iropt=N] [--show]\n");
+         exit(1);
+      }
+   }
+
+   LibVEX_default_VexControl(&vcon);
+   vcon.iropt_level = opt_iropt;
+   LibVEX_Init(failure_exit, log_bytes, 0, &vcon);
+
+   LibVEX_default_VexArchInfo(&vai);
+   vai.endness             = VexEndnessBE;
+   vai.hwcaps              = VEX_HWCAPS_PPC32_F | VEX_HWCAPS_PPC32_V
+                             | VEX_HWCAPS_PPC32_FX | VEX_HWCAPS_PPC32_GX;
+   vai.ppc_icache_line_szB = 128;
+   vai.ppc_dcbz_szB        = 128;
+   LibVEX_default_VexAbiInfo(&vbi);
+
+   memset(&vta, 0, sizeof(vta));
+   vta.arch_guest                 = VexArchPPC32;
+   vta.archinfo_guest             = vai;
+   vta.arch_host                  = VexArchPPC32;
+   vta.archinfo_host              = vai;
+   vta.abiinfo_both               = vbi;
+   vta.guest_bytes                = guestbuf;
+   vta.guest_bytes_addr           = 0x10000;
+   vta.chase_into_ok              = chase_into_ok;
+   vta.guest_extents              = &vge;
+   vta.host_bytes                 = transbuf;
+   vta.host_bytes_size            = N_TRANSBUF;
+   vta.host_bytes_used            = &used;
+   vta.needs_self_check           = needs_self_check;
+   vta.traceflags                 = opt_show ? (1 << 7) | (1 << 2) : 0;
+   vta.disp_cp_chain_me_to_slowEP = (void*)dispatcher;
+   vta.disp_cp_chain_me_to_fastEP = (void*)dispatcher;
+   vta.disp_cp_xindir             = (void*)dispatcher;
+   vta.disp_cp_xassisted          = (void*)dispatcher;
+
+   for (i = 0; i < sizeof(insns) / sizeof(insns[0]); i++) {
+      for (j = 0; j < sizeof(regs) / sizeof(regs[0]); j++) {
+         for (k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+            /* The indexed forms take their count from XER; r4 and
+               r5 are the address operands. */
+            cur_name  = insns[i].name;
+            cur_reg   = regs[j];
+            cur_count = insns[i].indexed ? -1 : counts[k];
+            if (translate_one(&vta,
+                              x_form(insns[i].xo, regs[j], 4,
+                                     insns[i].indexed ? 5 : counts[k]))) {
+               n_ok++;
+            } else {
+               printf("%s r%d, count %d: not translated\n",
+                      cur_name, cur_reg, cur_count);
+               n_failed++;
+            }
+            if (insns[i].indexed)
+               break;
+         }
+      }
+   }
+
+   printf("%d translated, %d not\n", n_ok, n_failed);
+   return n_failed == 0 ? 0 : 1;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                         ppcstring.c ---*/
+/*---------------------------------------------------------------*/
@@ -1,12 +1,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
-typedef  signed int              Int;
-typedef  unsigned int            UInt;
-typedef  unsigned long long int  Addr64;
-typedef  unsigned char           UChar;
+#include "libvex_basictypes.h"
+#include "vex_corpus.h"
+
 typedef  unsigned long int       UWord;
 
 static inline UInt ROL32 ( UInt x, UInt n ) {
@@ -85,6 +85,29 @@ void apply_to_all ( FILE* f,
   }
 }
 
+/* Same, but taking the blocks from a binary corpus.  The bytes are
+   copied out of the (read-only) mapping since the tests modify them,
+   and placed at the same alignment as the guest address. */
+void apply_to_all_corpus ( VexCorpus* c,
+                           void(*fn)( GuestBytes*, void* ),
+                           void* opaque )
+{
+  VexCorpusBlock b;
+  GuestBytes gb;
+  while (vex_corpus_next(c, &b)) {
+    assert(b.addr != 0);
+    assert(b.n_bytes > 0);
+    gb.ga     = b.addr;
+    gb.nbytes = b.n_bytes;
+    gb.bytes  = malloc(b.n_bytes + (b.addr & 3));
+    assert(gb.bytes);
+    gb.actual = gb.bytes + (b.addr & 3);
+    memcpy(gb.actual, b.bytes, b.n_bytes);
+    fn( &gb, opaque );
+    free(gb.bytes);
+  }
+}
+
 //////////////////////////////////////////////////////////
 
 UInt hash_const_zero ( GuestBytes* gb ) {
@@ -312,10 +335,24 @@ void try_onebit_changes( GuestBytes* gb, void* opaque )
 
 //////////////////////////////////////////////////////////
 
-int main ( void )
+/* Reads "GuestBytes" lines from stdin, or a binary corpus named
+   on the command line. */
+int main ( int argc, char** argv )
 {
-  FILE* f = stdin;
-  apply_to_all(f, try_onebit_changes, NULL);
+  if (argc > 1) {
+    VexCorpus c;
+    Bool bad;
+    if (!vex_corpus_open(&c, argv[1]))
+      return 1;
+    apply_to_all_corpus(&c, try_onebit_changes, NULL);
+    bad = c.bad;
+    vex_corpus_close(&c);
+    if (bad)
+      return 1;
+  } else {
+    FILE* f = stdin;
+    apply_to_all(f, try_onebit_changes, NULL);
+  }
   printf("\n%d blocks,  %d with a zero,  %5.2f avg avg\n\n",
          toc_nblocks, toc_nblocks_with_zero, toc_sum_of_avgs / (double)toc_nblocks );
   return 0;
@@ -42,6 +42,7 @@
 #include "libvex.h"
 
 #include "test_main.h"
+#include "vex_corpus.h"
 
 
 /*---------------------------------------------------------------*/
@@ -92,11 +93,80 @@ static UInt needs_self_check ( void *closureV, VexRegisterUpdates *pxControl,
    return 0;
 }
 
+static Bool is_64bit_arch ( VexArch arch )
+{
+   return arch == VexArchAMD64 || arch == VexArchPPC64
+          || arch == VexArchARM64 || arch == VexArchS390X
+          || arch == VexArchMIPS64;
+}
+
+/* Fetch the next block into origbuf[18 ..], either from a binary
+   corpus (if 'corpus' is non-NULL) or from a text .orig file.
+   Returns False at the end of the input. */
+static Bool next_block ( FILE* f, VexCorpus* corpus,
+                         /*OUT*/Int* bb_number, /*OUT*/Addr32* orig_addr,
+                         /*OUT*/Int* orig_nbytes )
+{
+   Int  i;
+   UInt u;
+
+   /* thumb ITstate analysis needs to examine the 18 bytes
+      preceding the first instruction.  So let's leave the first 18
+      zeroed out. */
+   memset(origbuf, 0, sizeof(origbuf));
+
+   if (corpus) {
+      VexCorpusBlock b;
+      if (!vex_corpus_next(corpus, &b))
+         return False;
+      *bb_number   = corpus->n_read - 1;
+      *orig_addr   = (Addr32)b.addr;
+      *orig_nbytes = b.n_bytes;
+      if (b.n_bytes > N_ORIGBUF - 18) {
+         fprintf(stderr, "block %d is too big (%u bytes)\n",
+                 *bb_number, b.n_bytes);
+         exit(1);
+      }
+      memcpy(&origbuf[18], b.bytes, b.n_bytes);
+      return True;
+   }
+
+   while (!feof(f)) {
+
+      linebuf[0] = 0;
+      __attribute__((unused))
+      char* unused1 = fgets(linebuf, N_LINEBUF,f);
+      if (linebuf[0] == 0) continue;
+      if (linebuf[0] != '.') continue;
+
+      /* first line is:   . bb-number bb-addr n-bytes */
+      assert(3 == sscanf(&linebuf[1], " %d %x %d\n", 
+                                 bb_number,
+                                 orig_addr, orig_nbytes ));
+      assert(*orig_nbytes >= 1);
+      assert(!feof(f));
+      __attribute__((unused))
+      char* unused2 = fgets(linebuf, N_LINEBUF,f);
+      assert(linebuf[0] == '.');
+
+      /* second line is:   . byte byte byte etc */
+      assert(*orig_nbytes >= 1 && *orig_nbytes <= N_ORIGBUF - 18);
+      for (i = 0; i < *orig_nbytes; i++) {
+         assert(1 == sscanf(&linebuf[2 + 3*i], "%x", &u));
+         origbuf[18+ i] = (UChar)u;
+      }
+      return True;
+   }
+   return False;
+}
+
 int main ( int argc, char** argv )
 {
-   FILE* f;
+   FILE* f = NULL;
+   VexCorpus corpus;
+   Bool use_corpus;
    Int i;
-   UInt u, sum;
+   UInt sum;
    Addr32 orig_addr;
    Int bb_number, n_bbs_done = 0;
    Int orig_nbytes, trans_used;
@@ -108,13 +178,19 @@ int main ( int argc, char** argv )
    VexTranslateArgs vta;
 
    if (argc != 2) {
-      fprintf(stderr, "usage: vex file.orig\n");
+      fprintf(stderr, "usage: vex file.orig|file.corpus\n");
       exit(1);
    }
-   f = fopen(argv[1], "r");
-   if (!f) {
-      fprintf(stderr, "can't open `%s'\n", argv[1]);
-      exit(1);
+   use_corpus = vex_corpus_is_corpus(argv[1]);
+   if (use_corpus) {
+      if (!vex_corpus_open(&corpus, argv[1]))
+         exit(1);
+   } else {
+      f = fopen(argv[1], "r");
+      if (!f) {
+         fprintf(stderr, "can't open `%s'\n", argv[1]);
+         exit(1);
+      }
    }
 
    /* Run with default params.  However, we can't allow bb chasing
@@ -131,43 +207,16 @@ int main ( int argc, char** argv )
                  &vcon );
 
 
-   while (!feof(f)) {
+   while (n_bbs_done < TEST_N_BBS
+          && next_block(f, use_corpus ? &corpus : NULL,
+                        &bb_number, &orig_addr, &orig_nbytes)) {
 
-      __attribute__((unused))
-      char* unused1 = fgets(linebuf, N_LINEBUF,f);
-      if (linebuf[0] == 0) continue;
-      if (linebuf[0] != '.') continue;
-
-      if (n_bbs_done == TEST_N_BBS) break;
       n_bbs_done++;
-
-      /* first line is:   . bb-number bb-addr n-bytes */
-      assert(3 == sscanf(&linebuf[1], " %d %x %d\n", 
-                                 & bb_number,
-                                 & orig_addr, & orig_nbytes ));
-      assert(orig_nbytes >= 1);
-      assert(!feof(f));
-      __attribute__((unused))
-      char* unused2 = fgets(linebuf, N_LINEBUF,f);
-      assert(linebuf[0] == '.');
-
-      /* second line is:   . byte byte byte etc */
       if (verbose)
          printf("============ Basic Block %d, Done %d, "
                 "Start %x, nbytes %2d ============", 
                 bb_number, n_bbs_done-1, orig_addr, orig_nbytes);
 
-      /* thumb ITstate analysis needs to examine the 18 bytes
-         preceding the first instruction.  So let's leave the first 18
-         zeroed out. */
-      memset(origbuf, 0, sizeof(origbuf));
-
-      assert(orig_nbytes >= 1 && orig_nbytes <= N_ORIGBUF);
-      for (i = 0; i < orig_nbytes; i++) {
-         assert(1 == sscanf(&linebuf[2 + 3*i], "%x", &u));
-         origbuf[18+ i] = (UChar)u;
-      }
-
       /* FIXME: put sensible values into the .hwcaps fields */
       LibVEX_default_VexArchInfo(&vai_x86);
       vai_x86.hwcaps = VEX_HWCAPS_X86_MMXEXT | VEX_HWCAPS_X86_SSE1
@@ -202,6 +251,7 @@ int main ( int argc, char** argv )
       vta.guest_bytes_addr = orig_addr;
       vta.callback_opaque = NULL;
       vta.chase_into_ok   = chase_into_not_ok;
+      vta.guess_indirect_target = NULL;
       vta.guest_extents   = &vge;
       vta.host_bytes      = transbuf;
       vta.host_bytes_size = N_TRANSBUF;
@@ -248,6 +298,33 @@ int main ( int argc, char** argv )
       vta.guest_bytes_addr = (Addr) &origbuf[18 +1];
 #endif
 
+      /* A corpus that says what it holds overrides the guest chosen
+         above.  Zero hwcaps or endness mean the corpus doesn't say,
+         so the defaults for that arch stay. */
+      if (use_corpus && corpus.info.arch != 0) {
+         vta.arch_guest = corpus.info.arch;
+         switch (vta.arch_guest) {
+            case VexArchX86:    vta.archinfo_guest = vai_x86;    break;
+            case VexArchAMD64:  vta.archinfo_guest = vai_amd64;  break;
+            case VexArchPPC32:  vta.archinfo_guest = vai_ppc32;  break;
+            case VexArchARM:    vta.archinfo_guest = vai_arm;    break;
+            case VexArchMIPS32: vta.archinfo_guest = vai_mips32; break;
+            case VexArchMIPS64: vta.archinfo_guest = vai_mips64; break;
+            default: LibVEX_default_VexArchInfo(&vta.archinfo_guest);
+         }
+         if (corpus.info.hwcaps != 0)
+            vta.archinfo_guest.hwcaps = corpus.info.hwcaps;
+         if (corpus.info.endness != 0)
+            vta.archinfo_guest.endness = corpus.info.endness;
+         if (is_64bit_arch(vta.arch_guest) && !is_64bit_arch(vta.arch_host)) {
+            fprintf(stderr, "can't translate %s code for a %s host; "
+                            "pick a 64-bit host above\n",
+                    LibVEX_ppVexArch(vta.arch_guest),
+                    LibVEX_ppVexArch(vta.arch_host));
+            exit(1);
+         }
+      }
+
 #if 1 /* no instrumentation */
       vta.instrument1     = NULL;
       vta.instrument2     = NULL;
@@ -264,6 +341,7 @@ int main ( int argc, char** argv )
       vta.preamble_function = NULL;
       vta.traceflags      = TEST_FLAGS;
       vta.addProfInc      = False;
+      vta.exit_sites      = NULL;
       vta.sigill_diag     = True;
 
       vta.disp_cp_chain_me_to_slowEP = (void*)0x12345678;
@@ -272,6 +350,7 @@ int main ( int argc, char** argv )
       vta.disp_cp_xassisted          = (void*)0x1234567B;
 
       vta.finaltidy = NULL;
+      vta.ir_pass_done = NULL;
 
       for (i = 0; i < TEST_N_ITERS; i++)
          tres = LibVEX_Translate ( &vta );
@@ -290,7 +369,14 @@ int main ( int argc, char** argv )
                (double)trans_used / (double)vge.len[0], sum );
    }
 
-   fclose(f);
+   if (use_corpus) {
+      Bool bad = corpus.bad;
+      vex_corpus_close(&corpus);
+      if (bad)
+         exit(1);
+   } else {
+      fclose(f);
+   }
    printf("\n");
    LibVEX_ShowAllocStats();
 
@@ -0,0 +1,264 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                      vex_corpus.c ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* See vex_corpus.h for the file format. */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "vex_corpus.h"
+
+
+/*---------------------------------------------------------------*/
+/*--- Little-endian field access                              ---*/
+/*---------------------------------------------------------------*/
+
+static UInt get32 ( const UChar* p )
+{
+   return (UInt)p[0] | ((UInt)p[1] << 8)
+          | ((UInt)p[2] << 16) | ((UInt)p[3] << 24);
+}
+
+static ULong get64 ( const UChar* p )
+{
+   return (ULong)get32(p) | ((ULong)get32(p+4) << 32);
+}
+
+static void put32 ( UChar* p, UInt w )
+{
+   p[0] = (UChar)w;         p[1] = (UChar)(w >> 8);
+   p[2] = (UChar)(w >> 16); p[3] = (UChar)(w >> 24);
+}
+
+static void put64 ( UChar* p, ULong w )
+{
+   put32(p, (UInt)w);
+   put32(p+4, (UInt)(w >> 32));
+}
+
+static SizeT roundUp8 ( SizeT n )
+{
+   return (n + 7) & ~(SizeT)7;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Reading                                                 ---*/
+/*---------------------------------------------------------------*/
+
+Bool vex_corpus_is_corpus ( const HChar* path )
+{
+   UChar magic[8];
+   Bool  ok = False;
+   FILE* f  = fopen(path, "rb");
+   if (!f)
+      return False;
+   if (fread(magic, 1, 8, f) == 8
+       && 0 == memcmp(magic, VEX_CORPUS_MAGIC, 8))
+      ok = True;
+   fclose(f);
+   return ok;
+}
+
+Bool vex_corpus_open ( /*OUT*/VexCorpus* c, const HChar* path )
+{
+   struct stat st;
+   void* m;
+   Int   fd;
+
+   memset(c, 0, sizeof(*c));
+   fd = open(path, O_RDONLY);
+   if (fd < 0) {
+      fprintf(stderr, "vex_corpus: can't open `%s'\n", path);
+      return False;
+   }
+   if (fstat(fd, &st) != 0 || st.st_size < VEX_CORPUS_HDR_SZB) {
+      fprintf(stderr, "vex_corpus: `%s' is too short\n", path);
+      close(fd);
+      return False;
+   }
+   m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (m == MAP_FAILED) {
+      fprintf(stderr, "vex_corpus: can't mmap `%s'\n", path);
+      return False;
+   }
+
+   c->base = m;
+   c->size = (SizeT)st.st_size;
+   if (0 != memcmp(c->base, VEX_CORPUS_MAGIC, 8)
+       || get32(c->base + 8) != VEX_CORPUS_VERSION) {
+      fprintf(stderr, "vex_corpus: `%s' is not a version %d corpus\n",
+              path, VEX_CORPUS_VERSION);
+      vex_corpus_close(c);
+      return False;
+   }
+   c->info.arch     = get32(c->base + 12);
+   c->info.hwcaps   = get32(c->base + 16);
+   c->info.endness  = get32(c->base + 20);
+   c->info.n_blocks = get32(c->base + 24);
+   vex_corpus_rewind(c);
+   return True;
+}
+
+void vex_corpus_close ( VexCorpus* c )
+{
+   if (c->base)
+      munmap((void*)c->base, c->size);
+   memset(c, 0, sizeof(*c));
+}
+
+void vex_corpus_rewind ( VexCorpus* c )
+{
+   c->cursor = VEX_CORPUS_HDR_SZB;
+   c->n_read = 0;
+   c->bad    = False;
+}
+
+Bool vex_corpus_next ( VexCorpus* c, /*OUT*/VexCorpusBlock* b )
+{
+   const UChar* rec;
+   UInt         n_bytes;
+
+   if (c->bad || c->n_read == c->info.n_blocks)
+      return False;
+
+   /* Everything is checked against the space left, so that a wild
+      byte count cannot overflow the cursor arithmetic. */
+   if (c->size - c->cursor < VEX_CORPUS_REC_SZB) {
+      fprintf(stderr, "vex_corpus: truncated at block %u of %u "
+                      "(offset %lu)\n", c->n_read, c->info.n_blocks,
+              (unsigned long)c->cursor);
+      c->bad = True;
+      return False;
+   }
+   rec     = c->base + c->cursor;
+   n_bytes = get32(rec + 8);
+   if (n_bytes == 0) {
+      fprintf(stderr, "vex_corpus: block %u (offset %lu) is empty\n",
+              c->n_read, (unsigned long)c->cursor);
+      c->bad = True;
+      return False;
+   }
+   if (c->size - c->cursor - VEX_CORPUS_REC_SZB < n_bytes) {
+      fprintf(stderr, "vex_corpus: block %u (offset %lu) of %u bytes "
+                      "runs off the end\n", c->n_read,
+              (unsigned long)c->cursor, n_bytes);
+      c->bad = True;
+      return False;
+   }
+
+   b->addr    = get64(rec);
+   b->n_bytes = n_bytes;
+   b->weight  = get32(rec + 12);
+   b->bytes   = rec + VEX_CORPUS_REC_SZB;
+
+   c->cursor += roundUp8(VEX_CORPUS_REC_SZB + (SizeT)n_bytes);
+   if (c->cursor > c->size)
+      c->cursor = c->size;   /* the last record's padding is optional */
+   c->n_read++;
+   return True;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Writing                                                 ---*/
+/*---------------------------------------------------------------*/
+
+static void write_header ( FILE* f, const VexCorpusInfo* info )
+{
+   UChar hdr[VEX_CORPUS_HDR_SZB];
+   memset(hdr, 0, sizeof(hdr));
+   memcpy(hdr, VEX_CORPUS_MAGIC, 8);
+   put32(hdr + 8,  VEX_CORPUS_VERSION);
+   put32(hdr + 12, info->arch);
+   put32(hdr + 16, info->hwcaps);
+   put32(hdr + 20, info->endness);
+   put32(hdr + 24, info->n_blocks);
+   fwrite(hdr, 1, sizeof(hdr), f);
+}
+
+Bool vex_corpus_create ( /*OUT*/VexCorpusWriter* w, const HChar* path,
+                         UInt arch, UInt hwcaps, UInt endness )
+{
+   FILE* f = fopen(path, "wb");
+   if (!f) {
+      fprintf(stderr, "vex_corpus: can't create `%s'\n", path);
+      return False;
+   }
+   w->f             = f;
+   w->info.arch     = arch;
+   w->info.hwcaps   = hwcaps;
+   w->info.endness  = endness;
+   w->info.n_blocks = 0;
+   write_header(f, &w->info);
+   return True;
+}
+
+void vex_corpus_add ( VexCorpusWriter* w, ULong addr,
+                      const UChar* bytes, UInt n_bytes, UInt weight )
+{
+   static const UChar zeroes[8] = { 0 };
+   UChar rec[VEX_CORPUS_REC_SZB];
+   SizeT pad = roundUp8(VEX_CORPUS_REC_SZB + n_bytes)
+               - (VEX_CORPUS_REC_SZB + n_bytes);
+
+   put64(rec, addr);
+   put32(rec + 8,  n_bytes);
+   put32(rec + 12, weight);
+   fwrite(rec, 1, sizeof(rec), (FILE*)w->f);
+   fwrite(bytes, 1, n_bytes, (FILE*)w->f);
+   fwrite(zeroes, 1, pad, (FILE*)w->f);
+   w->info.n_blocks++;
+}
+
+Bool vex_corpus_finish ( VexCorpusWriter* w )
+{
+   FILE* f  = (FILE*)w->f;
+   Bool  ok = True;
+   if (fseek(f, 0, SEEK_SET) != 0)
+      ok = False;
+   else
+      write_header(f, &w->info);
+   if (ferror(f))
+      ok = False;
+   if (fclose(f) != 0)
+      ok = False;
+   w->f = NULL;
+   return ok;
+}
+
+/*---------------------------------------------------------------*/
+/*--- end                                        vex_corpus.c ---*/
+/*---------------------------------------------------------------*/
@@ -0,0 +1,135 @@
+
+/*---------------------------------------------------------------*/
+/*--- begin                                      vex_corpus.h ---*/
+/*---------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2026 agent
+      agent@local
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* A compact binary format for corpora of guest code blocks, as an
+   alternative to the hex-text .orig files, and an mmap-based reader
+   for it.  Use orig2corpus to convert .orig, .sorted and smchash
+   "GuestBytes" files.
+
+   File layout.  All multi-byte fields are little-endian, regardless
+   of the host, and every record starts 8-aligned.
+
+      header, 32 bytes:
+         8  magic, VEX_CORPUS_MAGIC
+         4  version, VEX_CORPUS_VERSION
+         4  guest arch (a VexArch), or 0 if unknown
+         4  guest hwcaps
+         4  guest endness (a VexEndness), or 0 if unknown
+         4  number of block records
+         4  reserved, zero
+
+      then, for each block:
+         8  guest address
+         4  number of guest bytes, N
+         4  execution weight (1 if unknown)
+         N  guest bytes
+            zero padding up to an 8-byte boundary
+*/
+
+#ifndef __VEX_CORPUS_H
+#define __VEX_CORPUS_H
+
+#include "libvex_basictypes.h"
+
+#define VEX_CORPUS_MAGIC    "VEXCRPS\0"
+#define VEX_CORPUS_VERSION  1
+
+#define VEX_CORPUS_HDR_SZB  32
+#define VEX_CORPUS_REC_SZB  16
+
+typedef
+   struct {
+      UInt  arch;
+      UInt  hwcaps;
+      UInt  endness;
+      UInt  n_blocks;
+   }
+   VexCorpusInfo;
+
+typedef
+   struct {
+      ULong        addr;
+      UInt         n_bytes;
+      UInt         weight;
+      const UChar* bytes;   /* points into the mapping; read-only */
+   }
+   VexCorpusBlock;
+
+/* A corpus opened for reading. */
+typedef
+   struct {
+      const UChar*  base;
+      SizeT         size;
+      SizeT         cursor;   /* offset of the next record */
+      UInt          n_read;
+      Bool          bad;      /* a malformed record was found */
+      VexCorpusInfo info;
+   }
+   VexCorpus;
+
+/* Does 'path' name a file in this format?  Drivers use this to accept
+   either this or the old text format. */
+extern Bool vex_corpus_is_corpus ( const HChar* path );
+
+/* Map 'path' and check its header.  On failure, prints a message to
+   stderr and returns False. */
+extern Bool vex_corpus_open   ( /*OUT*/VexCorpus* c, const HChar* path );
+extern void vex_corpus_close  ( VexCorpus* c );
+
+/* Get the next block, or return False at the end.  Blocks come back
+   in file order.  A record that is truncated or runs past the end of
+   the file also ends the corpus: a message is printed to stderr and
+   'bad' is set, which callers should check once they are done. */
+extern Bool vex_corpus_next   ( VexCorpus* c, /*OUT*/VexCorpusBlock* b );
+extern void vex_corpus_rewind ( VexCorpus* c );
+
+
+/* A corpus being written.  Blocks are streamed out; the header's
+   block count is filled in by vex_corpus_finish. */
+typedef
+   struct {
+      void*         f;   /* FILE* */
+      VexCorpusInfo info;
+   }
+   VexCorpusWriter;
+
+extern Bool vex_corpus_create ( /*OUT*/VexCorpusWriter* w,
+                                const HChar* path,
+                                UInt arch, UInt hwcaps, UInt endness );
+extern void vex_corpus_add    ( VexCorpusWriter* w, ULong addr,
+                                const UChar* bytes, UInt n_bytes,
+                                UInt weight );
+extern Bool vex_corpus_finish ( VexCorpusWriter* w );
+
+#endif /* ndef __VEX_CORPUS_H */
+
+/*---------------------------------------------------------------*/
+/*--- end                                        vex_corpus.h ---*/
+/*---------------------------------------------------------------*/